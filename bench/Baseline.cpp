@@ -0,0 +1,76 @@
+#include "Benchmark.h"
+#include "utils/File.h"
+#include "utils/Json.h"
+#include <cstdio>
+
+namespace pg {
+namespace bench {
+
+namespace {
+
+const Result* findResult(const std::vector<Result>& results, const std::string& name) {
+    for (const Result& result : results) {
+        if (result.name == name) {
+            return &result;
+        }
+    }
+    return nullptr;
+}
+
+double tolerance(const JsonParser& json, const JsonToken& entry, const char* name, double fallback) {
+    const JsonToken token = json.query(entry, name);
+    return token ? token.as<double>() : fallback;
+}
+
+}
+
+int compareWithBaseline(const std::string& file, const std::vector<Result>& results, double timeTolerance, double counterTolerance) {
+    if (!fileExists(file)) {
+        std::fprintf(stderr, "Baseline %s does not exist\n", file.c_str());
+        return 1;
+    }
+    JsonParser json{ file.c_str() };
+    int failures = 0;
+    int compared = 0;
+    char query[64];
+    for (int i = 0;; ++i) {
+        std::snprintf(query, sizeof(query), "benchmarks[%i]", i);
+        const JsonToken entry = json.query(query);
+        if (!entry) {
+            break;
+        }
+        const std::string name = json.query(entry, "name").as<const char*>();
+        const Result* result = findResult(results, name);
+        if (!result) {
+            std::printf("MISSING   %s\n", name.c_str());
+            ++failures;
+            continue;
+        }
+        ++compared;
+
+        const JsonToken time = json.query(entry, "ns_per_iteration");
+        if (time) {
+            const double baseline = time.as<double>();
+            const double limit = baseline * (1.0 + tolerance(json, entry, "time_tolerance", timeTolerance));
+            if (result->nsPerIteration > limit) {
+                std::printf("REGRESSED %s: %.1f ns per iteration, baseline %.1f\n", name.c_str(), result->nsPerIteration, baseline);
+                ++failures;
+            }
+        }
+        const double counterLimit = 1.0 + tolerance(json, entry, "counter_tolerance", counterTolerance);
+        for (const auto& counter : result->counters) {
+            std::snprintf(query, sizeof(query), "counters.%s", counter.first.c_str());
+            const JsonToken value = json.query(entry, query);
+            // half a count of margin, for the one-off allocations which are spread over the iterations
+            if (value && counter.second > value.as<double>() * counterLimit + 0.5) {
+                std::printf("REGRESSED %s: %s %.3f, baseline %.3f\n", name.c_str(), counter.first.c_str(), counter.second, value.as<double>());
+                ++failures;
+            }
+        }
+    }
+    std::printf("Compared %d benchmarks against %s: %d failed\n", compared, file.c_str(), failures);
+    return failures;
+}
+
+}   // bench
+}   // pg
@@ -0,0 +1,93 @@
+#include "Benchmark.h"
+#include "utils/AllocationTracker.h"
+
+namespace pg {
+namespace bench {
+
+State::State(std::uint64_t iterations, std::int64_t argument)
+    : iterations_{ iterations },
+    remaining_{ iterations },
+    argument_{ argument },
+    items_{ 0u },
+    elapsed_{ 0.0 },
+    allocations_{ 0u },
+    startAllocations_{ 0u },
+    counters_{},
+    start_{},
+    started_{ false },
+    paused_{ false } {}
+
+bool State::keepRunning() {
+    if (!started_) {
+        started_ = true;
+        startAllocations_ = detail::allocationCount();
+        start_ = Clock::now();
+    }
+    if (remaining_ == 0u) {
+        pauseTiming();
+        return false;
+    }
+    --remaining_;
+    return true;
+}
+
+void State::pauseTiming() {
+    if (started_ && !paused_) {
+        elapsed_ += double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count());
+        allocations_ += detail::allocationCount() - startAllocations_;
+        paused_ = true;
+    }
+}
+
+void State::resumeTiming() {
+    if (paused_) {
+        paused_ = false;
+        startAllocations_ = detail::allocationCount();
+        start_ = Clock::now();
+    }
+}
+
+void State::setCounter(const std::string& name, double value) {
+    for (auto& counter : counters_) {
+        if (counter.first == name) {
+            counter.second = value;
+            return;
+        }
+    }
+    counters_.emplace_back(name, value);
+}
+
+std::vector<Benchmark>& benchmarks() {
+    static std::vector<Benchmark> registered{};
+    return registered;
+}
+
+Registrar::Registrar(const char* name, Function function, std::initializer_list<std::int64_t> arguments) {
+    benchmarks().push_back(Benchmark{ name, function, arguments });
+}
+
+namespace detail {
+
+#if defined(__GNUC__)
+// the empty asm may read the pointer and any memory, so the value has to be computed
+void escape(const void* p) {
+    asm volatile("" : : "g"(p) : "memory");
+}
+#else
+// MSVC has no inline asm on x64. The store to a volatile can't be elided either.
+const void* volatile escapeSink = nullptr;
+
+void escape(const void* p) {
+    escapeSink = p;
+}
+#endif
+
+// the bench program is built with PG_TRACK_ALLOCATIONS, so the tracker counts the allocations
+std::uint64_t allocationCount() {
+    return allocationTracker().total().allocations;
+}
+
+}
+
+}   // bench
+}   // pg
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace pg {
+namespace bench {
+
+/**
+ * @class State
+ * @brief Drives the timed loop of one benchmark run.
+ *
+ * The benchmark body loops while keepRunning returns true. The runner picks the number of
+ * iterations, so that the whole loop takes at least the minimum time. Setup which must not
+ * count towards the time goes between pauseTiming and resumeTiming. The heap allocations are
+ * counted over the same timed sections.
+ */
+class State {
+public:
+    State(std::uint64_t iterations, std::int64_t argument);
+
+    bool            keepRunning();
+    void            pauseTiming();
+    void            resumeTiming();
+
+    /// @brief The argument the benchmark was registered with, e.g. the number of entities.
+    std::int64_t    argument() const { return argument_; }
+    std::uint64_t   iterations() const { return iterations_; }
+    /// @brief Report the number of items processed over all iterations, for the items/s rate.
+    void            setItemsProcessed(std::uint64_t items) { items_ = items; }
+    std::uint64_t   itemsProcessed() const { return items_; }
+    /// @brief The timed duration of the loop in nanoseconds.
+    double          elapsed() const { return elapsed_; }
+    /// @brief The number of heap allocations made in the timed sections of the loop.
+    std::uint64_t   allocations() const { return allocations_; }
+
+    /**
+     * @brief Report a value which should not change from run to run, such as the number of draws.
+     * The counters are written with the results, and compared against the baseline.
+     */
+    void            setCounter(const std::string& name, double value);
+    const std::vector<std::pair<std::string, double>>& counters() const { return counters_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t       iterations_;
+    std::uint64_t       remaining_;
+    std::int64_t        argument_;
+    std::uint64_t       items_;
+    double              elapsed_;
+    std::uint64_t       allocations_;
+    std::uint64_t       startAllocations_;
+    std::vector<std::pair<std::string, double>> counters_;
+    Clock::time_point   start_;
+    bool                started_;
+    bool                paused_;
+};
+
+using Function = void(*)(State&);
+
+struct Benchmark {
+    std::string                 name;
+    Function                    function;
+    std::vector<std::int64_t>   arguments;  // the benchmark runs once per argument, or once if there are none
+};
+
+struct Result {
+    std::string     name;
+    std::uint64_t   iterations;
+    double          nsPerIteration;     // the median over the repetitions
+    double          nsPerIterationMin;
+    double          itemsPerSecond;
+    std::vector<std::pair<std::string, double>> counters;  // including allocations per iteration
+};
+
+std::vector<Benchmark>& benchmarks();
+
+struct Registrar {
+    Registrar(const char* name, Function function, std::initializer_list<std::int64_t> arguments);
+};
+
+/**
+ * @brief Compare the results against a baseline file in the format of the JSON results.
+ * A result is a regression if its time per iteration exceeds the baseline's by more than
+ * timeTolerance, or one of its counters exceeds the baseline's by more than counterTolerance.
+ * The tolerances are fractions of the baseline values, and can be overridden per benchmark with
+ * "time_tolerance" and "counter_tolerance". Only the values which the baseline has are compared.
+ * @return The number of regressions, and benchmarks of the baseline which are missing.
+ */
+int compareWithBaseline(const std::string& file, const std::vector<Result>& results, double timeTolerance, double counterTolerance);
+
+namespace detail {
+void escape(const void*);
+// the number of heap allocations made by the program so far
+std::uint64_t allocationCount();
+}
+
+/// @brief Keep the compiler from optimizing the computation of value away.
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    detail::escape(&value);
+}
+
+}   // bench
+}   // pg
+
+#define PG_BENCH_CONCAT_IMPL(a, b) a##b
+#define PG_BENCH_CONCAT(a, b) PG_BENCH_CONCAT_IMPL(a, b)
+
+/// @brief Define and register a benchmark, which runs once per argument.
+#define PG_BENCHMARK_ARGS(name, ...) \
+    static void name(::pg::bench::State&); \
+    static ::pg::bench::Registrar PG_BENCH_CONCAT(name, Registrar){ #name, &name, { __VA_ARGS__ } }; \
+    static void name(::pg::bench::State& state)
+
+/// @brief Define and register a benchmark without arguments.
+#define PG_BENCHMARK(name) \
+    static void name(::pg::bench::State&); \
+    static ::pg::bench::Registrar PG_BENCH_CONCAT(name, Registrar){ #name, &name, {} }; \
+    static void name(::pg::bench::State& state)
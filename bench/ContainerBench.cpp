@@ -0,0 +1,93 @@
+#include "Benchmark.h"
+#include "utils/Array.h"
+#include "utils/Container.h"
+#include "utils/MemoryArena.h"
+#include "utils/RingBuffer.h"
+#include <new>
+
+using pg::bench::doNotOptimize;
+
+namespace {
+
+struct Element {
+    float x, y, z, w;
+};
+
+}
+
+PG_BENCHMARK_ARGS(MemoryArenaFill, 1000, 100000) {
+    while (state.keepRunning()) {
+        pg::MemoryArena<Element> arena{ 128u };
+        for (std::int64_t i = 0; i < state.argument(); ++i) {
+            arena.reserve(std::size_t(i + 1));
+            new (arena.at(std::size_t(i))) Element{ float(i), 0.f, 0.f, 1.f };
+        }
+        doNotOptimize(*static_cast<const Element*>(arena.at(0u)));
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+PG_BENCHMARK_ARGS(MemoryArenaRead, 1000, 100000) {
+    pg::MemoryArena<Element> arena{ 128u };
+    arena.reserve(std::size_t(state.argument()));
+    for (std::int64_t i = 0; i < state.argument(); ++i) {
+        new (arena.at(std::size_t(i))) Element{ float(i), 0.f, 0.f, 1.f };
+    }
+    while (state.keepRunning()) {
+        float sum = 0.f;
+        for (std::int64_t i = 0; i < state.argument(); ++i) {
+            sum += static_cast<const Element*>(arena.at(std::size_t(i)))->x;
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+PG_BENCHMARK_ARGS(ContainerEmplace, 1000, 100000) {
+    while (state.keepRunning()) {
+        pg::Container<Element> container{};
+        for (std::int64_t i = 0; i < state.argument(); ++i) {
+            container.emplace(float(i), 0.f, 0.f, 1.f);
+        }
+        doNotOptimize(container.at(0u));
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+PG_BENCHMARK_ARGS(DynamicArrayPushBack, 1000, 100000) {
+    while (state.keepRunning()) {
+        pg::DynamicArray<Element> array{};
+        for (std::int64_t i = 0; i < state.argument(); ++i) {
+            array.pushBack(Element{ float(i), 0.f, 0.f, 1.f });
+        }
+        doNotOptimize(array.back());
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+PG_BENCHMARK_ARGS(DynamicArrayIterate, 1000, 100000) {
+    pg::DynamicArray<Element> array{};
+    for (std::int64_t i = 0; i < state.argument(); ++i) {
+        array.pushBack(Element{ float(i), 0.f, 0.f, 1.f });
+    }
+    while (state.keepRunning()) {
+        float sum = 0.f;
+        for (const Element& element : array) {
+            sum += element.x;
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+// the buffer wraps around after its capacity of 256 elements
+PG_BENCHMARK_ARGS(RingBufferPushBack, 1000, 100000) {
+    pg::RingBuffer<Element> ring{ 256u };
+    while (state.keepRunning()) {
+        for (std::int64_t i = 0; i < state.argument(); ++i) {
+            ring.pushBack(Element{ float(i), 0.f, 0.f, 1.f });
+        }
+        doNotOptimize(ring.back());
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
@@ -0,0 +1,117 @@
+#include "Benchmark.h"
+#include "ecs/Include.h"
+#include <memory>
+#include <vector>
+
+using pg::bench::doNotOptimize;
+using pg::ecs::Entity;
+using pg::ecs::EntityManager;
+using pg::ecs::EventManager;
+
+namespace {
+
+struct Position {
+    float x, y, z;
+};
+
+struct Velocity {
+    float x, y, z;
+};
+
+struct Collision {
+    std::uint32_t entity;
+};
+
+class CollisionCounter : public pg::ecs::Receiver {
+public:
+    void receive(const Collision& collision) {
+        count += collision.entity;
+    }
+
+    std::uint64_t count{ 0u };
+};
+
+}
+
+PG_BENCHMARK_ARGS(EntityCreate, 1000, 10000, 100000, 1000000) {
+    EventManager events{};
+    std::unique_ptr<EntityManager> entities{};
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        entities.reset(new EntityManager{ events });
+        state.resumeTiming();
+        for (std::int64_t i = 0; i < state.argument(); ++i) {
+            Entity entity = entities->create();
+            entity.assign<Position>(1.f, 2.f, 3.f);
+            doNotOptimize(entity);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+PG_BENCHMARK_ARGS(EntityDestroy, 1000, 10000, 100000, 1000000) {
+    EventManager events{};
+    EntityManager entities{ events };
+    std::vector<Entity> created;
+    created.reserve(std::size_t(state.argument()));
+    // the first round grows the free list, which would count as allocations
+    for (std::int64_t i = 0; i < state.argument(); ++i) {
+        created.push_back(entities.create());
+    }
+    for (Entity& entity : created) {
+        entity.destroy();
+    }
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        created.clear();
+        for (std::int64_t i = 0; i < state.argument(); ++i) {
+            created.push_back(entities.create());
+            created.back().assign<Position>(1.f, 2.f, 3.f);
+        }
+        state.resumeTiming();
+        for (Entity& entity : created) {
+            entity.destroy();
+        }
+    }
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+// every other entity has both components
+PG_BENCHMARK_ARGS(EntityJoin, 1000, 10000, 100000, 1000000) {
+    EventManager events{};
+    EntityManager entities{ events };
+    for (std::int64_t i = 0; i < state.argument(); ++i) {
+        Entity entity = entities.create();
+        entity.assign<Position>(0.f, 0.f, 0.f);
+        if (i % 2 == 0) {
+            entity.assign<Velocity>(1.f, 1.f, 1.f);
+        }
+    }
+    while (state.keepRunning()) {
+        for (Entity entity : entities.join<Position, Velocity>()) {
+            Position& position = *entity.component<Position>();
+            const Velocity& velocity = *entity.component<Velocity>();
+            position.x += velocity.x;
+            position.y += velocity.y;
+            position.z += velocity.z;
+        }
+    }
+    doNotOptimize(*entities.get(0u).component<Position>());
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+PG_BENCHMARK_ARGS(EventEmit, 0, 1, 8) {
+    EventManager events{};
+    std::vector<CollisionCounter> receivers(std::size_t(state.argument()));
+    for (CollisionCounter& receiver : receivers) {
+        events.subscribe<Collision>(receiver);
+    }
+    std::uint32_t i = 0u;
+    while (state.keepRunning()) {
+        events.emit<Collision>(i++);
+    }
+    for (CollisionCounter& receiver : receivers) {
+        doNotOptimize(receiver.count);
+    }
+    state.setItemsProcessed(state.iterations());
+}
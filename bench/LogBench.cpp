@@ -0,0 +1,53 @@
+#include "Benchmark.h"
+#include "utils/Log.h"
+#include <cstdio>
+
+namespace {
+
+const char* LogFile = "bench_log.txt";
+// fits in a thread's buffer, so that the writer's throughput isn't measured
+const int RecordsPerBurst = 256;
+
+}
+
+// the cost of a record on the calling thread
+PG_BENCHMARK(LogRecord) {
+    pg::Log::setOutput(LogFile);
+    int i = 0;
+    while (state.keepRunning()) {
+        for (int j = 0; j < RecordsPerBurst; ++j) {
+            LOG_INFO << "entity " << i++ << " moved to " << 1.5f;
+        }
+        state.pauseTiming();
+        pg::Log::flush();
+        state.resumeTiming();
+    }
+    pg::Log::setOutput("");
+    std::remove(LogFile);
+    state.setItemsProcessed(state.iterations() * RecordsPerBurst);
+}
+
+// the records written per second, when the writer can't keep up
+PG_BENCHMARK(LogThroughput) {
+    pg::Log::setOutput(LogFile);
+    int i = 0;
+    while (state.keepRunning()) {
+        LOG_INFO << "entity " << i++ << " moved to " << 1.5f;
+    }
+    pg::Log::flush();
+    pg::Log::setOutput("");
+    std::remove(LogFile);
+    state.setItemsProcessed(state.iterations());
+}
+
+// a record above the reporting level costs a comparison
+PG_BENCHMARK(LogFilteredRecord) {
+    const pg::LogLevel level = pg::Log::ReportingLevel();
+    pg::Log::ReportingLevel() = pg::LogLevel::Info;
+    int i = 0;
+    while (state.keepRunning()) {
+        LOG_DEBUG << "entity " << i++ << " moved to " << 1.5f;
+    }
+    pg::Log::ReportingLevel() = level;
+    state.setItemsProcessed(state.iterations());
+}
@@ -0,0 +1,192 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Runs the registered benchmarks, prints a table of the results and optionally writes them as
+ * JSON, so that runs of different versions can be compared. With --baseline, the results are
+ * compared against a stored baseline, and the exit code is 2 if any of them regressed.
+ *
+ * usage: bench [--filter <text>] [--min-time <seconds>] [--repetitions <n>] [--json <file>]
+ *              [--baseline <file>] [--time-tolerance <fraction>] [--counter-tolerance <fraction>]
+ * */
+
+using namespace pg::bench;
+
+namespace {
+
+struct Options {
+    std::string filter{};
+    double      minTime{ 0.2 };
+    int         repetitions{ 3 };
+    std::string json{};
+    std::string baseline{};
+    double      timeTolerance{ 0.25 };
+    double      counterTolerance{ 0.0 };
+};
+
+const char* Usage = "usage: %s [--filter <text>] [--min-time <seconds>] [--repetitions <n>] [--json <file>]\n"
+    "    [--baseline <file>] [--time-tolerance <fraction>] [--counter-tolerance <fraction>]\n";
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            options.minTime = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            options.repetitions = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            options.json = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            options.baseline = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--time-tolerance") == 0 && hasValue) {
+            options.timeTolerance = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--counter-tolerance") == 0 && hasValue) {
+            options.counterTolerance = std::atof(argv[++i]);
+        }
+        else {
+            std::fprintf(stderr, Usage, argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// run the benchmark with increasing iteration counts until it takes at least minTime
+State runOnce(const Benchmark& benchmark, std::int64_t argument, double minTime) {
+    const double minNanoseconds = minTime * 1e9;
+    std::uint64_t iterations = 1u;
+    for (;;) {
+        State state{ iterations, argument };
+        benchmark.function(state);
+        if (state.elapsed() >= minNanoseconds || iterations >= 1000000000u) {
+            return state;
+        }
+        const double multiplier = std::min(std::max(1.4 * minNanoseconds / std::max(state.elapsed(), 1.0), 2.0), 100.0);
+        iterations = std::uint64_t(double(iterations) * multiplier);
+    }
+}
+
+Result run(const Benchmark& benchmark, const std::string& name, std::int64_t argument, const Options& options) {
+    std::vector<double> times;
+    std::vector<double> rates;
+    std::uint64_t iterations = 0u;
+    double allocations = 0.0;
+    std::vector<std::pair<std::string, double>> counters;
+    for (int i = 0; i < options.repetitions; ++i) {
+        const State state = runOnce(benchmark, argument, options.minTime);
+        iterations = state.iterations();
+        times.push_back(state.elapsed() / double(state.iterations()));
+        rates.push_back(double(state.itemsProcessed()) * 1e9 / std::max(state.elapsed(), 1.0));
+        // the fewest, as the first run can make one-off allocations
+        const double perIteration = double(state.allocations()) / double(state.iterations());
+        allocations = i == 0 ? perIteration : std::min(allocations, perIteration);
+        counters = state.counters();
+    }
+    std::sort(times.begin(), times.end());
+    std::sort(rates.begin(), rates.end());
+    counters.insert(counters.begin(), std::make_pair(std::string("allocations"), allocations));
+    return Result{ name, iterations, times[times.size() / 2u], times.front(), rates[rates.size() / 2u], counters };
+}
+
+void writeEscaped(std::FILE* file, const std::string& str) {
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(c, file);
+    }
+}
+
+bool writeJson(const std::string& path, const std::vector<Result>& results, const Options& options) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::fprintf(stderr, "Could not open %s for writing\n", path.c_str());
+        return false;
+    }
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+    std::fprintf(file, "{\n  \"context\": {\"date\": \"%s\", \"build\": \"%s\", \"min_time\": %g, \"repetitions\": %d},\n",
+        date, build, options.minTime, options.repetitions);
+    std::fputs("  \"benchmarks\": [", file);
+    for (std::size_t i = 0u; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::fputs(i == 0u ? "\n    {\"name\": \"" : ",\n    {\"name\": \"", file);
+        writeEscaped(file, result.name);
+        std::fprintf(file, "\", \"iterations\": %llu, \"ns_per_iteration\": %.3f, \"ns_per_iteration_min\": %.3f, \"items_per_second\": %.1f, \"counters\": {",
+            (unsigned long long)result.iterations, result.nsPerIteration, result.nsPerIterationMin, result.itemsPerSecond);
+        for (std::size_t j = 0u; j < result.counters.size(); ++j) {
+            std::fputs(j == 0u ? "\"" : ", \"", file);
+            writeEscaped(file, result.counters[j].first);
+            std::fprintf(file, "\": %.3f", result.counters[j].second);
+        }
+        std::fputs("}}", file);
+    }
+    std::fputs("\n  ]\n}\n", file);
+    const bool ok = !std::ferror(file);
+    if (std::fclose(file) != 0 || !ok) {
+        std::fprintf(stderr, "Could not write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options{};
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<Result> results;
+    std::printf("%-40s %14s %16s %16s %12s\n", "benchmark", "iterations", "ns/iteration", "items/s", "allocations");
+    for (const Benchmark& benchmark : benchmarks()) {
+        std::vector<std::int64_t> arguments = benchmark.arguments;
+        if (arguments.empty()) {
+            arguments.push_back(0);
+        }
+        for (std::int64_t argument : arguments) {
+            std::string name = benchmark.name;
+            if (!benchmark.arguments.empty()) {
+                name += "/" + std::to_string(argument);
+            }
+            if (name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            results.push_back(run(benchmark, name, argument, options));
+            const Result& result = results.back();
+            std::printf("%-40s %14llu %16.1f %16.0f %12.2f\n", result.name.c_str(),
+                (unsigned long long)result.iterations, result.nsPerIteration, result.itemsPerSecond, result.counters.front().second);
+            std::fflush(stdout);
+        }
+    }
+
+    if (!options.json.empty() && !writeJson(options.json, results, options)) {
+        return 1;
+    }
+    if (!options.baseline.empty() && compareWithBaseline(options.baseline, results, options.timeTolerance, options.counterTolerance) != 0) {
+        return 2;
+    }
+    return 0;
+}
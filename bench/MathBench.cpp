@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+#include "math/Intersection.h"
+#include "math/Matrix.h"
+#include "math/Quaternion.h"
+#include "math/Vector.h"
+#include "utils/Random.h"
+#include <vector>
+
+using pg::bench::doNotOptimize;
+using namespace pg::math;
+
+namespace {
+
+// the inputs are regenerated from the same seed for each benchmark, so that runs are comparable
+const std::size_t Count = 1024u;
+
+std::vector<Vec3f> randomVectors() {
+    pg::seed(1234u);
+    std::vector<Vec3f> vectors;
+    for (std::size_t i = 0u; i < Count; ++i) {
+        vectors.push_back(Vec3f{ pg::randf(-1.f, 1.f), pg::randf(-1.f, 1.f), pg::randf(-1.f, 1.f) });
+    }
+    return vectors;
+}
+
+std::vector<Quatf> randomRotations() {
+    std::vector<Quatf> rotations;
+    for (const Vec3f& axis : randomVectors()) {
+        rotations.push_back(Quatf{ axis, 1.f }.normalized());
+    }
+    return rotations;
+}
+
+std::vector<Matrix4f> randomTransforms() {
+    std::vector<Matrix4f> transforms;
+    const std::vector<Vec3f> vectors = randomVectors();
+    const std::vector<Quatf> rotations = randomRotations();
+    for (std::size_t i = 0u; i < Count; ++i) {
+        transforms.push_back(Matrix4f::translation(vectors[i]) * Matrix4f::rotation(rotations[i]));
+    }
+    return transforms;
+}
+
+}
+
+PG_BENCHMARK(Vec3CrossNormalize) {
+    const std::vector<Vec3f> vectors = randomVectors();
+    while (state.keepRunning()) {
+        Vec3f sum{ 0.f, 0.f, 0.f };
+        for (std::size_t i = 1u; i < Count; ++i) {
+            sum = sum + vectors[i - 1u].cross(vectors[i]).normalized();
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * (Count - 1u));
+}
+
+PG_BENCHMARK(Matrix4Multiply) {
+    const std::vector<Matrix4f> transforms = randomTransforms();
+    while (state.keepRunning()) {
+        Matrix4f product{};
+        for (const Matrix4f& transform : transforms) {
+            product = product * transform;
+        }
+        doNotOptimize(product);
+    }
+    state.setItemsProcessed(state.iterations() * Count);
+}
+
+PG_BENCHMARK(Matrix4Inverse) {
+    const std::vector<Matrix4f> transforms = randomTransforms();
+    while (state.keepRunning()) {
+        for (const Matrix4f& transform : transforms) {
+            doNotOptimize(transform.inverse());
+        }
+    }
+    state.setItemsProcessed(state.iterations() * Count);
+}
+
+PG_BENCHMARK(Matrix4TransformPoint) {
+    const std::vector<Matrix4f> transforms = randomTransforms();
+    const std::vector<Vec3f> points = randomVectors();
+    while (state.keepRunning()) {
+        Vec4f sum{ 0.f, 0.f, 0.f, 0.f };
+        for (std::size_t i = 0u; i < Count; ++i) {
+            sum = sum + transforms[i] * Vec4f{ points[i], 1.f };
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * Count);
+}
+
+PG_BENCHMARK(QuaternionMultiply) {
+    const std::vector<Quatf> rotations = randomRotations();
+    while (state.keepRunning()) {
+        Quatf product = Quatf::Identity();
+        for (const Quatf& rotation : rotations) {
+            product = product * rotation;
+        }
+        doNotOptimize(product);
+    }
+    state.setItemsProcessed(state.iterations() * Count);
+}
+
+PG_BENCHMARK(QuaternionRotate) {
+    const std::vector<Quatf> rotations = randomRotations();
+    const std::vector<Vec3f> vectors = randomVectors();
+    while (state.keepRunning()) {
+        Vec4f sum{ 0.f, 0.f, 0.f, 0.f };
+        for (std::size_t i = 0u; i < Count; ++i) {
+            sum = sum + rotations[i].rotate(Vec4f{ vectors[i], 0.f });
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * Count);
+}
+
+// rays from random points around the box, towards random points, so that some of them miss
+PG_BENCHMARK(RayIntersectsAABox) {
+    const std::vector<Vec3f> targets = randomVectors();
+    std::vector<Rayf> rays;
+    for (const Vec3f& target : targets) {
+        const Vec3f origin = -4.f * target.normalized();
+        rays.push_back(Rayf{ origin, (target * 2.f - origin).normalized(), 0.f });
+    }
+    const AABoxf box{ Vec3f{ -0.5f, -0.5f, -0.5f }, Vec3f{ 0.5f, 0.5f, 0.5f } };
+    while (state.keepRunning()) {
+        std::size_t hits = 0u;
+        for (Rayf ray : rays) {
+            hits += rayIntersectsAABox(ray, box) ? 1u : 0u;
+        }
+        doNotOptimize(hits);
+    }
+    state.setItemsProcessed(state.iterations() * Count);
+}
@@ -0,0 +1,96 @@
+#include "Benchmark.h"
+#include "utils/Json.h"
+#include "utils/StringId.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using pg::bench::doNotOptimize;
+
+namespace {
+
+// a scene in the format readScene expects, with the given number of entities
+std::string writeScene(std::int64_t entities) {
+    const std::string path = "bench_scene_" + std::to_string(entities) + ".json";
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    std::fputs("{\n\"entities\": [\n", file);
+    for (std::int64_t i = 0; i < entities; ++i) {
+        std::fprintf(file,
+            "%s{ \"transform\": { \"position\": [%d.5, 0.0, -%d.25], \"scale\": [1.0, 1.0, 1.0], \"rotation\": [0.0, 0.0, 0.0, 1.0] },\n"
+            "  \"renderable\": { \"model\": \"data/cube.obj\", \"material\": { \"type\": \"specular\", \"shininess\": 80.0,\n"
+            "    \"specularColor\": [1.0, 1.0, 1.0], \"baseColor\": [0.8, 0.4, 0.2], \"ambientColor\": [0.1, 0.1, 0.1] } } }\n",
+            i == 0 ? "" : ",", int(i), int(i));
+    }
+    std::fputs("]\n}\n", file);
+    std::fclose(file);
+    return path;
+}
+
+}
+
+// parse the file, and query the transform of each entity like readScene does
+PG_BENCHMARK_ARGS(JsonParseScene, 10, 100, 1000) {
+    const std::string path = writeScene(state.argument());
+    char query[64];
+    while (state.keepRunning()) {
+        pg::JsonParser json{ path.c_str() };
+        float sum = 0.f;
+        for (int i = 0;; ++i) {
+            std::sprintf(query, "entities[%i]", i);
+            pg::JsonToken entity = json.query(query);
+            if (!entity) {
+                break;
+            }
+            pg::JsonToken transform = json.query(entity, "transform");
+            sum += json.query(transform, "position[0]").as<float>();
+            sum += json.query(transform, "scale[1]").as<float>();
+            sum += json.query(transform, "rotation[3]").as<float>();
+        }
+        doNotOptimize(sum);
+    }
+    std::remove(path.c_str());
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+PG_BENCHMARK_ARGS(StringIdIntern, 1000, 100000) {
+    std::vector<std::string> strings;
+    for (std::int64_t i = 0; i < state.argument(); ++i) {
+        strings.push_back("entity/component/" + std::to_string(i));
+    }
+    pg::StringId::Database database{};
+    pg::StringId::setDatabase(&database);
+    // the first round grows the buckets, which clear keeps
+    for (const std::string& str : strings) {
+        pg::StringId{ str.c_str() };
+    }
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        database.clear();
+        state.resumeTiming();
+        for (const std::string& str : strings) {
+            doNotOptimize(pg::StringId{ str.c_str() });
+        }
+    }
+    pg::StringId::setDatabase(nullptr);
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
+
+// interning strings which are already in the database
+PG_BENCHMARK_ARGS(StringIdLookup, 1000, 100000) {
+    std::vector<std::string> strings;
+    for (std::int64_t i = 0; i < state.argument(); ++i) {
+        strings.push_back("entity/component/" + std::to_string(i));
+    }
+    pg::StringId::Database database{};
+    pg::StringId::setDatabase(&database);
+    for (const std::string& str : strings) {
+        pg::StringId{ str.c_str() };
+    }
+    while (state.keepRunning()) {
+        for (const std::string& str : strings) {
+            doNotOptimize(pg::StringId{ str.c_str() });
+        }
+    }
+    pg::StringId::setDatabase(nullptr);
+    state.setItemsProcessed(state.iterations() * std::uint64_t(state.argument()));
+}
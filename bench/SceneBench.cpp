@@ -0,0 +1,146 @@
+#include "Benchmark.h"
+#include "ecs/Include.h"
+#include "math/Vector.h"
+#include "utils/Random.h"
+#include <memory>
+#include <vector>
+#include <cmath>
+
+using pg::bench::doNotOptimize;
+using pg::ecs::Entity;
+using pg::ecs::EntityManager;
+using pg::ecs::EventManager;
+using pg::ecs::SystemManager;
+using pg::math::Vec3f;
+
+/*
+ * A macro benchmark of whole simulation frames. A seeded scene of moving bodies runs through
+ * SystemManager with a fixed time step, so each iteration simulates exactly the same frames. The
+ * number of wall hits and respawns are reported as counters, which change only if the simulation
+ * does.
+ * */
+
+namespace {
+
+const float TimeStep = 1.f / 60.f;
+const int FramesPerIteration = 60;
+const float HalfExtent = 50.f;
+
+struct Body {
+    Vec3f position;
+    Vec3f velocity;
+};
+
+struct Lifetime {
+    float remaining;
+};
+
+struct WallHit {
+    std::uint32_t entity;
+};
+
+void spawn(EntityManager& entities) {
+    Entity entity = entities.create();
+    entity.assign<Body>(
+        Vec3f{ pg::randf(-HalfExtent, HalfExtent), pg::randf(-HalfExtent, HalfExtent), pg::randf(-HalfExtent, HalfExtent) },
+        Vec3f{ pg::randf(-20.f, 20.f), pg::randf(-20.f, 20.f), pg::randf(-20.f, 20.f) }
+    );
+    entity.assign<Lifetime>(pg::randf(0.1f, 2.f));
+}
+
+class MovementSystem : public pg::ecs::System {
+public:
+    void update(EntityManager& entities, EventManager& events, float dt) override {
+        for (Entity entity : entities.join<Body>()) {
+            Body& body = *entity.component<Body>();
+            body.position = body.position + body.velocity * dt;
+            for (int axis = 0; axis < 3; ++axis) {
+                if (std::abs(body.position.data[axis]) > HalfExtent) {
+                    body.velocity.data[axis] = -body.velocity.data[axis];
+                    events.emit<WallHit>(entity.id().index());
+                }
+            }
+        }
+    }
+};
+
+// replaces each expired body with a new one
+class LifetimeSystem : public pg::ecs::System {
+public:
+    void update(EntityManager& entities, EventManager&, float dt) override {
+        expired_.clear();
+        for (Entity entity : entities.join<Lifetime>()) {
+            Lifetime& lifetime = *entity.component<Lifetime>();
+            lifetime.remaining -= dt;
+            if (lifetime.remaining <= 0.f) {
+                expired_.push_back(entity);
+            }
+        }
+        for (Entity& entity : expired_) {
+            entity.destroy();
+            spawn(entities);
+        }
+        respawns += expired_.size();
+    }
+
+    std::uint64_t respawns{ 0u };
+
+private:
+    std::vector<Entity> expired_{};
+};
+
+class WallHitCounter : public pg::ecs::Receiver {
+public:
+    void receive(const WallHit&) {
+        ++hits;
+    }
+
+    std::uint64_t hits{ 0u };
+};
+
+struct Scene {
+    explicit Scene(std::int64_t bodies)
+        : events{},
+        entities{ events },
+        systems{ events, entities } {
+        pg::seed(42u);
+        systems.add<MovementSystem>();
+        systems.add<LifetimeSystem>();
+        events.subscribe<WallHit>(counter);
+        for (std::int64_t i = 0; i < bodies; ++i) {
+            spawn(entities);
+        }
+    }
+
+    void frame() {
+        systems.update<MovementSystem>(TimeStep);
+        systems.update<LifetimeSystem>(TimeStep);
+    }
+
+    EventManager    events;
+    EntityManager   entities;
+    SystemManager   systems;
+    WallHitCounter  counter;
+};
+
+}
+
+PG_BENCHMARK_ARGS(SceneFrames, 1000, 10000) {
+    std::unique_ptr<Scene> scene{};
+    std::uint64_t hits = 0u;
+    std::uint64_t respawns = 0u;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        scene.reset(new Scene{ state.argument() });
+        state.resumeTiming();
+        for (int i = 0; i < FramesPerIteration; ++i) {
+            scene->frame();
+        }
+        hits = scene->counter.hits;
+        respawns = scene->systems.system<LifetimeSystem>().respawns;
+    }
+    doNotOptimize(hits);
+    state.setCounter("wall_hits", double(hits));
+    state.setCounter("respawns", double(respawns));
+    state.setItemsProcessed(state.iterations() * FramesPerIteration);
+}
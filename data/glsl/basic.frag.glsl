@@ -1,9 +1,15 @@
 #version 330 core
 
-uniform vec3 color;
+layout(std140, row_major) uniform ObjectBlock {
+    mat4 model;
+    vec3 base;
+    float shininess;
+    vec3 ambient;
+    vec3 specularColor;
+};
 
 out vec4 fragColor;
 
 void main() {
-    fragColor = vec4( color, 1.0 );
+    fragColor = vec4( base, 1.0 );
 }
\ No newline at end of file
@@ -1,7 +1,23 @@
 #version 330 core
 
-uniform mat4 camera;
-uniform mat4 model;
+layout(std140, row_major) uniform FrameBlock {
+    mat4 camera;
+    mat4 screen;
+    vec3 cameraPosition;
+    float ambientCoefficient;
+    vec3 cameraForward;
+    // x, y: clusters per pixel. z, w: the scale and bias which map log(depth) to a slice
+    vec4 clusterScale;
+    ivec4 clusterCounts;
+};
+
+layout(std140, row_major) uniform ObjectBlock {
+    mat4 model;
+    vec3 base;
+    float shininess;
+    vec3 ambient;
+    vec3 specularColor;
+};
 
 in vec3 vertex;
 
@@ -0,0 +1,22 @@
+#version 330 core
+
+layout(std140, row_major) uniform FrameBlock {
+    mat4 camera;
+    mat4 screen;
+    vec3 cameraPosition;
+    float ambientCoefficient;
+    vec3 cameraForward;
+    // x, y: clusters per pixel. z, w: the scale and bias which map log(depth) to a slice
+    vec4 clusterScale;
+    ivec4 clusterCounts;
+};
+
+in vec3 vertex;
+in vec4 color;
+
+out vec4 vertexColor;
+
+void main() {
+    vertexColor = color;
+    gl_Position = camera * vec4( vertex, 1.0 );
+}
\ No newline at end of file
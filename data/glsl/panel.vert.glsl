@@ -1,6 +1,15 @@
 #version 330
 
-uniform mat4 MOrtho;
+layout(std140, row_major) uniform FrameBlock {
+    mat4 camera;
+    mat4 screen;
+    vec3 cameraPosition;
+    float ambientCoefficient;
+    vec3 cameraForward;
+    // x, y: clusters per pixel. z, w: the scale and bias which map log(depth) to a slice
+    vec4 clusterScale;
+    ivec4 clusterCounts;
+};
 
 in vec2 position;
 in vec2 uv;
@@ -12,5 +21,5 @@ out vec4 fragColor;
 void main() {
     fragUv = uv;
     fragColor = color;
-    gl_Position = MOrtho * vec4( position.xy, 0.0, 1.0 );
+    gl_Position = screen * vec4( position.xy, 0.0, 1.0 );
 }
\ No newline at end of file
@@ -2,51 +2,80 @@
 
 in vec3 fragPos;
 in vec3 fragNorm;
+flat in vec3 fragBase;
+flat in float fragShininess;
+flat in vec3 fragAmbient;
+flat in vec3 fragSpecular;
 
-uniform vec3 cameraPosition;
-
-uniform struct PointLight {
-    vec3 position;
-    vec3 intensity;
-    float attenuation;
+layout(std140, row_major) uniform FrameBlock {
+    mat4 camera;
+    mat4 screen;
+    vec3 cameraPosition;
     float ambientCoefficient;
-} pointLight;
-
-uniform float shininess;
-uniform vec3 base;
-uniform vec3 ambient;
-uniform vec3 specularColor;
+    vec3 cameraForward;
+    // x, y: clusters per pixel. z, w: the scale and bias which map log(depth) to a slice
+    vec4 clusterScale;
+    ivec4 clusterCounts;
+};
 
-// there needs to be an array of these lights, as well as a light count.
+// two texels per light: the position and radius, the intensity and attenuation
+uniform samplerBuffer lightData;
+// the offset and count of each cluster's lights in lightIndices
+uniform usamplerBuffer lightClusters;
+uniform usamplerBuffer lightIndices;
 
 out vec4 color;
 
 void main() {
     vec3 eye = normalize( cameraPosition - fragPos );
-    vec3 lightDir = pointLight.position - fragPos;
-    float lightDist = length(lightDir);
-    // direction should point to the light
-    // it should be normalized
-    // now the dot product gives positive cosines
-    lightDir = lightDir / lightDist;
-
-    float attenuation = 1.0 / (
-        1.0 +
-        pointLight.attenuation * lightDist * lightDist
+
+    // find the cluster of the fragment, see math::ClusterGrid
+    float depth = max( dot( fragPos - cameraPosition, cameraForward ), 1e-4 );
+    ivec3 cluster = ivec3(
+        int( gl_FragCoord.x * clusterScale.x ),
+        int( gl_FragCoord.y * clusterScale.y ),
+        int( floor( log( depth ) * clusterScale.z + clusterScale.w ) )
     );
+    cluster = clamp( cluster, ivec3( 0 ), clusterCounts.xyz - 1 );
+    uvec2 lights = texelFetch( lightClusters, cluster.x + clusterCounts.x * ( cluster.y + clusterCounts.y * cluster.z ) ).xy;
 
-    float diffuse = max( 0.0, dot(lightDir, fragNorm) );
-    float specular = max( 0.0, dot(reflect(lightDir, fragNorm), eye) );
+    vec3 scatteredLight = fragAmbient * ambientCoefficient;
+    vec3 reflectedLight = vec3( 0.0 );
+    for ( uint i = 0u; i < lights.y; ++i ) {
+        int light = int( texelFetch( lightIndices, int( lights.x + i ) ).x );
+        vec4 positionRadius = texelFetch( lightData, 2 * light );
+        vec4 intensityAttenuation = texelFetch( lightData, 2 * light + 1 );
 
-    if ( diffuse == 0.0 ) {
-        specular = 0.0;
-    } else {
-        specular = pow(specular, shininess);
-    }
+        vec3 lightDir = positionRadius.xyz - fragPos;
+        float lightDist = length(lightDir);
+        if ( lightDist >= positionRadius.w ) {
+            continue;
+        }
+        // direction should point to the light
+        // it should be normalized
+        // now the dot product gives positive cosines
+        lightDir = lightDir / lightDist;
 
-    vec3 scatteredLight = ambient * pointLight.ambientCoefficient + diffuse * pointLight.intensity * attenuation;
-    vec3 reflectedLight = specular*pointLight.intensity*specularColor*attenuation;
-    vec3 rgb = min( base + scatteredLight + reflectedLight, vec3(1.0) );
+        // the light fades out before its radius, so that the cluster edges don't show
+        float fade = clamp( 1.0 - pow( lightDist / positionRadius.w, 4.0 ), 0.0, 1.0 );
+        float attenuation = fade * fade / (
+            1.0 +
+            intensityAttenuation.w * lightDist * lightDist
+        );
+
+        float diffuse = max( 0.0, dot(lightDir, fragNorm) );
+        float specular = max( 0.0, dot(reflect(lightDir, fragNorm), eye) );
+
+        if ( diffuse == 0.0 ) {
+            specular = 0.0;
+        } else {
+            specular = pow(specular, fragShininess);
+        }
+
+        scatteredLight += diffuse * intensityAttenuation.rgb * attenuation;
+        reflectedLight += specular * intensityAttenuation.rgb * fragSpecular * attenuation;
+    }
+    vec3 rgb = min( fragBase + scatteredLight + reflectedLight, vec3(1.0) );
 
     color = vec4( rgb, 1.0 );
 }
@@ -1,18 +1,53 @@
 #version 330 core
 
-uniform mat4 camera;
-uniform mat4 model;
+layout(std140, row_major) uniform FrameBlock {
+    mat4 camera;
+    mat4 screen;
+    vec3 cameraPosition;
+    float ambientCoefficient;
+    vec3 cameraForward;
+    // x, y: clusters per pixel. z, w: the scale and bias which map log(depth) to a slice
+    vec4 clusterScale;
+    ivec4 clusterCounts;
+};
 
+layout(std140, row_major) uniform ObjectBlock {
+    mat4 model;
+    vec3 base;
+    float shininess;
+    vec3 ambient;
+    vec3 specularColor;
+};
+
+// quantized within the mesh bounds, the model matrix includes the dequantization
 in vec3 vertex;
-in vec3 normal;
+// octahedral encoding
+in vec2 normal;
 
 out vec3 fragPos;
 out vec3 fragNorm;
+// the material is passed on, so that the fragment shader can be shared with static.vert
+flat out vec3 fragBase;
+flat out float fragShininess;
+flat out vec3 fragAmbient;
+flat out vec3 fragSpecular;
+
+vec3 octahedralDecode( vec2 e ) {
+    vec3 n = vec3( e, 1.0 - abs( e.x ) - abs( e.y ) );
+    if ( n.z < 0.0 ) {
+        n.xy = ( 1.0 - abs( n.yx ) ) * vec2( n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0 );
+    }
+    return normalize( n );
+}
 
 void main() {
     fragPos = vec3( model * vec4( vertex, 1.0 ) );
     mat3 normalMat = transpose( inverse( mat3( model ) ) );
-    fragNorm = normalize( normalMat * normal );
+    fragNorm = normalize( normalMat * octahedralDecode( normal ) );
+    fragBase = base;
+    fragShininess = shininess;
+    fragAmbient = ambient;
+    fragSpecular = specularColor;
     
     //apply all matrix transformations
     gl_Position = camera * model * vec4( vertex, 1.0 );
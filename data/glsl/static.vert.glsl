@@ -0,0 +1,49 @@
+#version 330 core
+
+layout(std140, row_major) uniform FrameBlock {
+    mat4 camera;
+    mat4 screen;
+    vec3 cameraPosition;
+    float ambientCoefficient;
+    vec3 cameraForward;
+    // x, y: clusters per pixel. z, w: the scale and bias which map log(depth) to a slice
+    vec4 clusterScale;
+    ivec4 clusterCounts;
+};
+
+// the vertices of a static batch are in world space, quantized within the batch bounds
+in vec3 vertex;
+// octahedral encoding, in world space
+in vec2 normal;
+
+// per batch: the center of the bounds, and the scale which maps [-1, 1] into the bounds
+in vec4 dequantize;
+in vec4 materialBase;   // the base color, and the shininess
+in vec3 materialAmbient;
+in vec3 materialSpecular;
+
+out vec3 fragPos;
+out vec3 fragNorm;
+flat out vec3 fragBase;
+flat out float fragShininess;
+flat out vec3 fragAmbient;
+flat out vec3 fragSpecular;
+
+vec3 octahedralDecode( vec2 e ) {
+    vec3 n = vec3( e, 1.0 - abs( e.x ) - abs( e.y ) );
+    if ( n.z < 0.0 ) {
+        n.xy = ( 1.0 - abs( n.yx ) ) * vec2( n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0 );
+    }
+    return normalize( n );
+}
+
+void main() {
+    fragPos = dequantize.xyz + dequantize.w * vertex;
+    fragNorm = octahedralDecode( normal );
+    fragBase = materialBase.rgb;
+    fragShininess = materialBase.a;
+    fragAmbient = materialAmbient;
+    fragSpecular = materialSpecular;
+
+    gl_Position = camera * vec4( fragPos, 1.0 );
+}
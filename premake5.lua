@@ -1,4 +1,9 @@
 
+newoption {
+    trigger = "track-allocations",
+    description = "Count the heap allocations of the engine, see src/utils/AllocationTracker.h"
+}
+
 workspace "playground"
     if _ACTION then
         location( "build/" .._ACTION )
@@ -12,7 +17,8 @@ workspace "playground"
         flags { "Symbols" }
 
     filter "configurations:Release"
-        defines { "NDEBUG" }
+        -- the debug log levels are compiled out, see utils/Log.h
+        defines { "NDEBUG", "PG_LOG_MAX_LEVEL=pg::LogLevel::Info" }
         optimize "On"
 
     filter "configurations:Test"
@@ -20,7 +26,8 @@ workspace "playground"
         optimize "On"
 
     filter "action:gmake"
-        buildoptions { "-std=gnu++14" }
+        buildoptions { "-std=gnu++14", "-pthread" }
+        linkoptions { "-pthread" }
 
     group("external")
 --[[
@@ -114,6 +121,11 @@ workspace "playground"
             buildoutputs { "%{cfg.targetdir}/glsl/%{file.name}" }
         filter "configurations:Debug"
             debugdir "bin"
+        filter "options:track-allocations"
+            defines { "PG_TRACK_ALLOCATIONS" }
+        -- the sampled call sites are named by the exported symbols
+        filter { "options:track-allocations", "action:gmake" }
+            linkoptions { "-rdynamic" }
         --[[
   _   ___               __  ______          ___    
  | | / (_)__ __ _____ _/ / / __/ /___ _____/ (_)__ 
@@ -139,8 +151,13 @@ workspace "playground"
         kind "ConsoleApp"
         language "C++"
         targetdir "bin"
-        files { "test/**.cpp", "src/utils/**.cpp", "src/ecs/**.cpp" }
-        includedirs { "src", "extern/unittest++", "extern" }
+        files {
+            "test/**.cpp", "src/utils/**.cpp", "src/ecs/**.cpp", "src/math/**.cpp",
+            "src/system/SpatialSystem.cpp", "src/manager/MeshCache.cpp"
+        }
+        -- the mesh cache reads the vertex format from manager/Mesh.h, which includes glew
+        includedirs { "src", "extern/unittest++", "extern", "extern/glew-1.13.0/include" }
+        defines { "PG_TRACK_ALLOCATIONS" }
         configuration "vs*"
             defines { "_CRT_SECURE_NO_WARNINGS" } -- This is to turn off warnings about 'localtime'
         filter "configurations:Debug"
@@ -150,3 +167,17 @@ workspace "playground"
         filter "configurations:Release"
             links { "UnitTest++" }
             libdirs { "extern/unittest++/lib/Release" }
+
+    -- Run with --json <file> to write machine readable results, see bench/Main.cpp
+    project "bench"
+        kind "ConsoleApp"
+        language "C++"
+        targetdir "bin"
+        files { "bench/**.cpp", "bench/**.h", "src/utils/**.cpp", "src/ecs/**.cpp", "src/math/**.cpp" }
+        includedirs { "src", "extern" }
+        -- each benchmark reports its heap allocations
+        defines { "PG_TRACK_ALLOCATIONS" }
+        configuration "vs*"
+            defines { "_CRT_SECURE_NO_WARNINGS" } -- This is to turn off warnings about 'localtime'
+        filter "configurations:Debug"
+            debugdir "bin"
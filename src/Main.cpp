@@ -1,48 +1,159 @@
 #include "app/Application.h"
+#include "utils/Log.h"
 #include "Wren++.h"
 #include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>  // for std::exit()
+#include <iostream>
 #include <string>
 #include <vector>
 
-void parseArguments(const std::vector<std::string>& arguments, std::string& wrenTest) {
-    for (auto it = arguments.begin(); it != arguments.end(); it += 2) {
-        if (*it == "--test") {
-            wrenTest = *(it + 1);
+namespace {
+// the frames which the allocation check runs after the warm-up, unless the number of frames is given
+const std::uint64_t CheckedFrames = 600u;
+}
+
+struct Arguments {
+    std::string wrenTest{};
+    bool headless{ false };
+    pg::HeadlessSettings headlessSettings{};
+    std::string record{};
+    std::string logFile{};
+    pg::LogFormat logFormat{ pg::LogFormat::Text };
+};
+
+Arguments parseArguments(const std::vector<std::string>& arguments) {
+    Arguments result{};
+    for (auto it = arguments.begin(); it != arguments.end(); ++it) {
+        const bool hasValue = it + 1 != arguments.end();
+        if (*it == "--test" && hasValue) {
+            result.wrenTest = *++it;
+        }
+        else if (*it == "--headless") {
+            result.headless = true;
+        }
+        else if (*it == "--frames" && hasValue) {
+            result.headlessSettings.frames = std::strtoull((++it)->c_str(), nullptr, 10);
+        }
+        else if (*it == "--time-step" && hasValue) {
+            result.headlessSettings.timeStep = float(std::atof((++it)->c_str()));
+        }
+        else if (*it == "--system-stats" && hasValue) {
+            result.headlessSettings.systemStats = *++it;
+        }
+        else if (*it == "--record" && hasValue) {
+            result.record = *++it;
+        }
+        else if (*it == "--log" && hasValue) {
+            result.logFile = *++it;
+        }
+        else if (*it == "--binary-log" && hasValue) {
+            result.logFile = *++it;
+            result.logFormat = pg::LogFormat::Binary;
+        }
+        else if (*it == "--replay" && hasValue) {
+            // a replay always runs headless
+            result.headless = true;
+            result.headlessSettings.replay = *++it;
+        }
+        else if (*it == "--scene" && hasValue) {
+            result.headlessSettings.scene = *++it;
+        }
+        else if (*it == "--check-allocations") {
+            result.headless = true;
+            result.headlessSettings.checkAllocations = true;
+            if (hasValue && (it + 1)->compare(0u, 2u, "--") != 0) {
+                result.headlessSettings.warmupFrames = std::strtoull((++it)->c_str(), nullptr, 10);
+            }
+        }
+        else if (*it == "--render") {
+            result.headless = true;
+            result.headlessSettings.render = true;
+        }
+        else if (*it == "--counters" && hasValue) {
+            result.headless = true;
+            result.headlessSettings.counters = *++it;
+        }
+        else if (*it == "--baseline" && hasValue) {
+            result.headless = true;
+            result.headlessSettings.baseline = *++it;
+        }
+        else if (*it == "--counter-tolerance" && hasValue) {
+            result.headlessSettings.counterTolerance = std::atof((++it)->c_str());
         }
         else {
             std::printf("Unknown option: %s\n", it->c_str());
             std::exit(EXIT_SUCCESS);
         }
     }
+    if (result.headlessSettings.timeStep <= 0.f) {
+        std::printf("The time step must be positive\n");
+        std::exit(EXIT_FAILURE);
+    }
+    if (result.headlessSettings.checkAllocations && result.headlessSettings.frames == 0u) {
+        result.headlessSettings.frames = result.headlessSettings.warmupFrames + CheckedFrames;
+    }
+    return result;
 }
 
 void printHelp() {
     std::printf("Usage: The playground engine.\n");
     std::printf("--help : this help.\n");
     std::printf("--test [wren file] : execute a wren test suite.\n");
+    std::printf("--headless : simulate without a window, as fast as possible.\n");
+    std::printf("--frames [n] : with --headless, stop after n frames.\n");
+    std::printf("--time-step [seconds] : with --headless, the fixed time step. The default is 1/60.\n");
+    std::printf("--system-stats [csv file] : with --headless, write the system update times at the end.\n");
+    std::printf("--record [file] : record the input, the random seed and the scene for --replay.\n");
+    std::printf("--replay [file] : replay a recording headless, step by step. Implies --headless.\n");
+    std::printf("--scene [file] : with --headless, the scene to load instead of scene.json.\n");
+    std::printf("--check-allocations [warm-up frames] : fail if a frame after the warm-up allocates. The default\n");
+    std::printf("    is 60 warm-up frames and 600 checked ones. Implies --headless, and needs --track-allocations.\n");
+    std::printf("--render : render the headless frames into a hidden window, to count the draw calls and\n");
+    std::printf("    state changes. Needs a GL context. Implies --headless.\n");
+    std::printf("--counters [json file] : with --headless, write the draw call, state change and allocation\n");
+    std::printf("    counts summed over the frames. Needs --track-allocations.\n");
+    std::printf("--baseline [json file] : with --headless, fail if a counter exceeds the one in the file, written\n");
+    std::printf("    by --counters.\n");
+    std::printf("--counter-tolerance [fraction] : how far a counter can exceed the baseline. The default is 0.\n");
+    std::printf("--log [file] : write the log to a file instead of stderr.\n");
+    std::printf("--binary-log [file] : write the log in the binary format, which is cheaper to write.\n");
+    std::printf("--decode-log [file] : print a binary log as text, and exit.\n");
 }
 
 int main( int argc, char** argv ) {
     // we skip the first argument, because it is the name of the program
     std::vector<std::string> arguments(argv + 1, argv + argc);
-    if (argc == 2) {
-        if (std::find(arguments.begin(), arguments.end(), "--help") != arguments.end()) {
-            printHelp();
-        }
+    if (std::find(arguments.begin(), arguments.end(), "--help") != arguments.end()) {
+        printHelp();
+        return 0;
     }
-    else if (argc > 2) {
-        std::string wrenTest;
-        parseArguments(arguments, wrenTest);
 
+    if (arguments.size() == 2u && arguments[0] == "--decode-log") {
+        return pg::decodeBinaryLog(arguments[1], std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const Arguments parsed = parseArguments(arguments);
+    if (!parsed.logFile.empty() && !pg::Log::setOutput(parsed.logFile, parsed.logFormat)) {
+        std::printf("Could not open the log file %s\n", parsed.logFile.c_str());
+        return EXIT_FAILURE;
+    }
+    if (!parsed.wrenTest.empty()) {
         wrenpp::VM vm;
-        vm.executeModule(wrenTest);
+        vm.executeModule(parsed.wrenTest);
+    }
+    else if (parsed.headless) {
+        pg::Application app{};
+        if (!app.runHeadless(parsed.headlessSettings)) {
+            return EXIT_FAILURE;
+        }
     }
     else {
         pg::Application app{};
-        app.run();
+        app.run(parsed.record);
     }
 
     return 0;
 }
+
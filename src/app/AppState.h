@@ -17,8 +17,15 @@ public:
     virtual ~AppState() = default;
 
     virtual void activate() = 0;
+    // called on the GL thread, while the next frame is updated
     virtual void render(float dt) = 0;
+    // called on the simulation thread, once per fixed step
     virtual bool update(float dt) = 0;
+    // called on the simulation thread after the frame's steps, to copy the state for the next
+    // render. dt is the time the steps covered, and alpha how far into the next step the frame is.
+    virtual bool prepareRender(float dt, float alpha) = 0;
+    // called on the main thread between frames, while neither update nor render runs
+    virtual void synchronize(float dt) = 0;
     virtual bool handleEvent(const SDL_Event& event) = 0;
 
 protected:
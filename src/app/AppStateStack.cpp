@@ -23,13 +23,27 @@ void AppStateStack::update(float dt) {
     }
 }
 
+void AppStateStack::prepareRender(float dt, float alpha) {
+    for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+        if (!(*it)->prepareRender(dt, alpha)) {
+            break;
+        }
+    }
+}
+
+void AppStateStack::synchronize(float dt) {
+    for (auto& ptr : stack_) {
+        ptr->synchronize(dt);
+    }
+}
+
 void AppStateStack::handleEvent(const SDL_Event& event) {
     for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
         if (!(*it)->handleEvent(event)) {
             break;
         }
     }
-    applyPendingChanges_();
+    applyPendingChanges();
 }
 
 void AppStateStack::pushState(states::Id id) {
@@ -55,7 +69,7 @@ std::unique_ptr<AppState> AppStateStack::createState_(states::Id id) {
     return it->second();
 }
 
-void AppStateStack::applyPendingChanges_() {
+void AppStateStack::applyPendingChanges() {
     for (PendingChange& change : pendingList_) {
         switch (change.action) {
         case states::Push:
@@ -31,6 +31,8 @@ public:
 
     void render(float dt);
     void update(float dt);
+    void prepareRender(float dt, float alpha);
+    void synchronize(float dt);
     void handleEvent(const SDL_Event& event);
 
     void pushState(states::Id id);
@@ -39,10 +41,12 @@ public:
 
     bool isEmpty() const;
 
+    // push, pop or clear the states as requested. handleEvent does this after each event.
+    void applyPendingChanges();
+
 private:
     // METHODS
     std::unique_ptr<AppState> 	createState_(states::Id id);
-    void 						applyPendingChanges_();
 
     // STRUCTS
     struct PendingChange {
@@ -1,11 +1,18 @@
 #include "app/Application.h"
 #include "app/GameState.h"
 #include "app/PauseState.h"
+#include "opengl/StateCache.h"
+#include "utils/AllocationTracker.h"
 #include "utils/Assert.h"
 #include "utils/File.h"
 #include "utils/Json.h"
 #include "utils/Log.h"
 #include "utils/Locator.h"
+#include "utils/FrameTimer.h"
+#include "utils/InputRecording.h"
+#include "utils/Profiler.h"
+#include "utils/Random.h"
+#include "utils/SceneCounters.h"
 #include "utils/StringId.h"
 #include "system/WrenBindings.h"
 #include "system/DebugDrawRenderer.h"
@@ -13,48 +20,228 @@
 #include "DebugDraw.hpp"
 #include "Wren++.h"
 #include "mm_json.h"
-#include <SDL_timer.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
 #include <string>
+#include <vector>
 #include <cstdint>
+#include <cstring>
 
 namespace {
-uint32_t targetDeltaTime{ 16u };
-inline float SDLTimeToPgTime(uint32_t dt) {
-    return float(dt) / 1000.f;
+// the initial size, the stream buffer grows if a frame needs more
+const std::size_t StreamBufferBytesPerFrame = 1u << 20u;
+// a slower frame than this many steps slows the simulation down, instead of catching up
+const int MaxStepsPerFrame = 5;
+// the tag of the allocation check's and the scene counters' own bookkeeping, which doesn't count
+// as the frame's allocations
+const char* const AllocationCheckTag = "allocation check";
+// the number of sampled call sites which a failed allocation check reports
+const std::size_t ReportedAllocationSites = 8u;
+
+std::chrono::nanoseconds period(double rate) {
+    return std::chrono::nanoseconds(std::int64_t(1e9 / rate));
+}
+
+// the default implementations draw nothing, and disable the text
+class NullDebugDrawRenderer : public dd::RenderInterface {
+public:
+    ~NullDebugDrawRenderer() override = default;
+};
+
+// returns false for the events which the states don't read, and which aren't recorded
+bool toInputEvent(const SDL_Event& event, pg::InputEvent& input) {
+    switch (event.type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        input.type = event.type == SDL_KEYDOWN ? pg::InputEvent::KeyDown : pg::InputEvent::KeyUp;
+        input.code = event.key.keysym.sym;
+        input.scancode = event.key.keysym.scancode;
+        input.state = event.key.keysym.mod;
+        input.repeat = event.key.repeat;
+        return true;
+    case SDL_MOUSEMOTION:
+        input.type = pg::InputEvent::MouseMotion;
+        input.x = event.motion.x;
+        input.y = event.motion.y;
+        input.dx = event.motion.xrel;
+        input.dy = event.motion.yrel;
+        input.state = event.motion.state;
+        return true;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        input.type = event.type == SDL_MOUSEBUTTONDOWN ? pg::InputEvent::MouseButtonDown : pg::InputEvent::MouseButtonUp;
+        input.code = event.button.button;
+        input.repeat = event.button.clicks;
+        input.x = event.button.x;
+        input.y = event.button.y;
+        return true;
+    case SDL_MOUSEWHEEL:
+        input.type = pg::InputEvent::MouseWheel;
+        input.x = event.wheel.x;
+        input.y = event.wheel.y;
+        return true;
+    case SDL_QUIT:
+        input.type = pg::InputEvent::Quit;
+        return true;
+    default:
+        return false;
+    }
+}
+
+SDL_Event toSdlEvent(const pg::InputEvent& input) {
+    SDL_Event event{};
+    switch (input.type) {
+    case pg::InputEvent::KeyDown:
+    case pg::InputEvent::KeyUp:
+        event.type = input.type == pg::InputEvent::KeyDown ? SDL_KEYDOWN : SDL_KEYUP;
+        event.key.state = input.type == pg::InputEvent::KeyDown ? SDL_PRESSED : SDL_RELEASED;
+        event.key.keysym.sym = SDL_Keycode(input.code);
+        event.key.keysym.scancode = SDL_Scancode(input.scancode);
+        event.key.keysym.mod = Uint16(input.state);
+        event.key.repeat = Uint8(input.repeat);
+        break;
+    case pg::InputEvent::MouseMotion:
+        event.type = SDL_MOUSEMOTION;
+        event.motion.x = input.x;
+        event.motion.y = input.y;
+        event.motion.xrel = input.dx;
+        event.motion.yrel = input.dy;
+        event.motion.state = input.state;
+        break;
+    case pg::InputEvent::MouseButtonDown:
+    case pg::InputEvent::MouseButtonUp:
+        event.type = input.type == pg::InputEvent::MouseButtonDown ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+        event.button.state = input.type == pg::InputEvent::MouseButtonDown ? SDL_PRESSED : SDL_RELEASED;
+        event.button.button = Uint8(input.code);
+        event.button.clicks = Uint8(input.repeat);
+        event.button.x = input.x;
+        event.button.y = input.y;
+        break;
+    case pg::InputEvent::MouseWheel:
+        event.type = SDL_MOUSEWHEEL;
+        event.wheel.x = input.x;
+        event.wheel.y = input.y;
+        break;
+    case pg::InputEvent::Quit:
+        event.type = SDL_QUIT;
+        break;
+    }
+    return event;
+}
+
+// the allocations of a frame, apart from the allocation check's own
+std::uint64_t checkedAllocations(const pg::AllocationTracker::Frame& frame) {
+    std::uint64_t allocations = 0u;
+    for (const pg::AllocationTracker::TagStats& tag : frame.tags) {
+        if (std::strcmp(tag.name, AllocationCheckTag) != 0) {
+            allocations += tag.stats.allocations;
+        }
+    }
+    return allocations;
+}
+
+void logAllocationSite(const pg::AllocationSite& site) {
+    LOG_ERROR << site.samples << " allocations, " << site.bytes << " bytes, tagged " << site.tag << ", from:";
+    std::vector<std::string> frames;
+    for (void* address : site.frames) {
+        frames.push_back(pg::describeFrame(address));
+    }
+    // the innermost frames are the tracker's own, up to operator new
+    auto first = std::find_if(frames.begin(), frames.end(),
+        [](const std::string& frame) -> bool { return frame.find("operator new") != std::string::npos; });
+    first = first == frames.end() ? frames.begin() : first + 1;
+    for (auto it = first; it != frames.end(); ++it) {
+        LOG_ERROR << "    " << *it;
+    }
 }
 
 }
 
 namespace pg {
 
-void Application::run() {
+void Application::run(const std::string& inputRecording) {
     StringId::Database stringDb{};
     StringId::setDatabase(&stringDb);
 
-    initialize_();
+    JsonParser config("config.json");
+    WindowSettings settings{};
+    initialize_(config, settings);
+    initializeGraphics_(config, settings);
+
+    /*
+     * The recording holds what a replay needs to run the same steps: the events which reach the
+     * states, with the number of steps before them, and the seed of the random numbers.
+     * */
+    InputRecorder recorder{};
+    if (!inputRecording.empty()) {
+        InputRecordingHeader header{};
+        header.seed = std::random_device{}();
+        header.stepLength = std::uint64_t(stepTime_.count());
+        header.width = context_.width();
+        header.height = context_.height();
+        header.scene = context_.scene;
+        header.sceneHash = hashFile(context_.scene);
+        seedDeterministic(header.seed);
+        if (recorder.open(inputRecording, header)) {
+            LOG_INFO << "Recording the input to " << inputRecording;
+        }
+    }
+    // the number of steps simulated so far
+    std::uint64_t step = 0u;
+    // activate the states before the first step, like a replay does
+    stateStack_.applyPendingChanges();
 
     DebugDrawRenderer debugDrawRenderer(context_);
     dd::initialize(&debugDrawRenderer);
 
+    profiler().setThreadName("main");
+    simulation_.start([]() -> void { profiler().setThreadName("simulation"); });
+    simulation_.wait();
+
+    using Clock = FramePacer::Clock;
+    FixedTimestep timestep{ stepTime_, MaxStepsPerFrame };
+    FramePacer pacer{};
+    const Clock::time_point begin = Clock::now();
+    Clock::time_point last = begin;
+    Clock::time_point deadline = begin;
     running_ = true;
-    uint32_t tdelta{ targetDeltaTime };
 
     while (running_) {
-        uint32_t start = SDL_GetTicks();
-        context_.imguiRenderer->newFrame(SDLTimeToPgTime(tdelta), mouse_.getMouseCoords().x, mouse_.getMouseCoords().y);
+        /*
+         * The simulation runs in fixed steps, as many as the time since the last frame covers.
+         * The renderer interpolates the rest.
+         * */
+        const Clock::time_point start = Clock::now();
+        const float frameTime = std::max(std::chrono::duration<float>(start - last).count(), 1e-6f);
+        const int steps = timestep.advance(start - last);
+        const float dt = timestep.step();
+        const float alpha = timestep.alpha();
+        last = start;
+
         /*
          * Handle events here
          * */
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
+            PG_ALLOCATION_TAG("Events");
             // there are only two events which are handled here
             // mouse down and mouse up, which are passed to ImGui
             // so isn't the mouse click then passed on to the script system?
             // Because currently the GameState registers its own mouse handler with the script system
-            if (!(mouse_.handleEvent(event) && ImGui::IsMouseHoveringAnyWindow())) {
+            const bool handledByUi = mouse_.handleEvent(event) && ImGui::IsMouseHoveringAnyWindow();
+            // a release always reaches the states, and the recording, which track the held buttons
+            // from the events. Otherwise a button released over the UI would stay held.
+            if (!handledByUi || event.type == SDL_MOUSEBUTTONUP) {
+                InputEvent input{};
+                if (recorder.isOpen() && toInputEvent(event, input)) {
+                    recorder.record(step, input);
+                }
                 stateStack_.handleEvent(event);
             }
         }
+        step += std::uint64_t(steps);
         /*
          * A state might have called quits
          * */
@@ -67,45 +254,340 @@ void Application::run() {
         * */
         mouse_.handleMousePressedCallbacks();
 
-        context_.textFileManager.update();
-        stateStack_.update(SDLTimeToPgTime(tdelta));
+        {
+            PG_PROFILE_ZONE("TextFileManager::update");
+            PG_ALLOCATION_TAG("TextFileManager::update");
+            context_.textFileManager.update();
+        }
+        {
+            PG_PROFILE_ZONE("MeshManager::update");
+            PG_ALLOCATION_TAG("MeshManager::update");
+            context_.meshManager.update();
+        }
+        {
+            PG_PROFILE_ZONE("ImGuiRenderer::newFrame");
+            PG_ALLOCATION_TAG("ImGuiRenderer::newFrame");
+            context_.imguiRenderer->newFrame(frameTime, mouse_.getMouseCoords().x, mouse_.getMouseCoords().y);
+        }
+
+        /*
+         * Update the next frame on the simulation thread, while the last one is rendered here
+         * */
+        simulation_.start([this, steps, dt, alpha]() -> void {
+            PG_PROFILE_ZONE("Update");
+            PG_ALLOCATION_TAG("Update");
+            for (int i = 0; i < steps; ++i) {
+                stateStack_.update(dt);
+            }
+            stateStack_.prepareRender(float(steps) * dt, alpha);
+        });
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        stateStack_.render(SDLTimeToPgTime(tdelta));
-        dd::flush(std::uint64_t(tdelta * 1000.f));
-        context_.imguiRenderer->render();
+        {
+            PG_PROFILE_ZONE("Render");
+            PG_ALLOCATION_TAG("Render");
+            opengl::stateCache().resetCounters();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            stateStack_.render(frameTime);
+            debugDrawRenderer.draw();
+            PG_PROFILE_ZONE("ImGuiRenderer::draw");
+            context_.imguiRenderer->draw();
+        }
+        {
+            PG_PROFILE_ZONE("Swap");
+            PG_ALLOCATION_TAG("Swap");
+            window_.display();
+            streamBuffer_->endFrame();
+        }
+        {
+            PG_PROFILE_ZONE("Wait for update");
+            simulation_.wait();
+        }
+        // the UI shows the frame which just finished
+        profiler().endFrame();
+        allocationTracker().endFrame();
 
-        window_.display();
+        /*
+         * Hand the updated frame over to the renderer, and finish the UI and the debug draw lists
+         * which the update built
+         * */
+        {
+            PG_PROFILE_ZONE("Synchronize");
+            PG_ALLOCATION_TAG("Synchronize");
+            stateStack_.synchronize(frameTime);
+            dd::flush(std::uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count()));
+            PG_PROFILE_ZONE("ImGuiRenderer::render");
+            context_.imguiRenderer->render();
+        }
 
         /*
-         * Sleep for the remainder of the frame, if we have time for it
+         * Wait for the start of the next frame. A late frame starts the next one right away,
+         * without trying to make up for the lost time.
          * */
-        uint32_t end = SDL_GetTicks();
-        tdelta = end - start;
-        if (tdelta < targetDeltaTime) {
-            tdelta = targetDeltaTime;
-            SDL_Delay(targetDeltaTime - tdelta);
+        deadline = std::max(deadline + frameTime_, Clock::now());
+        pacer.waitUntil(deadline);
+    }
+
+    if (recorder.isOpen()) {
+        if (recorder.close(step)) {
+            LOG_INFO << "Recorded " << step << " steps of input to " << inputRecording;
+        }
+        else {
+            LOG_ERROR << "Could not write the input recording " << inputRecording;
         }
     }
 
     dd::shutdown();
 }
 
-void Application::initialize_() {
+bool Application::runHeadless(const HeadlessSettings& settings) {
+    const bool counting = !settings.counters.empty() || !settings.baseline.empty();
+    if ((settings.checkAllocations || counting) && !AllocationTracker::enabled()) {
+        LOG_ERROR << "Counting the allocations needs a build with PG_TRACK_ALLOCATIONS, see premake5.lua";
+        return false;
+    }
+    StringId::Database stringDb{};
+    StringId::setDatabase(&stringDb);
+
+    context_.headless = !settings.render;
+    if (!settings.scene.empty()) {
+        context_.scene = settings.scene;
+    }
+    InputReplay replay{};
+    if (!settings.replay.empty()) {
+        if (!replay.open(settings.replay)) {
+            return false;
+        }
+        context_.scene = replay.header().scene;
+        if (hashFile(context_.scene) != replay.header().sceneHash) {
+            LOG_WARNING << "The scene " << context_.scene << " has changed since it was recorded";
+        }
+        seedDeterministic(replay.header().seed);
+    }
+    const bool replaying = !settings.replay.empty();
+
+    JsonParser config("config.json");
+    WindowSettings windowSettings{};
+    initialize_(config, windowSettings);
+    // the mouse coordinates and the camera rays are relative to the configured, or recorded, window
+    if (replaying) {
+        windowSettings.width = int(replay.header().width);
+        windowSettings.height = int(replay.header().height);
+    }
+    context_.width_ = unsigned(windowSettings.width);
+    context_.height_ = unsigned(windowSettings.height);
+
+    // without rendering, the scripts can still build their UI and debug draw lists, which are thrown away
+    ImGuiIO& io = ImGui::GetIO();
+    NullDebugDrawRenderer nullDebugDrawRenderer{};
+    std::unique_ptr<DebugDrawRenderer> debugDrawRenderer{};
+    if (settings.render) {
+        windowSettings.hidden = true;
+        initializeGraphics_(config, windowSettings);
+        debugDrawRenderer.reset(new DebugDrawRenderer(context_));
+        dd::initialize(debugDrawRenderer.get());
+    }
+    else {
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(float(windowSettings.width), float(windowSettings.height));
+        unsigned char* pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+        dd::initialize(&nullDebugDrawRenderer);
+    }
+
+    profiler().setThreadName("main");
+    // the states are activated by the first applied change, which isn't triggered by an event here
+    stateStack_.applyPendingChanges();
+
+    // a replay steps like the recording did
+    const float dt = replaying ? FixedTimestep{ std::chrono::nanoseconds(replay.header().stepLength), 1 }.step() : settings.timeStep;
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t frame = 0u;
+    std::uint64_t allocatingFrames = 0u;
+    SceneCounters counters{};
+    // the first frame doesn't count the start up
+    allocationTracker().endFrame();
+    while (context_.running && !stateStack_.isEmpty() && (settings.frames == 0u || frame < settings.frames)) {
+        if (replaying) {
+            // the events which were handled before this step in the recording
+            PG_ALLOCATION_TAG("Events");
+            InputEvent input{};
+            while (replay.next(frame, input)) {
+                const SDL_Event event = toSdlEvent(input);
+                if (settings.render) {
+                    // the UI follows the mouse
+                    mouse_.handleEvent(event);
+                }
+                stateStack_.handleEvent(event);
+            }
+            if (frame == replay.steps() || !context_.running || stateStack_.isEmpty()) {
+                break;
+            }
+        }
+        {
+            PG_PROFILE_ZONE("TextFileManager::update");
+            PG_ALLOCATION_TAG("TextFileManager::update");
+            context_.textFileManager.update();
+        }
+        if (settings.render) {
+            {
+                PG_PROFILE_ZONE("MeshManager::finishLoading");
+                PG_ALLOCATION_TAG("MeshManager::update");
+                // the meshes appear in the same frame in every run
+                context_.meshManager.finishLoading();
+            }
+            PG_ALLOCATION_TAG("ImGuiRenderer::newFrame");
+            mouse_.handleMousePressedCallbacks();
+            context_.imguiRenderer->newFrame(dt, mouse_.getMouseCoords().x, mouse_.getMouseCoords().y);
+        }
+        else {
+            PG_ALLOCATION_TAG("ImGui::NewFrame");
+            io.DeltaTime = dt;
+            ImGui::NewFrame();
+        }
+        {
+            PG_PROFILE_ZONE("Update");
+            PG_ALLOCATION_TAG("Update");
+            stateStack_.update(dt);
+            stateStack_.prepareRender(dt, 1.f);
+        }
+        {
+            PG_PROFILE_ZONE("Synchronize");
+            PG_ALLOCATION_TAG("Synchronize");
+            stateStack_.synchronize(dt);
+            ++frame;
+            dd::flush(std::uint64_t(double(frame) * dt * 1000.0));
+            if (settings.render) {
+                context_.imguiRenderer->render();
+            }
+            else {
+                ImGui::Render();
+            }
+        }
+        if (settings.render) {
+            {
+                PG_PROFILE_ZONE("Render");
+                PG_ALLOCATION_TAG("Render");
+                opengl::stateCache().resetCounters();
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                stateStack_.render(dt);
+                debugDrawRenderer->draw();
+                context_.imguiRenderer->draw();
+            }
+            {
+                PG_ALLOCATION_TAG("Swap");
+                window_.display();
+                streamBuffer_->endFrame();
+            }
+            if (counting) {
+                PG_ALLOCATION_TAG(AllocationCheckTag);
+                const opengl::StateCache::Counters& state = opengl::stateCache().counters();
+                counters.add("stateChanges", double(state.calls - state.elided));
+                counters.add("stateQueries", double(state.queries));
+                if (const system::RenderSystem* renderSystem = Locator<system::RenderSystem>::get()) {
+                    counters.add("drawCalls", double(renderSystem->frameStats().drawCalls));
+                    counters.add("triangles", double(renderSystem->frameStats().triangles));
+                }
+            }
+        }
+        stateStack_.applyPendingChanges();
+        profiler().endFrame();
+        allocationTracker().endFrame();
+
+        if (counting) {
+            PG_ALLOCATION_TAG(AllocationCheckTag);
+            counters.add("allocations", double(checkedAllocations(allocationTracker().lastFrame())));
+            for (const AllocationTracker::TagStats& tag : allocationTracker().lastFrame().tags) {
+                if (tag.stats.allocations != 0u && std::strcmp(tag.name, AllocationCheckTag) != 0) {
+                    counters.add(std::string("allocations ") + tag.name, double(tag.stats.allocations));
+                }
+            }
+        }
+
+        if (settings.checkAllocations) {
+            PG_ALLOCATION_TAG(AllocationCheckTag);
+            if (frame == settings.warmupFrames) {
+                // keep the call stack of every allocation from here on
+                allocationTracker().clearSamples();
+                allocationTracker().setSampleInterval(1u);
+            }
+            else if (frame > settings.warmupFrames && checkedAllocations(allocationTracker().lastFrame()) != 0u) {
+                if (allocatingFrames == 0u) {
+                    LOG_ERROR << "Frame " << frame << " allocated after the warm-up:";
+                    for (const AllocationTracker::TagStats& tag : allocationTracker().lastFrame().tags) {
+                        if (tag.stats.allocations != 0u && std::strcmp(tag.name, AllocationCheckTag) != 0) {
+                            LOG_ERROR << "    " << tag.name << ": " << tag.stats.allocations << " allocations, " << tag.stats.bytes << " bytes";
+                        }
+                    }
+                }
+                ++allocatingFrames;
+            }
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO << "Simulated " << frame << " frames, " << double(frame) * dt << " s, in " << seconds << " s";
+    if (!settings.systemStats.empty() && !context_.systemManager.writeUpdateStats(settings.systemStats)) {
+        LOG_ERROR << "Could not write the system statistics to " << settings.systemStats;
+    }
+
+    bool passed = true;
+    if (settings.checkAllocations) {
+        allocationTracker().setSampleInterval(0u);
+        if (frame <= settings.warmupFrames) {
+            LOG_ERROR << "The allocations weren't checked, the simulation stopped after " << frame
+                << " of the " << settings.warmupFrames << " warm-up frames";
+            passed = false;
+        }
+        else if (allocatingFrames != 0u) {
+            LOG_ERROR << allocatingFrames << " of the " << frame - settings.warmupFrames << " frames after the warm-up allocated";
+            std::size_t reported = 0u;
+            for (const AllocationSite& site : allocationTracker().sampledSites()) {
+                if (std::strcmp(site.tag, AllocationCheckTag) != 0 && reported++ < ReportedAllocationSites) {
+                    logAllocationSite(site);
+                }
+            }
+            passed = false;
+        }
+        else {
+            LOG_INFO << "None of the " << frame - settings.warmupFrames << " frames after the warm-up allocated";
+        }
+    }
+    if (!settings.counters.empty()) {
+        if (counters.write(settings.counters)) {
+            LOG_INFO << "Wrote the counters of " << frame << " frames to " << settings.counters;
+        }
+        else {
+            passed = false;
+        }
+    }
+    if (!settings.baseline.empty() && counters.compare(settings.baseline, settings.counterTolerance) != 0) {
+        passed = false;
+    }
+
+    dd::shutdown();
+    // the renderer shuts ImGui down
+    if (!settings.render) {
+        ImGui::Shutdown();
+    }
+    return passed;
+}
+
+void Application::initialize_(const JsonParser& json, WindowSettings& settings) {
     /*
      * Add the resource managers to the locators.
      * This is so that we can access the managers from C-style free functions.
+     * Headless, there are no meshes or shaders.
      **/
-    Locator<MeshManager>::set(&context_.meshManager);
-    Locator<ShaderManager>::set(&context_.shaderManager);
+    if (!context_.headless) {
+        Locator<MeshManager>::set(&context_.meshManager);
+        Locator<ShaderManager>::set(&context_.shaderManager);
+    }
     Locator<TextFileManager>::set(&context_.textFileManager);
 
     /*
      * Initialize app state here
      * */
-    JsonParser json("config.json");
-    WindowSettings settings{};
-
     JsonToken window = json.query("window");
     settings.width = json.query(window, "width").as<int>();
     settings.height = json.query(window, "height").as<int>();
@@ -118,13 +600,11 @@ void Application::initialize_() {
     settings.multisampleBuffer = json.query(opengl, "multisampleBuffer").as<int>();
     settings.multisampleSamples = json.query(opengl, "multisampleSamples").as<int>();
 
-    window_.initialize(settings);
-
-    targetDeltaTime = uint32_t(1.f / json.query("frameRate").as<int>());
-
-
-    std::string shaderPrefix = json.query("shaderPrefix").as<const char*>();
-    LOG_DEBUG << "shaderPrefix: " << shaderPrefix;
+    // the frame rate caps the frames, and the simulation steps at its own rate, which defaults to the frame rate
+    const float frameRate = json.query("frameRate").as<float>();
+    JsonToken simulationRate = json.query("simulationRate");
+    frameTime_ = period(frameRate);
+    stepTime_ = period(simulationRate ? simulationRate.as<float>() : frameRate);
 
     /*
      * Create app states here
@@ -153,6 +633,28 @@ void Application::initialize_() {
         }
     };
 
+    // bind the scripting API so that Wren can find the methods
+    wren::bindVectorModule();
+    wren::bindMathModule();
+    wren::bindRandomModule();
+    wren::bindQuaternionModule();
+    wren::bindEntityModule();
+    wren::bindComponentModule();
+    wren::bindNumberArrayModule();
+    wren::bindRingBufferModule();
+    wren::bindImguiModule();
+    wren::bindUtilsModule();
+    wren::bindSystemsModule();
+}
+
+void Application::initializeGraphics_(const JsonParser& json, const WindowSettings& settings) {
+    window_.initialize(settings);
+    // the window sets up some default state directly
+    opengl::stateCache().reset();
+
+    std::string shaderPrefix = json.query("shaderPrefix").as<const char*>();
+    LOG_DEBUG << "shaderPrefix: " << shaderPrefix;
+
     /*
      * Load resources that all app states will depend on
      **/
@@ -162,10 +664,18 @@ void Application::initialize_() {
     context_.shaderManager.addShader(shaderPrefix + "/basic.frag.glsl", GL_FRAGMENT_SHADER);
     context_.shaderManager.compile("basic");
 
+    context_.shaderManager.addShader(shaderPrefix + "/debug.vert.glsl", GL_VERTEX_SHADER);
+    context_.shaderManager.addShader(shaderPrefix + "/debug.frag.glsl", GL_FRAGMENT_SHADER);
+    context_.shaderManager.compile("debug");
+
     context_.shaderManager.addShader(shaderPrefix + "/specular.vert.glsl", GL_VERTEX_SHADER);
     context_.shaderManager.addShader(shaderPrefix + "/specular.frag.glsl", GL_FRAGMENT_SHADER);
     context_.shaderManager.compile("specular");
 
+    context_.shaderManager.addShader(shaderPrefix + "/static.vert.glsl", GL_VERTEX_SHADER);
+    context_.shaderManager.addShader(shaderPrefix + "/specular.frag.glsl", GL_FRAGMENT_SHADER);
+    context_.shaderManager.compile("static");
+
     context_.shaderManager.addShader(shaderPrefix + "/panel.vert.glsl", GL_VERTEX_SHADER);
     context_.shaderManager.addShader(shaderPrefix + "/panel.frag.glsl", GL_FRAGMENT_SHADER);
     context_.shaderManager.compile("panel");
@@ -174,9 +684,16 @@ void Application::initialize_() {
      * Finally, set the application context
      * */
     context_.window = &window_;
+    streamBuffer_.reset(new opengl::StreamBuffer(StreamBufferBytesPerFrame));
+    context_.streamBuffer = streamBuffer_.get();
     context_.imguiRenderer = new system::ImGuiRenderer(context_);
 
     context_.meshManager.initialize();
+    // the vertex arrays are created with GL calls, so create them here for every program, and the
+    // scripts on the simulation thread only look them up
+    for (opengl::Program* program : context_.shaderManager.programs()) {
+        context_.meshManager.createAttributes(*program);
+    }
 
     mouse_.registerMouseDownCallback(
         MouseButton::Left,
@@ -190,19 +707,6 @@ void Application::initialize_() {
         this->context_.imguiRenderer->mouseButtonReleased(SDL_BUTTON_LEFT);
     }
     );
-
-    // bind the scripting API so that Wren can find the methods
-    wren::bindVectorModule();
-    wren::bindMathModule();
-    wren::bindRandomModule();
-    wren::bindQuaternionModule();
-    wren::bindEntityModule();
-    wren::bindComponentModule();
-    wren::bindNumberArrayModule();
-    wren::bindRingBufferModule();
-    wren::bindImguiModule();
-    wren::bindUtilsModule();
-    wren::bindSystemsModule();
 }
 
 }
@@ -5,14 +5,60 @@
 #include "app/Context.h"
 #include "app/AppStateStack.h"
 #include "app/MouseEvents.h"
+#include "opengl/StreamBuffer.h"
+#include "utils/Worker.h"
+#include <chrono>
 #include <memory>
+#include <string>
+#include <cstdint>
 
 namespace pg {
 
+class JsonParser;
+
+struct HeadlessSettings {
+    // the number of frames to simulate. With zero, the simulation runs until a state quits.
+    std::uint64_t   frames{ 0u };
+    // the fixed time step of each frame, in seconds
+    float           timeStep{ 1.f / 60.f };
+    // if not empty, the per-system update time statistics are written here at the end, see SystemManager
+    std::string     systemStats{};
+    // if not empty, the input recording to replay. It sets the scene, the random seed and the time step.
+    std::string     replay{};
+    // if not empty, the scene to load instead of the default one
+    std::string     scene{};
+    // fail if a frame after the warm-up frames allocates, see AllocationTracker
+    bool            checkAllocations{ false };
+    std::uint64_t   warmupFrames{ 60u };
+    // render each frame into a hidden window, so that the draw calls and the state changes are
+    // counted. This needs a GL context. The meshes are loaded before each frame, see MeshManager::finishLoading.
+    bool            render{ false };
+    // if not empty, the counters summed over the frames are written here at the end, see SceneCounters
+    std::string     counters{};
+    // if not empty, the counters are compared against this baseline, and a regressed counter fails the run
+    std::string     baseline{};
+    // how far a counter can exceed the baseline's, as a fraction of the baseline's
+    double          counterTolerance{ 0.0 };
+};
+
 /**
  * @class Application
  * @file Application.h
  * @brief Wraps all systems and managers, contains the main game loop.
+ *
+ * The frames are pipelined: the states update the next frame on the simulation thread, while
+ * this thread, which owns the GL context, renders the last one. Events, resource uploads and
+ * the hand over between the two happen in between, while the simulation thread is idle.
+ *
+ * The simulation runs in fixed steps, see FixedTimestep, so that it doesn't depend on the frame
+ * times. The renderer interpolates the transforms between the last two steps. The frames are
+ * capped to the configured frame rate with a FramePacer.
+ *
+ * runHeadless runs the same states without a window or a GL context, see HeadlessSettings.
+ * It can replay the input which run recorded, see InputRecorder, to repeat a session step by step,
+ * and check that the frames after a warm-up don't allocate. A replay can also be rendered into a
+ * hidden window, and its draw calls, state changes and allocations by tag compared against a
+ * baseline, see SceneCounters.
  */
 class Application {
 public:
@@ -21,18 +67,36 @@ public:
 
     /**
      * @brief Execute the main game loop.
+     * @param inputRecording If not empty, the input is recorded to this file for runHeadless to replay.
+     */
+    void run(const std::string& inputRecording = std::string{});
+    /**
+     * @brief Simulate the game without a window, a GL context or a frame rate cap.
+     * Only the systems which don't render are added, unless the frames are rendered. The frames
+     * run on this thread, one after the other, with the fixed time step.
+     * @return false if the replay can't be read, if a frame allocated while checking the
+     * allocations, or if a counter regressed against the baseline.
      */
-    void run();
+    bool runHeadless(const HeadlessSettings& settings);
 
 private:
-    void initialize_();
+    // the window settings are read from the configuration
+    void initialize_(const JsonParser& config, WindowSettings& settings);
+    void initializeGraphics_(const JsonParser& config, const WindowSettings& settings);
 
     bool            running_{ false };
+    // the frame rate cap, and the length of a simulation step
+    std::chrono::nanoseconds frameTime_{ 16666667 };
+    std::chrono::nanoseconds stepTime_{ 16666667 };
     Window          window_{};
+    // declared after the window, so that it is destroyed while the GL context still exists
+    std::unique_ptr<opengl::StreamBuffer> streamBuffer_{};
     Context         context_{};
     MouseEvents     mouse_{ context_ };
 
     AppStateStack   stateStack_{ context_ };
+    // declared last, so that it stops before what it updates is destroyed
+    Worker          simulation_{};
 };
 
 }
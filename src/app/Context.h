@@ -8,6 +8,9 @@
 #include "manager/MeshManager.h"
 #include "manager/ShaderManager.h"
 #include "manager/TextFileManager.h"
+#include "opengl/StreamBuffer.h"
+#include "utils/ThreadPool.h"
+#include <string>
 
 namespace pg {
 
@@ -33,6 +36,11 @@ struct Context {
     /// @brief Get real-time input for the mouse.
     Mouse mouse()     const { return mouse_; }
 
+    /// @brief The size of the window, or the configured window size when headless.
+    unsigned width()  const { return window ? window->width() : width_; }
+    unsigned height() const { return window ? window->height() : height_; }
+    float aspectRatio() const { return float(width()) / float(height()); }
+
     EventManager  eventManager{};
     EntityManager entityManager{ eventManager };
     SystemManager systemManager{ eventManager, entityManager };
@@ -41,11 +49,21 @@ struct Context {
     ShaderManager   shaderManager{};
     TextFileManager textFileManager{ *this };
     bool            running{ true };
+    // there is no window or GL context, and only the systems which don't render are added
+    bool            headless{ false };
+    // the scene which the game state loads
+    std::string     scene{ "scene.json" };
     Window*         window{ nullptr };
     system::ImGuiRenderer* imguiRenderer{ nullptr };
+    // for vertex, index and uniform data which is rewritten every frame
+    opengl::StreamBuffer*  streamBuffer{ nullptr };
+    // for parallel loops while rendering, on the GL thread
+    ThreadPool      threadPool{};
 
 private:
     Mouse  mouse_{};
+    unsigned width_{ 800u };
+    unsigned height_{ 600u };
 
 };
 
@@ -4,10 +4,12 @@
 #include "system/DebugSystem.h"
 #include "system/RenderSystem.h"
 #include "system/ScriptSystem.h"
+#include "system/SpatialSystem.h"
 #include "system/UiSystem.h"
 #include "system/Events.h"
 #include "system/PickingSystem.h"
 #include "system/DebugRenderSystem.h"
+#include "utils/Assert.h"
 #include "utils/Locator.h"
 
 #include <cmath>
@@ -25,46 +27,87 @@ GameState::GameState(Context& context, AppStateStack& stack)
 }
 
 void GameState::activate() {
-    context_.systemManager.add< system::RenderSystem >(context_);
-    context_.systemManager.add<system::DebugRenderSystem>(context_);
+    // headless, only the systems which don't render or draw the UI are added
+    if (!context_.headless) {
+        context_.systemManager.add< system::RenderSystem >(context_);
+        context_.systemManager.add<system::DebugRenderSystem>(context_);
+    }
     context_.systemManager.add< system::PickingSystem >(context_);
     context_.systemManager.add< system::DebugSystem >();
     context_.systemManager.add< system::ScriptSystem >(context_, keyboard_, mouse_);
-    context_.systemManager.add< system::UiSystem >(context_);
+    if (!context_.headless) {
+        context_.systemManager.add< system::UiSystem >(context_);
+    }
+    context_.systemManager.add<system::SpatialSystem>();
     context_.systemManager.configure< system::DebugSystem >();
-    context_.systemManager.configure< system::RenderSystem >();
-    context_.systemManager.configure<system::DebugRenderSystem>();
+    if (!context_.headless) {
+        context_.systemManager.configure< system::RenderSystem >();
+        context_.systemManager.configure<system::DebugRenderSystem>();
+    }
     context_.systemManager.configure<system::PickingSystem>();
     context_.systemManager.configure< system::ScriptSystem >();
+    context_.systemManager.configure<system::SpatialSystem>();
 
     // NOTICE
     // this is a dirty hack to get ScriptSystem bound to Wren
     // I really need a way to set the bytes of a foreign object in a better way....
     Locator<system::ScriptSystem>::set(&context_.systemManager.system<system::ScriptSystem>());
     Locator<system::PickingSystem>::set(&context_.systemManager.system<system::PickingSystem>());
-    Locator<system::RenderSystem>::set(&context_.systemManager.system<system::RenderSystem>());
-    Locator<system::DebugRenderSystem>::set(&context_.systemManager.system<system::DebugRenderSystem>());
+    if (!context_.headless) {
+        Locator<system::RenderSystem>::set(&context_.systemManager.system<system::RenderSystem>());
+        Locator<system::DebugRenderSystem>::set(&context_.systemManager.system<system::DebugRenderSystem>());
+    }
 
-    keyboard_.registerKeyDownCallback(Keycode::KeyF1,
-        [this]() -> void {
-        auto& ui = this->context_.systemManager.system< system::UiSystem >();
-        ui.toggleDisplay();
-    });
+    if (!context_.headless) {
+        keyboard_.registerKeyDownCallback(Keycode::KeyF1,
+            [this]() -> void {
+            auto& ui = this->context_.systemManager.system< system::UiSystem >();
+            ui.toggleDisplay();
+        });
+    }
     keyboard_.registerKeyDownCallback(Keycode::KeyP,
         [this]() -> void {
         this->requestStackPush_(states::Pause);
     });
 
-    readScene(context_, "scene.json");
+    readScene(context_, context_.scene.c_str());
 }
 
 bool GameState::update(float dt) {
+    if (!context_.headless) {
+        // the renderer interpolates from the transforms before the step
+        context_.systemManager.system< system::RenderSystem >().storePreviousTransforms(context_.entityManager);
+    }
     keyboard_.handleKeyPressedCallbacks();
     mouse_.handleMousePressedCallbacks();
     context_.systemManager.update< system::ScriptSystem >(dt);
+    context_.systemManager.update<system::SpatialSystem>(dt);
     return false;
 }
 
+bool GameState::prepareRender(float dt, float alpha) {
+    // headless too, the UI and the debug draw lists are built, and thrown away
+    context_.systemManager.system< system::ScriptSystem >().draw(dt);
+    if (context_.headless) {
+        return false;
+    }
+    // copy the render state for the next render
+    context_.systemManager.system< system::RenderSystem >().setInterpolation(alpha);
+    context_.systemManager.update< system::RenderSystem >(dt);
+    context_.systemManager.update<system::DebugRenderSystem>(dt);
+    return false;
+}
+
+void GameState::synchronize(float dt) {
+    if (context_.headless) {
+        return;
+    }
+    context_.systemManager.system< system::RenderSystem >().swapFrames();
+    context_.systemManager.system<system::DebugRenderSystem>().swapFrames();
+    // the UI reads the last render's statistics, and its events go to the simulation
+    context_.systemManager.update< system::UiSystem >(dt);
+}
+
 bool GameState::handleEvent(const SDL_Event& event) {
     if (event.type == SDL_QUIT) {
         requestStackClear_();
@@ -76,9 +119,9 @@ bool GameState::handleEvent(const SDL_Event& event) {
 }
 
 void GameState::render(float dt) {
-    context_.systemManager.update< system::RenderSystem >(dt);
-    context_.systemManager.update<system::DebugRenderSystem>(dt);
-    context_.systemManager.update< system::UiSystem >(dt);
+    PG_ASSERT(!context_.headless);
+    context_.systemManager.system< system::RenderSystem >().render();
+    context_.systemManager.system<system::DebugRenderSystem>().render();
 }
 
 }
@@ -30,6 +30,8 @@ public:
     void activate() override;
     void render(float dt) override;
     bool update(float dt) override;
+    bool prepareRender(float dt, float alpha) override;
+    void synchronize(float dt) override;
     bool handleEvent(const SDL_Event& event) override;
 };
 
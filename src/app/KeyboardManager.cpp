@@ -122,6 +122,7 @@ void KeyboardManager::addToMap_(std::map<int, CallbackData>& m, Keycode code, st
 
 void KeyboardManager::handleEvent(const SDL_Event& event) {
     if (event.type == SDL_KEYDOWN) {
+        heldKeys_.insert(int(event.key.keysym.sym));
         auto it = keyDownCallbacks_.find(int(event.key.keysym.sym));
         if (it != keyDownCallbacks_.end()) {
             it->second.callback();
@@ -131,6 +132,7 @@ void KeyboardManager::handleEvent(const SDL_Event& event) {
         }
     }
     else if (event.type == SDL_KEYUP) {
+        heldKeys_.erase(int(event.key.keysym.sym));
         auto it = keyUpCallbacks_.find(int(event.key.keysym.sym));
         if (it != keyUpCallbacks_.end()) {
             it->second.callback();
@@ -143,10 +145,8 @@ void KeyboardManager::handleEvent(const SDL_Event& event) {
 
 void KeyboardManager::handleKeyPressedCallbacks() {
     // handle real time input
-    const uint8_t* state = SDL_GetKeyboardState(NULL);
     for (std::pair<const int, CallbackData>& c : keyPressedCallbacks_) {
-        // the key code is the index
-        if (state[SDL_GetScancodeFromKey(int(c.first))]) {
+        if (heldKeys_.count(c.first)) {
             c.second.callback();
             for (ecs::Entity* entity : c.second.entities) {
                 scriptSystem_->onKeyPressed(toString(Keycode(c.first)), entity);
@@ -7,6 +7,7 @@
 #include <SDL_scancode.h>
 #include <functional>
 #include <map>
+#include <unordered_set>
 #include <vector>
 #include <string>
 
@@ -98,6 +99,9 @@ enum Keycode {
  * @file KeyboardManager.h
  * @brief Use this class to register commands to certain keyboard events.
  * This class will handle what to do with an event.
+ *
+ * The held keys are tracked from the key down and up events, instead of reading SDL's keyboard
+ * state, so that the callbacks only depend on the events, which can be recorded and replayed.
  */
 class KeyboardManager {
 public:
@@ -143,6 +147,7 @@ private:
     std::map<int, CallbackData> keyDownCallbacks_{};
     std::map<int, CallbackData> keyPressedCallbacks_{};
     std::map<int, CallbackData> keyUpCallbacks_{};
+    std::unordered_set<int>     heldKeys_{};
     system::ScriptSystem*      scriptSystem_{ nullptr };
 };
 
@@ -49,20 +49,26 @@ math::Vec2i MouseEvents::getMouseCoords() const {
 
 math::Vec2f MouseEvents::getNormalizedMouseCoords() const {
     return math::Vec2f{
-        2.f * currentCoords_.x / context_.window->width() - 1.f,
-        1.f - (2.f * currentCoords_.y / context_.window->height())
+        2.f * currentCoords_.x / context_.width() - 1.f,
+        1.f - (2.f * currentCoords_.y / context_.height())
     };
 }
 
 math::Vec2f MouseEvents::getMouseDelta() const {
     return math::Vec2f{
-        float(currentCoords_.x - previousCoords_.x) / context_.window->width(),
-        - float(currentCoords_.y - previousCoords_.y) / context_.window->height()
+        float(currentCoords_.x - previousCoords_.x) / context_.width(),
+        - float(currentCoords_.y - previousCoords_.y) / context_.height()
     };
 }
 
 bool MouseEvents::handleEvent(const SDL_Event& event) {
-    if (event.type == SDL_MOUSEBUTTONDOWN) {
+    if (event.type == SDL_MOUSEMOTION) {
+        latestCoords_ = math::Vec2i{ event.motion.x, event.motion.y };
+        buttons_ = event.motion.state;
+    }
+    else if (event.type == SDL_MOUSEBUTTONDOWN) {
+        latestCoords_ = math::Vec2i{ event.button.x, event.button.y };
+        buttons_ |= SDL_BUTTON(event.button.button);
         auto it = mouseDownCallbacks_.find(event.button.button);
         if (it != mouseDownCallbacks_.end()) {
             it->second.callback();
@@ -73,6 +79,8 @@ bool MouseEvents::handleEvent(const SDL_Event& event) {
         }
     }
     else if (event.type == SDL_MOUSEBUTTONUP) {
+        latestCoords_ = math::Vec2i{ event.button.x, event.button.y };
+        buttons_ &= ~SDL_BUTTON(event.button.button);
         auto it = mouseUpCallbacks_.find(event.button.button);
         if (it != mouseUpCallbacks_.end()) {
             it->second.callback();
@@ -96,9 +104,9 @@ bool MouseEvents::handleEvent(const SDL_Event& event) {
 
 void MouseEvents::handleMousePressedCallbacks() {
     previousCoords_ = currentCoords_;
-    const uint32_t state = SDL_GetMouseState(&currentCoords_.x, &currentCoords_.y);
+    currentCoords_ = latestCoords_;
     for (auto& pair : mousePressedCallbacks_) {
-        if (state & SDL_BUTTON(pair.first)) {
+        if (buttons_ & SDL_BUTTON(pair.first)) {
             pair.second.callback();
             for (ecs::Entity* entity : pair.second.entities) {
                 scriptSystem_->onMousePressed(toString(MouseButton(pair.first)), entity);
@@ -35,6 +35,10 @@ enum MouseButton {
  * @class MouseEvents
  * @file MouseEvents.h
  * @brief Bind callbacks to mouse events.
+ *
+ * The coordinates and the held buttons are tracked from the events, instead of reading SDL's
+ * mouse state, so that the callbacks only depend on the events, which can be recorded and replayed.
+ * handleMousePressedCallbacks moves the coordinates of the events so far into the current frame.
  */
 class MouseEvents {
 public:
@@ -79,9 +83,10 @@ private:
         std::function<void()>       callback;
     };
 
-    uint32_t    previousState_; // the mouse state mask
-    math::Vec2i previousCoords_;
-    math::Vec2i currentCoords_;
+    uint32_t    buttons_{ 0u };  // the mouse state mask
+    math::Vec2i latestCoords_{ 0, 0 };
+    math::Vec2i previousCoords_{ 0, 0 };
+    math::Vec2i currentCoords_{ 0, 0 };
 
     void addToMap_(std::map<int, CallbackData>&, MouseButton, std::function<void()>);
     void addToMap_(std::map<int, CallbackData>&, MouseButton, ecs::Entity*);
@@ -17,6 +17,14 @@ bool PauseState::update(float dt) {
     return false;
 }
 
+bool PauseState::prepareRender(float dt, float alpha) {
+    return false;
+}
+
+void PauseState::synchronize(float dt) {
+    // do nothing
+}
+
 bool PauseState::handleEvent(const SDL_Event& event) {
     if (event.type == SDL_QUIT) {
         requestStackClear_();
@@ -75,6 +75,8 @@ void readScene(Context& context, const char* file) {
             vm.executeString(
                 "import \"pg/entity\" for Entity\n"
                 "var entity = Entity.new()\n"
+                // the script assigns its own, if it draws anything
+                "var draw = Fn.new { |dt| }\n"
                 );
             // make sure the method gets destroyed before the vm is moved into the entity's script component
             {
@@ -98,9 +100,14 @@ void readScene(Context& context, const char* file) {
         }
 
         JsonToken renderable = json.query(entity, "renderable");
-        if (renderable) {
+        if (renderable && context.headless) {
+            // nothing is drawn or loaded, but the entity can still be picked, with the placeholder's box
+            const math::AABoxf bounds = MeshManager::cubeBounds();
+            newEntity.assign<math::AABoxf>(bounds.min, bounds.max);
+        }
+        else if (renderable) {
             const char* modelName = json.query(renderable, "model").as<const char*>();
-            opengl::BufferObject* buffer = context.meshManager.get(modelName);
+            const Mesh* mesh = context.meshManager.get(modelName);
             opengl::Program* shader{ nullptr };
             system::Material mat;
 
@@ -128,16 +135,21 @@ void readScene(Context& context, const char* file) {
 
             shader = context.shaderManager.get("specular");
 
-            buffer->bind();
-            opengl::VertexAttributes vao{
-                {unsigned(shader->attribute("vertex")), opengl::AttributeType::Float, 3},
-                {unsigned(shader->attribute("normal")), opengl::AttributeType::Float, 3}
-            };
-            buffer->unbind();
+            opengl::VertexAttributes vao = context.meshManager.attributes(*shader);
+
+            newEntity.assign<component::Renderable>(mesh, shader, vao, mat);
+            newEntity.assign<math::AABoxf>(mesh->bounds.min, mesh->bounds.max);
 
-            newEntity.assign<component::Renderable>(buffer, shader, vao, mat);
-            const auto& boundingBox = context.meshManager.getBoundingBox(modelName);
-            newEntity.assign<math::AABoxf>(boundingBox.min, boundingBox.max);
+            // static renderables are drawn in merged batches
+            JsonToken isStatic = json.query(renderable, "static");
+            if (isStatic && isStatic.as<bool>()) {
+                newEntity.assign<component::Static>();
+            }
+            // occluders hide the renderables behind them, see OcclusionBuffer
+            JsonToken isOccluder = json.query(renderable, "occluder");
+            if (isOccluder && isOccluder.as<bool>()) {
+                newEntity.assign<component::Occluder>();
+            }
         }
     }
 }
@@ -91,7 +91,8 @@ Window::Window()
     stencilBits_(8),
     depthBits_(24),
     msBuffer_(1),
-    msSamples_(4)
+    msSamples_(4),
+    hidden_(false)
 {}
 
 Window::~Window() {
@@ -124,7 +125,7 @@ void Window::initializeSDL_() {
         SDL_WINDOWPOS_UNDEFINED,
         SDL_WINDOWPOS_UNDEFINED,
         width_, height_,
-        SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL
+        SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL | (hidden_ ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
         );
     glContext_ = SDL_GL_CreateContext(window_);
 }
@@ -179,6 +180,7 @@ void Window::initialize(const WindowSettings& settings) {
     depthBits_ = settings.depthBits;
     msBuffer_ = settings.multisampleBuffer;
     msSamples_ = settings.multisampleSamples;
+    hidden_ = settings.hidden;
     clearColorR_ = settings.clearColor.r;
     clearColorG_ = settings.clearColor.g;
     clearColorB_ = settings.clearColor.b;
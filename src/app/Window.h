@@ -19,6 +19,8 @@ struct WindowSettings {
     int depthBits{ 24 };
     int multisampleBuffer{ 1 };
     int multisampleSamples{ 4 };
+    // the window isn't shown, but it still has a GL context to render into
+    bool hidden{ false };
     typedef struct {
         float r, g, b, a;
     } Color;
@@ -71,6 +73,7 @@ private:
     int             depthBits_;
     int             msBuffer_;  // multisample buffer
     int             msSamples_; // number of multisamples
+    bool            hidden_;
     float           clearColorR_;
     float           clearColorB_;
     float           clearColorG_;
@@ -7,3 +7,5 @@
 #include "component/PointLight.h"
 #include "component/Transform.h"
 #include "component/Script.h"
+#include "component/Static.h"
+#include "component/Occluder.h"
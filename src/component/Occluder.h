@@ -0,0 +1,15 @@
+#pragma once
+
+namespace pg {
+namespace component {
+
+/**
+ * @brief Marks a renderable entity which hides what is behind it, like a wall.
+ * The RenderSystem rasterizes the meshes of occluders into a software depth buffer each frame,
+ * and skips the renderables whose bounding boxes are entirely behind them. Occluders should be
+ * large and simple, with closed, counter clockwise front faces.
+ */
+struct Occluder {};
+
+}
+}
@@ -2,8 +2,8 @@
 #pragma once
 
 #include "system/Material.h"
+#include "manager/Mesh.h"
 #include "opengl/VertexAttributes.h"
-#include "opengl/BufferObject.h"
 #include "opengl/Program.h"
 #include <memory>
 #include <unordered_map>
@@ -13,7 +13,7 @@ namespace pg {
 namespace component {
 
 struct Renderable {
-    opengl::BufferObject* vbo;
+    const Mesh* mesh;
     opengl::Program* shader;
     opengl::VertexAttributes attributes;
     system::Material material;
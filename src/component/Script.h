@@ -13,13 +13,15 @@ struct Script {
         vm{ std::move(otherVM) },
         activate{ vm.method("main", "activate", "call()") },
         deactivate{ vm.method("main", "deactivate", "call()") },
-        update{ vm.method("main", "update", "call(_)") } {}
+        update{ vm.method("main", "update", "call(_)") },
+        draw{ vm.method("main", "draw", "call(_)") } {}
 
     std::size_t    scriptId;   // the hash of the script file name
     wrenpp::VM     vm;
     wrenpp::Method activate;
     wrenpp::Method deactivate;
-    wrenpp::Method update;
+    wrenpp::Method update;     // once per simulation step
+    wrenpp::Method draw;       // once per frame, for the UI and the debug draw lists
 };
 
 }
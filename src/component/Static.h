@@ -0,0 +1,15 @@
+#pragma once
+
+namespace pg {
+namespace component {
+
+/**
+ * @brief Marks a renderable entity which never moves.
+ * Static entities are merged into pre-transformed batches by the RenderSystem. Changing the
+ * transform of a static entity has no effect until the batches are rebuilt, which happens when
+ * a static entity is added, removed or its mesh finishes loading.
+ */
+struct Static {};
+
+}
+}
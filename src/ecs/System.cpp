@@ -0,0 +1,67 @@
+#include "ecs/System.h"
+#include "utils/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace pg {
+namespace ecs {
+
+namespace {
+
+// the nearest-rank percentile of the sorted samples
+float percentile(const std::vector<float>& sorted, float p) {
+    const std::size_t rank = std::size_t(std::ceil(p * float(sorted.size())));
+    return sorted[std::min(std::max(rank, std::size_t(1u)), sorted.size()) - 1u];
+}
+
+}
+
+std::vector<SystemManager::UpdateStats> SystemManager::updateStats() const {
+    std::vector<UpdateStats> stats;
+    std::vector<float> sorted;
+    for (const Timing& timing : timings_) {
+        if (timing.samples.size() == 0u) {
+            continue;
+        }
+        sorted.clear();
+        float sum = 0.f;
+        for (std::size_t i = 0u; i < timing.samples.size(); ++i) {
+            sorted.push_back(timing.samples.at(i));
+            sum += sorted.back();
+        }
+        std::sort(sorted.begin(), sorted.end());
+        stats.push_back(UpdateStats{
+            timing.name,
+            sorted.size(),
+            sum / float(sorted.size()),
+            percentile(sorted, 0.5f),
+            percentile(sorted, 0.95f),
+            percentile(sorted, 0.99f),
+            sorted.back()
+        });
+    }
+    return stats;
+}
+
+bool SystemManager::writeUpdateStats(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR << "Could not open system statistics file " << path << " for writing";
+        return false;
+    }
+    std::fputs("system,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n", file);
+    for (const UpdateStats& stats : updateStats()) {
+        std::fprintf(file, "%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", stats.name.c_str(), unsigned(stats.samples),
+            stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+    }
+    const bool ok = !std::ferror(file);
+    if (std::fclose(file) != 0 || !ok) {
+        LOG_ERROR << "Could not write system statistics file " << path;
+        return false;
+    }
+    return true;
+}
+
+}   // namespace ecs
+}   // namespace pg
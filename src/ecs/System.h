@@ -4,7 +4,12 @@
 #include "ecs/Component.h"
 #include "ecs/Event.h"
 #include "ecs/Entity.h"
+#include "utils/AllocationTracker.h"
 #include "utils/Assert.h"
+#include "utils/Profiler.h"
+#include "utils/RingBuffer.h"
+#include "utils/TypeName.h"
+#include <string>
 #include <vector>
 #include <type_traits>
 #include <memory>
@@ -46,12 +51,35 @@ public:
     virtual void update(EntityManager&, EventManager&, float dt) {}
 };
 
+/**
+ * @class SystemManager
+ * @brief Owns the systems, and times each of their updates.
+ *
+ * The times of the last TimingWindow update<S> calls are kept per system, so that a spike can
+ * be traced to the system which caused it. See updateStats.
+ */
 class SystemManager {
 public:
+    // the number of updates each system keeps the time of
+    static const std::size_t TimingWindow = 600u;
+
+    // the update times of a system over its timing window, in milliseconds
+    struct UpdateStats {
+        std::string     name;
+        std::size_t     samples;
+        float           mean;
+        float           p50;
+        float           p95;
+        float           p99;
+        float           max;
+    };
+
     SystemManager(EventManager& events, EntityManager& entities)
         : events_{ events},
         entities_{ entities },
-        systems_{} {}
+        systems_{},
+        timings_{},
+        timingIndices_{} {}
     ~SystemManager() = default;
 
     template<typename S, typename... Args>
@@ -65,10 +93,27 @@ public:
     template<typename S>
     void update(float dt);
 
+    /// @brief The statistics of the systems which have been updated, in the order they were added.
+    std::vector<UpdateStats> updateStats() const;
+    /// @brief Write updateStats to a CSV file, with a header row.
+    bool writeUpdateStats(const std::string& file) const;
+
 private:
+    struct Timing {
+        explicit Timing(const char* name)
+            : name{ name },
+            samples{ TimingWindow } {}
+
+        const char*         name;
+        RingBuffer<float>   samples;
+    };
+
     EventManager&   events_;
     EntityManager&  entities_;
+    // indexed by the system type id, which is global, so a manager can hold any subset of the systems
     std::vector<std::unique_ptr<System>> systems_;
+    std::vector<Timing> timings_;   // in the order the systems were added
+    std::vector<std::size_t> timingIndices_;    // indexed by the system type id
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -76,27 +121,39 @@ private:
 /////////////////////////////////////////////////////////////////////////////
 template<typename S, typename... Args>
 System* SystemManager::add(Args&&... args) {
-    PG_ASSERT(detail::getSystemId<S>() == systems_.size());
-    systems_.emplace_back(new S(std::forward<Args>(args)...));
-    return systems_[detail::getSystemId<S>()].get();
+    const uint32_t id = detail::getSystemId<S>();
+    if (id >= systems_.size()) {
+        systems_.resize(id + 1u);
+        timingIndices_.resize(id + 1u, 0u);
+    }
+    PG_ASSERT(!systems_[id]);
+    systems_[id].reset(new S(std::forward<Args>(args)...));
+    timingIndices_[id] = timings_.size();
+    timings_.emplace_back(typeName<S>());
+    return systems_[id].get();
 }
 
 template<typename S>
 S& SystemManager::system() {
-    PG_ASSERT(detail::getSystemId<S>() < systems_.size());
+    PG_ASSERT(detail::getSystemId<S>() < systems_.size() && systems_[detail::getSystemId<S>()]);
     return (S&)(*systems_[detail::getSystemId<S>()].get());
 }
 
 template<typename S>
 void SystemManager::configure() {
-    PG_ASSERT(detail::getSystemId<S>() < systems_.size());
+    PG_ASSERT(detail::getSystemId<S>() < systems_.size() && systems_[detail::getSystemId<S>()]);
     systems_[detail::getSystemId<S>()]->configure(events_);
 }
 
 template<typename S>
 void SystemManager::update(float dt) {
-    PG_ASSERT(detail::getSystemId<S>() < systems_.size());
+    PG_ASSERT(detail::getSystemId<S>() < systems_.size() && systems_[detail::getSystemId<S>()]);
+    ProfileZone zone{ typeName<S>() };
+    static const std::uint32_t allocationTag = allocationTracker().tag(typeName<S>());
+    AllocationTag allocations{ allocationTag };
+    const std::uint64_t begin = Profiler::now();
     systems_[detail::getSystemId<S>()]->update(entities_, events_, dt);
+    timings_[timingIndices_[detail::getSystemId<S>()]].samples.pushBack(float(Profiler::now() - begin) / 1000000.f);
 }
 
 }   // namespace ecs
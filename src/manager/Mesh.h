@@ -0,0 +1,48 @@
+#pragma once
+
+#include "opengl/BufferArena.h"
+#include "math/Geometry.h"
+#include "math/Matrix.h"
+#include <GL/glew.h>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+
+/// @brief The vertex format of all meshes, quantized at import time.
+struct MeshVertex {
+    std::int16_t    position[4];    // snorm16 relative to the mesh bounds, see math::quantizePosition. The last one is padding.
+    std::int16_t    normal[2];      // snorm16 octahedral encoding, decoded in the vertex shader
+};
+
+static_assert(sizeof(MeshVertex) == 12u, "MeshVertex should be tightly packed");
+
+/// @brief The number of detail levels a mesh can have, including the full resolution one.
+const std::size_t MaxMeshLods = 4u;
+
+/// @brief A range of the mesh's index buffer, which draws the mesh at one level of detail.
+struct MeshLod {
+    GLintptr    indexOffset{ 0 };   // in bytes
+    GLsizei     indexCount{ 0 };
+};
+
+/**
+ * @brief An indexed triangle mesh on the GPU. Meshes are owned by the MeshManager.
+ * The vertices and indices are ranges of the MeshManager's vertex and index arenas, which all
+ * meshes share. The detail levels share the vertex range. lods[0] is the full resolution mesh,
+ * and each following level has fewer triangles.
+ */
+struct Mesh {
+    opengl::BufferArena::Range  vertexRange{};
+    opengl::BufferArena::Range  indexRange{};
+    // added to each index, the offset of vertexRange in vertices. Zero if the indices were rebased instead.
+    GLint                       baseVertex{ 0 };
+    MeshLod                     lods[MaxMeshLods]{};    // the index offsets are from the start of the arena
+    std::uint32_t               lodCount{ 1u };
+    GLenum                      indexType{ GL_UNSIGNED_INT };   // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    math::AABoxf                bounds{};
+    // maps the quantized positions into the bounds, and goes to the right of the model matrix
+    math::Matrix4f              dequantize{};
+};
+
+}
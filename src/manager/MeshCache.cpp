@@ -0,0 +1,183 @@
+#include "manager/MeshCache.h"
+#include "utils/Log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const std::uint32_t Magic = 0x4853454du;    // "MESH"
+// bump this whenever the header, the vertex format, or the mesh processing changes
+const std::uint32_t FormatVersion = 2u;
+// the vertex and index data start at multiples of this
+const std::size_t BlobAlignment = 16u;
+
+struct MeshFileHeader {
+    std::uint32_t   magic;
+    std::uint32_t   version;
+    std::uint64_t   modified;
+    std::uint64_t   sourceSize;
+    std::uint32_t   importFlags;
+    std::uint32_t   sourceLength;   // the source path follows the header
+    std::uint64_t   vertexOffset;   // in bytes, from the start of the file
+    std::uint64_t   vertexCount;
+    std::uint64_t   indexOffset;
+    std::uint64_t   indexCount;
+    std::uint32_t   indexSize;
+    std::uint32_t   lodCount;
+    std::uint64_t   lodOffsets[pg::MaxMeshLods];
+    std::uint64_t   lodSizes[pg::MaxMeshLods];
+    float           boundsMin[3];
+    float           boundsMax[3];
+};
+
+std::uint64_t align(std::uint64_t offset) {
+    return (offset + BlobAlignment - 1u) / BlobAlignment * BlobAlignment;
+}
+
+// whether count elements at the offset end within the size, without overflowing
+bool fits(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize, std::uint64_t size) {
+    return offset <= size && count <= (size - offset) / elementSize;
+}
+
+// the ranges index the shared arena once uploaded, so a corrupt file must not reach past its own indices
+bool validLods(const MeshFileHeader& header) {
+    if (header.lodCount == 0u || header.lodCount > pg::MaxMeshLods) {
+        return false;
+    }
+    for (std::uint32_t lod = 0u; lod < header.lodCount; ++lod) {
+        if (!fits(header.lodOffsets[lod], header.lodSizes[lod], 1u, header.indexCount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Index>
+bool indicesBelow(const void* indices, std::size_t count, std::uint64_t vertexCount) {
+    const Index* begin = static_cast<const Index*>(indices);
+    Index max = 0u;
+    for (const Index* index = begin; index != begin + count; ++index) {
+        max = std::max(max, *index);
+    }
+    return count == 0u || max < vertexCount;
+}
+
+}
+
+namespace pg {
+
+std::string meshCachePath(const std::string& directory, const std::string& source) {
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : source) {
+        hash ^= std::uint64_t(static_cast<unsigned char>(c));
+        hash *= 1099511628211ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(hash));
+    return directory + "/" + name;
+}
+
+bool writeMeshCache(const std::string& path, const MeshCacheKey& key, const MeshView& mesh) {
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = Magic;
+    header.version = FormatVersion;
+    header.modified = key.modified;
+    header.sourceSize = key.sourceSize;
+    header.importFlags = key.importFlags;
+    header.sourceLength = std::uint32_t(key.source.size());
+    header.vertexOffset = align(sizeof(header) + key.source.size());
+    header.vertexCount = mesh.vertexCount;
+    header.indexOffset = align(header.vertexOffset + mesh.vertexCount * sizeof(MeshVertex));
+    header.indexCount = mesh.indexCount;
+    header.indexSize = std::uint32_t(mesh.indexSize);
+    header.lodCount = mesh.lodCount;
+    for (std::size_t lod = 0u; lod < mesh.lodCount; ++lod) {
+        header.lodOffsets[lod] = mesh.lodOffsets[lod];
+        header.lodSizes[lod] = mesh.lodSizes[lod];
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = mesh.bounds.min.data[axis];
+        header.boundsMax[axis] = mesh.bounds.max.data[axis];
+    }
+
+    // write to a temporary file first, so that a crash can't leave a truncated cache file behind
+    const std::string temporary = path + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        LOG_ERROR << "Could not open mesh cache file " << temporary << " for writing";
+        return false;
+    }
+    const std::vector<char> padding(BlobAlignment, 0);
+    bool ok = std::fwrite(&header, sizeof(header), 1u, file) == 1u;
+    ok = ok && std::fwrite(key.source.data(), 1u, key.source.size(), file) == key.source.size();
+    const std::size_t vertexPadding = std::size_t(header.vertexOffset - sizeof(header) - key.source.size());
+    ok = ok && std::fwrite(padding.data(), 1u, vertexPadding, file) == vertexPadding;
+    ok = ok && std::fwrite(mesh.vertices, sizeof(MeshVertex), mesh.vertexCount, file) == mesh.vertexCount;
+    const std::size_t indexPadding = std::size_t(header.indexOffset - header.vertexOffset - mesh.vertexCount * sizeof(MeshVertex));
+    ok = ok && std::fwrite(padding.data(), 1u, indexPadding, file) == indexPadding;
+    ok = ok && std::fwrite(mesh.indices, mesh.indexSize, mesh.indexCount, file) == mesh.indexCount;
+    ok = std::fclose(file) == 0 && ok;
+
+    std::remove(path.c_str());
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        LOG_ERROR << "Could not write mesh cache file " << path;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool readMeshCache(const std::string& path, const MeshCacheKey& key, MappedFile& file, MeshView& mesh) {
+    if (!file.open(path)) {
+        return false;
+    }
+    MeshFileHeader header;
+    if (file.size() < sizeof(header)) {
+        file.close();
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    const bool matches = header.magic == Magic
+        && header.version == FormatVersion
+        && header.modified == key.modified
+        && header.sourceSize == key.sourceSize
+        && header.importFlags == key.importFlags
+        && header.sourceLength == key.source.size()
+        && file.size() >= sizeof(header) + header.sourceLength
+        && key.source.compare(0u, key.source.size(), file.data() + sizeof(header), header.sourceLength) == 0
+        && (header.indexSize == 2u || header.indexSize == 4u)
+        && header.vertexOffset % BlobAlignment == 0u && header.indexOffset % BlobAlignment == 0u
+        && header.vertexOffset >= sizeof(header) + header.sourceLength
+        && fits(header.vertexOffset, header.vertexCount, sizeof(MeshVertex), header.indexOffset)
+        && fits(header.indexOffset, header.indexCount, header.indexSize, file.size())
+        && validLods(header);
+    // an index out of the vertex range would fetch another mesh's vertices from the shared arena
+    if (!matches || !(header.indexSize == 2u ?
+        indicesBelow<std::uint16_t>(file.data() + header.indexOffset, std::size_t(header.indexCount), header.vertexCount) :
+        indicesBelow<std::uint32_t>(file.data() + header.indexOffset, std::size_t(header.indexCount), header.vertexCount))) {
+        file.close();
+        return false;
+    }
+
+    mesh.vertices = reinterpret_cast<const MeshVertex*>(file.data() + header.vertexOffset);
+    mesh.vertexCount = std::size_t(header.vertexCount);
+    mesh.indices = file.data() + header.indexOffset;
+    mesh.indexCount = std::size_t(header.indexCount);
+    mesh.indexSize = header.indexSize;
+    mesh.lodCount = header.lodCount;
+    for (std::size_t lod = 0u; lod < header.lodCount; ++lod) {
+        mesh.lodOffsets[lod] = std::size_t(header.lodOffsets[lod]);
+        mesh.lodSizes[lod] = std::size_t(header.lodSizes[lod]);
+    }
+    mesh.bounds = math::AABoxf{
+        math::Vec3f{ header.boundsMin[0], header.boundsMin[1], header.boundsMin[2] },
+        math::Vec3f{ header.boundsMax[0], header.boundsMax[1], header.boundsMax[2] }
+    };
+    return true;
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "manager/Mesh.h"
+#include "math/Geometry.h"
+#include "utils/MappedFile.h"
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+
+/// @brief Mesh data laid out the way it is stored in the GPU buffers, ready for upload.
+struct MeshView {
+    const MeshVertex*   vertices{ nullptr };
+    std::size_t         vertexCount{ 0u };
+    const void*         indices{ nullptr };
+    std::size_t         indexCount{ 0u };
+    std::size_t         indexSize{ 0u };            // 2 or 4 bytes
+    std::size_t         lodOffsets[MaxMeshLods]{};  // in indices
+    std::size_t         lodSizes[MaxMeshLods]{};
+    std::uint32_t       lodCount{ 0u };
+    math::AABoxf        bounds{};
+};
+
+/// @brief What a cached mesh was made from. A cache file is only used if all of it matches.
+struct MeshCacheKey {
+    std::string     source;
+    std::uint64_t   modified;       // the modification time of the source file
+    std::uint32_t   importFlags;    // the assimp post processing flags
+    // the size of the source file, which catches most edits within the modification time's second
+    std::uint64_t   sourceSize;
+};
+
+/**
+ * @brief Get the cache file name of a source file, within the cache directory.
+ * The name is a hash of the source path, which the cache file stores for verification.
+ */
+std::string meshCachePath(const std::string& directory, const std::string& source);
+
+/**
+ * @brief Write the mesh into a cache file.
+ * The file starts with a header, followed by the source path, the vertices and the indices. The
+ * vertex and index data are aligned, so that a mapping of the file can be uploaded as it is.
+ */
+bool writeMeshCache(const std::string& path, const MeshCacheKey& key, const MeshView& mesh);
+
+/**
+ * @brief Map a cache file, and point the view at its contents.
+ * @return false if the file is missing, was written by another format version, or was made
+ * from a different source, modification time, source size or set of import flags. Also if the
+ * data ranges are misaligned, overlap, or reach past the end of the file or the indices, or if
+ * an index is out of the vertex range.
+ */
+bool readMeshCache(const std::string& path, const MeshCacheKey& key, MappedFile& file, MeshView& mesh);
+
+}
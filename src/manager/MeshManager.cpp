@@ -1,13 +1,23 @@
 #include "manager/MeshManager.h"
+#include "math/MeshOptimizer.h"
+#include "math/MeshSimplifier.h"
+#include "math/Quantize.h"
 #include "math/Vector.h"
+#include "opengl/StateCache.h"
+#include "system/Events.h"
 #include "utils/Assert.h"
 #include "utils/File.h"
+#include "utils/Locator.h"
+#include "utils/Log.h"
 #include <GL/glew.h>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <limits>
+#include <utility>
 
 namespace {
 
@@ -47,16 +57,56 @@ int cubeIndices[] = {
     5, 6, 1, 6, 3, 6
 };
 
+// a position and a normal, before quantization
+const std::size_t VertexStride = 6u;
+
+// the largest surface deviation of a detail level, as a fraction of the bounding sphere radius
+const float MaxLodError = 0.05f;
+// a detail level which keeps more than this fraction of the previous level's triangles isn't worth storing
+const float MinLodReduction = 0.9f;
+
+const unsigned ImportFlags = aiProcess_Triangulate | aiProcess_GenSmoothNormals;
+// relative to the working directory
+const char* CacheDirectory = "meshcache";
+
+// the initial arena sizes, in bytes. The arenas double when they run out of space.
+const std::size_t VertexArenaSize = 4u << 20u;
+const std::size_t IndexArenaSize = 2u << 20u;
+
+// importing is mostly memory bound, so a couple of threads is enough
+const std::size_t LoaderThreadCount = 2u;
+// update stops uploading once this much time has gone by. At least one mesh is uploaded per update.
+const std::chrono::microseconds UploadBudget{ 2000 };
+
 }
 
 namespace pg {
 
+MeshManager::~MeshManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& loader : loaders_) {
+        loader.join();
+    }
+}
+
 void MeshManager::initialize() {
-    buffer_.emplace<GLenum>(GL_ARRAY_BUFFER);
+    vertices_.reset(new opengl::BufferArena(VertexArenaSize));
+    indices_.reset(new opengl::BufferArena(IndexArenaSize));
+    baseVertex_ = GLEW_ARB_draw_elements_base_vertex != 0;
+    if (!baseVertex_) {
+        LOG_INFO << "ARB_draw_elements_base_vertex is not available, mesh indices are rebased to 32 bits";
+    }
+
     std::vector<float> cubeData;
+    std::vector<std::uint32_t> cubeTriangles;
     for (int i = 0; i < 72; i += 2) {
         int triIndex = cubeIndices[i] - 1;
         int normIndex = cubeIndices[i + 1] - 1;
+        cubeTriangles.push_back(std::uint32_t(cubeTriangles.size()));
         cubeData.push_back(cubeVertices[triIndex * 3]);
         cubeData.push_back(cubeVertices[triIndex * 3 + 1]);
         cubeData.push_back(cubeVertices[triIndex * 3 + 2]);
@@ -64,113 +114,187 @@ void MeshManager::initialize() {
         cubeData.push_back(cubeNormals[normIndex * 3 + 1]);
         cubeData.push_back(cubeNormals[normIndex * 3 + 2]);
     }
-    buffer_[0].dataStore(cubeData.size(), sizeof(float), &cubeData[0], GL_STATIC_DRAW);
-    resources_.emplace("cube", &buffer_[0]);
-    boxes_.emplace(
-        "cube",
-        math::AABoxf{
-        math::Vec3f{ -0.5f, -0.5f, -0.5f },
-        math::Vec3f{ 0.5f, 0.5f, 0.5f }
+    MeshData cubeMesh;
+    processMesh_(cubeData, cubeTriangles, cubeMesh);
+    Mesh& cube = meshes_[meshes_.emplace()];
+    upload(view_(cubeMesh), cube);
+    log_("cube", cubeMesh);
+    resources_.emplace("cube", &cube);
+    cube_ = &cube;
+
+    if (!createDirectory(CacheDirectory)) {
+        LOG_ERROR << "Could not create the mesh cache directory " << CacheDirectory;
+    }
+    for (std::size_t i = 0u; i < LoaderThreadCount; ++i) {
+        loaders_.emplace_back(&MeshManager::load_, this);
     }
-    );
 }
 
-opengl::BufferObject* MeshManager::get(const std::string& file) const {
+const Mesh* MeshManager::get(const std::string& file) const {
     auto it = resources_.find(file);
 
     if (it != resources_.end()) {
         return it->second;
     }
-    //else {
-    //    it = resources_.find("cube");
-    //    return it->second;
-    //}
 
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(
-        file.c_str(),
-        aiProcess_Triangulate |
-        aiProcess_GenSmoothNormals
-        );
-
-    if (!scene) {
-        it = resources_.find("cube");
-        PG_ASSERT(it != resources_.end());
-        return it->second;
+    // draw a cube until the loaders are done with the file
+    PG_ASSERT(!loaders_.empty());
+    Mesh& mesh = meshes_[meshes_.emplace()];
+    mesh = *cube_;
+    resources_.emplace(file, &mesh);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.push_back(LoadRequest{ file, &mesh });
+        ++pending_;
     }
+    wake_.notify_one();
+    return &mesh;
+}
 
-    float minx = std::numeric_limits< float >::max();
-    float maxx = std::numeric_limits< float >::min();
-    float miny = std::numeric_limits< float >::max();
-    float maxy = std::numeric_limits< float >::min();
-    float minz = std::numeric_limits< float >::max();
-    float maxz = std::numeric_limits< float >::min();
-
-    std::vector<float> data;
+void MeshManager::update() {
+    upload_(UploadBudget);
+}
 
-    for (std::size_t i = 0u; i < scene->mNumMeshes; i++) {
-        aiMesh* mesh = scene->mMeshes[i];
-        int numFaces = mesh->mNumFaces;
-        for (int j = 0; j < numFaces; j++) {
-            const aiFace& face = mesh->mFaces[j];
-            for (std::size_t k = 0u; k < 3u; k++) {
+void MeshManager::finishLoading() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        finished_.wait(lock, [this]() -> bool { return pending_ == 0u; });
+    }
+    upload_(std::chrono::steady_clock::duration::max());
+}
 
-                aiVector3D vert = mesh->mVertices[face.mIndices[k]];
-
-                // find aabb bounding min/max extents
-                if (vert.x < minx) {
-                    minx = vert.x;
-                }
-                else if (vert.x > maxx) {
-                    maxx = vert.x;
-                }
-                if (vert.y < miny) {
-                    miny = vert.y;
-                }
-                else if (vert.y > maxy) {
-                    maxy = vert.y;
-                }
-                if (vert.z < minz) {
-                    minz = vert.z;
-                }
-                else if (vert.z > maxz) {
-                    maxz = vert.z;
-                }
-
-                // stick the vertex into memory
-                data.push_back(vert.x); data.push_back(vert.y); data.push_back(vert.z);
-
-                // get the normal vector
-                if (mesh->HasNormals()) {
-                    aiVector3D norm = mesh->mNormals[face.mIndices[k]];
-                    data.push_back(norm.x); data.push_back(norm.y); data.push_back(norm.z);
-                }
+void MeshManager::upload_(std::chrono::steady_clock::duration budget) {
+    const auto start = std::chrono::steady_clock::now();
+    for (;;) {
+        LoadedMesh loaded;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (loaded_.empty()) {
+                return;
             }
+            loaded = std::move(loaded_.front());
+            loaded_.pop_front();
+        }
+        // the placeholder's ranges belong to the cube, so they aren't released
+        upload(loaded.view, *loaded.mesh);
+        if (loaded.cache.isOpen()) {
+            LOG_INFO << "Mesh " << loaded.file << ": " << loaded.view.lodSizes[0] / 3u << " triangles, "
+                << loaded.view.vertexCount << " vertices, " << loaded.view.lodCount << " LODs, from the cache";
+        }
+        else {
+            log_(loaded.file, loaded.data);
+        }
+        Locator< ecs::EventManager >::get()->emit< system::MeshLoaded >(loaded.mesh);
+        if (std::chrono::steady_clock::now() - start >= budget) {
+            return;
         }
     }
-    auto index = buffer_.emplace<GLenum>(GL_ARRAY_BUFFER);
-    resources_.emplace(file, &buffer_[index]);
-    opengl::BufferObject* vbo = resources_.find(file)->second;
-    vbo->dataStore(
-        data.size(), sizeof(float), &data[0], GL_STATIC_DRAW
-        );
-
-    boxes_.emplace(
-        file,
-        math::AABoxf{
-            math::Vec3f{ minx, miny, minz },
-            math::Vec3f{ maxx, maxy, maxz }
+}
+
+void MeshManager::createAttributes(const opengl::Program& program) {
+    const GLint vertex = program.attribute("vertex");
+    if (vertex < 0 || attributes_.find(program.object()) != attributes_.end()) {
+        return;
+    }
+    const GLint normal = program.attribute("normal");
+    opengl::StateCache& state = opengl::stateCache();
+    const GLuint lastBuffer = state.buffer(GL_ARRAY_BUFFER);
+    state.bindBuffer(GL_ARRAY_BUFFER, vertices_->object());
+    // the layout of MeshVertex; programs which don't use normals skip them
+    opengl::VertexAttributes attributes = normal >= 0 ?
+        opengl::VertexAttributes{
+            { unsigned(vertex), opengl::AttributeType::Short, 3, true },
+            { opengl::AttributeType::Short, 1 },
+            { unsigned(normal), opengl::AttributeType::Short, 2, true }
+        } :
+        opengl::VertexAttributes{
+            { unsigned(vertex), opengl::AttributeType::Short, 3, true },
+            { opengl::AttributeType::Short, 1 },
+            { opengl::AttributeType::Short, 2 }
+        };
+    state.bindBuffer(GL_ARRAY_BUFFER, lastBuffer);
+    attributes.attachIndices(indices_->object());
+    attributes_.emplace(program.object(), attributes);
+}
+
+opengl::VertexAttributes MeshManager::attributes(const opengl::Program& program) const {
+    auto it = attributes_.find(program.object());
+    // created in Application::initializeGraphics_ for every program
+    PG_ASSERT(it != attributes_.end());
+    return it->second;
+}
+
+void MeshManager::upload(const MeshView& mesh, Mesh& target) {
+    PG_ASSERT(mesh.indexSize == sizeof(std::uint16_t) || mesh.indexSize == sizeof(std::uint32_t));
+    target.vertexRange = vertices_->allocate(mesh.vertexCount * sizeof(MeshVertex), sizeof(MeshVertex));
+    vertices_->upload(target.vertexRange, mesh.vertices, mesh.vertexCount * sizeof(MeshVertex));
+    const GLint firstVertex = GLint(target.vertexRange.offset / GLintptr(sizeof(MeshVertex)));
+
+    std::size_t indexSize = mesh.indexSize;
+    if (baseVertex_) {
+        target.indexRange = indices_->allocate(mesh.indexCount * indexSize, sizeof(std::uint32_t));
+        indices_->upload(target.indexRange, mesh.indices, mesh.indexCount * indexSize);
+        target.baseVertex = firstVertex;
+    }
+    else {
+        std::vector<std::uint32_t> rebased(mesh.indexCount);
+        for (std::size_t i = 0u; i < mesh.indexCount; ++i) {
+            const std::uint32_t index = indexSize == sizeof(std::uint16_t) ?
+                static_cast<const std::uint16_t*>(mesh.indices)[i] : static_cast<const std::uint32_t*>(mesh.indices)[i];
+            rebased[i] = std::uint32_t(firstVertex) + index;
         }
-    );
+        indexSize = sizeof(std::uint32_t);
+        target.indexRange = indices_->allocate(rebased.size() * indexSize, indexSize);
+        indices_->upload(target.indexRange, rebased.data(), rebased.size() * indexSize);
+        target.baseVertex = 0;
+    }
+    target.indexType = indexSize == sizeof(std::uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
-    return vbo;
+    target.lodCount = mesh.lodCount;
+    for (std::size_t lod = 0u; lod < mesh.lodCount; ++lod) {
+        target.lods[lod].indexOffset = target.indexRange.offset + GLintptr(mesh.lodOffsets[lod] * indexSize);
+        target.lods[lod].indexCount = GLsizei(mesh.lodSizes[lod]);
+    }
+    target.bounds = mesh.bounds;
+    target.dequantize = math::dequantizationMatrix(mesh.bounds);
+}
+
+void MeshManager::release(Mesh& mesh) {
+    PG_ASSERT(mesh.vertexRange.offset != cube_->vertexRange.offset);
+    vertices_->free(mesh.vertexRange);
+    indices_->free(mesh.indexRange);
+    mesh.vertexRange = opengl::BufferArena::Range{};
+    mesh.indexRange = opengl::BufferArena::Range{};
+    mesh.lodCount = 0u;
+}
+
+void MeshManager::download(const Mesh& mesh, std::vector<MeshVertex>& vertices, std::vector<std::uint32_t>& indices) const {
+    vertices.resize(std::size_t(mesh.vertexRange.size) / sizeof(MeshVertex));
+    vertices_->download(mesh.vertexRange, vertices.data());
+
+    const MeshLod& lod = mesh.lods[0];
+    const std::size_t indexSize = mesh.indexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+    std::vector<char> raw(std::size_t(lod.indexCount) * indexSize);
+    indices_->download(opengl::BufferArena::Range{ lod.indexOffset, GLsizeiptr(raw.size()) }, raw.data());
+    // rebased indices count from the start of the arena, instead of from baseVertex
+    const std::uint32_t firstVertex = std::uint32_t(mesh.vertexRange.offset / GLintptr(sizeof(MeshVertex)) - mesh.baseVertex);
+    indices.resize(std::size_t(lod.indexCount));
+    for (std::size_t i = 0u; i < indices.size(); ++i) {
+        const std::uint32_t index = indexSize == sizeof(std::uint16_t) ?
+            reinterpret_cast<const std::uint16_t*>(raw.data())[i] : reinterpret_cast<const std::uint32_t*>(raw.data())[i];
+        indices[i] = index - firstVertex;
+    }
 }
 
 math::AABoxf MeshManager::getBoundingBox(const std::string& file) const {
     LOG_DEBUG << "Getting bounding box for " << file;
-    auto it = boxes_.find(file);
-    PG_ASSERT(it != boxes_.end());
-    return it->second;
+    auto it = resources_.find(file);
+    PG_ASSERT(it != resources_.end());
+    return it->second->bounds;
+}
+
+math::AABoxf MeshManager::cubeBounds() {
+    return math::AABoxf{ math::Vec3f{ -0.5f, -0.5f, -0.5f }, math::Vec3f{ 0.5f, 0.5f, 0.5f } };
 }
 
 void MeshManager::clear() {
@@ -181,4 +305,191 @@ std::size_t MeshManager::size() const {
     return resources_.size();
 }
 
+void MeshManager::load_() {
+    for (;;) {
+        LoadRequest request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() -> bool { return stop_ || !requests_.empty(); });
+            if (stop_) {
+                return;
+            }
+            request = std::move(requests_.front());
+            requests_.pop_front();
+        }
+
+        LoadedMesh loaded{ std::move(request.file), request.mesh, MeshView{}, MeshData{}, MappedFile{} };
+        const std::string cachePath = meshCachePath(CacheDirectory, loaded.file);
+        const MeshCacheKey key{ loaded.file, fileModifiedTime(loaded.file), ImportFlags, fileSize(loaded.file) };
+        if (!readMeshCache(cachePath, key, loaded.cache, loaded.view)) {
+            if (import_(loaded.file, loaded.data)) {
+                loaded.view = view_(loaded.data);
+                writeMeshCache(cachePath, key, loaded.view);
+            }
+            else {
+                // the placeholder stays
+                loaded.mesh = nullptr;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (loaded.mesh) {
+                loaded_.push_back(std::move(loaded));
+            }
+            --pending_;
+        }
+        finished_.notify_all();
+    }
+}
+
+bool MeshManager::import_(const std::string& file, MeshData& data) {
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(file.c_str(), ImportFlags);
+
+    if (!scene) {
+        LOG_ERROR << "Failed to import " << file << ": " << importer.GetErrorString();
+        return false;
+    }
+
+    // keep the per-mesh indices, and merge the meshes into one vertex and index list
+    std::vector<float> vertices;
+    std::vector<std::uint32_t> indices;
+    for (std::size_t i = 0u; i < scene->mNumMeshes; i++) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        const std::uint32_t baseVertex = std::uint32_t(vertices.size() / VertexStride);
+        for (std::size_t j = 0u; j < mesh->mNumVertices; j++) {
+            const aiVector3D& vert = mesh->mVertices[j];
+            vertices.push_back(vert.x); vertices.push_back(vert.y); vertices.push_back(vert.z);
+            if (mesh->HasNormals()) {
+                const aiVector3D& norm = mesh->mNormals[j];
+                vertices.push_back(norm.x); vertices.push_back(norm.y); vertices.push_back(norm.z);
+            }
+            else {
+                vertices.push_back(0.f); vertices.push_back(0.f); vertices.push_back(0.f);
+            }
+        }
+        for (std::size_t j = 0u; j < mesh->mNumFaces; j++) {
+            const aiFace& face = mesh->mFaces[j];
+            // triangulation leaves points and lines as they are
+            if (face.mNumIndices != 3u) {
+                continue;
+            }
+            for (std::size_t k = 0u; k < 3u; k++) {
+                indices.push_back(baseVertex + face.mIndices[k]);
+            }
+        }
+    }
+
+    if (indices.empty()) {
+        LOG_ERROR << file << " contains no triangles";
+        return false;
+    }
+
+    processMesh_(vertices, indices, data);
+    return true;
+}
+
+void MeshManager::processMesh_(const std::vector<float>& vertices, std::vector<std::uint32_t>& indices, MeshData& data) {
+    PG_ASSERT(vertices.size() % VertexStride == 0u);
+    PG_ASSERT(indices.size() % 3u == 0u);
+    data.inputVertexCount = vertices.size() / VertexStride;
+
+    std::vector<float> unique;
+    std::vector<std::uint32_t> remap;
+    std::size_t vertexCount = math::weldVertices(vertices.data(), data.inputVertexCount, VertexStride, unique, remap);
+    for (std::uint32_t& index : indices) {
+        index = remap[index];
+    }
+    data.acmrBefore = math::averageCacheMissRatio(indices.data(), indices.size(), vertexCount);
+
+    math::Vec3f min{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    math::Vec3f max{ -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+    for (std::size_t i = 0u; i < vertexCount; ++i) {
+        const float* position = &unique[i * VertexStride];
+        for (int axis = 0; axis < 3; ++axis) {
+            min.data[axis] = std::min(min.data[axis], position[axis]);
+            max.data[axis] = std::max(max.data[axis], position[axis]);
+        }
+    }
+    data.bounds = math::AABoxf{ min, max };
+
+    /*
+     * Simplify the full mesh into coarser levels of detail, halving the triangle count each time.
+     * The levels index the same vertices, so only the index buffer grows.
+     */
+    std::vector<std::vector<std::uint32_t>> lods(1u, indices);
+    const float maxLodError = MaxLodError * data.bounds.extents().norm();
+    for (std::size_t lod = 1u; lod < MaxMeshLods; ++lod) {
+        const std::size_t target = (indices.size() / 3u >> lod) * 3u;
+        std::vector<std::uint32_t> simplified;
+        math::simplifyMesh(unique.data(), vertexCount, VertexStride, indices.data(), indices.size(), target, maxLodError, simplified);
+        if (float(simplified.size()) > MinLodReduction * float(lods.back().size())) {
+            break;
+        }
+        lods.push_back(std::move(simplified));
+    }
+
+    // the levels are stored one after another in the index buffer, the full mesh first
+    std::vector<std::uint32_t> lodIndices;
+    data.lodCount = std::uint32_t(lods.size());
+    for (std::size_t lod = 0u; lod < lods.size(); ++lod) {
+        math::optimizeVertexCache(lods[lod].data(), lods[lod].size(), vertexCount);
+        data.lodOffsets[lod] = lodIndices.size();
+        data.lodSizes[lod] = lods[lod].size();
+        lodIndices.insert(lodIndices.end(), lods[lod].begin(), lods[lod].end());
+    }
+    // the coarser levels use a subset of the full mesh's vertices, so they don't affect the order
+    vertexCount = math::optimizeVertexFetch(unique.data(), vertexCount, VertexStride, lodIndices.data(), lodIndices.size());
+    data.acmrAfter = math::averageCacheMissRatio(lodIndices.data(), data.lodSizes[0], vertexCount);
+
+    if (vertexCount <= 0x10000u) {
+        std::vector<std::uint16_t> shortIndices(lodIndices.begin(), lodIndices.end());
+        data.indexSize = sizeof(std::uint16_t);
+        data.indices.assign(reinterpret_cast<const char*>(shortIndices.data()), reinterpret_cast<const char*>(shortIndices.data() + shortIndices.size()));
+    }
+    else {
+        data.indexSize = sizeof(std::uint32_t);
+        data.indices.assign(reinterpret_cast<const char*>(lodIndices.data()), reinterpret_cast<const char*>(lodIndices.data() + lodIndices.size()));
+    }
+
+    data.vertices.resize(vertexCount);
+    for (std::size_t i = 0u; i < vertexCount; ++i) {
+        const float* vertex = &unique[i * VertexStride];
+        MeshVertex& packed = data.vertices[i];
+        math::quantizePosition(math::Vec3f{ vertex[0], vertex[1], vertex[2] }, data.bounds, packed.position);
+        packed.position[3] = 0;
+        math::quantizeNormal(math::Vec3f{ vertex[3], vertex[4], vertex[5] }, packed.normal);
+    }
+}
+
+MeshView MeshManager::view_(const MeshData& data) {
+    MeshView view;
+    view.vertices = data.vertices.data();
+    view.vertexCount = data.vertices.size();
+    view.indices = data.indices.data();
+    view.indexCount = data.indices.size() / data.indexSize;
+    view.indexSize = data.indexSize;
+    for (std::size_t lod = 0u; lod < data.lodCount; ++lod) {
+        view.lodOffsets[lod] = data.lodOffsets[lod];
+        view.lodSizes[lod] = data.lodSizes[lod];
+    }
+    view.lodCount = data.lodCount;
+    view.bounds = data.bounds;
+    return view;
+}
+
+void MeshManager::log_(const std::string& name, const MeshData& data) {
+    // the unindexed layout stored every triangle corner as floats
+    const std::size_t triangleCount = data.lodSizes[0] / 3u;
+    const std::size_t bytesBefore = triangleCount * 3u * VertexStride * sizeof(float);
+    const std::size_t bytesAfter = data.vertices.size() * sizeof(MeshVertex) + data.indices.size();
+    LOG_INFO << "Mesh " << name << ": " << triangleCount << " triangles, "
+        << data.inputVertexCount << " -> " << data.vertices.size() << " vertices, ACMR "
+        << data.acmrBefore << " -> " << data.acmrAfter << ", "
+        << bytesBefore << " -> " << bytesAfter << " bytes";
+    for (std::size_t lod = 1u; lod < data.lodCount; ++lod) {
+        LOG_INFO << "  LOD " << lod << ": " << data.lodSizes[lod] / 3u << " triangles";
+    }
+}
+
 }
@@ -1,38 +1,110 @@
 
 #pragma once
 
-#include "opengl/BufferObject.h"
+#include "manager/Mesh.h"
+#include "manager/MeshCache.h"
+#include "opengl/BufferArena.h"
+#include "opengl/Program.h"
+#include "opengl/VertexAttributes.h"
 #include "utils/Container.h"
+#include "utils/MappedFile.h"
 #include "math/Geometry.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <string>
+#include <vector>
 #include <cstddef>
+#include <cstdint>
 
 namespace pg {
 
 /**
- * This class parses mesh objects and creates the corresponding vertex buffer object.
- * Use this class to gain access to the vertex buffer object.
+ * This class parses mesh objects and creates the corresponding vertex and index buffer objects.
+ * Use this class to gain access to the meshes.
+ *
+ * Loaded meshes are welded, and their triangles and vertices are reordered for the
+ * post-transform vertex cache and for vertex fetch locality. The vertices are then
+ * quantized into the MeshVertex format.
+ *
+ * Up to MaxMeshLods - 1 coarser detail levels are generated for each mesh by quadric error
+ * metric simplification, see math::simplifyMesh.
+ *
+ * All meshes are suballocated from one vertex arena and one index arena, so every mesh can be
+ * drawn with the same vertex array per program, see attributes(). If base vertex draws are
+ * available, the indices stay relative to the mesh's vertices, and are drawn with the mesh's
+ * baseVertex. Otherwise they are rebased to 32-bit arena indices at upload.
+ *
+ * Files are imported and processed on loader threads. Until a file has been uploaded, its mesh
+ * is a copy of the built-in cube, and shares the cube's ranges. The upload gives the mesh
+ * ranges of its own, so the returned pointer stays valid, and starts drawing the loaded mesh.
+ * A system::MeshLoaded event is emitted for each uploaded mesh.
+ *
+ * Processed meshes are written into a binary cache, see MeshCache.h. Later loads of the same
+ * file map the cache file, and upload straight from the mapping without running assimp.
  */
 class MeshManager {
 public:
     MeshManager() = default;
-    ~MeshManager() = default;
+    ~MeshManager();
 
     // OpenGL needs to be initialized before this is called
     void initialize();
 
     /**
-     * @param file The mesh file to get.
+     * @param file The mesh file to get. The file is loaded in the background, if it hasn't been requested yet.
      */
-    opengl::BufferObject*   get(const std::string& file) const;
+    const Mesh*     get(const std::string& file) const;
+    /**
+     * @brief Upload the meshes which the loader threads have finished, within a time budget.
+     * Call this once per frame, on the OpenGL thread.
+     */
+    void            update();
+    /**
+     * @brief Wait for the loader threads to finish every requested file, and upload all of them.
+     * This makes the frame a mesh appears in independent of the loaders, for replays.
+     */
+    void            finishLoading();
+    /**
+     * @brief Create the vertex array which draws any mesh with the program, unless it exists.
+     * This makes GL calls, so it has to be on the GL thread. Programs without a vertex attribute
+     * don't draw meshes, and are skipped.
+     */
+    void            createAttributes(const opengl::Program& program);
+    /**
+     * @brief Get the vertex array which draws any mesh with the program.
+     * It has to be created with createAttributes first. This makes no GL calls, so the scripts
+     * can call it from the simulation thread.
+     */
+    opengl::VertexAttributes attributes(const opengl::Program& program) const;
+    /**
+     * @brief Allocate ranges for the mesh data in the arenas, and fill in target.
+     * This is how the loaded meshes are uploaded, and it can be used for generated meshes.
+     * The ranges target had before are not freed, use release for that.
+     */
+    void            upload(const MeshView& mesh, Mesh& target);
+    /// @brief Free the ranges of a mesh uploaded with upload.
+    void            release(Mesh& mesh);
+    /**
+     * @brief Read the vertices and the full detail triangle list of the mesh back from the GPU.
+     * The indices are relative to the first vertex. This waits for the GPU.
+     */
+    void            download(const Mesh& mesh, std::vector<MeshVertex>& vertices, std::vector<std::uint32_t>& indices) const;
     /**
     * @param file
     * @returns The bounding box corresponding to the given file name.
     */
     math::AABoxf getBoundingBox(const std::string& file) const;
+    /**
+     * @brief The bounds of the built-in cube, which stands in for the meshes which haven't loaded.
+     * This doesn't need OpenGL, or the manager to be initialized.
+     */
+    static math::AABoxf cubeBounds();
     /**
      * Remove all the managed mesh objects from GPU and system memory.
      */
@@ -43,9 +115,60 @@ public:
     std::size_t     size() const;
 
 private:
-    mutable Container< opengl::BufferObject >                           buffer_{};
-    mutable std::unordered_map< std::string, opengl::BufferObject* >    resources_{};
-    mutable std::unordered_map< std::string, math::AABoxf >             boxes_{};
+    // a processed mesh, ready for upload
+    struct MeshData {
+        std::vector<MeshVertex>     vertices{};
+        std::vector<char>           indices{};      // the detail levels one after another, in 16 or 32 bits
+        std::size_t                 indexSize{ 0u };
+        std::size_t                 lodOffsets[MaxMeshLods]{};
+        std::size_t                 lodSizes[MaxMeshLods]{};
+        std::uint32_t               lodCount{ 0u };
+        math::AABoxf                bounds{};
+        // for the log
+        std::size_t                 inputVertexCount{ 0u };
+        float                       acmrBefore{ 0.f };
+        float                       acmrAfter{ 0.f };
+    };
+
+    struct LoadRequest {
+        std::string file;
+        Mesh*       mesh;   // the placeholder
+    };
+
+    struct LoadedMesh {
+        std::string file;
+        Mesh*       mesh;
+        MeshView    view;   // points into either data or cache
+        MeshData    data;
+        MappedFile  cache;
+    };
+
+    // the loader threads run this
+    void            load_();
+    void            upload_(std::chrono::steady_clock::duration budget);
+    static bool     import_(const std::string& file, MeshData& data);
+    // vertices contains a position and a normal per vertex, and indices a triangle list
+    static void     processMesh_(const std::vector<float>& vertices, std::vector<std::uint32_t>& indices, MeshData& data);
+    static MeshView view_(const MeshData& data);
+    static void     log_(const std::string& name, const MeshData& data);
+
+    std::unique_ptr< opengl::BufferArena >                  vertices_{};
+    std::unique_ptr< opengl::BufferArena >                  indices_{};
+    bool                                                    baseVertex_{ false };   // glDrawElementsBaseVertex is available
+    std::unordered_map< GLuint, opengl::VertexAttributes > attributes_{};   // by program object
+    mutable Container< Mesh >                               meshes_{};
+    mutable std::unordered_map< std::string, const Mesh* >  resources_{};
+    const Mesh*                                             cube_{ nullptr };   // copied into every placeholder
+
+    // shared with the loader threads
+    mutable std::mutex                                      mutex_{};
+    mutable std::condition_variable                         wake_{};
+    mutable std::deque< LoadRequest >                       requests_{};
+    mutable std::size_t                                     pending_{ 0u };    // requested, but not loaded or failed yet
+    std::condition_variable                                 finished_{};       // notified when pending_ decreases
+    std::deque< LoadedMesh >                                loaded_{};
+    bool                                                    stop_{ false };
+    std::vector< std::thread >                              loaders_{};
 };
 
 }
@@ -1,5 +1,6 @@
 #include "utils/Exception.h"
 #include "manager/ShaderManager.h"
+#include "opengl/UniformBlocks.h"
 #include "utils/File.h"
 #include "utils/Assert.h"
 
@@ -17,7 +18,14 @@ void ShaderManager::addShader(const std::string file, GLenum type) {
 void ShaderManager::compile(const std::string& tag) {
     try {
         auto index = buffer_.emplace(shaderStages_);
-        resources_.emplace(tag, &buffer_[index]);
+        opengl::Program& program = buffer_[index];
+        // the blocks are optional, a program only gets connected to the ones it declares
+        program.bindUniformBlock("FrameBlock", GLuint(opengl::BlockBinding::Frame));
+        program.bindUniformBlock("ObjectBlock", GLuint(opengl::BlockBinding::Object));
+        program.bindSampler("lightData", GLint(opengl::TextureUnit::LightData));
+        program.bindSampler("lightClusters", GLint(opengl::TextureUnit::LightClusters));
+        program.bindSampler("lightIndices", GLint(opengl::TextureUnit::LightIndices));
+        resources_.emplace(tag, &program);
     }
     catch (const PlaygroundException&) {
         LOG_ERROR << "Exception in compiling " << tag << " shader.";
@@ -33,6 +41,14 @@ opengl::Program* ShaderManager::get(const std::string& tag) const {
     return it->second;
 }
 
+std::vector<opengl::Program*> ShaderManager::programs() const {
+    std::vector<opengl::Program*> result;
+    for (const auto& resource : resources_) {
+        result.push_back(resource.second);
+    }
+    return result;
+}
+
 void ShaderManager::clear() {
     resources_.clear();
     shaderStages_.clear();
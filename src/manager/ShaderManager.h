@@ -38,6 +38,9 @@ public:
      */
     opengl::Program*    get(const std::string& tag) const;
 
+    /// @brief Get all compiled programs.
+    std::vector<opengl::Program*> programs() const;
+
     /**
      * @brief Delete all contained shaders.
      */
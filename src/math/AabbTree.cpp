@@ -0,0 +1,403 @@
+#include "math/AabbTree.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+const int SahBinCount = 12;
+// below this depth the SAH build falls back to median splits, which bounds the tree height
+const int MaxSahDepth = 48;
+
+}
+
+namespace pg {
+namespace math {
+
+const std::uint32_t AabbTree::Null;
+
+AabbTree::AabbTree(float margin)
+    : margin_{ margin } {}
+
+std::uint32_t AabbTree::insert(const AABoxf& box, std::uint32_t userData) {
+    std::uint32_t leaf = allocateNode_();
+    Node& node = nodes_[leaf];
+    node.box = box.expanded(margin_);
+    node.userData = userData;
+    node.height = 0;
+    insertLeaf_(leaf);
+    leafCount_++;
+    return leaf;
+}
+
+void AabbTree::remove(std::uint32_t proxy) {
+    PG_ASSERT(proxy < nodes_.size());
+    PG_ASSERT(nodes_[proxy].isLeaf());
+    removeLeaf_(proxy);
+    freeNode_(proxy);
+    leafCount_--;
+}
+
+bool AabbTree::move(std::uint32_t proxy, const AABoxf& box) {
+    PG_ASSERT(proxy < nodes_.size());
+    PG_ASSERT(nodes_[proxy].isLeaf());
+    if (nodes_[proxy].box.contains(box)) {
+        return false;
+    }
+    removeLeaf_(proxy);
+    nodes_[proxy].box = box.expanded(margin_);
+    insertLeaf_(proxy);
+    return true;
+}
+
+void AabbTree::clear() {
+    nodes_.clear();
+    root_ = Null;
+    freeList_ = Null;
+    leafCount_ = 0u;
+}
+
+const AABoxf& AabbTree::fatBox(std::uint32_t proxy) const {
+    PG_ASSERT(proxy < nodes_.size());
+    return nodes_[proxy].box;
+}
+
+std::uint32_t AabbTree::userData(std::uint32_t proxy) const {
+    PG_ASSERT(proxy < nodes_.size());
+    return nodes_[proxy].userData;
+}
+
+std::size_t AabbTree::size() const {
+    return leafCount_;
+}
+
+int AabbTree::height() const {
+    if (root_ == Null) {
+        return 0;
+    }
+    return nodes_[root_].height;
+}
+
+void AabbTree::rebuild() {
+    if (leafCount_ < 2u) {
+        return;
+    }
+    std::vector<std::uint32_t> leaves;
+    leaves.reserve(leafCount_);
+    for (std::uint32_t i = 0u; i < nodes_.size(); ++i) {
+        if (nodes_[i].height < 0) {
+            continue;
+        }
+        if (nodes_[i].isLeaf()) {
+            leaves.push_back(i);
+        }
+        else {
+            freeNode_(i);
+        }
+    }
+    PG_ASSERT(leaves.size() == leafCount_);
+    root_ = buildSah_(leaves.data(), leaves.size(), 0);
+    nodes_[root_].parent = Null;
+}
+
+std::uint32_t AabbTree::allocateNode_() {
+    std::uint32_t index;
+    if (freeList_ != Null) {
+        index = freeList_;
+        freeList_ = nodes_[index].parent;
+    }
+    else {
+        index = std::uint32_t(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[index];
+    node.parent = Null;
+    node.left = Null;
+    node.right = Null;
+    node.userData = 0u;
+    node.height = 0;
+    return index;
+}
+
+void AabbTree::freeNode_(std::uint32_t index) {
+    nodes_[index].parent = freeList_;
+    nodes_[index].height = -1;
+    freeList_ = index;
+}
+
+void AabbTree::insertLeaf_(std::uint32_t leaf) {
+    if (root_ == Null) {
+        root_ = leaf;
+        nodes_[leaf].parent = Null;
+        return;
+    }
+
+    // find the best sibling by descending into the child with the lowest cost
+    const AABoxf box = nodes_[leaf].box;
+    std::uint32_t index = root_;
+    while (!nodes_[index].isLeaf()) {
+        const Node& node = nodes_[index];
+        float area = node.box.surfaceArea();
+        float combinedArea = node.box.merged(box).surfaceArea();
+        // the cost of creating a new parent for this node and the new leaf
+        float cost = 2.f * combinedArea;
+        // the minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.f * (combinedArea - area);
+
+        auto descendCost = [&](std::uint32_t child) -> float {
+            const Node& c = nodes_[child];
+            float merged = c.box.merged(box).surfaceArea();
+            if (c.isLeaf()) {
+                return merged + inheritanceCost;
+            }
+            return merged - c.box.surfaceArea() + inheritanceCost;
+        };
+        float leftCost = descendCost(node.left);
+        float rightCost = descendCost(node.right);
+
+        if (cost < leftCost && cost < rightCost) {
+            break;
+        }
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+
+    const std::uint32_t sibling = index;
+    const std::uint32_t oldParent = nodes_[sibling].parent;
+    const std::uint32_t newParent = allocateNode_();
+    Node& parent = nodes_[newParent];
+    parent.parent = oldParent;
+    parent.box = box.merged(nodes_[sibling].box);
+    parent.height = nodes_[sibling].height + 1;
+    parent.left = sibling;
+    parent.right = leaf;
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    if (oldParent != Null) {
+        if (nodes_[oldParent].left == sibling) {
+            nodes_[oldParent].left = newParent;
+        }
+        else {
+            nodes_[oldParent].right = newParent;
+        }
+    }
+    else {
+        root_ = newParent;
+    }
+
+    fixUpwards_(nodes_[leaf].parent);
+}
+
+void AabbTree::removeLeaf_(std::uint32_t leaf) {
+    if (leaf == root_) {
+        root_ = Null;
+        return;
+    }
+
+    const std::uint32_t parent = nodes_[leaf].parent;
+    const std::uint32_t grandParent = nodes_[parent].parent;
+    const std::uint32_t sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+
+    if (grandParent != Null) {
+        if (nodes_[grandParent].left == parent) {
+            nodes_[grandParent].left = sibling;
+        }
+        else {
+            nodes_[grandParent].right = sibling;
+        }
+        nodes_[sibling].parent = grandParent;
+        freeNode_(parent);
+        fixUpwards_(grandParent);
+    }
+    else {
+        root_ = sibling;
+        nodes_[sibling].parent = Null;
+        freeNode_(parent);
+    }
+    nodes_[leaf].parent = Null;
+}
+
+void AabbTree::fixUpwards_(std::uint32_t index) {
+    while (index != Null) {
+        index = balance_(index);
+        Node& node = nodes_[index];
+        const Node& left = nodes_[node.left];
+        const Node& right = nodes_[node.right];
+        node.height = 1 + std::max(left.height, right.height);
+        node.box = left.box.merged(right.box);
+        index = node.parent;
+    }
+}
+
+// Perform a left or right rotation if node A is imbalanced.
+// Returns the new root of the subtree.
+std::uint32_t AabbTree::balance_(std::uint32_t iA) {
+    Node& A = nodes_[iA];
+    if (A.isLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    const std::uint32_t iB = A.left;
+    const std::uint32_t iC = A.right;
+    Node& B = nodes_[iB];
+    Node& C = nodes_[iC];
+    const int balance = C.height - B.height;
+
+    // rotate the taller child up, and move its shorter grandchild to A
+    auto rotateUp = [this, iA](std::uint32_t iUp, std::uint32_t iOther, bool upWasRight) -> std::uint32_t {
+        Node& A = nodes_[iA];
+        Node& U = nodes_[iUp];
+        const std::uint32_t iF = U.left;
+        const std::uint32_t iG = U.right;
+        Node& F = nodes_[iF];
+        Node& G = nodes_[iG];
+
+        U.left = iA;
+        U.parent = A.parent;
+        A.parent = iUp;
+
+        if (U.parent != Null) {
+            if (nodes_[U.parent].left == iA) {
+                nodes_[U.parent].left = iUp;
+            }
+            else {
+                nodes_[U.parent].right = iUp;
+            }
+        }
+        else {
+            root_ = iUp;
+        }
+
+        // the taller grandchild stays under U, the shorter one replaces U under A
+        std::uint32_t iKeep = F.height > G.height ? iF : iG;
+        std::uint32_t iMove = F.height > G.height ? iG : iF;
+        U.right = iKeep;
+        if (upWasRight) {
+            A.right = iMove;
+        }
+        else {
+            A.left = iMove;
+        }
+        nodes_[iMove].parent = iA;
+
+        const Node& other = nodes_[iOther];
+        const Node& moved = nodes_[iMove];
+        A.box = other.box.merged(moved.box);
+        A.height = 1 + std::max(other.height, moved.height);
+        const Node& kept = nodes_[iKeep];
+        U.box = A.box.merged(kept.box);
+        U.height = 1 + std::max(A.height, kept.height);
+        return iUp;
+    };
+
+    if (balance > 1) {
+        return rotateUp(iC, iB, true);
+    }
+    if (balance < -1) {
+        return rotateUp(iB, iC, false);
+    }
+    return iA;
+}
+
+std::uint32_t AabbTree::buildSah_(std::uint32_t* leaves, std::size_t count, int depth) {
+    if (count == 1u) {
+        return leaves[0];
+    }
+
+    AABoxf centroidBounds{ nodes_[leaves[0]].box.center(), nodes_[leaves[0]].box.center() };
+    for (std::size_t i = 1u; i < count; ++i) {
+        Vec3f c = nodes_[leaves[i]].box.center();
+        centroidBounds = centroidBounds.merged(AABoxf{ c, c });
+    }
+    Vec3f extent = centroidBounds.max - centroidBounds.min;
+    int axis = 0;
+    if (extent.y > extent.data[axis]) {
+        axis = 1;
+    }
+    if (extent.z > extent.data[axis]) {
+        axis = 2;
+    }
+
+    std::size_t mid = count / 2u;
+    bool useMedian = depth >= MaxSahDepth || extent.data[axis] <= 0.f;
+
+    if (!useMedian) {
+        const float binMin = centroidBounds.min.data[axis];
+        const float binScale = float(SahBinCount) / extent.data[axis];
+        auto binOf = [&](std::uint32_t leaf) -> int {
+            int bin = int((nodes_[leaf].box.center().data[axis] - binMin) * binScale);
+            return std::min(bin, SahBinCount - 1);
+        };
+
+        std::size_t binCounts[SahBinCount] = {};
+        AABoxf binBoxes[SahBinCount];
+        for (std::size_t i = 0u; i < count; ++i) {
+            int bin = binOf(leaves[i]);
+            const AABoxf& box = nodes_[leaves[i]].box;
+            binBoxes[bin] = binCounts[bin] == 0u ? box : binBoxes[bin].merged(box);
+            binCounts[bin]++;
+        }
+
+        // sweep from the right to get the cost of each right-hand partition
+        float rightCosts[SahBinCount] = {};
+        {
+            AABoxf box{};
+            std::size_t n = 0u;
+            for (int i = SahBinCount - 1; i > 0; --i) {
+                if (binCounts[i] != 0u) {
+                    box = n == 0u ? binBoxes[i] : box.merged(binBoxes[i]);
+                    n += binCounts[i];
+                }
+                rightCosts[i] = n == 0u ? 0.f : float(n) * box.surfaceArea();
+            }
+        }
+
+        float bestCost = std::numeric_limits<float>::max();
+        int bestSplit = -1;
+        AABoxf box{};
+        std::size_t n = 0u;
+        for (int i = 0; i < SahBinCount - 1; ++i) {
+            if (binCounts[i] != 0u) {
+                box = n == 0u ? binBoxes[i] : box.merged(binBoxes[i]);
+                n += binCounts[i];
+            }
+            if (n == 0u || n == count) {
+                continue;
+            }
+            float cost = float(n) * box.surfaceArea() + rightCosts[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if (bestSplit >= 0) {
+            std::uint32_t* pivot = std::partition(leaves, leaves + count, [&](std::uint32_t leaf) -> bool {
+                return binOf(leaf) <= bestSplit;
+            });
+            mid = std::size_t(pivot - leaves);
+        }
+        useMedian = bestSplit < 0 || mid == 0u || mid == count;
+    }
+
+    if (useMedian) {
+        mid = count / 2u;
+        std::nth_element(leaves, leaves + mid, leaves + count, [&](std::uint32_t a, std::uint32_t b) -> bool {
+            return nodes_[a].box.center().data[axis] < nodes_[b].box.center().data[axis];
+        });
+    }
+
+    const std::uint32_t left = buildSah_(leaves, mid, depth + 1);
+    const std::uint32_t right = buildSah_(leaves + mid, count - mid, depth + 1);
+    const std::uint32_t index = allocateNode_();
+    Node& node = nodes_[index];
+    node.left = left;
+    node.right = right;
+    node.box = nodes_[left].box.merged(nodes_[right].box);
+    node.height = 1 + std::max(nodes_[left].height, nodes_[right].height);
+    nodes_[left].parent = index;
+    nodes_[right].parent = index;
+    return index;
+}
+
+}   // math
+}   // pg
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "math/Geometry.h"
+#include "math/Intersection.h"
+#include "utils/Assert.h"
+#include <vector>
+#include <limits>
+#include <cstdlib>
+#include <cstdint>
+#include <utility>
+
+namespace pg {
+namespace math {
+
+/**
+ * @class AabbTree
+ * @brief A dynamic bounding volume hierarchy of axis-aligned boxes.
+ *
+ * Leaves store a fattened copy of the inserted box, so that small movements don't
+ * require touching the tree at all. New leaves are inserted next to the sibling which
+ * increases the total surface area the least, and the tree is kept balanced with
+ * AVL-style rotations on the way back up. rebuild() throws away the internal nodes and
+ * builds the whole tree top-down using the binned surface area heuristic (SAH).
+ *
+ * Each leaf carries a 32-bit user value, which is passed to the query callbacks.
+ * Leaf handles (proxies) remain valid until the leaf is removed, also across rebuilds.
+ *
+ * Queries don't modify the tree, so they can be run concurrently.
+ */
+class AabbTree {
+public:
+    static const std::uint32_t Null = 0xffffffffu;
+
+    /**
+     * @param margin The amount by which leaf boxes are fattened on each side.
+     */
+    explicit AabbTree(float margin = 0.1f);
+    ~AabbTree() = default;
+
+    /**
+     * @brief Insert a box into the tree.
+     * @return The proxy with which the leaf can be moved or removed.
+     */
+    std::uint32_t   insert(const AABoxf& box, std::uint32_t userData);
+    void            remove(std::uint32_t proxy);
+    /**
+     * @brief Update the box of a leaf.
+     * @return True, if the box escaped its fattened box and the leaf was reinserted.
+     */
+    bool            move(std::uint32_t proxy, const AABoxf& box);
+    /**
+     * @brief Rebuild the internal nodes using the surface area heuristic.
+     */
+    void            rebuild();
+    void            clear();
+
+    const AABoxf&   fatBox(std::uint32_t proxy) const;
+    std::uint32_t   userData(std::uint32_t proxy) const;
+    /**
+     * @brief Get the number of leaves in the tree.
+     */
+    std::size_t     size() const;
+    int             height() const;
+
+    /// @brief Call callback(userData) for every leaf whose fat box overlaps the box.
+    template<typename F>
+    void queryBox(const AABoxf& box, F&& callback) const;
+    /// @brief Call callback(userData) for every leaf whose fat box overlaps the sphere.
+    template<typename F>
+    void querySphere(const Spheref& sphere, F&& callback) const;
+    /// @brief Call callback(userData) for every leaf whose fat box isn't outside the frustum.
+    template<typename F>
+    void queryFrustum(const FrustumPlanesf& frustum, F&& callback) const;
+    /**
+     * @brief Find the closest hit along a ray.
+     * The callback has the signature float(std::uint32_t userData). It should perform the exact
+     * intersection test, and return the hit distance, or std::numeric_limits<float>::max() on a miss.
+     * Subtrees further away than the closest hit so far are skipped.
+     */
+    template<typename F>
+    void queryRay(const Rayf& ray, F&& callback) const;
+
+private:
+    struct Node {
+        AABoxf          box;
+        std::uint32_t   parent;     // also the next free node, when the node is in the free list
+        std::uint32_t   left;
+        std::uint32_t   right;
+        std::uint32_t   userData;
+        int             height;     // leaves have a height of zero, free nodes -1
+
+        inline bool isLeaf() const {
+            return left == Null;
+        }
+    };
+
+    // the tree depth is bounded by the balancing, and by the median split fallback in the SAH build
+    static const int MaxStackSize_ = 256;
+
+    template<typename Overlaps, typename F>
+    void query_(Overlaps&& overlaps, F&& callback) const;
+
+    std::uint32_t   allocateNode_();
+    void            freeNode_(std::uint32_t node);
+    void            insertLeaf_(std::uint32_t leaf);
+    void            removeLeaf_(std::uint32_t leaf);
+    std::uint32_t   balance_(std::uint32_t node);
+    void            fixUpwards_(std::uint32_t node);
+    std::uint32_t   buildSah_(std::uint32_t* leaves, std::size_t count, int depth);
+
+    std::vector<Node>   nodes_{};
+    std::uint32_t       root_{ Null };
+    std::uint32_t       freeList_{ Null };
+    std::size_t         leafCount_{ 0u };
+    float               margin_;
+};
+
+template<typename Overlaps, typename F>
+void AabbTree::query_(Overlaps&& overlaps, F&& callback) const {
+    if (root_ == Null) {
+        return;
+    }
+    std::uint32_t stack[MaxStackSize_];
+    int top = 0;
+    stack[top++] = root_;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        if (!overlaps(node.box)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            callback(node.userData);
+        }
+        else {
+            PG_ASSERT(top + 2 <= MaxStackSize_);
+            stack[top++] = node.right;
+            stack[top++] = node.left;
+        }
+    }
+}
+
+template<typename F>
+void AabbTree::queryBox(const AABoxf& box, F&& callback) const {
+    query_([&box](const AABoxf& nodeBox) -> bool {
+        return aaboxIntersectsAABox(box, nodeBox);
+    }, std::forward<F>(callback));
+}
+
+template<typename F>
+void AabbTree::querySphere(const Spheref& sphere, F&& callback) const {
+    query_([&sphere](const AABoxf& nodeBox) -> bool {
+        return sphereIntersectsAABox(sphere, nodeBox);
+    }, std::forward<F>(callback));
+}
+
+template<typename F>
+void AabbTree::queryFrustum(const FrustumPlanesf& frustum, F&& callback) const {
+    query_([&frustum](const AABoxf& nodeBox) -> bool {
+        return frustumIntersectsAABox(frustum, nodeBox);
+    }, std::forward<F>(callback));
+}
+
+template<typename F>
+void AabbTree::queryRay(const Rayf& ray, F&& callback) const {
+    if (root_ == Null) {
+        return;
+    }
+    float closest = std::numeric_limits<float>::max();
+    std::uint32_t stack[MaxStackSize_];
+    int top = 0;
+    stack[top++] = root_;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        Rayf test = ray;
+        if (!rayIntersectsAABox(test, node.box) || test.t > closest) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            float t = callback(node.userData);
+            if (t < closest) {
+                closest = t;
+            }
+        }
+        else {
+            PG_ASSERT(top + 2 <= MaxStackSize_);
+            stack[top++] = node.right;
+            stack[top++] = node.left;
+        }
+    }
+}
+
+}   // math
+}   // pg
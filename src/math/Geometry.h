@@ -1,7 +1,9 @@
 #pragma once
 
 #include "math/Matrix.h"
+#include "math/Quaternion.h"
 #include "math/Vector.h"
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
@@ -83,6 +85,80 @@ struct AABox {
     inline Vector3<T> center() const {
         return T(0.5) * (min + max);
     }
+
+    inline Vector3<T> extents() const {
+        return T(0.5) * (max - min);
+    }
+
+    inline T surfaceArea() const {
+        Vector3<T> d = max - min;
+        return T(2.0) * (d.x*d.y + d.y*d.z + d.z*d.x);
+    }
+
+    inline bool contains(const AABox<T>& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+            && other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+
+    inline AABox<T> merged(const AABox<T>& other) const {
+        return AABox<T>{
+            Vector3<T>{ std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z) },
+            Vector3<T>{ std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z) }
+        };
+    }
+
+    inline AABox<T> expanded(T margin) const {
+        Vector3<T> m{ margin, margin, margin };
+        return AABox<T>{ min - m, max + m };
+    }
+};
+
+/*
+ * Get the world space bounding box of a model space box, transformed by the
+ * scale, rotation, and translation of a transform, in that order.
+ **/
+template<typename T>
+AABox<T> transformAABox(const AABox<T>& box, const Vector3<T>& position, const Quaternion<T>& rotation, const Vector3<T>& scale) {
+    Matrix4<T> R = Matrix4<T>::rotation(rotation);
+    Vector3<T> c = scale.hadamard(box.center());
+    Vector3<T> e = scale.hadamard(box.extents());
+    e = Vector3<T>{ std::abs(e.x), std::abs(e.y), std::abs(e.z) };
+    Vector3<T> center{
+        R.data[0] * c.x + R.data[1] * c.y + R.data[2] * c.z + position.x,
+        R.data[4] * c.x + R.data[5] * c.y + R.data[6] * c.z + position.y,
+        R.data[8] * c.x + R.data[9] * c.y + R.data[10] * c.z + position.z
+    };
+    Vector3<T> extents{
+        std::abs(R.data[0]) * e.x + std::abs(R.data[1]) * e.y + std::abs(R.data[2]) * e.z,
+        std::abs(R.data[4]) * e.x + std::abs(R.data[5]) * e.y + std::abs(R.data[6]) * e.z,
+        std::abs(R.data[8]) * e.x + std::abs(R.data[9]) * e.y + std::abs(R.data[10]) * e.z
+    };
+    return AABox<T>{ center - extents, center + extents };
+}
+
+/*
+ * The six clip planes of a view frustum, extracted from a view-projection matrix.
+ * Each plane is stored as (a, b, c, d), where a point p is on the inside of the plane
+ * if a*p.x + b*p.y + c*p.z + d >= 0. The plane normals are not normalized.
+ **/
+template<typename T>
+struct FrustumPlanes {
+    enum Side { Left = 0, Right, Bottom, Top, Near, Far };
+
+    FrustumPlanes() = default;
+    explicit FrustumPlanes(const Matrix4<T>& M) {
+        const T* d = M.data;
+        for (int i = 0; i < 4; ++i) {
+            planes[Left].data[i] = d[12 + i] + d[i];
+            planes[Right].data[i] = d[12 + i] - d[i];
+            planes[Bottom].data[i] = d[12 + i] + d[4 + i];
+            planes[Top].data[i] = d[12 + i] - d[4 + i];
+            planes[Near].data[i] = d[12 + i] + d[8 + i];
+            planes[Far].data[i] = d[12 + i] - d[8 + i];
+        }
+    }
+
+    Vector4<T> planes[6];
 };
 
 template<typename T>
@@ -97,6 +173,7 @@ using Frustumf = Frustum<float>;
 using Planef = Plane<float>;
 using AABoxf = AABox<float>;
 using Spheref = Sphere<float>;
+using FrustumPlanesf = FrustumPlanes<float>;
 
 }
 }
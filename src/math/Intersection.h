@@ -41,6 +41,71 @@ inline bool rayIntersectsSphere(Rayf& ray, const Spheref& sphere) {
     return true;
 }
 
+/*
+ * Slab test against an axis-aligned box in the same coordinate system as the ray.
+ * On intersection, ray.t is set to the entry distance, or zero if the ray starts inside the box.
+ **/
+inline bool rayIntersectsAABox(Rayf& ray, const AABoxf& box) {
+    float tmin = 0.f;
+    float tmax = std::numeric_limits<float>::max();
+    for (int i = 0; i < 3; ++i) {
+        float invD = 1.f / ray.direction.data[i];
+        float t1 = (box.min.data[i] - ray.origin.data[i]) * invD;
+        float t2 = (box.max.data[i] - ray.origin.data[i]) * invD;
+        if (t1 > t2) {
+            std::swap(t1, t2);
+        }
+        // the comparisons are ordered so that NaNs (0 * inf) leave the interval untouched
+        tmin = t1 > tmin ? t1 : tmin;
+        tmax = t2 < tmax ? t2 : tmax;
+        if (tmax < tmin) {
+            return false;
+        }
+    }
+    ray.t = tmin;
+    return true;
+}
+
+inline bool aaboxIntersectsAABox(const AABoxf& a, const AABoxf& b) {
+    return a.min.x <= b.max.x && b.min.x <= a.max.x
+        && a.min.y <= b.max.y && b.min.y <= a.max.y
+        && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+inline bool sphereIntersectsAABox(const Spheref& sphere, const AABoxf& box) {
+    float distSquared = 0.f;
+    for (int i = 0; i < 3; ++i) {
+        float c = sphere.center.data[i];
+        if (c < box.min.data[i]) {
+            float d = box.min.data[i] - c;
+            distSquared += d*d;
+        }
+        else if (c > box.max.data[i]) {
+            float d = c - box.max.data[i];
+            distSquared += d*d;
+        }
+    }
+    return distSquared <= sphere.radius*sphere.radius;
+}
+
+/*
+ * Conservative frustum test: returns false only if the box is completely outside one of the planes.
+ **/
+inline bool frustumIntersectsAABox(const FrustumPlanesf& frustum, const AABoxf& box) {
+    for (const Vec4f& p : frustum.planes) {
+        // the box corner furthest along the plane normal
+        Vec3f corner{
+            p.x >= 0.f ? box.max.x : box.min.x,
+            p.y >= 0.f ? box.max.y : box.min.y,
+            p.z >= 0.f ? box.max.z : box.min.z
+        };
+        if (p.x*corner.x + p.y*corner.y + p.z*corner.z + p.w < 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
 inline bool rayIntersectsAABox(Rayf& ray, const AABoxf& aabb, const Vec3f& aabbPos, const Quatf& aabbQuat, const Vec3f& aabbScale) {
     // for calculating the transformed coordinate system
 
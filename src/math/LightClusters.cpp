@@ -0,0 +1,220 @@
+#include "math/LightClusters.h"
+#include "utils/Assert.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PG_LIGHT_CLUSTERS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+using pg::math::ClusterGrid;
+
+struct ClusterBox {
+    float minX, minY, minZ;
+    float maxX, maxY, maxZ;
+};
+
+// the box which contains the part of the tile's frustum between the depths
+ClusterBox clusterBox(const ClusterGrid& grid, std::uint32_t x, std::uint32_t y, float nearPlane, float farPlane) {
+    // the tile edges, as slopes from the view axis
+    const float left = (-1.f + 2.f * float(x) / float(ClusterGrid::CountX)) * grid.tanHalfFovX;
+    const float right = (-1.f + 2.f * float(x + 1u) / float(ClusterGrid::CountX)) * grid.tanHalfFovX;
+    const float bottom = (-1.f + 2.f * float(y) / float(ClusterGrid::CountY)) * grid.tanHalfFovY;
+    const float top = (-1.f + 2.f * float(y + 1u) / float(ClusterGrid::CountY)) * grid.tanHalfFovY;
+    return ClusterBox{
+        std::min(left * nearPlane, left * farPlane),
+        std::min(bottom * nearPlane, bottom * farPlane),
+        -farPlane,
+        std::max(right * nearPlane, right * farPlane),
+        std::max(top * nearPlane, top * farPlane),
+        -nearPlane
+    };
+}
+
+// the box which contains the row of tiles between the depths
+ClusterBox rowBox(const ClusterGrid& grid, std::uint32_t y, float nearPlane, float farPlane) {
+    ClusterBox box = clusterBox(grid, 0u, y, nearPlane, farPlane);
+    const ClusterBox last = clusterBox(grid, ClusterGrid::CountX - 1u, y, nearPlane, farPlane);
+    box.maxX = last.maxX;
+    return box;
+}
+
+float distanceSquared(const ClusterBox& box, float x, float y, float z) {
+    const float dx = std::max(box.minX - x, 0.f) + std::max(x - box.maxX, 0.f);
+    const float dy = std::max(box.minY - y, 0.f) + std::max(y - box.maxY, 0.f);
+    const float dz = std::max(box.minZ - z, 0.f) + std::max(z - box.maxZ, 0.f);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+}
+
+namespace pg {
+namespace math {
+
+const std::uint32_t ClusterGrid::CountX;
+const std::uint32_t ClusterGrid::CountY;
+const std::uint32_t ClusterGrid::CountZ;
+const std::uint32_t ClusterGrid::Count;
+
+ClusterGrid::ClusterGrid(const Matrix4f& projection, float n, float f)
+    : tanHalfFovX{ 1.f / projection.data[0] },
+    tanHalfFovY{ 1.f / projection.data[5] },
+    nearPlane{ n },
+    farPlane{ f },
+    depthScale{ float(CountZ) / std::log(f / n) },
+    depthBias{ 0.f } {
+    PG_ASSERT(n > 0.f && f > n);
+    depthBias = -std::log(n) * depthScale;
+}
+
+float ClusterGrid::sliceDepth(std::uint32_t slice) const {
+    return nearPlane * std::pow(farPlane / nearPlane, float(slice) / float(CountZ));
+}
+
+std::uint32_t ClusterGrid::slice(float depth) const {
+    if (depth <= nearPlane) {
+        return 0u;
+    }
+    const float s = std::floor(std::log(depth) * depthScale + depthBias);
+    return s <= 0.f ? 0u : std::min(std::uint32_t(s), CountZ - 1u);
+}
+
+void LightSpheres::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void LightSpheres::push_back(const Vec3f& center, float r) {
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+}
+
+std::size_t LightSpheres::size() const {
+    return x.size();
+}
+
+void LightClusters::assign(const ClusterGrid& grid, const LightSpheres& lights, ThreadPool& pool) {
+    clusters_.resize(2u * ClusterGrid::Count);
+    sliceIndices_.resize(ClusterGrid::CountZ);
+    if (candidates_.size() < pool.size()) {
+        candidates_.resize(pool.size());
+    }
+    pool.parallelFor(ClusterGrid::CountZ, 1u, [this, &grid, &lights](std::size_t begin, std::size_t end, std::size_t range) -> void {
+        for (std::size_t slice = begin; slice < end; ++slice) {
+            assignSlice_(grid, lights, std::uint32_t(slice), candidates_[range]);
+        }
+    });
+
+    // the offsets were relative to the slice, make them relative to the compacted list
+    indices_.clear();
+    for (std::uint32_t slice = 0u; slice < ClusterGrid::CountZ; ++slice) {
+        const std::uint32_t base = std::uint32_t(indices_.size());
+        const std::uint32_t first = slice * ClusterGrid::CountX * ClusterGrid::CountY;
+        for (std::uint32_t cluster = first; cluster < first + ClusterGrid::CountX * ClusterGrid::CountY; ++cluster) {
+            clusters_[2u * cluster] += base;
+        }
+        indices_.insert(indices_.end(), sliceIndices_[slice].begin(), sliceIndices_[slice].end());
+    }
+}
+
+const std::vector<std::uint32_t>& LightClusters::clusters() const {
+    return clusters_;
+}
+
+const std::vector<std::uint32_t>& LightClusters::indices() const {
+    return indices_;
+}
+
+void LightClusters::assignSlice_(const ClusterGrid& grid, const LightSpheres& lights, std::uint32_t slice, Candidates& candidates) {
+    std::vector<std::uint32_t>& sliceLights = candidates.sliceLights;
+    const float nearPlane = grid.sliceDepth(slice);
+    const float farPlane = grid.sliceDepth(slice + 1u);
+
+    // the lights which overlap the slice's depth range
+    sliceLights.clear();
+    for (std::size_t i = 0u; i < lights.size(); ++i) {
+        const float depth = -lights.z[i];
+        const float radius = lights.radius[i];
+        if (depth + radius >= nearPlane && depth - radius <= farPlane) {
+            sliceLights.push_back(std::uint32_t(i));
+        }
+    }
+
+    std::vector<std::uint32_t>& indices = sliceIndices_[slice];
+    indices.clear();
+    for (std::uint32_t y = 0u; y < ClusterGrid::CountY; ++y) {
+        // the lights which overlap the row, padded to a multiple of four
+        const ClusterBox row = rowBox(grid, y, nearPlane, farPlane);
+        candidates.x.clear();
+        candidates.y.clear();
+        candidates.z.clear();
+        candidates.radiusSquared.clear();
+        candidates.lights.clear();
+        for (std::uint32_t i : sliceLights) {
+            const float radiusSquared = lights.radius[i] * lights.radius[i];
+            if (distanceSquared(row, lights.x[i], lights.y[i], lights.z[i]) <= radiusSquared) {
+                candidates.x.push_back(lights.x[i]);
+                candidates.y.push_back(lights.y[i]);
+                candidates.z.push_back(lights.z[i]);
+                candidates.radiusSquared.push_back(radiusSquared);
+                candidates.lights.push_back(i);
+            }
+        }
+        // the padding can't intersect anything
+        while (candidates.x.size() % 4u != 0u) {
+            candidates.x.push_back(0.f);
+            candidates.y.push_back(0.f);
+            candidates.z.push_back(0.f);
+            candidates.radiusSquared.push_back(-1.f);
+            candidates.lights.push_back(0u);
+        }
+        const std::size_t count = candidates.x.size();
+
+        for (std::uint32_t x = 0u; x < ClusterGrid::CountX; ++x) {
+            const std::uint32_t cluster = x + ClusterGrid::CountX * (y + ClusterGrid::CountY * slice);
+            const std::size_t offset = indices.size();
+            const ClusterBox box = clusterBox(grid, x, y, nearPlane, farPlane);
+#ifdef PG_LIGHT_CLUSTERS_SSE
+            // the squared distance from each center to the box, against the squared radius
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 minX = _mm_set1_ps(box.minX), maxX = _mm_set1_ps(box.maxX);
+            const __m128 minY = _mm_set1_ps(box.minY), maxY = _mm_set1_ps(box.maxY);
+            const __m128 minZ = _mm_set1_ps(box.minZ), maxZ = _mm_set1_ps(box.maxZ);
+            for (std::size_t i = 0u; i < count; i += 4u) {
+                const __m128 cx = _mm_loadu_ps(&candidates.x[i]);
+                const __m128 cy = _mm_loadu_ps(&candidates.y[i]);
+                const __m128 cz = _mm_loadu_ps(&candidates.z[i]);
+                const __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minX, cx), zero), _mm_max_ps(_mm_sub_ps(cx, maxX), zero));
+                const __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minY, cy), zero), _mm_max_ps(_mm_sub_ps(cy, maxY), zero));
+                const __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minZ, cz), zero), _mm_max_ps(_mm_sub_ps(cz, maxZ), zero));
+                const __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                const int mask = _mm_movemask_ps(_mm_cmple_ps(d2, _mm_loadu_ps(&candidates.radiusSquared[i])));
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (mask & (1 << lane)) {
+                        indices.push_back(candidates.lights[i + lane]);
+                    }
+                }
+            }
+#else
+            for (std::size_t i = 0u; i < count; ++i) {
+                if (distanceSquared(box, candidates.x[i], candidates.y[i], candidates.z[i]) <= candidates.radiusSquared[i]) {
+                    indices.push_back(candidates.lights[i]);
+                }
+            }
+#endif
+            clusters_[2u * cluster] = std::uint32_t(offset);
+            clusters_[2u * cluster + 1u] = std::uint32_t(indices.size() - offset);
+        }
+    }
+}
+
+}   // math
+}   // pg
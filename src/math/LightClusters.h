@@ -0,0 +1,103 @@
+#pragma once
+
+#include "math/Matrix.h"
+#include "math/Vector.h"
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+
+class ThreadPool;
+
+namespace math {
+
+/**
+ * @brief The view frustum, split into clusters: tiles on the screen, and slices in depth.
+ * The slices are exponentially spaced, so that clusters are roughly cubical at all depths.
+ * Cluster (x, y, z) has the index x + CountX * (y + CountY * z). Tile (0, 0) is in the bottom
+ * left corner of the screen, like gl_FragCoord.
+ */
+struct ClusterGrid {
+    static const std::uint32_t CountX = 16u;
+    static const std::uint32_t CountY = 9u;
+    static const std::uint32_t CountZ = 24u;
+    static const std::uint32_t Count = CountX * CountY * CountZ;
+
+    ClusterGrid() = default;
+    /**
+     * @param projection A perspective projection, see Matrix4f::perspective.
+     * @param nearPlane The distance to the near plane.
+     * @param farPlane The distance to the far plane.
+     */
+    ClusterGrid(const Matrix4f& projection, float nearPlane, float farPlane);
+
+    /// @brief The view space depth at which the slice begins. sliceDepth(CountZ) is the far plane.
+    float   sliceDepth(std::uint32_t slice) const;
+    /// @brief The slice which contains the depth, clamped into the grid.
+    std::uint32_t slice(float depth) const;
+
+    float   tanHalfFovX{ 1.f };
+    float   tanHalfFovY{ 1.f };
+    float   nearPlane{ 0.1f };
+    float   farPlane{ 100.f };
+    // slice(depth) = log(depth) * depthScale + depthBias
+    float   depthScale{ 0.f };
+    float   depthBias{ 0.f };
+};
+
+/**
+ * @brief Spheres in view space, as a structure of arrays, so that they can be tested four at a time.
+ * View space is right handed, and looks along -z.
+ */
+struct LightSpheres {
+    std::vector<float>  x{}, y{}, z{}, radius{};
+
+    void        clear();
+    void        push_back(const Vec3f& center, float radius);
+    std::size_t size() const;
+};
+
+/**
+ * @class LightClusters
+ * @brief Finds the lights which affect each cluster.
+ *
+ * Each light sphere is tested against the bounding box of each cluster it could reach. The
+ * slices are split between the thread pool's threads. The lights are culled against each slice,
+ * and then against each row of tiles in the slice. The remaining lights are tested against the
+ * row's clusters four at a time, with SSE where available.
+ *
+ * The result is a compact list of light indices, and an (offset, count) range of the list for
+ * each cluster. No OpenGL calls are made, so the assignment can run, and be measured, without a
+ * context.
+ */
+class LightClusters {
+public:
+    LightClusters() = default;
+
+    void        assign(const ClusterGrid& grid, const LightSpheres& lights, ThreadPool& pool);
+
+    /// @brief Two per cluster: the offset of the cluster's lights in indices(), and their count.
+    const std::vector<std::uint32_t>& clusters() const;
+    /// @brief The light indices of all clusters, one cluster after another.
+    const std::vector<std::uint32_t>& indices() const;
+
+private:
+    // the scratch space of one thread
+    struct Candidates {
+        std::vector<std::uint32_t>  sliceLights;    // the lights overlapping the slice's depth range
+        // the lights overlapping a row of the slice, padded to a multiple of four
+        std::vector<float>          x, y, z, radiusSquared;
+        std::vector<std::uint32_t>  lights;
+    };
+
+    void        assignSlice_(const ClusterGrid& grid, const LightSpheres& lights, std::uint32_t slice, Candidates& candidates);
+
+    std::vector<std::uint32_t>              clusters_{};
+    std::vector<std::uint32_t>              indices_{};
+    std::vector<std::vector<std::uint32_t>> sliceIndices_{};    // the light indices of each slice, before compaction
+    std::vector<Candidates>                 candidates_{};      // one per thread pool range
+};
+
+}   // math
+}   // pg
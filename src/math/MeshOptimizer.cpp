@@ -0,0 +1,258 @@
+#include "math/MeshOptimizer.h"
+#include "utils/Assert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const std::uint32_t Unused = 0xffffffffu;
+
+// the parameters from Forsyth's article
+const int ForsythCacheSize = 32;
+const float CacheDecayPower = 1.5f;
+const float LastTriangleScore = 0.75f;
+const float ValenceBoostScale = 2.f;
+const float ValenceBoostPower = 0.5f;
+
+std::uint32_t hashVertex(const float* vertex, std::size_t stride) {
+    // FNV-1a
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertex);
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0u; i < stride * sizeof(float); ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+float vertexScore(int cachePosition, std::uint32_t remainingTriangles) {
+    if (remainingTriangles == 0u) {
+        return -1.f;
+    }
+    float score = 0.f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // the vertices of the last triangle are scored the same, so that strips aren't favored
+            score = LastTriangleScore;
+        }
+        else {
+            const float scale = 1.f / (ForsythCacheSize - 3);
+            score = std::pow(1.f - (cachePosition - 3) * scale, CacheDecayPower);
+        }
+    }
+    // vertices with few triangles left are picked first, so that they can leave the cache
+    score += ValenceBoostScale * std::pow(float(remainingTriangles), -ValenceBoostPower);
+    return score;
+}
+
+}
+
+namespace pg {
+namespace math {
+
+std::size_t weldVertices(
+    const float* vertices,
+    std::size_t vertexCount,
+    std::size_t stride,
+    std::vector<float>& unique,
+    std::vector<std::uint32_t>& remap
+) {
+    unique.clear();
+    remap.resize(vertexCount);
+
+    // an open addressing hash table of unique vertex indices, at most half full
+    std::size_t tableSize = 1u;
+    while (tableSize < vertexCount * 2u) {
+        tableSize *= 2u;
+    }
+    std::vector<std::uint32_t> table(tableSize, Unused);
+    const std::size_t vertexBytes = stride * sizeof(float);
+    std::uint32_t uniqueCount = 0u;
+
+    for (std::size_t i = 0u; i < vertexCount; ++i) {
+        const float* vertex = vertices + i * stride;
+        std::size_t slot = hashVertex(vertex, stride) & (tableSize - 1u);
+        for (;;) {
+            const std::uint32_t existing = table[slot];
+            if (existing == Unused) {
+                table[slot] = uniqueCount;
+                unique.insert(unique.end(), vertex, vertex + stride);
+                remap[i] = uniqueCount++;
+                break;
+            }
+            if (std::memcmp(&unique[existing * stride], vertex, vertexBytes) == 0) {
+                remap[i] = existing;
+                break;
+            }
+            slot = (slot + 1u) & (tableSize - 1u);
+        }
+    }
+    return uniqueCount;
+}
+
+void optimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::size_t vertexCount) {
+    PG_ASSERT(indexCount % 3u == 0u);
+    const std::size_t triangleCount = indexCount / 3u;
+    if (triangleCount == 0u) {
+        return;
+    }
+
+    // the triangles adjacent to each vertex, in compressed rows
+    std::vector<std::uint32_t> remaining(vertexCount, 0u);
+    for (std::size_t i = 0u; i < indexCount; ++i) {
+        PG_ASSERT(indices[i] < vertexCount);
+        remaining[indices[i]]++;
+    }
+    std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1u, 0u);
+    for (std::size_t v = 0u; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1u] = adjacencyOffsets[v] + remaining[v];
+    }
+    std::vector<std::uint32_t> adjacency(indexCount);
+    {
+        std::vector<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (std::size_t t = 0u; t < triangleCount; ++t) {
+            for (std::size_t k = 0u; k < 3u; ++k) {
+                adjacency[fill[indices[t * 3u + k]]++] = std::uint32_t(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (std::size_t v = 0u; v < vertexCount; ++v) {
+        vertexScores[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (std::size_t t = 0u; t < triangleCount; ++t) {
+        triangleScores[t] = vertexScores[indices[t * 3u]] + vertexScores[indices[t * 3u + 1u]] + vertexScores[indices[t * 3u + 2u]];
+    }
+
+    std::vector<std::uint32_t> output(indexCount);
+    std::uint32_t cache[ForsythCacheSize + 3];
+    int cacheSize = 0;
+    std::size_t scanCursor = 0u;    // triangles before the cursor have all been emitted
+
+    std::uint32_t best = Unused;
+    for (std::size_t emittedCount = 0u; emittedCount < triangleCount; ++emittedCount) {
+        if (best == Unused) {
+            // nothing in the cache has triangles left, so restart from the next unemitted triangle
+            while (emitted[scanCursor]) {
+                ++scanCursor;
+            }
+            best = std::uint32_t(scanCursor);
+        }
+        const std::uint32_t* triangle = indices + best * 3u;
+        std::copy(triangle, triangle + 3, output.begin() + emittedCount * 3u);
+        emitted[best] = true;
+
+        // remove the triangle from its vertices' adjacency
+        for (std::size_t k = 0u; k < 3u; ++k) {
+            const std::uint32_t v = triangle[k];
+            std::uint32_t* begin = adjacency.data() + adjacencyOffsets[v];
+            std::uint32_t* end = begin + remaining[v];
+            std::uint32_t* it = std::find(begin, end, best);
+            PG_ASSERT(it != end);
+            std::swap(*it, *(end - 1));
+            remaining[v]--;
+        }
+
+        // move the triangle's vertices to the front of the LRU cache
+        std::uint32_t newCache[ForsythCacheSize + 3];
+        int newCacheSize = 0;
+        for (std::size_t k = 0u; k < 3u; ++k) {
+            newCache[newCacheSize++] = triangle[k];
+        }
+        for (int i = 0; i < cacheSize; ++i) {
+            const std::uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache[newCacheSize++] = v;
+            }
+        }
+        for (int i = 0; i < newCacheSize; ++i) {
+            cachePosition[newCache[i]] = i < ForsythCacheSize ? i : -1;
+        }
+        cacheSize = std::min(newCacheSize, ForsythCacheSize);
+        for (int i = 0; i < cacheSize; ++i) {
+            cache[i] = newCache[i];
+        }
+
+        // rescore the vertices whose cache position changed, including the ones pushed out,
+        // and pick the best triangle which touches the cache
+        for (int i = 0; i < newCacheSize; ++i) {
+            const std::uint32_t v = newCache[i];
+            const float score = vertexScore(cachePosition[v], remaining[v]);
+            const float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            const std::uint32_t* begin = adjacency.data() + adjacencyOffsets[v];
+            for (const std::uint32_t* t = begin; t != begin + remaining[v]; ++t) {
+                triangleScores[*t] += delta;
+            }
+        }
+        best = Unused;
+        float bestScore = -1.f;
+        for (int i = 0; i < cacheSize; ++i) {
+            const std::uint32_t v = cache[i];
+            const std::uint32_t* begin = adjacency.data() + adjacencyOffsets[v];
+            for (const std::uint32_t* t = begin; t != begin + remaining[v]; ++t) {
+                if (triangleScores[*t] > bestScore) {
+                    bestScore = triangleScores[*t];
+                    best = *t;
+                }
+            }
+        }
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+std::size_t optimizeVertexFetch(
+    float* vertices,
+    std::size_t vertexCount,
+    std::size_t stride,
+    std::uint32_t* indices,
+    std::size_t indexCount
+) {
+    std::vector<std::uint32_t> remap(vertexCount, Unused);
+    std::vector<float> reordered;
+    reordered.reserve(vertexCount * stride);
+    std::uint32_t next = 0u;
+    for (std::size_t i = 0u; i < indexCount; ++i) {
+        const std::uint32_t v = indices[i];
+        PG_ASSERT(v < vertexCount);
+        if (remap[v] == Unused) {
+            remap[v] = next++;
+            reordered.insert(reordered.end(), vertices + v * stride, vertices + (v + 1u) * stride);
+        }
+        indices[i] = remap[v];
+    }
+    std::copy(reordered.begin(), reordered.end(), vertices);
+    return next;
+}
+
+float averageCacheMissRatio(
+    const std::uint32_t* indices,
+    std::size_t indexCount,
+    std::size_t vertexCount,
+    std::size_t cacheSize
+) {
+    if (indexCount < 3u) {
+        return 0.f;
+    }
+    // the time stamp at which each vertex entered the FIFO
+    std::vector<std::size_t> entered(vertexCount, 0u);
+    std::size_t misses = 0u;
+    for (std::size_t i = 0u; i < indexCount; ++i) {
+        const std::uint32_t v = indices[i];
+        PG_ASSERT(v < vertexCount);
+        // the timestamps start at cacheSize + 1, so that zero means never loaded
+        if (entered[v] == 0u || misses + cacheSize + 1u - entered[v] > cacheSize) {
+            ++misses;
+            entered[v] = misses + cacheSize;
+        }
+    }
+    return float(misses) / float(indexCount / 3u);
+}
+
+}   // math
+}   // pg
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+namespace math {
+
+/**
+ * @brief Merge bitwise identical vertices.
+ * @param vertices The vertex data, vertexCount vertices of stride floats each.
+ * @param unique Receives the distinct vertices, in order of first occurrence.
+ * @param remap Receives the index in unique of each input vertex.
+ * @return The number of distinct vertices.
+ */
+std::size_t weldVertices(
+    const float* vertices,
+    std::size_t vertexCount,
+    std::size_t stride,
+    std::vector<float>& unique,
+    std::vector<std::uint32_t>& remap
+);
+
+/**
+ * @brief Reorder triangles for the post-transform vertex cache.
+ * This is Tom Forsyth's linear-speed vertex cache optimization. Each step emits the triangle
+ * whose vertices score highest, favoring vertices which are in the simulated LRU cache and
+ * vertices with few remaining triangles.
+ * @param indices The triangle list, reordered in place.
+ */
+void optimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::size_t vertexCount);
+
+/**
+ * @brief Reorder the vertices in the order in which the triangles first use them.
+ * This improves the locality of vertex fetches, and drops vertices which aren't referenced.
+ * @param vertices The vertex data, stride floats per vertex, reordered in place.
+ * @param indices The triangle list, rewritten to refer to the new vertex order.
+ * @return The number of vertices which are used.
+ */
+std::size_t optimizeVertexFetch(
+    float* vertices,
+    std::size_t vertexCount,
+    std::size_t stride,
+    std::uint32_t* indices,
+    std::size_t indexCount
+);
+
+/**
+ * @brief Get the average cache miss ratio, the transformed vertices per triangle.
+ * The post-transform cache is simulated as a FIFO of the given size. The result ranges from
+ * 3 (no reuse at all) down to about 0.5 for large regular meshes.
+ */
+float averageCacheMissRatio(
+    const std::uint32_t* indices,
+    std::size_t indexCount,
+    std::size_t vertexCount,
+    std::size_t cacheSize = 16u
+);
+
+}   // math
+}   // pg
@@ -0,0 +1,280 @@
+#include "math/MeshSimplifier.h"
+#include "math/MeshOptimizer.h"
+#include "math/Vector.h"
+#include "utils/Assert.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+using pg::math::Vec3f;
+
+/// The symmetric 4x4 matrix of a sum of squared plane distances.
+struct Quadric {
+    double a00{ 0.0 }, a01{ 0.0 }, a02{ 0.0 }, a03{ 0.0 };
+    double a11{ 0.0 }, a12{ 0.0 }, a13{ 0.0 };
+    double a22{ 0.0 }, a23{ 0.0 };
+    double a33{ 0.0 };
+
+    void addPlane(double a, double b, double c, double d) {
+        a00 += a * a; a01 += a * b; a02 += a * c; a03 += a * d;
+        a11 += b * b; a12 += b * c; a13 += b * d;
+        a22 += c * c; a23 += c * d;
+        a33 += d * d;
+    }
+
+    Quadric& operator+=(const Quadric& rhs) {
+        a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02; a03 += rhs.a03;
+        a11 += rhs.a11; a12 += rhs.a12; a13 += rhs.a13;
+        a22 += rhs.a22; a23 += rhs.a23;
+        a33 += rhs.a33;
+        return *this;
+    }
+
+    double evaluate(const Vec3f& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        return a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+            + a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+            + a22 * z * z + 2.0 * a23 * z
+            + a33;
+    }
+};
+
+// collapses may turn the normal of a remaining triangle by at most about 75 degrees
+const float MinNormalCosine = 0.25f;
+
+struct Collapse {
+    double          cost;
+    std::uint32_t   from;
+    std::uint32_t   to;
+};
+
+}
+
+namespace pg {
+namespace math {
+
+float simplifyMesh(
+    const float* vertices,
+    std::size_t vertexCount,
+    std::size_t stride,
+    const std::uint32_t* indices,
+    std::size_t indexCount,
+    std::size_t targetIndexCount,
+    float maxError,
+    std::vector<std::uint32_t>& result
+) {
+    PG_ASSERT(stride >= 3u);
+    PG_ASSERT(indexCount % 3u == 0u);
+    result.assign(indices, indices + indexCount);
+    if (indexCount == 0u) {
+        return 0.f;
+    }
+
+    std::vector<Vec3f> positions(vertexCount);
+    for (std::size_t v = 0u; v < vertexCount; ++v) {
+        const float* p = vertices + v * stride;
+        positions[v] = Vec3f{ p[0], p[1], p[2] };
+    }
+
+    /*
+     * Find the vertices which must stay in place: the ones whose position is shared with
+     * another vertex, and the ones on open boundaries
+     */
+    std::vector<std::uint32_t> positionIds;
+    std::vector<float> uniquePositions;
+    const std::size_t positionCount = weldVertices(&positions[0].x, vertexCount, 3u, uniquePositions, positionIds);
+    std::vector<std::uint32_t> positionUses(positionCount, 0u);
+    for (std::uint32_t id : positionIds) {
+        positionUses[id]++;
+    }
+    std::vector<bool> lockedPositions(positionCount, false);
+    for (std::size_t id = 0u; id < positionCount; ++id) {
+        lockedPositions[id] = positionUses[id] > 1u;
+    }
+    {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+        edges.reserve(indexCount);
+        for (std::size_t i = 0u; i < indexCount; i += 3u) {
+            for (std::size_t k = 0u; k < 3u; ++k) {
+                std::uint32_t a = positionIds[indices[i + k]];
+                std::uint32_t b = positionIds[indices[i + (k + 1u) % 3u]];
+                edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (std::size_t i = 0u; i < edges.size();) {
+            std::size_t j = i + 1u;
+            while (j < edges.size() && edges[j] == edges[i]) {
+                ++j;
+            }
+            if (j - i == 1u) {
+                lockedPositions[edges[i].first] = true;
+                lockedPositions[edges[i].second] = true;
+            }
+            i = j;
+        }
+    }
+    std::vector<bool> locked(vertexCount);
+    for (std::size_t v = 0u; v < vertexCount; ++v) {
+        locked[v] = lockedPositions[positionIds[v]];
+    }
+
+    // the quadrics of the original triangle planes
+    std::vector<Quadric> quadrics(vertexCount);
+    for (std::size_t i = 0u; i < indexCount; i += 3u) {
+        const Vec3f& p0 = positions[indices[i]];
+        const Vec3f& p1 = positions[indices[i + 1u]];
+        const Vec3f& p2 = positions[indices[i + 2u]];
+        Vec3f normal = (p1 - p0).cross(p2 - p0);
+        const float length = normal.norm();
+        if (length == 0.f) {
+            continue;
+        }
+        normal = normal * (1.f / length);
+        const double d = -double(normal.dot(p0));
+        for (std::size_t k = 0u; k < 3u; ++k) {
+            quadrics[indices[i + k]].addPlane(normal.x, normal.y, normal.z, d);
+        }
+    }
+
+    const double maxCost = double(maxError) * double(maxError);
+    double largestCost = 0.0;
+    std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1u);
+    std::vector<std::uint32_t> adjacency;
+    std::vector<std::uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    std::vector<Collapse> collapses;
+
+    /*
+     * Collapse edges in passes. In each pass, the one-ring of every collapsed vertex is frozen,
+     * so that the flip checks stay valid until the end of the pass
+     */
+    while (result.size() > targetIndexCount) {
+        const std::size_t triangleCount = result.size() / 3u;
+
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+        for (std::uint32_t v : result) {
+            adjacencyOffsets[v + 1u]++;
+        }
+        for (std::size_t v = 0u; v < vertexCount; ++v) {
+            adjacencyOffsets[v + 1u] += adjacencyOffsets[v];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (std::size_t t = 0u; t < triangleCount; ++t) {
+                for (std::size_t k = 0u; k < 3u; ++k) {
+                    adjacency[fill[result[t * 3u + k]]++] = std::uint32_t(t);
+                }
+            }
+        }
+
+        edges.clear();
+        for (std::size_t t = 0u; t < triangleCount; ++t) {
+            for (std::size_t k = 0u; k < 3u; ++k) {
+                const std::uint32_t a = result[t * 3u + k];
+                const std::uint32_t b = result[t * 3u + (k + 1u) % 3u];
+                if (!(locked[a] && locked[b])) {
+                    edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+                }
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (const auto& edge : edges) {
+            const std::uint32_t a = edge.first;
+            const std::uint32_t b = edge.second;
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            const double costAB = locked[a] ? maxCost + 1.0 : q.evaluate(positions[b]);
+            const double costBA = locked[b] ? maxCost + 1.0 : q.evaluate(positions[a]);
+            if (costAB <= costBA) {
+                collapses.push_back(Collapse{ costAB, a, b });
+            }
+            else {
+                collapses.push_back(Collapse{ costBA, b, a });
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) -> bool {
+            return lhs.cost < rhs.cost;
+        });
+
+        for (std::size_t v = 0u; v < vertexCount; ++v) {
+            remap[v] = std::uint32_t(v);
+        }
+        std::fill(touched.begin(), touched.end(), false);
+        std::size_t remainingTriangles = triangleCount;
+        bool collapsed = false;
+
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > maxCost) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+            const std::uint32_t* begin = adjacency.data() + adjacencyOffsets[collapse.from];
+            const std::uint32_t* end = adjacency.data() + adjacencyOffsets[collapse.from + 1u];
+
+            bool flips = false;
+            std::size_t removed = 0u;
+            for (const std::uint32_t* t = begin; t != end && !flips; ++t) {
+                const std::uint32_t* triangle = &result[*t * 3u];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                    removed++;
+                    continue;
+                }
+                // rotate the collapsed vertex first, keeping the winding
+                const std::size_t k = triangle[0] == collapse.from ? 0u : triangle[1] == collapse.from ? 1u : 2u;
+                const Vec3f& a = positions[triangle[(k + 1u) % 3u]];
+                const Vec3f& b = positions[triangle[(k + 2u) % 3u]];
+                const Vec3f before = (a - positions[collapse.from]).cross(b - positions[collapse.from]);
+                const Vec3f after = (a - positions[collapse.to]).cross(b - positions[collapse.to]);
+                // reject flips, and turns so steep that the triangle nearly stands on its edge
+                flips = before.dot(after) <= MinNormalCosine * before.norm() * after.norm();
+            }
+            if (flips) {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            for (const std::uint32_t* t = begin; t != end; ++t) {
+                touched[result[*t * 3u]] = true;
+                touched[result[*t * 3u + 1u]] = true;
+                touched[result[*t * 3u + 2u]] = true;
+            }
+            largestCost = std::max(largestCost, collapse.cost);
+            remainingTriangles -= removed;
+            collapsed = true;
+            if (remainingTriangles * 3u <= targetIndexCount) {
+                break;
+            }
+        }
+        if (!collapsed) {
+            break;
+        }
+
+        std::size_t write = 0u;
+        for (std::size_t t = 0u; t < triangleCount; ++t) {
+            const std::uint32_t a = remap[result[t * 3u]];
+            const std::uint32_t b = remap[result[t * 3u + 1u]];
+            const std::uint32_t c = remap[result[t * 3u + 2u]];
+            if (a != b && b != c && c != a) {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        result.resize(write);
+    }
+    return float(std::sqrt(largestCost));
+}
+
+}   // math
+}   // pg
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+namespace math {
+
+/**
+ * @brief Simplify a triangle list with quadric error metric edge collapses.
+ *
+ * Each collapse moves a vertex onto one of its neighbors, so the result indexes the same vertex
+ * data as the input, and can share its vertex buffer. The collapse with the smallest error, the
+ * sum of squared distances to the planes of the original triangles (Garland & Heckbert), is done
+ * first. Collapses which would flip a triangle, or turn it nearly on its edge, are skipped.
+ *
+ * Vertices on open boundaries, and vertices whose position is shared by another vertex (for
+ * instance across a hard normal edge), never move. That keeps seams and silhouettes closed.
+ *
+ * @param vertices The vertex data, stride floats per vertex. The first three floats are the position.
+ * @param targetIndexCount Simplification stops once the triangle list is at most this long.
+ * @param maxError Collapses which would move the surface further than this are not done.
+ * @param result Receives the simplified triangle list.
+ * @return The largest error of the collapses which were done.
+ */
+float simplifyMesh(
+    const float* vertices,
+    std::size_t vertexCount,
+    std::size_t stride,
+    const std::uint32_t* indices,
+    std::size_t indexCount,
+    std::size_t targetIndexCount,
+    float maxError,
+    std::vector<std::uint32_t>& result
+);
+
+}   // math
+}   // pg
@@ -0,0 +1,323 @@
+#include "math/OcclusionBuffer.h"
+#include "utils/Assert.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PG_OCCLUSION_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+using pg::math::Vec4f;
+
+// triangles are clipped to this multiple of the screen, so that the edge functions stay precise
+const float GuardBand = 2.f;
+// a clipped triangle gains at most one vertex per plane
+const int MaxClippedVertices = 3 + 5;
+
+// the clip space planes the triangles are clipped against, as (x, y, z, w) coefficients
+const Vec4f ClipPlanes[] = {
+    Vec4f{ 0.f, 0.f, 1.f, 1.f },            // near
+    Vec4f{ -1.f, 0.f, 0.f, GuardBand },
+    Vec4f{ 1.f, 0.f, 0.f, GuardBand },
+    Vec4f{ 0.f, -1.f, 0.f, GuardBand },
+    Vec4f{ 0.f, 1.f, 0.f, GuardBand }
+};
+
+// the frustum planes the clip space point is outside of, one bit per plane
+unsigned outcode(const Vec4f& p) {
+    return (p.x < -p.w ? 1u : 0u) | (p.x > p.w ? 2u : 0u)
+        | (p.y < -p.w ? 4u : 0u) | (p.y > p.w ? 8u : 0u)
+        | (p.z < -p.w ? 16u : 0u) | (p.z > p.w ? 32u : 0u);
+}
+
+float planeDistance(const Vec4f& plane, const Vec4f& p) {
+    return plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w * p.w;
+}
+
+// Sutherland-Hodgman, returns the vertex count of the clipped polygon
+int clipPolygon(const Vec4f& plane, const Vec4f* in, int count, Vec4f* out) {
+    int outCount = 0;
+    for (int i = 0; i < count; ++i) {
+        const Vec4f& a = in[i];
+        const Vec4f& b = in[(i + 1) % count];
+        const float da = planeDistance(plane, a);
+        const float db = planeDistance(plane, b);
+        if (da >= 0.f) {
+            out[outCount++] = a;
+        }
+        if ((da >= 0.f) != (db >= 0.f)) {
+            out[outCount++] = a + (b - a) * (da / (da - db));
+        }
+    }
+    return outCount;
+}
+
+}
+
+namespace pg {
+namespace math {
+
+const std::uint32_t OcclusionBuffer::TileSize;
+
+void OcclusionBuffer::resize(std::uint32_t width, std::uint32_t height) {
+    const std::uint32_t tilesX = (width + TileSize - 1u) / TileSize;
+    const std::uint32_t tilesY = (height + TileSize - 1u) / TileSize;
+    if (tilesX == tilesX_ && tilesY == tilesY_) {
+        return;
+    }
+    tilesX_ = tilesX;
+    tilesY_ = tilesY;
+    width_ = tilesX_ * TileSize;
+    height_ = tilesY_ * TileSize;
+    depth_.assign(std::size_t(width_) * height_, 0.f);
+    tileDepth_.assign(std::size_t(tilesX_) * tilesY_, 0.f);
+    triangleCount_ = 0u;
+}
+
+void OcclusionBuffer::render(const Matrix4f& viewProjection, const std::vector<OccluderInstance>& occluders, ThreadPool& pool) {
+    PG_ASSERT(width_ > 0u && height_ > 0u);
+    viewProjection_ = viewProjection;
+    if (triangles_.size() < pool.size()) {
+        triangles_.resize(pool.size());
+        clip_.resize(pool.size());
+    }
+    const std::size_t lists = pool.parallelFor(occluders.size(), 1u,
+        [this, &viewProjection, &occluders](std::size_t begin, std::size_t end, std::size_t range) -> void {
+            triangles_[range].clear();
+            for (std::size_t i = begin; i < end; ++i) {
+                setupOccluder_(viewProjection, occluders[i], clip_[range], triangles_[range]);
+            }
+        });
+    triangleCount_ = 0u;
+    for (std::size_t list = 0u; list < lists; ++list) {
+        triangleCount_ += triangles_[list].size();
+    }
+    // each range owns whole rows of tiles, so the ranges don't share pixels
+    pool.parallelFor(tilesY_, 1u, [this, lists](std::size_t begin, std::size_t end, std::size_t) -> void {
+        for (std::size_t row = begin; row < end; ++row) {
+            rasterizeTileRow_(std::uint32_t(row), lists);
+        }
+    });
+}
+
+bool OcclusionBuffer::isVisible(const AABoxf& box) const {
+    float minX = float(width_), minY = float(height_), maxX = 0.f, maxY = 0.f;
+    float boxDepth = 0.f;   // of the nearest corner
+    for (int i = 0; i < 8; ++i) {
+        const Vec4f corner{
+            (i & 1) ? box.max.x : box.min.x,
+            (i & 2) ? box.max.y : box.min.y,
+            (i & 4) ? box.max.z : box.min.z,
+            1.f
+        };
+        const Vec4f p = viewProjection_ * corner;
+        if (p.z < -p.w) {
+            return true;
+        }
+        const float invW = 1.f / p.w;
+        const float x = (p.x * invW * 0.5f + 0.5f) * float(width_);
+        const float y = (p.y * invW * 0.5f + 0.5f) * float(height_);
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        boxDepth = std::max(boxDepth, invW);
+    }
+    // the pixels the box touches
+    const std::uint32_t x0 = std::uint32_t(std::max(std::floor(minX), 0.f));
+    const std::uint32_t y0 = std::uint32_t(std::max(std::floor(minY), 0.f));
+    const std::uint32_t x1 = std::uint32_t(std::min(std::ceil(maxX), float(width_)));
+    const std::uint32_t y1 = std::uint32_t(std::min(std::ceil(maxY), float(height_)));
+    if (x0 >= x1 || y0 >= y1) {
+        // off the screen
+        return false;
+    }
+
+    for (std::uint32_t ty = y0 / TileSize; ty <= (y1 - 1u) / TileSize; ++ty) {
+        for (std::uint32_t tx = x0 / TileSize; tx <= (x1 - 1u) / TileSize; ++tx) {
+            if (tileDepth_[ty * tilesX_ + tx] > boxDepth) {
+                // all of the tile is in front of the box
+                continue;
+            }
+            const std::uint32_t rowEnd = std::min(y1, (ty + 1u) * TileSize);
+            const std::uint32_t columnEnd = std::min(x1, (tx + 1u) * TileSize);
+            for (std::uint32_t y = std::max(y0, ty * TileSize); y < rowEnd; ++y) {
+                const float* row = depth_.data() + std::size_t(y) * width_;
+                for (std::uint32_t x = std::max(x0, tx * TileSize); x < columnEnd; ++x) {
+                    if (row[x] <= boxDepth) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+std::uint32_t OcclusionBuffer::width() const {
+    return width_;
+}
+
+std::uint32_t OcclusionBuffer::height() const {
+    return height_;
+}
+
+float OcclusionBuffer::depth(std::uint32_t x, std::uint32_t y) const {
+    PG_ASSERT(x < width_ && y < height_);
+    return depth_[std::size_t(y) * width_ + x];
+}
+
+std::size_t OcclusionBuffer::triangleCount() const {
+    return triangleCount_;
+}
+
+void OcclusionBuffer::setupOccluder_(const Matrix4f& viewProjection, const OccluderInstance& occluder, std::vector<Vec4f>& clip, std::vector<ScreenTriangle>& triangles) const {
+    const Matrix4f toClip = viewProjection * occluder.world;
+    clip.resize(occluder.vertexCount);
+    for (std::size_t v = 0u; v < occluder.vertexCount; ++v) {
+        clip[v] = toClip * Vec4f{ occluder.positions[v], 1.f };
+    }
+
+    Vec4f polygons[2][MaxClippedVertices];
+    for (std::size_t i = 0u; i + 2u < occluder.indexCount; i += 3u) {
+        const Vec4f& v0 = clip[occluder.indices[i]];
+        const Vec4f& v1 = clip[occluder.indices[i + 1u]];
+        const Vec4f& v2 = clip[occluder.indices[i + 2u]];
+        if ((outcode(v0) & outcode(v1) & outcode(v2)) != 0u) {
+            // entirely outside one of the frustum planes
+            continue;
+        }
+        bool clipped = false;
+        for (const Vec4f& plane : ClipPlanes) {
+            clipped = clipped || planeDistance(plane, v0) < 0.f || planeDistance(plane, v1) < 0.f || planeDistance(plane, v2) < 0.f;
+        }
+        if (!clipped) {
+            setupTriangle_(v0, v1, v2, triangles);
+            continue;
+        }
+        polygons[0][0] = v0;
+        polygons[0][1] = v1;
+        polygons[0][2] = v2;
+        int count = 3;
+        int current = 0;
+        for (const Vec4f& plane : ClipPlanes) {
+            count = clipPolygon(plane, polygons[current], count, polygons[1 - current]);
+            current = 1 - current;
+            if (count < 3) {
+                break;
+            }
+        }
+        for (int k = 1; k + 1 < count; ++k) {
+            setupTriangle_(polygons[current][0], polygons[current][k], polygons[current][k + 1], triangles);
+        }
+    }
+}
+
+void OcclusionBuffer::setupTriangle_(const Vec4f& v0, const Vec4f& v1, const Vec4f& v2, std::vector<ScreenTriangle>& triangles) const {
+    const Vec4f* v[3] = { &v0, &v1, &v2 };
+    float x[3], y[3], z[3];
+    for (int k = 0; k < 3; ++k) {
+        z[k] = 1.f / v[k]->w;
+        x[k] = (v[k]->x * z[k] * 0.5f + 0.5f) * float(width_);
+        y[k] = (v[k]->y * z[k] * 0.5f + 0.5f) * float(height_);
+    }
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area <= 0.f) {
+        // back facing, or degenerate
+        return;
+    }
+    ScreenTriangle triangle;
+    triangle.minX = std::min(x[0], std::min(x[1], x[2]));
+    triangle.minY = std::min(y[0], std::min(y[1], y[2]));
+    triangle.maxX = std::max(x[0], std::max(x[1], x[2]));
+    triangle.maxY = std::max(y[0], std::max(y[1], y[2]));
+    if (triangle.maxX <= 0.f || triangle.maxY <= 0.f || triangle.minX >= float(width_) || triangle.minY >= float(height_)) {
+        return;
+    }
+    for (int k = 0; k < 3; ++k) {
+        const int next = (k + 1) % 3;
+        triangle.a[k] = y[k] - y[next];
+        triangle.b[k] = x[next] - x[k];
+        triangle.c[k] = -(triangle.a[k] * x[k] + triangle.b[k] * y[k]);
+    }
+    triangle.dzdx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    triangle.dzdy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+    triangle.z0 = z[0] - triangle.dzdx * x[0] - triangle.dzdy * y[0];
+    triangles.push_back(triangle);
+}
+
+void OcclusionBuffer::rasterizeTileRow_(std::uint32_t tileRow, std::size_t listCount) {
+    const int rowBegin = int(tileRow * TileSize);
+    const int rowEnd = rowBegin + int(TileSize);
+    float* const rows = depth_.data() + std::size_t(rowBegin) * width_;
+    std::fill(rows, rows + std::size_t(TileSize) * width_, 0.f);
+
+    for (std::size_t list = 0u; list < listCount; ++list) {
+        for (const ScreenTriangle& t : triangles_[list]) {
+            // the pixels whose centers are in the bounding box
+            const int yBegin = std::max(rowBegin, int(std::ceil(t.minY - 0.5f)));
+            const int yEnd = std::min(rowEnd, int(std::floor(t.maxY - 0.5f)) + 1);
+            // whole groups of four, so that the loads stay within the row
+            const int xBegin = std::max(0, int(std::ceil(t.minX - 0.5f))) & ~3;
+            const int xEnd = std::min(int(width_), int(std::floor(t.maxX - 0.5f)) + 1);
+            if (yBegin >= yEnd || xBegin >= xEnd) {
+                continue;
+            }
+            for (int y = yBegin; y < yEnd; ++y) {
+                float* row = depth_.data() + std::size_t(y) * width_;
+                const float py = float(y) + 0.5f;
+#ifdef PG_OCCLUSION_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 laneCenters = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+                const __m128 a0 = _mm_set1_ps(t.a[0]), a1 = _mm_set1_ps(t.a[1]), a2 = _mm_set1_ps(t.a[2]);
+                const __m128 e0Row = _mm_set1_ps(t.b[0] * py + t.c[0]);
+                const __m128 e1Row = _mm_set1_ps(t.b[1] * py + t.c[1]);
+                const __m128 e2Row = _mm_set1_ps(t.b[2] * py + t.c[2]);
+                const __m128 dzdx = _mm_set1_ps(t.dzdx);
+                const __m128 zRow = _mm_set1_ps(t.z0 + t.dzdy * py);
+                for (int x = xBegin; x < xEnd; x += 4) {
+                    const __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), laneCenters);
+                    const __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), e0Row);
+                    const __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), e1Row);
+                    const __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), e2Row);
+                    const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                    if (_mm_movemask_ps(inside) == 0) {
+                        continue;
+                    }
+                    const __m128 z = _mm_add_ps(_mm_mul_ps(dzdx, px), zRow);
+                    const __m128 depth = _mm_loadu_ps(row + x);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, _mm_max_ps(depth, z)), _mm_andnot_ps(inside, depth)));
+                }
+#else
+                for (int x = xBegin; x < xEnd; ++x) {
+                    const float px = float(x) + 0.5f;
+                    if (t.a[0] * px + t.b[0] * py + t.c[0] >= 0.f
+                        && t.a[1] * px + t.b[1] * py + t.c[1] >= 0.f
+                        && t.a[2] * px + t.b[2] * py + t.c[2] >= 0.f) {
+                        row[x] = std::max(row[x], t.z0 + t.dzdx * px + t.dzdy * py);
+                    }
+                }
+#endif
+            }
+        }
+    }
+
+    // the farthest depth of each tile in the row
+    for (std::uint32_t tx = 0u; tx < tilesX_; ++tx) {
+        float farthest = rows[tx * TileSize];
+        for (std::uint32_t y = 0u; y < TileSize; ++y) {
+            const float* tile = rows + std::size_t(y) * width_ + tx * TileSize;
+            for (std::uint32_t x = 0u; x < TileSize; ++x) {
+                farthest = std::min(farthest, tile[x]);
+            }
+        }
+        tileDepth_[tileRow * tilesX_ + tx] = farthest;
+    }
+}
+
+}   // math
+}   // pg
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "math/Geometry.h"
+#include "math/Matrix.h"
+#include "math/Vector.h"
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+
+class ThreadPool;
+
+namespace math {
+
+/// @brief A triangle mesh which hides what is behind it, placed in the world.
+struct OccluderInstance {
+    Matrix4f                world;
+    const Vec3f*            positions;
+    std::size_t             vertexCount;
+    const std::uint32_t*    indices;        // a triangle list, the front faces counter clockwise
+    std::size_t             indexCount;
+};
+
+/**
+ * @class OcclusionBuffer
+ * @brief A low resolution depth buffer, rasterized on the CPU, which bounding boxes are tested against.
+ *
+ * The front faces of the occluders are clipped against the near plane, and rasterized four
+ * pixels at a time with SSE where available. The depth is stored as 1 / w, which is linear in
+ * screen space, so nearer is larger and empty pixels are zero. Each 8x8 tile also stores the
+ * farthest depth of its pixels, so most box tests only read a few tiles.
+ *
+ * The occluders are transformed and set up on the thread pool's threads, and then each thread
+ * rasterizes all triangles into its own rows of tiles, so the threads never write to the same
+ * pixels. No OpenGL calls are made.
+ */
+class OcclusionBuffer {
+public:
+    static const std::uint32_t TileSize = 8u;
+
+    OcclusionBuffer() = default;
+
+    /// @brief Set the resolution, rounded up to a multiple of the tile size. Nothing happens if it doesn't change.
+    void            resize(std::uint32_t width, std::uint32_t height);
+    /// @brief Clear the buffer, and rasterize the occluders as seen through the view-projection matrix.
+    void            render(const Matrix4f& viewProjection, const std::vector<OccluderInstance>& occluders, ThreadPool& pool);
+    /**
+     * @brief Test a world space box against the occluders of the last render.
+     * @return False only if every pixel the box covers has an occluder in front of the whole box.
+     * Boxes which cross the near plane are always visible.
+     */
+    bool            isVisible(const AABoxf& box) const;
+
+    std::uint32_t   width() const;
+    std::uint32_t   height() const;
+    /// @brief The depth of the pixel, as 1 / w. Row zero is at the bottom of the screen.
+    float           depth(std::uint32_t x, std::uint32_t y) const;
+    /// @brief The number of triangles which were rasterized in the last render.
+    std::size_t     triangleCount() const;
+
+private:
+    // a clipped, projected triangle, set up for rasterization
+    struct ScreenTriangle {
+        // the edge functions a * x + b * y + c, positive inside
+        float a[3], b[3], c[3];
+        // the depth plane, z = z0 + dzdx * x + dzdy * y
+        float z0, dzdx, dzdy;
+        float minX, minY, maxX, maxY;
+    };
+
+    void            setupOccluder_(const Matrix4f& viewProjection, const OccluderInstance& occluder, std::vector<Vec4f>& clip, std::vector<ScreenTriangle>& triangles) const;
+    void            setupTriangle_(const Vec4f& v0, const Vec4f& v1, const Vec4f& v2, std::vector<ScreenTriangle>& triangles) const;
+    void            rasterizeTileRow_(std::uint32_t tileRow, std::size_t listCount);
+
+    std::uint32_t   width_{ 0u };
+    std::uint32_t   height_{ 0u };
+    std::uint32_t   tilesX_{ 0u };
+    std::uint32_t   tilesY_{ 0u };
+    Matrix4f        viewProjection_{};
+    std::vector<float>  depth_{};
+    std::vector<float>  tileDepth_{};       // the farthest depth in each tile
+    std::size_t     triangleCount_{ 0u };
+    // one per thread pool range, reused between renders
+    std::vector<std::vector<ScreenTriangle>>    triangles_{};
+    std::vector<std::vector<Vec4f>>             clip_{};
+};
+
+}   // math
+}   // pg
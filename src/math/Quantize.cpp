@@ -0,0 +1,89 @@
+#include "math/Quantize.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// the smallest quantization scale, for meshes which are a single point
+const float MinHalfExtent = 1e-5f;
+
+float signNotZero(float value) {
+    return value >= 0.f ? 1.f : -1.f;
+}
+
+}
+
+namespace pg {
+namespace math {
+
+std::int16_t quantizeSnorm16(float value) {
+    value = std::max(-1.f, std::min(1.f, value));
+    return std::int16_t(std::lround(value * 32767.f));
+}
+
+float dequantizeSnorm16(std::int16_t value) {
+    return std::max(float(value) / 32767.f, -1.f);
+}
+
+std::uint16_t quantizeUnorm16(float value) {
+    value = std::max(0.f, std::min(1.f, value));
+    return std::uint16_t(std::lround(value * 65535.f));
+}
+
+float dequantizeUnorm16(std::uint16_t value) {
+    return float(value) / 65535.f;
+}
+
+Vec2f octahedralEncode(const Vec3f& normal) {
+    const float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (l1 == 0.f) {
+        // a missing normal points up
+        return Vec2f{ 0.f, 0.f };
+    }
+    Vec2f encoded{ normal.x / l1, normal.y / l1 };
+    if (normal.z < 0.f) {
+        // fold the lower hemisphere over the diagonals
+        encoded = Vec2f{
+            (1.f - std::abs(encoded.y)) * signNotZero(encoded.x),
+            (1.f - std::abs(encoded.x)) * signNotZero(encoded.y)
+        };
+    }
+    return encoded;
+}
+
+Vec3f octahedralDecode(const Vec2f& encoded) {
+    Vec3f normal{ encoded.x, encoded.y, 1.f - std::abs(encoded.x) - std::abs(encoded.y) };
+    if (normal.z < 0.f) {
+        const float x = normal.x;
+        normal.x = (1.f - std::abs(normal.y)) * signNotZero(x);
+        normal.y = (1.f - std::abs(x)) * signNotZero(normal.y);
+    }
+    return normal.normalized();
+}
+
+float quantizationScale(const AABoxf& bounds) {
+    const Vec3f halfExtents = bounds.extents();
+    return std::max(std::max(halfExtents.x, halfExtents.y), std::max(halfExtents.z, MinHalfExtent));
+}
+
+Matrix4f dequantizationMatrix(const AABoxf& bounds) {
+    const float scale = quantizationScale(bounds);
+    return Matrix4f::translation(bounds.center()) * Matrix4f::scale(Vec3f{ scale, scale, scale });
+}
+
+void quantizePosition(const Vec3f& position, const AABoxf& bounds, std::int16_t out[3]) {
+    const float scale = 1.f / quantizationScale(bounds);
+    const Vec3f center = bounds.center();
+    out[0] = quantizeSnorm16((position.x - center.x) * scale);
+    out[1] = quantizeSnorm16((position.y - center.y) * scale);
+    out[2] = quantizeSnorm16((position.z - center.z) * scale);
+}
+
+void quantizeNormal(const Vec3f& normal, std::int16_t out[2]) {
+    const Vec2f encoded = octahedralEncode(normal);
+    out[0] = quantizeSnorm16(encoded.x);
+    out[1] = quantizeSnorm16(encoded.y);
+}
+
+}   // math
+}   // pg
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "math/Geometry.h"
+#include "math/Matrix.h"
+#include "math/Vector.h"
+#include <cstdint>
+
+namespace pg {
+namespace math {
+
+/*
+ * Conversions between floats and the normalized integer formats of vertex attributes.
+ * The dequantization functions follow the OpenGL conversion rules, so they give the
+ * values that the shaders see.
+ **/
+
+/// @brief Quantize a value in [-1, 1]. The error is at most 0.5 / 32767.
+std::int16_t    quantizeSnorm16(float value);
+float           dequantizeSnorm16(std::int16_t value);
+/// @brief Quantize a value in [0, 1], such as a texture coordinate. The error is at most 0.5 / 65535.
+std::uint16_t   quantizeUnorm16(float value);
+float           dequantizeUnorm16(std::uint16_t value);
+
+/**
+ * @brief Map a unit vector onto the octahedron, unfolded into the square [-1, 1]^2.
+ * The two components can be quantized independently.
+ */
+Vec2f   octahedralEncode(const Vec3f& normal);
+Vec3f   octahedralDecode(const Vec2f& encoded);
+
+/**
+ * @brief Get the scale which maps the box into [-1, 1]^3, when applied around the box center.
+ * The scale is the same along all axes, so that normals aren't skewed by the dequantization.
+ */
+float   quantizationScale(const AABoxf& bounds);
+/**
+ * @brief Get the matrix which maps quantized positions in [-1, 1]^3 back into the box.
+ */
+Matrix4f dequantizationMatrix(const AABoxf& bounds);
+
+/**
+ * @brief Quantize a position to 16-bit snorm coordinates relative to the box.
+ * The error along each axis is at most 0.5 / 32767 of the largest half extent of the box.
+ */
+void    quantizePosition(const Vec3f& position, const AABoxf& bounds, std::int16_t out[3]);
+/**
+ * @brief Quantize a unit normal to a 16-bit snorm octahedral encoding.
+ * The angular error is below 0.01 degrees.
+ */
+void    quantizeNormal(const Vec3f& normal, std::int16_t out[2]);
+
+}   // math
+}   // pg
@@ -151,6 +151,14 @@ Quaternion<T> operator*(T lhs, const Quaternion<T>& rhs) {
     return Quaternion<T>{ lhs*rhs.v.x, lhs*rhs.v.y, lhs*rhs.v.z, lhs*rhs.w };
 }
 
+// normalized linear interpolation along the shorter arc. Close to slerp for small angles, like
+// the rotation between two simulation steps.
+template<typename T>
+Quaternion<T> nlerp(const Quaternion<T>& a, const Quaternion<T>& b, T t) {
+    const T s = a.v.dot(b.v) + a.w*b.w < T(0.0) ? -t : t;
+    return Quaternion<T>{ a.v*(T(1.0) - t) + b.v*s, a.w*(T(1.0) - t) + b.w*s }.normalized();
+}
+
 using Quatf = Quaternion<float>;
 using Quatd = Quaternion<double>;
 
@@ -0,0 +1,97 @@
+#include "opengl/BufferArena.h"
+#include "opengl/StateCache.h"
+#include "utils/Assert.h"
+#include "utils/Log.h"
+#include <algorithm>
+
+namespace pg {
+namespace opengl {
+
+BufferArena::BufferArena(std::size_t initialBytes)
+    : object_{ 0u },
+    allocator_{ initialBytes } {
+    glGenBuffers(1, &object_);
+    StateCache& state = stateCache();
+    const GLuint last = state.buffer(GL_COPY_WRITE_BUFFER);
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, object_);
+    glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(initialBytes), nullptr, GL_STATIC_DRAW);
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, last);
+}
+
+BufferArena::~BufferArena() {
+    stateCache().deleteBuffer(object_);
+}
+
+BufferArena::Range BufferArena::allocate(std::size_t bytes, std::size_t alignment) {
+    PG_ASSERT(bytes != 0u);
+    std::size_t offset = allocator_.allocate(bytes, alignment);
+    if (offset == RangeAllocator::Invalid) {
+        // the padding of the new allocation is at most alignment - 1
+        grow_(std::max(allocator_.capacity() * 2u, allocator_.capacity() + bytes + alignment));
+        offset = allocator_.allocate(bytes, alignment);
+        PG_ASSERT(offset != RangeAllocator::Invalid);
+    }
+    return Range{ GLintptr(offset), GLsizeiptr(bytes) };
+}
+
+void BufferArena::free(const Range& range) {
+    allocator_.free(std::size_t(range.offset), std::size_t(range.size));
+}
+
+void BufferArena::upload(const Range& range, const void* data, std::size_t bytes) {
+    PG_ASSERT(GLsizeiptr(bytes) <= range.size);
+    StateCache& state = stateCache();
+    const GLuint last = state.buffer(GL_COPY_WRITE_BUFFER);
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, object_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, range.offset, GLsizeiptr(bytes), data);
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, last);
+}
+
+void BufferArena::download(const Range& range, void* data) const {
+    StateCache& state = stateCache();
+    const GLuint last = state.buffer(GL_COPY_READ_BUFFER);
+    state.bindBuffer(GL_COPY_READ_BUFFER, object_);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, range.offset, range.size, data);
+    state.bindBuffer(GL_COPY_READ_BUFFER, last);
+}
+
+GLuint BufferArena::object() const {
+    return object_;
+}
+
+std::size_t BufferArena::capacity() const {
+    return allocator_.capacity();
+}
+
+std::size_t BufferArena::used() const {
+    return allocator_.used();
+}
+
+void BufferArena::grow_(std::size_t capacity) {
+    const GLsizeiptr oldSize = GLsizeiptr(allocator_.capacity());
+    LOG_DEBUG << "Growing buffer arena " << object_ << " from " << oldSize << " to " << capacity << " bytes";
+    StateCache& state = stateCache();
+    const GLuint lastRead = state.buffer(GL_COPY_READ_BUFFER);
+    const GLuint lastWrite = state.buffer(GL_COPY_WRITE_BUFFER);
+
+    // respecifying the store loses the contents, so park them in a temporary buffer
+    GLuint temporary = 0u;
+    glGenBuffers(1, &temporary);
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, temporary);
+    glBufferData(GL_COPY_WRITE_BUFFER, oldSize, nullptr, GL_STREAM_COPY);
+    state.bindBuffer(GL_COPY_READ_BUFFER, object_);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, object_);
+    glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(capacity), nullptr, GL_STATIC_DRAW);
+    state.bindBuffer(GL_COPY_READ_BUFFER, temporary);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+
+    state.deleteBuffer(temporary);
+    state.bindBuffer(GL_COPY_READ_BUFFER, lastRead);
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, lastWrite);
+    allocator_.grow(capacity);
+}
+
+}   // opengl
+}   // pg
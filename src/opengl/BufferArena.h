@@ -0,0 +1,61 @@
+#pragma once
+
+#include "utils/RangeAllocator.h"
+#include <GL/glew.h>
+#include <cstdlib>
+
+namespace pg {
+namespace opengl {
+
+/**
+ * @class BufferArena
+ * @brief A single buffer object, suballocated into ranges.
+ *
+ * Many meshes live in one arena, so that they can be drawn with the same vertex array, and
+ * without rebinding buffers between draws. Only the bookkeeping is on the CPU side. Ranges are
+ * written and read with glBufferSubData and glGetBufferSubData through the copy targets, so the
+ * array and element buffer bindings aren't disturbed.
+ *
+ * When the arena runs out of space, it grows by doubling. The contents are copied out and back
+ * in, so the buffer object keeps its name, and vertex arrays which refer to it stay valid.
+ */
+class BufferArena {
+public:
+    struct Range {
+        GLintptr    offset{ 0 };    // in bytes
+        GLsizeiptr  size{ 0 };
+    };
+
+    explicit BufferArena(std::size_t initialBytes);
+    ~BufferArena();
+
+    BufferArena() = delete;
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+    BufferArena(BufferArena&&) = delete;
+    BufferArena& operator=(BufferArena&&) = delete;
+
+    /**
+     * @param alignment The offset of the range is a multiple of this, in bytes. Vertex ranges
+     * are aligned to the vertex size, so that the offset is a whole number of vertices.
+     */
+    Range       allocate(std::size_t bytes, std::size_t alignment);
+    void        free(const Range& range);
+    /// @brief Write bytes to the start of the range. The data must fit in the range.
+    void        upload(const Range& range, const void* data, std::size_t bytes);
+    /// @brief Read the whole range back. This waits for the GPU, so don't do it every frame.
+    void        download(const Range& range, void* data) const;
+
+    GLuint      object() const;
+    std::size_t capacity() const;
+    std::size_t used() const;
+
+private:
+    void        grow_(std::size_t capacity);
+
+    GLuint          object_{ 0u };
+    RangeAllocator  allocator_{};
+};
+
+}   // opengl
+}   // pg
@@ -1,5 +1,5 @@
 #include "opengl/BufferObject.h"
-#include "opengl/Enum.h"
+#include "opengl/StateCache.h"
 
 namespace pg {
 namespace opengl {
@@ -10,7 +10,7 @@ BufferObject::BufferObject(GLenum type)
 }
 
 BufferObject::~BufferObject() {
-    glDeleteBuffers(1, &object_);
+    stateCache().deleteBuffer(object_);
 }
 
 void BufferObject::dataStore(GLsizeiptr count, GLsizei elementSize, const GLvoid* data, int usage) {
@@ -32,12 +32,12 @@ void BufferObject::unmapBuffer() {
 }
 
 void BufferObject::bind() {
-    glGetIntegerv(GetBindingTarget(type_), &old_);
-    glBindBuffer(type_, object_);
+    old_ = stateCache().buffer(type_);
+    stateCache().bindBuffer(type_, object_);
 }
 
 void BufferObject::unbind() {
-    glBindBuffer(type_, old_);
+    stateCache().bindBuffer(type_, old_);
 }
 
 GLuint BufferObject::object() const {
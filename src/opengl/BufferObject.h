@@ -75,7 +75,7 @@ protected:
     GLuint      object_{ 0u };    // the OpenGL name of this object
     GLsizei     size_{ 0u };    // the size of the element, in bytes
     GLsizeiptr  count_{ 0u };   // the number of elements
-    GLint       old_{ 0u };
+    GLuint      old_{ 0u };     // the previously bound buffer, restored by unbind
 };
 
 }
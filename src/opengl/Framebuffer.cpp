@@ -1,4 +1,5 @@
 #include "opengl/Framebuffer.h"
+#include "opengl/StateCache.h"
 
 namespace pg {
 namespace opengl {
@@ -10,16 +11,16 @@ Framebuffer::Framebuffer()
 }
 
 Framebuffer::~Framebuffer() {
-    glDeleteFramebuffers(1, &object_);
+    stateCache().deleteFramebuffer(object_);
 }
 
 void Framebuffer::bind() {
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &old_);
-    glBindFramebuffer(GL_FRAMEBUFFER, object_);
+    old_ = stateCache().framebuffer();
+    stateCache().bindFramebuffer(object_);
 }
 
 void Framebuffer::unbind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, old_);
+    stateCache().bindFramebuffer(old_);
 }
 
 void Framebuffer::attach(const Texture& t, GLenum attachment) {
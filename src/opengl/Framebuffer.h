@@ -38,7 +38,7 @@ public:
     GLuint object() const;
 
 private:
-    GLint   old_;
+    GLuint  old_;
     GLuint  object_;
 };
 
@@ -1,4 +1,5 @@
 #include "opengl/Program.h"
+#include "opengl/StateCache.h"
 #include "utils/Assert.h"
 #include "utils/Exception.h"
 #include <iostream>
@@ -12,7 +13,7 @@ Program::Program(const std::vector<std::unique_ptr<Shader>>& shaders) {
 }
 
 Program::~Program() {
-    glDeleteProgram(object_);
+    stateCache().deleteProgram(object_);
     object_ = 0;
 }
 
@@ -87,19 +88,42 @@ GLuint Program::subroutineIndex(const GLchar* functionName, GLenum shaderType) c
     return index;
 }
 
+bool Program::bindUniformBlock(const GLchar* blockName, GLuint bindingPoint) const {
+    PG_ASSERT(blockName);
+    GLuint index = glGetUniformBlockIndex(object_, blockName);
+    if (index == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(object_, index, bindingPoint);
+    return true;
+}
+
+bool Program::bindSampler(const GLchar* samplerName, GLint unit) const {
+    PG_ASSERT(samplerName);
+    const GLint location = glGetUniformLocation(object_, samplerName);
+    if (location == -1) {
+        return false;
+    }
+    // uniforms are set on the program in use
+    StateCache& state = stateCache();
+    const GLuint lastProgram = state.program();
+    state.useProgram(object_);
+    glUniform1i(location, unit);
+    state.useProgram(lastProgram);
+    return true;
+}
+
 void Program::use() const {
-    glUseProgram(object_);
+    stateCache().useProgram(object_);
 }
 
 bool Program::isInUse() const {
-    GLint currentProgram = 0;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
-    return (currentProgram == (GLint)object_);
+    return stateCache().program() == object_;
 }
 
 void Program::stopUsing() const {
     PG_ASSERT(isInUse());
-    glUseProgram(0);
+    stateCache().useProgram(0u);
 }
 
 void Program::setUniform(const GLchar* name, GLint v0) const {
@@ -52,6 +52,17 @@ public:
 
     GLuint subroutineIndex(const GLchar* functionName, GLenum shaderType) const;
 
+    /**
+     * @brief Connect a uniform block of the program to a uniform buffer binding point.
+     * @return False, if the program has no active block with the given name.
+     */
+    bool bindUniformBlock(const GLchar* blockName, GLuint bindingPoint) const;
+    /**
+     * @brief Set the texture unit a sampler uniform of the program reads from.
+     * @return False, if the program has no active sampler with the given name.
+     */
+    bool bindSampler(const GLchar* samplerName, GLint unit) const;
+
     /// @brief Use this shader.
     void use() const;
     bool isInUse() const;
@@ -0,0 +1,330 @@
+#include "opengl/StateCache.h"
+#include "opengl/Enum.h"
+#include "utils/Assert.h"
+
+namespace {
+
+int bufferTargetIndex(GLenum target) {
+    switch (target) {
+    case GL_ARRAY_BUFFER:           return 0;
+    case GL_ELEMENT_ARRAY_BUFFER:   return 1;
+    case GL_UNIFORM_BUFFER:         return 2;
+    case GL_COPY_READ_BUFFER:       return 3;
+    case GL_COPY_WRITE_BUFFER:      return 4;
+    case GL_PIXEL_PACK_BUFFER:      return 5;
+    case GL_PIXEL_UNPACK_BUFFER:    return 6;
+    case GL_TEXTURE_BUFFER:         return 7;
+    case GL_DRAW_INDIRECT_BUFFER:   return 8;
+    default: return -1;
+    }
+}
+
+GLenum bufferBindingQuery(GLenum target) {
+    switch (target) {
+    // these are missing from GetBindingTarget
+    case GL_COPY_READ_BUFFER:       return GL_COPY_READ_BUFFER_BINDING;
+    case GL_COPY_WRITE_BUFFER:      return GL_COPY_WRITE_BUFFER_BINDING;
+    default: return pg::opengl::GetBindingTarget(target);
+    }
+}
+
+int textureTargetIndex(GLenum target) {
+    switch (target) {
+    case GL_TEXTURE_2D:         return 0;
+    case GL_TEXTURE_3D:         return 1;
+    case GL_TEXTURE_CUBE_MAP:   return 2;
+    case GL_TEXTURE_2D_ARRAY:   return 3;
+    case GL_TEXTURE_BUFFER:     return 4;
+    default: return -1;
+    }
+}
+
+int capabilityIndex(GLenum capability) {
+    switch (capability) {
+    case GL_BLEND:          return 0;
+    case GL_CULL_FACE:      return 1;
+    case GL_DEPTH_TEST:     return 2;
+    case GL_SCISSOR_TEST:   return 3;
+    case GL_STENCIL_TEST:   return 4;
+    default: return -1;
+    }
+}
+
+}
+
+namespace pg {
+namespace opengl {
+
+StateCache::StateCache() {
+    reset();
+}
+
+void StateCache::reset() {
+    program_ = Unknown;
+    vertexArray_ = Unknown;
+    for (GLuint& buffer : buffers_) {
+        buffer = Unknown;
+    }
+    for (Range& range : uniformRanges_) {
+        range = Range{};
+    }
+    activeTexture_ = Unknown;
+    for (auto& unit : textures_) {
+        for (GLuint& texture : unit) {
+            texture = Unknown;
+        }
+    }
+    framebuffer_ = Unknown;
+    for (GLuint& capability : capabilities_) {
+        capability = Unknown;
+    }
+    blendSource_ = Unknown;
+    blendDestination_ = Unknown;
+    blendEquation_ = Unknown;
+}
+
+void StateCache::useProgram(GLuint program) {
+    if (update_(program_, program)) {
+        glUseProgram(program);
+    }
+}
+
+void StateCache::bindVertexArray(GLuint array) {
+    if (update_(vertexArray_, array)) {
+        glBindVertexArray(array);
+        // the element array binding is part of the vertex array state
+        buffers_[bufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+    }
+}
+
+void StateCache::bindBuffer(GLenum target, GLuint buffer) {
+    const int index = bufferTargetIndex(target);
+    if (index < 0) {
+        counters_.calls++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (update_(buffers_[index], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void StateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    counters_.calls++;
+    if (target == GL_UNIFORM_BUFFER && index < GLuint(UniformBindingCount)) {
+        Range& range = uniformRanges_[index];
+        if (range.buffer == buffer && range.offset == offset && range.size == size) {
+            counters_.elided++;
+            return;
+        }
+        range = Range{ buffer, offset, size };
+    }
+    glBindBufferRange(target, index, buffer, offset, size);
+    const int targetIndex = bufferTargetIndex(target);
+    if (targetIndex >= 0) {
+        buffers_[targetIndex] = buffer;
+    }
+}
+
+void StateCache::activeTexture(GLenum unit) {
+    PG_ASSERT(unit >= GL_TEXTURE0 && unit < GL_TEXTURE0 + TextureUnitCount);
+    if (update_(activeTexture_, unit)) {
+        glActiveTexture(unit);
+    }
+}
+
+void StateCache::bindTexture(GLenum target, GLuint texture) {
+    GLuint* slot = textureSlot_(target);
+    if (!slot) {
+        counters_.calls++;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (update_(*slot, texture)) {
+        glBindTexture(target, texture);
+    }
+}
+
+void StateCache::bindFramebuffer(GLuint framebuffer) {
+    if (update_(framebuffer_, framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void StateCache::setEnabled(GLenum capability, bool enabled) {
+    const int index = capabilityIndex(capability);
+    if (index >= 0 && !update_(capabilities_[index], enabled ? GL_TRUE : GL_FALSE)) {
+        return;
+    }
+    if (index < 0) {
+        counters_.calls++;
+    }
+    if (enabled) {
+        glEnable(capability);
+    }
+    else {
+        glDisable(capability);
+    }
+}
+
+void StateCache::blendFunc(GLenum source, GLenum destination) {
+    counters_.calls++;
+    if (blendSource_ == source && blendDestination_ == destination) {
+        counters_.elided++;
+        return;
+    }
+    blendSource_ = source;
+    blendDestination_ = destination;
+    glBlendFunc(source, destination);
+}
+
+void StateCache::blendEquation(GLenum mode) {
+    if (update_(blendEquation_, mode)) {
+        glBlendEquation(mode);
+    }
+}
+
+GLuint StateCache::program() {
+    return query_(program_, GL_CURRENT_PROGRAM);
+}
+
+GLuint StateCache::vertexArray() {
+    return query_(vertexArray_, GL_VERTEX_ARRAY_BINDING);
+}
+
+GLuint StateCache::buffer(GLenum target) {
+    const int index = bufferTargetIndex(target);
+    PG_ASSERT(index >= 0);
+    return query_(buffers_[index], bufferBindingQuery(target));
+}
+
+GLenum StateCache::activeTexture() {
+    return query_(activeTexture_, GL_ACTIVE_TEXTURE);
+}
+
+GLuint StateCache::texture(GLenum target) {
+    GLuint* slot = textureSlot_(target);
+    PG_ASSERT(slot);
+    return query_(*slot, GetBindingTarget(target));
+}
+
+GLuint StateCache::framebuffer() {
+    return query_(framebuffer_, GL_FRAMEBUFFER_BINDING);
+}
+
+bool StateCache::isEnabled(GLenum capability) {
+    const int index = capabilityIndex(capability);
+    PG_ASSERT(index >= 0);
+    GLuint& shadow = capabilities_[index];
+    if (shadow == Unknown) {
+        counters_.queries++;
+        shadow = glIsEnabled(capability);
+    }
+    return shadow == GL_TRUE;
+}
+
+GLenum StateCache::blendSource() {
+    return query_(blendSource_, GL_BLEND_SRC_RGB);
+}
+
+GLenum StateCache::blendDestination() {
+    return query_(blendDestination_, GL_BLEND_DST_RGB);
+}
+
+GLenum StateCache::blendEquation() {
+    return query_(blendEquation_, GL_BLEND_EQUATION_RGB);
+}
+
+void StateCache::deleteProgram(GLuint program) {
+    if (program_ == program) {
+        program_ = 0u;
+    }
+    glDeleteProgram(program);
+}
+
+void StateCache::deleteVertexArray(GLuint array) {
+    if (vertexArray_ == array) {
+        vertexArray_ = 0u;
+        buffers_[bufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+    }
+    glDeleteVertexArrays(1, &array);
+}
+
+void StateCache::deleteBuffer(GLuint buffer) {
+    // deleting a bound buffer reverts the binding to zero
+    for (GLuint& binding : buffers_) {
+        if (binding == buffer) {
+            binding = 0u;
+        }
+    }
+    for (Range& range : uniformRanges_) {
+        if (range.buffer == buffer) {
+            range = Range{};
+        }
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void StateCache::deleteTexture(GLuint texture) {
+    for (auto& unit : textures_) {
+        for (GLuint& binding : unit) {
+            if (binding == texture) {
+                binding = 0u;
+            }
+        }
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void StateCache::deleteFramebuffer(GLuint framebuffer) {
+    if (framebuffer_ == framebuffer) {
+        framebuffer_ = 0u;
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+const StateCache::Counters& StateCache::counters() const {
+    return counters_;
+}
+
+void StateCache::resetCounters() {
+    counters_ = Counters{};
+}
+
+bool StateCache::update_(GLuint& shadow, GLuint value) {
+    counters_.calls++;
+    if (shadow == value) {
+        counters_.elided++;
+        return false;
+    }
+    shadow = value;
+    return true;
+}
+
+GLuint StateCache::query_(GLuint& shadow, GLenum binding) {
+    if (shadow == Unknown) {
+        counters_.queries++;
+        GLint value = 0;
+        glGetIntegerv(binding, &value);
+        shadow = GLuint(value);
+    }
+    return shadow;
+}
+
+GLuint* StateCache::textureSlot_(GLenum target) {
+    const int index = textureTargetIndex(target);
+    if (index < 0) {
+        return nullptr;
+    }
+    const GLuint unit = activeTexture() - GL_TEXTURE0;
+    PG_ASSERT(unit < GLuint(TextureUnitCount));
+    return &textures_[unit][index];
+}
+
+StateCache& stateCache() {
+    static StateCache cache{};
+    return cache;
+}
+
+}   // opengl
+}   // pg
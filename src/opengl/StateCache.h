@@ -0,0 +1,111 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+
+namespace pg {
+namespace opengl {
+
+/**
+ * @class StateCache
+ * @brief A shadow copy of the OpenGL binding and capability state.
+ *
+ * All wrappers bind objects and toggle state through the cache. A call is only forwarded to
+ * OpenGL if it changes the shadowed state, and state queries are answered from the shadow
+ * instead of with glGet*, which can stall the driver.
+ *
+ * Objects must be deleted through the cache as well, so that a recycled object name isn't
+ * mistaken for the one which is still bound. State which is not known (after reset(), or for
+ * GL_ELEMENT_ARRAY_BUFFER after a vertex array change) is queried from OpenGL on demand.
+ */
+class StateCache {
+public:
+    struct Counters {
+        std::uint64_t   calls{ 0u };    // calls which went through the cache
+        std::uint64_t   elided{ 0u };   // calls which were redundant, and not forwarded
+        std::uint64_t   queries{ 0u };  // glGet* calls, made when the shadowed state was unknown
+    };
+
+    StateCache();
+    ~StateCache() = default;
+
+    StateCache(const StateCache&) = delete;
+    StateCache& operator=(const StateCache&) = delete;
+
+    /**
+     * @brief Forget all the shadowed state.
+     * Call this after creating the context, or after code which changes state behind the cache's back.
+     */
+    void    reset();
+
+    void    useProgram(GLuint program);
+    void    bindVertexArray(GLuint array);
+    void    bindBuffer(GLenum target, GLuint buffer);
+    /// @brief glBindBufferRange, which also binds the buffer to the generic target.
+    void    bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void    activeTexture(GLenum unit);
+    /// @brief Bind a texture to the active texture unit.
+    void    bindTexture(GLenum target, GLuint texture);
+    void    bindFramebuffer(GLuint framebuffer);
+    void    setEnabled(GLenum capability, bool enabled);
+    void    blendFunc(GLenum source, GLenum destination);
+    void    blendEquation(GLenum mode);
+
+    GLuint  program();
+    GLuint  vertexArray();
+    GLuint  buffer(GLenum target);
+    GLenum  activeTexture();
+    GLuint  texture(GLenum target);
+    GLuint  framebuffer();
+    bool    isEnabled(GLenum capability);
+    GLenum  blendSource();
+    GLenum  blendDestination();
+    GLenum  blendEquation();
+
+    void    deleteProgram(GLuint program);
+    void    deleteVertexArray(GLuint array);
+    void    deleteBuffer(GLuint buffer);
+    void    deleteTexture(GLuint texture);
+    void    deleteFramebuffer(GLuint framebuffer);
+
+    const Counters& counters() const;
+    void    resetCounters();
+
+private:
+    static const GLuint Unknown = 0xffffffffu;
+    static const int BufferTargetCount = 9;
+    static const int TextureTargetCount = 5;
+    static const int TextureUnitCount = 16;
+    static const int CapabilityCount = 5;
+    static const int UniformBindingCount = 8;
+
+    struct Range {
+        GLuint      buffer{ Unknown };
+        GLintptr    offset{ 0 };
+        GLsizeiptr  size{ 0 };
+    };
+
+    // returns true, if the call needs to be forwarded to OpenGL
+    bool    update_(GLuint& shadow, GLuint value);
+    GLuint  query_(GLuint& shadow, GLenum binding);
+    GLuint* textureSlot_(GLenum target);
+
+    Counters    counters_{};
+    GLuint      program_{ Unknown };
+    GLuint      vertexArray_{ Unknown };
+    GLuint      buffers_[BufferTargetCount];
+    Range       uniformRanges_[UniformBindingCount];
+    GLuint      activeTexture_{ Unknown };
+    GLuint      textures_[TextureUnitCount][TextureTargetCount];
+    GLuint      framebuffer_{ Unknown };
+    GLuint      capabilities_[CapabilityCount];    // GL_TRUE, GL_FALSE, or Unknown
+    GLuint      blendSource_{ Unknown };
+    GLuint      blendDestination_{ Unknown };
+    GLuint      blendEquation_{ Unknown };
+};
+
+/// @brief Get the state cache of the (single) OpenGL context.
+StateCache& stateCache();
+
+}   // opengl
+}   // pg
@@ -0,0 +1,179 @@
+#include "opengl/StreamBuffer.h"
+#include "opengl/StateCache.h"
+#include "utils/Assert.h"
+#include "utils/Log.h"
+#include <utility>
+
+namespace {
+
+// all regions start at a multiple of this, which covers any uniform buffer offset alignment
+const std::size_t RegionAlignment = 256u;
+const GLuint64 WaitTimeout = 1000000u;    // one millisecond, in nanoseconds
+
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1u) / alignment * alignment;
+}
+
+}
+
+namespace pg {
+namespace opengl {
+
+StreamBuffer::StreamBuffer(std::size_t bytesPerFrame)
+    : persistent_{ GLEW_ARB_buffer_storage && GLEW_ARB_sync },
+    object_{ 0u },
+    regionSize_{ 0u },
+    region_{ 0 },
+    head_{ 0u },
+    mapped_{ nullptr },
+    staging_{},
+    fences_{},
+    retired_{},
+    bytesUsed_{ 0u },
+    frameBytes_{ 0u },
+    waitCount_{ 0u } {
+    create_(bytesPerFrame);
+    LOG_DEBUG << "StreamBuffer: " << (persistent_ ? "persistent mapping" : "orphaning") << ", " << regionSize_ << " bytes per frame";
+}
+
+StreamBuffer::~StreamBuffer() {
+    retire_();
+    for (Retired& r : retired_) {
+        stateCache().deleteBuffer(r.object);
+    }
+    for (GLsync& fence : fences_) {
+        if (fence) {
+            glDeleteSync(fence);
+        }
+    }
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(std::size_t bytes, std::size_t alignment) {
+    PG_ASSERT(alignment != 0u);
+    const std::size_t base = regionBase_();
+    std::size_t start = alignUp(base + head_, alignment) - base;
+    if (start + bytes > regionSize_) {
+        grow_(start + bytes);
+        start = 0u;
+    }
+    head_ = start + bytes;
+    frameBytes_ += bytes;
+    char* data = persistent_ ? mapped_ + base + start : staging_.data() + start;
+    return Allocation{ data, object_, GLintptr(base + start), GLsizeiptr(bytes) };
+}
+
+void StreamBuffer::flush(const Allocation& allocation) {
+    if (persistent_ || allocation.size == 0) {
+        // coherent mapping, the writes are already visible
+        return;
+    }
+    stateCache().bindBuffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset, allocation.size, allocation.data);
+    stateCache().bindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+}
+
+void StreamBuffer::endFrame() {
+    if (persistent_) {
+        if (fences_[region_]) {
+            glDeleteSync(fences_[region_]);
+        }
+        fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region_ = (region_ + 1) % FrameCount;
+        GLsync& fence = fences_[region_];
+        if (fence) {
+            GLenum result = glClientWaitSync(fence, 0, 0u);
+            if (result == GL_TIMEOUT_EXPIRED) {
+                waitCount_++;
+                while (result == GL_TIMEOUT_EXPIRED) {
+                    result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WaitTimeout);
+                }
+            }
+            PG_ASSERT(result != GL_WAIT_FAILED);
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+    else {
+        // orphan the storage, the driver hands us a fresh block while the old one is in use
+        stateCache().bindBuffer(GL_COPY_WRITE_BUFFER, object_);
+        glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(regionSize_), NULL, GL_STREAM_DRAW);
+        stateCache().bindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+    }
+    for (Retired& r : retired_) {
+        // the storage lives on until the GPU is done with it
+        stateCache().deleteBuffer(r.object);
+    }
+    retired_.clear();
+    head_ = 0u;
+    bytesUsed_ = frameBytes_;
+    frameBytes_ = 0u;
+}
+
+bool StreamBuffer::isPersistent() const {
+    return persistent_;
+}
+
+std::size_t StreamBuffer::bytesPerFrame() const {
+    return regionSize_;
+}
+
+std::size_t StreamBuffer::bytesUsed() const {
+    return bytesUsed_;
+}
+
+std::size_t StreamBuffer::waitCount() const {
+    return waitCount_;
+}
+
+void StreamBuffer::create_(std::size_t regionSize) {
+    regionSize_ = alignUp(regionSize, RegionAlignment);
+    region_ = 0;
+    head_ = 0u;
+    glGenBuffers(1, &object_);
+    PG_ASSERT(object_ != 0u);
+    stateCache().bindBuffer(GL_COPY_WRITE_BUFFER, object_);
+    if (persistent_) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr size = GLsizeiptr(regionSize_ * FrameCount);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+        mapped_ = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+        PG_ASSERT(mapped_ != nullptr);
+    }
+    else {
+        glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(regionSize_), NULL, GL_STREAM_DRAW);
+        staging_.resize(regionSize_);
+    }
+    stateCache().bindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+}
+
+void StreamBuffer::retire_() {
+    // persistently mapped buffers are unmapped implicitly when deleted
+    retired_.push_back(Retired{ object_, std::move(staging_) });
+    staging_ = std::vector<char>{};
+    object_ = 0u;
+    mapped_ = nullptr;
+    for (GLsync& fence : fences_) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+}
+
+void StreamBuffer::grow_(std::size_t bytes) {
+    // allocations already made this frame keep pointing into the retired buffer
+    std::size_t size = regionSize_ * 2u;
+    while (size < bytes) {
+        size *= 2u;
+    }
+    LOG_DEBUG << "StreamBuffer: growing to " << size << " bytes per frame";
+    retire_();
+    create_(size);
+}
+
+std::size_t StreamBuffer::regionBase_() const {
+    return persistent_ ? regionSize_ * std::size_t(region_) : 0u;
+}
+
+}   // opengl
+}   // pg
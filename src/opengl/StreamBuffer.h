@@ -0,0 +1,98 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include <cstdlib>
+
+namespace pg {
+namespace opengl {
+
+/**
+ * @class StreamBuffer
+ * @brief A ring buffer for vertex, index and uniform data which is rewritten every frame.
+ *
+ * The buffer is split into FrameCount regions. Each frame allocates linearly from its own region,
+ * and a fence is placed at the end of the frame, so that the CPU never writes into a region the
+ * GPU may still be reading from.
+ *
+ * If ARB_buffer_storage is available, the buffer is mapped persistently and coherently once, and
+ * allocations point directly into buffer memory. Otherwise, allocations point into a staging copy,
+ * which flush() uploads, and the buffer is orphaned at the end of each frame.
+ *
+ * The buffer grows when a frame runs out of space, so there is no upper limit on the amount of
+ * data streamed per frame. Allocations made earlier in the frame remain valid until endFrame().
+ */
+class StreamBuffer {
+public:
+    static const int FrameCount = 3;
+
+    struct Allocation {
+        void*       data;
+        GLuint      buffer;     // bind this buffer object to the target when drawing
+        GLintptr    offset;     // in bytes, from the start of the buffer object
+        GLsizeiptr  size;
+    };
+
+    /**
+     * @param bytesPerFrame The initial size of a single frame's region.
+     */
+    explicit StreamBuffer(std::size_t bytesPerFrame);
+    ~StreamBuffer();
+
+    StreamBuffer() = delete;
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+    StreamBuffer(StreamBuffer&&) = delete;
+    StreamBuffer& operator=(StreamBuffer&&) = delete;
+
+    /**
+     * @brief Allocate writable memory for this frame.
+     * @param alignment The offset of the allocation in the buffer object will be a multiple of this.
+     */
+    Allocation  allocate(std::size_t bytes, std::size_t alignment = 16u);
+    /**
+     * @brief Make the data written to the allocation visible to OpenGL.
+     * This must be called after writing, before the allocation is used in a draw call.
+     */
+    void        flush(const Allocation&);
+    /**
+     * @brief Fence the current region, and move on to the next one.
+     * This may block, if the GPU is more than FrameCount frames behind.
+     */
+    void        endFrame();
+
+    bool        isPersistent() const;
+    std::size_t bytesPerFrame() const;
+    // the number of bytes allocated during the previous frame
+    std::size_t bytesUsed() const;
+    // the number of times endFrame() had to wait for the GPU
+    std::size_t waitCount() const;
+
+private:
+    void        create_(std::size_t regionSize);
+    void        retire_();
+    void        grow_(std::size_t bytes);
+    std::size_t regionBase_() const;
+
+    struct Retired {
+        GLuint              object;
+        std::vector<char>   staging;
+    };
+
+    const bool          persistent_;
+    GLuint              object_;
+    std::size_t         regionSize_;
+    int                 region_;
+    std::size_t         head_;      // the next free byte in the current region
+    char*               mapped_;
+    std::vector<char>   staging_;   // only used without persistent mapping
+    GLsync              fences_[FrameCount];
+    // buffers which ran out of space during this frame, deleted at the end of the frame
+    std::vector<Retired> retired_;
+    std::size_t         bytesUsed_;
+    std::size_t         frameBytes_;
+    std::size_t         waitCount_;
+};
+
+}   // opengl
+}   // pg
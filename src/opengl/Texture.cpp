@@ -1,6 +1,6 @@
 #include "opengl/Texture.h"
 #include "opengl/BufferObject.h"
-#include "opengl/Enum.h"
+#include "opengl/StateCache.h"
 
 namespace pg {
 namespace opengl {
@@ -13,7 +13,7 @@ Texture::Texture(GLenum type)
 }
 
 Texture::~Texture() {
-    glDeleteTextures(1, &object_);
+    stateCache().deleteTexture(object_);
 }
 
 void Texture::setStore(GLenum internalFormat, const BufferObject& object) {
@@ -36,12 +36,12 @@ void Texture::allocateStore(GLenum internalFormat, uint32_t width, uint32_t heig
 }
 
 void Texture::bind() {
-    glGetIntegerv(GetBindingTarget(type_), &old_);
-    glBindTexture(type_, object_);
+    old_ = stateCache().texture(type_);
+    stateCache().bindTexture(type_, object_);
 }
 
 void Texture::unbind() {
-    glBindTexture(type_, old_);
+    stateCache().bindTexture(type_, old_);
 }
 
 GLuint Texture::object() const {
@@ -34,7 +34,7 @@ public:
 
 private:
     GLuint      object_;
-    GLint       old_;
+    GLuint      old_;
     GLenum      type_;
 };
 
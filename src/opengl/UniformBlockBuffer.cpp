@@ -0,0 +1,44 @@
+#include "opengl/UniformBlockBuffer.h"
+#include "opengl/StateCache.h"
+
+namespace pg {
+namespace opengl {
+
+UniformBlockBuffer::UniformBlockBuffer(StreamBuffer& stream, BlockBinding binding, std::size_t blockSize)
+    : stream_{ stream },
+    allocation_{},
+    binding_{ GLuint(binding) },
+    blockSize_{ blockSize },
+    stride_{ blockSize },
+    alignment_{ 16u },
+    count_{ 0u } {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0) {
+        alignment_ = std::size_t(alignment);
+        stride_ = (blockSize_ + alignment_ - 1u) / alignment_ * alignment_;
+    }
+}
+
+void UniformBlockBuffer::allocate(std::size_t count) {
+    allocation_ = stream_.allocate(count * stride_, alignment_);
+    count_ = count;
+}
+
+void UniformBlockBuffer::flush() {
+    stream_.flush(allocation_);
+}
+
+void UniformBlockBuffer::bind(std::size_t i) const {
+    PG_ASSERT(i < count_);
+    stateCache().bindBufferRange(
+        GL_UNIFORM_BUFFER,
+        binding_,
+        allocation_.buffer,
+        allocation_.offset + GLintptr(i * stride_),
+        GLsizeiptr(blockSize_)
+    );
+}
+
+}   // opengl
+}   // pg
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "opengl/StreamBuffer.h"
+#include "opengl/UniformBlocks.h"
+#include "utils/Assert.h"
+#include <GL/glew.h>
+#include <cstdlib>
+
+namespace pg {
+namespace opengl {
+
+/**
+ * @class UniformBlockBuffer
+ * @brief An array of uniform blocks of the same type, streamed through a StreamBuffer.
+ *
+ * The blocks are written in one go between allocate() and flush(), and each block
+ * can then be bound to the binding point for a draw call. The blocks are padded to
+ * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, as required by glBindBufferRange.
+ */
+class UniformBlockBuffer {
+public:
+    UniformBlockBuffer(StreamBuffer& stream, BlockBinding binding, std::size_t blockSize);
+    ~UniformBlockBuffer() = default;
+
+    UniformBlockBuffer() = delete;
+    UniformBlockBuffer(const UniformBlockBuffer&) = delete;
+    UniformBlockBuffer& operator=(const UniformBlockBuffer&) = delete;
+
+    /// @brief Allocate this frame's storage for count blocks.
+    void    allocate(std::size_t count);
+    /// @brief Make the written blocks visible to OpenGL.
+    void    flush();
+
+    /// @brief Get the i:th block of the current allocation.
+    template<typename T>
+    T& block(std::size_t i) {
+        PG_ASSERT(sizeof(T) == blockSize_);
+        PG_ASSERT(i < count_);
+        return *reinterpret_cast<T*>(static_cast<char*>(allocation_.data) + i * stride_);
+    }
+
+    /// @brief Get the first block of the current allocation. Block i starts at data() + i * stride().
+    inline char* data() {
+        return static_cast<char*>(allocation_.data);
+    }
+
+    inline std::size_t stride() const {
+        return stride_;
+    }
+
+    /// @brief Bind the i:th block to the binding point.
+    void    bind(std::size_t i) const;
+
+private:
+    StreamBuffer&               stream_;
+    StreamBuffer::Allocation    allocation_;
+    GLuint                      binding_;
+    std::size_t                 blockSize_;
+    std::size_t                 stride_;
+    std::size_t                 alignment_;
+    std::size_t                 count_;
+};
+
+}   // opengl
+}   // pg
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "math/Matrix.h"
+#include "math/Vector.h"
+#include <GL/glew.h>
+#include <cstdint>
+
+namespace pg {
+namespace opengl {
+
+/// @brief The uniform buffer binding points shared by all programs.
+/// ShaderManager connects the blocks of each program to these points when the program is compiled.
+enum class BlockBinding : GLuint {
+    Frame = 0u,     // FrameBlock, written once per frame
+    Object = 1u     // ObjectBlock, one per draw call
+};
+
+/// @brief The texture units of the buffer textures shared by all programs.
+/// ShaderManager connects the samplers of each program to these units when the program is compiled.
+enum class TextureUnit : GLint {
+    LightData = 1,      // samplerBuffer, two texels per light: the position and radius, the intensity and attenuation
+    LightClusters = 2,  // usamplerBuffer, the offset and count of each cluster's lights in LightIndices
+    LightIndices = 3    // usamplerBuffer
+};
+
+/*
+ * The following structs mirror the std140 layout of the uniform blocks declared in the
+ * shaders. The blocks are declared row_major, so that Matrix4f can be copied in directly.
+ **/
+
+struct FrameBlock {
+    math::Matrix4f  camera;     // projection * view
+    math::Matrix4f  screen;     // from window pixel coordinates to clip space
+    math::Vec3f     cameraPosition;
+    float           ambientCoefficient;     // the average of the point lights'
+    math::Vec3f     cameraForward;
+    float           pad0_;
+    // x, y: clusters per pixel. z, w: the scale and bias which map log(depth) to a slice, see math::ClusterGrid
+    math::Vec4f     clusterScale;
+    std::int32_t    clusterCounts[4];       // the last one is padding
+};
+
+struct ObjectBlock {
+    math::Matrix4f  model;
+    math::Vec3f     base;
+    float           shininess;
+    math::Vec3f     ambient;
+    float           pad0_;
+    math::Vec3f     specularColor;
+    float           pad1_;
+};
+
+static_assert(sizeof(FrameBlock) == 192u, "FrameBlock doesn't match the std140 layout");
+static_assert(sizeof(ObjectBlock) == 112u, "ObjectBlock doesn't match the std140 layout");
+
+}   // opengl
+}   // pg
@@ -1,5 +1,7 @@
 #include "VertexAttributes.h"
+#include "opengl/StateCache.h"
 #include <vector>
+#include <cstdint>
 
 namespace {
 
@@ -8,6 +10,8 @@ int attributeTypeToGlType(pg::opengl::AttributeType type) {
     case pg::opengl::AttributeType::Float: return GL_FLOAT;
     case pg::opengl::AttributeType::Int:   return GL_INT;
     case pg::opengl::AttributeType::Ubyte: return GL_UNSIGNED_BYTE;
+    case pg::opengl::AttributeType::Short: return GL_SHORT;
+    case pg::opengl::AttributeType::Ushort: return GL_UNSIGNED_SHORT;
     default: PG_ASSERT(false); return 0u;
     }
 }
@@ -17,26 +21,62 @@ unsigned int attributeTypeInBytes(pg::opengl::AttributeType type) {
     case pg::opengl::AttributeType::Float:  return 4u;
     case pg::opengl::AttributeType::Int:    return 4u;
     case pg::opengl::AttributeType::Ubyte:  return 1u;
+    case pg::opengl::AttributeType::Short:  return 2u;
+    case pg::opengl::AttributeType::Ushort: return 2u;
     default: PG_ASSERT(false); return 0u;
     }
 }
 
+// specify the attributes as interleaved in the bound array buffer, and return the elements per vertex
+unsigned attributePointers(std::initializer_list<pg::opengl::Attribute> attribs, GLuint divisor) {
+    unsigned int bytes = 0u;
+    unsigned elements = 0u;
+    std::vector<unsigned int> offsets;
+    offsets.reserve(attribs.size());
+    for (const auto& attrib : attribs) {
+        offsets.push_back(bytes);
+        bytes += attrib.byteCount();
+        elements += attrib.elementCount();
+    }
+    int i = 0;
+    for (const auto& attrib : attribs) {
+        if (attrib.isUsed()) {
+            glVertexAttribPointer(
+                GLuint(attrib.index()),
+                attrib.elementCount(),
+                attributeTypeToGlType(attrib.type()),
+                attrib.isNormalized() ? GL_TRUE : GL_FALSE,
+                bytes,
+                (const void*)std::uintptr_t(offsets[i])
+            );
+            glEnableVertexAttribArray(attrib.index());
+            if (divisor != 0u) {
+                glVertexAttribDivisor(attrib.index(), divisor);
+            }
+        }
+        ++i;
+    }
+    return elements;
+}
+
 }
 
 namespace pg {
 namespace opengl {
 
-Attribute::Attribute(unsigned int index, AttributeType type, unsigned int attribCount)
+Attribute::Attribute(unsigned int index, AttributeType type, unsigned int attribCount, bool normalized)
     :   isUsed_(true),
         index_(index),
         type_(type),
-        elementCount_(attribCount) {}
+        elementCount_(attribCount),
+        isNormalized_(normalized) {}
 
 Attribute::Attribute(AttributeType type, unsigned int attribCount)
     :   isUsed_(false),
         index_(0u),
         type_(type),
-        elementCount_(attribCount) {}
+        elementCount_(attribCount),
+        isNormalized_(false) {}
 
 unsigned int Attribute::byteCount() const {
     return elementCount_ * attributeTypeInBytes(type_);
@@ -54,28 +94,7 @@ VertexAttributes::VertexAttributes(std::initializer_list<Attribute> attribs)
     glGenVertexArrays(1, &object_);
     PG_ASSERT(object_ != 0u);
     bind();
-    unsigned int bytes = 0u;
-    std::vector<unsigned int> offsets(attribs.size());
-    for (const auto& attrib : attribs) {
-        offsets.push_back(bytes);
-        bytes += attrib.byteCount();
-        elementsPerIndex_ += attrib.elementCount();
-    }
-    int i = 0;
-    for (const auto& attrib : attribs) {
-        if (attrib.isUsed()) {
-            glVertexAttribPointer(
-                GLuint(attrib.index()),
-                attrib.elementCount(),
-                attributeTypeToGlType(attrib.type()),
-                GL_FALSE,
-                bytes,
-                (const void*)offsets[i]
-            );
-            glEnableVertexAttribArray(attrib.index());
-        }
-        ++i;
-    }
+    elementsPerIndex_ = attributePointers(attribs, 0u);
     unbind();
 }
 
@@ -128,12 +147,28 @@ VertexAttributes::~VertexAttributes() {
 }
 
 void VertexAttributes::bind() {
-    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousObject_);
-    glBindVertexArray(object_);
+    previousObject_ = stateCache().vertexArray();
+    stateCache().bindVertexArray(object_);
 }
 
 void VertexAttributes::unbind() {
-    glBindVertexArray(previousObject_);
+    stateCache().bindVertexArray(previousObject_);
+}
+
+void VertexAttributes::attachIndices(GLuint indices) {
+    bind();
+    // the binding is recorded in the vertex array, so it is not restored before unbinding
+    stateCache().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
+    unbind();
+}
+
+void VertexAttributes::attachInstanceAttributes(GLuint buffer, std::initializer_list<Attribute> attributes) {
+    bind();
+    const GLuint lastBuffer = stateCache().buffer(GL_ARRAY_BUFFER);
+    stateCache().bindBuffer(GL_ARRAY_BUFFER, buffer);
+    attributePointers(attributes, 1u);
+    stateCache().bindBuffer(GL_ARRAY_BUFFER, lastBuffer);
+    unbind();
 }
 
 void VertexAttributes::retain_() {
@@ -145,7 +180,7 @@ void VertexAttributes::release_() {
     if (refCount_) {
         *refCount_ -= 1u;
         if (*refCount_ == 0u) {
-            glDeleteVertexArrays(1, &object_);
+            stateCache().deleteVertexArray(object_);
             delete refCount_;
             refCount_ = nullptr;
         }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "opengl/BufferObject.h"
 #include "utils/Assert.h"
 #include "GL/glew.h"
 #include <initializer_list>
@@ -10,7 +11,9 @@ namespace opengl {
 enum class AttributeType {
     Float,
     Int,
-    Ubyte
+    Ubyte,
+    Short,
+    Ushort
 };
 
 class VertexAttributes;
@@ -26,7 +29,9 @@ public:
     /// @param index The index of the generic vertex attribute (the location in glsl).
     /// @param type The type of the attribute
     /// @param elementCount The number of elements of type type contained in the attribute
-    Attribute(unsigned int index, AttributeType type, unsigned int elementCount);
+    /// @param normalized Whether integer types are mapped to [-1, 1] or [0, 1] in the shader,
+    /// instead of being converted directly to float.
+    Attribute(unsigned int index, AttributeType type, unsigned int elementCount, bool normalized = false);
     /// Use this constructor if the segment of the buffer contains data that isn't used in an attribute.
     Attribute(AttributeType type, unsigned int elementCount);
 
@@ -49,11 +54,16 @@ public:
         return type_;
     }
 
+    inline bool isNormalized() const {
+        return isNormalized_;
+    }
+
 private:
     const bool            isUsed_;
     const unsigned int    index_;
     const AttributeType   type_;
     const unsigned int    elementCount_;
+    const bool            isNormalized_;
 };
 
 /// This class describes the content of an entire vertex buffer. It must be constructed
@@ -75,17 +85,28 @@ public:
     void bind();
     void unbind();
 
+    /// Make the element buffer part of the vertex array state, for indexed draws.
+    void attachIndices(GLuint indices);
+    /// Add attributes which advance once per instance instead of once per vertex, read from
+    /// the buffer. The attributes are interleaved in the buffer, like in the constructor.
+    void attachInstanceAttributes(GLuint buffer, std::initializer_list<Attribute> attributes);
+
     inline unsigned elementsPerIndex() const {
         return elementsPerIndex_;
     }
 
+    /// @brief Get the vertex array object name.
+    inline GLuint object() const {
+        return object_;
+    }
+
 private:
     void retain_();
     void release_();
 
     unsigned*   refCount_{ nullptr };
     GLuint      object_{ 0u };
-    GLint       previousObject_{ 0u };
+    GLuint      previousObject_{ 0u };
     unsigned    elementsPerIndex_{ 0u };
 };
 
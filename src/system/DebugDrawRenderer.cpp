@@ -3,6 +3,7 @@
 #include "utils/Assert.h"
 #include "utils/Log.h"
 #include "math/Matrix.h"
+#include "opengl/StateCache.h"
 
 #define DEBUG_DRAW_IMPLEMENTATION
 #define DEBUG_DRAW_MAT4X4_TYPE_DEFINED pg::math::Matrix4f4
@@ -173,78 +174,104 @@ namespace pg {
 //
 
 void DebugDrawRenderer::drawPointList(const dd::DrawVertex * points, int count, bool depthEnabled)
+{
+    record(ListType::Points, points, count, depthEnabled, nullptr);
+}
+
+void DebugDrawRenderer::drawLineList(const dd::DrawVertex * lines, int count, bool depthEnabled)
+{
+    record(ListType::Lines, lines, count, depthEnabled, nullptr);
+}
+
+void DebugDrawRenderer::drawGlyphList(const dd::DrawVertex * glyphs, int count, dd::GlyphTextureHandle glyphTex)
+{
+    record(ListType::Glyphs, glyphs, count, false, glyphTex);
+}
+
+void DebugDrawRenderer::draw()
+{
+    for (const RecordedList& list : recordedLists)
+    {
+        const dd::DrawVertex* vertices = recordedVertices.data() + list.first;
+        switch (list.type)
+        {
+        case ListType::Points: submitPointList(vertices, list.count, list.depthEnabled); break;
+        case ListType::Lines: submitLineList(vertices, list.count, list.depthEnabled); break;
+        case ListType::Glyphs: submitGlyphList(vertices, list.count, list.glyphTexture); break;
+        }
+    }
+    recordedLists.clear();
+    recordedVertices.clear();
+}
+
+void DebugDrawRenderer::record(ListType type, const dd::DrawVertex * vertices, int count, bool depthEnabled, dd::GlyphTextureHandle glyphTex)
+{
+    PG_ASSERT(vertices != nullptr);
+    PG_ASSERT(count > 0 && count <= DEBUG_DRAW_VERTEX_BUFFER_SIZE);
+
+    recordedLists.push_back(RecordedList{ type, depthEnabled, glyphTex, recordedVertices.size(), count });
+    recordedVertices.insert(recordedVertices.end(), vertices, vertices + count);
+}
+
+void DebugDrawRenderer::submitPointList(const dd::DrawVertex * points, int count, bool depthEnabled)
 {
     PG_ASSERT(points != nullptr);
     PG_ASSERT(count > 0 && count <= DEBUG_DRAW_VERTEX_BUFFER_SIZE);
 
-    glBindVertexArray(linePointVAO);
-    glUseProgram(linePointProgram);
+    pg::opengl::StateCache& state = pg::opengl::stateCache();
+
+    state.bindVertexArray(linePointVAO);
+    state.useProgram(linePointProgram);
 
     glUniformMatrix4fv(linePointProgram_MvpMatrixLocation,
                         1, GL_TRUE, mvpMatrix.data);
 
-    if (depthEnabled)
-    {
-        glEnable(GL_DEPTH_TEST);
-    }
-    else
-    {
-        glDisable(GL_DEPTH_TEST);
-    }
+    state.setEnabled(GL_DEPTH_TEST, depthEnabled);
 
     // NOTE: Could also use glBufferData to take advantage of the buffer orphaning trick...
-    glBindBuffer(GL_ARRAY_BUFFER, linePointVBO);
+    state.bindBuffer(GL_ARRAY_BUFFER, linePointVBO);
     glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(dd::DrawVertex), points);
 
     // Issue the draw call:
     glDrawArrays(GL_POINTS, 0, count);
 
-    glUseProgram(0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     checkGLError(__FILE__, __LINE__);
 }
 
-void DebugDrawRenderer::drawLineList(const dd::DrawVertex * lines, int count, bool depthEnabled)
+void DebugDrawRenderer::submitLineList(const dd::DrawVertex * lines, int count, bool depthEnabled)
 {
     PG_ASSERT(lines != nullptr);
     PG_ASSERT(count > 0 && count <= DEBUG_DRAW_VERTEX_BUFFER_SIZE);
 
-    glBindVertexArray(linePointVAO);
-    glUseProgram(linePointProgram);
+    pg::opengl::StateCache& state = pg::opengl::stateCache();
+
+    state.bindVertexArray(linePointVAO);
+    state.useProgram(linePointProgram);
 
     glUniformMatrix4fv(linePointProgram_MvpMatrixLocation,
                         1, GL_TRUE, mvpMatrix.data);
 
-    if (depthEnabled)
-    {
-        glEnable(GL_DEPTH_TEST);
-    }
-    else
-    {
-        glDisable(GL_DEPTH_TEST);
-    }
+    state.setEnabled(GL_DEPTH_TEST, depthEnabled);
 
     // NOTE: Could also use glBufferData to take advantage of the buffer orphaning trick...
-    glBindBuffer(GL_ARRAY_BUFFER, linePointVBO);
+    state.bindBuffer(GL_ARRAY_BUFFER, linePointVBO);
     glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(dd::DrawVertex), lines);
 
     // Issue the draw call:
     glDrawArrays(GL_LINES, 0, count);
 
-    glUseProgram(0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     checkGLError(__FILE__, __LINE__);
 }
 
-void DebugDrawRenderer::drawGlyphList(const dd::DrawVertex * glyphs, int count, dd::GlyphTextureHandle glyphTex)
+void DebugDrawRenderer::submitGlyphList(const dd::DrawVertex * glyphs, int count, dd::GlyphTextureHandle glyphTex)
 {
     PG_ASSERT(glyphs != nullptr);
     PG_ASSERT(count > 0 && count <= DEBUG_DRAW_VERTEX_BUFFER_SIZE);
 
-    glBindVertexArray(textVAO);
-    glUseProgram(textProgram);
+    pg::opengl::StateCache& state = pg::opengl::stateCache();
+
+    state.bindVertexArray(textVAO);
+    state.useProgram(textProgram);
 
     // These doesn't have to be reset every draw call, I'm just being lazy ;)
     glUniform1i(textProgram_GlyphTextureLocation, 0);
@@ -254,24 +281,20 @@ void DebugDrawRenderer::drawGlyphList(const dd::DrawVertex * glyphs, int count,
 
     if (glyphTex != nullptr)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, handleToGL(glyphTex));
+        state.activeTexture(GL_TEXTURE0);
+        state.bindTexture(GL_TEXTURE_2D, handleToGL(glyphTex));
     }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_DEPTH_TEST);
+    state.setEnabled(GL_BLEND, true);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.setEnabled(GL_DEPTH_TEST, false);
 
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
+    state.bindBuffer(GL_ARRAY_BUFFER, textVBO);
     glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(dd::DrawVertex), glyphs);
 
     glDrawArrays(GL_TRIANGLES, 0, count); // Issue the draw call
 
-    glDisable(GL_BLEND);
-    glUseProgram(0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D,  0);
+    state.setEnabled(GL_BLEND, false);
     checkGLError(__FILE__, __LINE__);
 }
 
@@ -307,9 +330,7 @@ void DebugDrawRenderer::destroyGlyphTexture(dd::GlyphTextureHandle glyphTex)
         return;
     }
 
-    const GLuint textureId = handleToGL(glyphTex);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDeleteTextures(1, &textureId);
+    pg::opengl::stateCache().deleteTexture(handleToGL(glyphTex));
 }
 
     // These two can also be implemented to perform GL render
@@ -334,7 +355,9 @@ DebugDrawRenderer::DebugDrawRenderer(Context& c)
     , linePointVAO(0)
     , linePointVBO(0)
     , textVAO(0)
-    , textVBO(0){
+    , textVBO(0)
+    , recordedVertices()
+    , recordedLists(){
     LOG_INFO << "DebugDrawRenderer initializing ...";
 
     // Default OpenGL states:
@@ -348,18 +371,22 @@ DebugDrawRenderer::DebugDrawRenderer(Context& c)
     setupShaderPrograms();
     setupVertexBuffers();
 
+    // the setup above talks to GL directly, so the shadowed state has to be thrown away
+    pg::opengl::stateCache().reset();
+
     LOG_INFO << "DebugDrawRenderer ready!";
 }
 
 DebugDrawRenderer::~DebugDrawRenderer() {
-    glDeleteProgram(linePointProgram);
-    glDeleteProgram(textProgram);
+    pg::opengl::StateCache& state = pg::opengl::stateCache();
+    state.deleteProgram(linePointProgram);
+    state.deleteProgram(textProgram);
 
-    glDeleteVertexArrays(1, &linePointVAO);
-    glDeleteBuffers(1, &linePointVBO);
+    state.deleteVertexArray(linePointVAO);
+    state.deleteBuffer(linePointVBO);
 
-    glDeleteVertexArrays(1, &textVAO);
-    glDeleteBuffers(1, &textVBO);
+    state.deleteVertexArray(textVAO);
+    state.deleteBuffer(textVBO);
 }
 
 void DebugDrawRenderer::setupShaderPrograms()
@@ -3,11 +3,17 @@
 #include "DebugDraw.hpp"
 #include "math/Matrix.h"
 #include "GL/glew.h"
+#include <vector>
+#include <cstdlib>
 
 namespace pg {
 
 struct Context;
 
+/*
+ * dd::flush records the vertex lists here instead of drawing them, so that it can run while the
+ * simulation is idle. draw replays them on the GL thread.
+ */
 class DebugDrawRenderer :  public dd::RenderInterface {
 public:
     // This aren't necessarily needed
@@ -25,7 +31,29 @@ public:
 
     inline void setProjectionMatrix(const math::Matrix4f& mat) { mvpMatrix = mat; }
 
+    // draw the lists recorded by the last dd::flush, and forget them
+    void draw();
+
 private:
+    enum class ListType {
+        Points,
+        Lines,
+        Glyphs
+    };
+
+    struct RecordedList {
+        ListType                type;
+        bool                    depthEnabled;
+        dd::GlyphTextureHandle  glyphTexture;
+        std::size_t             first;      // in recordedVertices
+        int                     count;
+    };
+
+    void record(ListType type, const dd::DrawVertex* vertices, int count, bool depthEnabled, dd::GlyphTextureHandle glyphTexture);
+    void submitPointList(const dd::DrawVertex* points, int count, bool depthEnabled);
+    void submitLineList(const dd::DrawVertex* lines, int count, bool depthEnabled);
+    void submitGlyphList(const dd::DrawVertex* glyphs, int count, dd::GlyphTextureHandle glyphTexture);
+
     void setupShaderPrograms();
     void setupVertexBuffers();
     
@@ -48,6 +76,9 @@ private:
     GLuint textVAO;
     GLuint textVBO;
 
+    std::vector<dd::DrawVertex> recordedVertices;
+    std::vector<RecordedList>   recordedLists;
+
 };
 
 }
@@ -0,0 +1,74 @@
+#include "system/DebugGeometry.h"
+#include <algorithm>
+
+namespace {
+
+using pg::math::Vec3f;
+
+// corner i is on the positive side of axis k if bit k of i is set
+const std::uint8_t BoxEdges[] = {
+    0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u,     // along x
+    0u, 2u, 1u, 3u, 4u, 6u, 5u, 7u,     // along y
+    0u, 4u, 1u, 5u, 2u, 6u, 3u, 7u      // along z
+};
+
+const std::uint8_t BoxTriangles[] = {
+    1u, 3u, 7u, 1u, 7u, 5u,     // +x
+    0u, 4u, 6u, 0u, 6u, 2u,     // -x
+    2u, 6u, 7u, 2u, 7u, 3u,     // +y
+    0u, 1u, 5u, 0u, 5u, 4u,     // -y
+    4u, 5u, 7u, 4u, 7u, 6u,     // +z
+    0u, 2u, 3u, 0u, 3u, 1u      // -z
+};
+
+void boxCorners(const Vec3f& center, const Vec3f& x, const Vec3f& y, const Vec3f& z, Vec3f corners[8]) {
+    for (int i = 0; i < 8; ++i) {
+        corners[i] = center + ((i & 1) ? x : -1.f * x) + ((i & 2) ? y : -1.f * y) + ((i & 4) ? z : -1.f * z);
+    }
+}
+
+std::uint32_t unorm8(float value) {
+    return std::uint32_t(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+}
+
+}
+
+namespace pg {
+namespace system {
+
+std::uint32_t packDebugColor(const math::Vec3f& color) {
+    return unorm8(color.x) | (unorm8(color.y) << 8u) | (unorm8(color.z) << 16u) | (255u << 24u);
+}
+
+void writeBoxLines(
+    const math::Vec3f& center,
+    const math::Vec3f& x,
+    const math::Vec3f& y,
+    const math::Vec3f& z,
+    std::uint32_t color,
+    DebugVertex* out
+) {
+    Vec3f corners[8];
+    boxCorners(center, x, y, z, corners);
+    for (std::size_t i = 0u; i < BoxLineVertexCount; ++i) {
+        out[i] = DebugVertex{ corners[BoxEdges[i]], color };
+    }
+}
+
+void writeBoxTriangles(
+    const math::Vec3f& center,
+    const math::Vec3f& x,
+    const math::Vec3f& y,
+    const math::Vec3f& z,
+    std::uint32_t color,
+    DebugVertex* out
+) {
+    Vec3f corners[8];
+    boxCorners(center, x, y, z, corners);
+    for (std::size_t i = 0u; i < BoxTriangleVertexCount; ++i) {
+        out[i] = DebugVertex{ corners[BoxTriangles[i]], color };
+    }
+}
+
+}   // system
+}   // pg
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "math/Vector.h"
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+namespace system {
+
+/// @brief The vertex format of the batched debug primitives, see debug.vert.glsl.
+struct DebugVertex {
+    math::Vec3f     position;
+    std::uint32_t   color;      // RGBA8, red in the lowest byte
+};
+
+static_assert(sizeof(DebugVertex) == 16u, "DebugVertex should be tightly packed");
+
+/// @brief A debug line, as the two vertices of a line list.
+struct DebugLine {
+    DebugVertex start;
+    DebugVertex end;
+};
+
+/// @brief The vertices writeBoxLines writes, two per edge.
+const std::size_t BoxLineVertexCount = 24u;
+/// @brief The vertices writeBoxTriangles writes, two triangles per face.
+const std::size_t BoxTriangleVertexCount = 36u;
+
+/// @brief Pack a color with components in [0, 1] into RGBA8, with full alpha.
+std::uint32_t packDebugColor(const math::Vec3f& color);
+
+/**
+ * @brief Write the twelve edges of a box as a line list.
+ * The box is center +- x +- y +- z, so the axes are the half extents, and needn't be axis aligned.
+ */
+void writeBoxLines(
+    const math::Vec3f& center,
+    const math::Vec3f& x,
+    const math::Vec3f& y,
+    const math::Vec3f& z,
+    std::uint32_t color,
+    DebugVertex* out
+);
+
+/**
+ * @brief Write the six faces of a box as a triangle list, counter clockwise seen from outside.
+ * The box is the same as in writeBoxLines.
+ */
+void writeBoxTriangles(
+    const math::Vec3f& center,
+    const math::Vec3f& x,
+    const math::Vec3f& y,
+    const math::Vec3f& z,
+    std::uint32_t color,
+    DebugVertex* out
+);
+
+}   // system
+}   // pg
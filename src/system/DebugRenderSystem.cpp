@@ -1,40 +1,20 @@
 #include "system/DebugRenderSystem.h"
+#include "opengl/StateCache.h"
 #include "opengl/Use.h"
 #include "opengl/VertexAttributes.h"
 #include "app/Context.h"
+#include "utils/Assert.h"
 #include <GL/glew.h>
+#include <cstddef>
 
 namespace {
 
-const std::size_t MaxTransientElements = 500u;
-
-const float cubePoints[] = {
-    -0.500000, -0.500000,  0.500000,    // 0
-    0.500000, -0.500000,  0.500000,     // 1
-    -0.500000,  0.500000,  0.500000,    // 2
-    0.500000,  0.500000,  0.500000,     // 3
-    -0.500000,  0.500000, -0.500000,    // 4
-    0.500000,  0.500000, -0.500000,     // 5
-    -0.500000, -0.500000, -0.500000,    // 6
-    0.500000, -0.500000, -0.500000      // 7
-};
-
-const GLuint cubeLines[] = {
-    0u, 2u, 2u, 4u, 4u, 6u, 6u, 0u,
-    0u, 1u, 1u, 3u, 3u, 2u, 2u, 0u,
-    6u, 7u, 7u, 5u, 5u, 4u, 4u, 6u,
-    7u, 1u, 1u, 3u, 3u, 5u, 5u, 7u,
-
-};
-
-const GLuint cubeTris[] = {
-    0u, 1u, 3u, 3u, 2u, 0u,
-    5u, 7u, 6u, 6u, 4u, 5u,
-    5u, 4u, 2u, 2u, 3u, 5u,
-    7u, 1u, 0u, 0u, 6u, 7u,
-    6u, 0u, 2u, 2u, 4u, 6u,
-    5u, 3u, 1u, 1u, 7u, 5u
-};
+const pg::math::Vec3f BoundingBoxColor{ 1.0f, 0.2f, 0.2f };
+const pg::math::Vec3f LineColor{ 0.9f, 0.6f, 0.15f };
+// smaller ranges aren't worth waking up a worker for
+const std::size_t MinBoundsRange = 256u;
+// the resolution of the transient element lifetimes, in seconds
+const float LifeTimeTick = 1.f / 60.f;
 
 }
 
@@ -43,57 +23,36 @@ namespace system {
 
 DebugRenderSystem::DebugRenderSystem(Context& context)
     : context_{ context },
-    defaultProjection_{},
     staticDebugLines_{},
-    transientDebugLines_{},
-    lineLifeTimes_{},
+    transientDebugLines_{ LifeTimeTick },
     staticDebugBoxes_{},
-    transientDebugBoxes_{},
-    boxLifeTimes_{},
-    lineBuffer_{ GL_ARRAY_BUFFER },
-    lineBufferArray_{},
+    transientDebugBoxes_{ LifeTimeTick },
+    frames_{},
+    vao_{ 0u },
+    vertexAttribute_{ 0u },
+    colorAttribute_{ 0u },
     showLines_{ false },
     showBoundingBoxes_{ false },
     showDebugBoxes_{ false } {
-    defaultProjection_ = math::Matrix4f::perspective(70.0f, 1.5f, 0.1f, 100.0f);
-
-    // set up the debug buffers and VAOs
-    lineBuffer_.dataStore(MaxTransientElements, 6 * sizeof(float), NULL, GL_STREAM_DRAW);
-    lineBuffer_.bind();
-    lineBufferArray_ = opengl::VertexAttributes{
-        {unsigned(context_.shaderManager.get("basic")->attribute("vertex")), opengl::AttributeType::Float, 3}
-    };
-    lineBuffer_.unbind();
-
-    // generate cube objects
-    cubeVbo_ = 0u;
-    glGenBuffers(1, &cubeVbo_);
-    PG_ASSERT(cubeVbo_);
-    GLint old;
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &old);
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVbo_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubePoints), cubePoints, GL_STATIC_DRAW);
-    opengl::Program* basicShader = context_.shaderManager.get("basic");
-    basicShader->use();
-    glGenVertexArrays(1, &cubeVao_);
-    glGetIntegerv(GL_ARRAY_BUFFER, &old);
-    glBindVertexArray(cubeVao_);
-    PG_ASSERT(cubeVao_);
-    GLint index = glGetAttribLocation(basicShader->object(), "vertex");
-    glVertexAttribPointer(index, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(index);
-    glBindVertexArray(cubeVao_);
-    basicShader->stopUsing();
-    glBindBuffer(GL_ARRAY_BUFFER, old);
+    opengl::StateCache& state = opengl::stateCache();
+    const GLuint oldArray = state.vertexArray();
+
+    const opengl::Program* shader = context_.shaderManager.get("debug");
+    vertexAttribute_ = GLuint(shader->attribute("vertex"));
+    colorAttribute_ = GLuint(shader->attribute("color"));
+    glGenVertexArrays(1, &vao_);
+    PG_ASSERT(vao_);
+    state.bindVertexArray(vao_);
+    glEnableVertexAttribArray(vertexAttribute_);
+    glEnableVertexAttribArray(colorAttribute_);
+    state.bindVertexArray(oldArray);
 }
 
 DebugRenderSystem::~DebugRenderSystem() {
-    glDeleteBuffers(1, &cubeVbo_);
-    glDeleteVertexArrays(1, &cubeVao_);
+    opengl::stateCache().deleteVertexArray(vao_);
 }
 
 void DebugRenderSystem::configure(ecs::EventManager& events) {
-    events.subscribe<ecs::ComponentAssignedEvent<component::Camera>>(*this);
     events.subscribe<ShowDebugLines>(*this);
     events.subscribe<ShowBoundingBoxes>(*this);
     events.subscribe<ShowDebugBoxes>(*this);
@@ -102,108 +61,127 @@ void DebugRenderSystem::configure(ecs::EventManager& events) {
 }
 
 void DebugRenderSystem::update(ecs::EntityManager& entities, ecs::EventManager& events, float dt) {
-    updateTransientElements_(lineLifeTimes_, transientDebugLines_, dt);
-    updateTransientElements_(boxLifeTimes_, transientDebugBoxes_, dt);
-
-    math::Matrix4f cameraMatrix{ defaultProjection_ };
-    if (cameraEntity_.isValid()) {
-        float aspectRatio = float(context_.window->width()) / context_.window->height();
-        auto transform = cameraEntity_.component< component::Transform >();
-        auto view = math::Matrix4f::translation(transform->position)
-            * math::Matrix4f::rotation(transform->rotation)
-            * math::Matrix4f::scale(transform->scale);
-        auto camera = cameraEntity_.component< component::Camera >();
-        auto proj = math::Matrix4f::perspective(
-            camera->verticalFov,
-            aspectRatio,
-            camera->nearPlane,
-            camera->farPlane
-            );
-        cameraMatrix = proj * view.inverse();
+    transientDebugLines_.advance(dt);
+    transientDebugBoxes_.advance(dt);
+
+    DebugFrame& frame = frames_.write();
+    frame.bounds.clear();
+    if (showBoundingBoxes_) {
+        for (ecs::Entity entity : entities.join< component::Transform, math::AABoxf >()) {
+            frame.bounds.push_back(BoundsItem{ *entity.component< component::Transform >(), *entity.component< math::AABoxf >() });
+        }
+    }
+    frame.lines.clear();
+    if (showLines_) {
+        frame.lines.insert(frame.lines.end(), staticDebugLines_.begin(), staticDebugLines_.end());
+        transientDebugLines_.forEachSlot([&frame](const DebugLine* lines, std::size_t count) -> void {
+            frame.lines.insert(frame.lines.end(), lines, lines + count);
+        });
     }
+    frame.boxes.clear();
+    if (showDebugBoxes_) {
+        frame.boxes.insert(frame.boxes.end(), staticDebugBoxes_.begin(), staticDebugBoxes_.end());
+        transientDebugBoxes_.forEachSlot([&frame](const RenderDebugBox* boxes, std::size_t count) -> void {
+            frame.boxes.insert(frame.boxes.end(), boxes, boxes + count);
+        });
+    }
+}
 
-    // create rendering state
-    auto* shader = context_.shaderManager.get("basic");
-
-    {
-        opengl::UseProgram use{ *shader };
-        shader->setUniform("color", math::Vec3f{ 1.0f, 0.2f, 0.2f });
-        shader->setUniform("camera", cameraMatrix);
-        if (showBoundingBoxes_) {
-            /// BOUNDING BOXES
-            ///////////////////////////////////////////////////////////
-            for (ecs::Entity entity : entities.join< component::Transform, math::AABoxf >()) {
-                auto t = entity.component< component::Transform >();
-                auto bb = entity.component<math::AABoxf>();
-                math::Vec3f min = t->scale.hadamard(bb->min);
-                math::Vec3f max = t->scale.hadamard(bb->max);
-                math::Vec3f center = 0.5f * (min + max);
-                math::Vec3f scale{ max.x - min.x, max.y - min.y, max.z - min.z };
-                math::Matrix4f S = math::Matrix4f::scale(scale);                // scale to current model dimensions
-                math::Matrix4f R = math::Matrix4f::rotation(t->rotation);       // rotate to world coords
-                math::Matrix4f Tl = math::Matrix4f::translation(center);        // translate to local coords
-                math::Matrix4f Tw = math::Matrix4f::translation(t->position);   // translate to world coords
-                math::Matrix4f TRS = Tw * R  * Tl * S;
-
-                shader->setUniform("model", TRS);
-                {
-                    GLint old;
-                    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &old);
-                    glBindVertexArray(cubeVao_);
-                    glDrawElements(GL_LINES, 32, GL_UNSIGNED_INT, cubeLines);
-                    glBindVertexArray(old);
+void DebugRenderSystem::render() {
+    const DebugFrame& frame = frames_.read();
+    const std::size_t lineVertexCount = BoxLineVertexCount * frame.bounds.size() + 2u * frame.lines.size();
+    const std::size_t triangleVertexCount = BoxTriangleVertexCount * frame.boxes.size();
+    if (lineVertexCount == 0u && triangleVertexCount == 0u) {
+        return;
+    }
+
+    /*
+     * Expand everything into world space vertices, one line list and one triangle list.
+     * The camera comes from the frame block, written by RenderSystem.
+     */
+    opengl::StreamBuffer& stream = *context_.streamBuffer;
+    opengl::UseProgram use{ *context_.shaderManager.get("debug") };
+    opengl::StateCache& state = opengl::stateCache();
+    const GLuint oldArray = state.vertexArray();
+    const GLuint oldBuffer = state.buffer(GL_ARRAY_BUFFER);
+    state.bindVertexArray(vao_);
+
+    if (lineVertexCount > 0u) {
+        opengl::StreamBuffer::Allocation allocation = stream.allocate(lineVertexCount * sizeof(DebugVertex));
+        DebugVertex* vertices = static_cast<DebugVertex*>(allocation.data);
+
+        // the bounding boxes are oriented with their entities, so their wireframes go through the rotation
+        const BoundsItem* items = frame.bounds.data();
+        const std::uint32_t boundsColor = packDebugColor(BoundingBoxColor);
+        context_.threadPool.parallelFor(frame.bounds.size(), MinBoundsRange,
+            [items, vertices, boundsColor](std::size_t begin, std::size_t end, std::size_t) -> void {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const component::Transform& t = items[i].transform;
+                    const math::Vec3f min = t.scale.hadamard(items[i].bounds.min);
+                    const math::Vec3f max = t.scale.hadamard(items[i].bounds.max);
+                    const math::Matrix4f R = math::Matrix4f::rotation(t.rotation);
+                    const math::Vec3f c = 0.5f * (min + max);
+                    const math::Vec3f e = 0.5f * (max - min);
+                    const math::Vec3f center{
+                        R.data[0] * c.x + R.data[1] * c.y + R.data[2] * c.z + t.position.x,
+                        R.data[4] * c.x + R.data[5] * c.y + R.data[6] * c.z + t.position.y,
+                        R.data[8] * c.x + R.data[9] * c.y + R.data[10] * c.z + t.position.z
+                    };
+                    writeBoxLines(
+                        center,
+                        math::Vec3f{ R.data[0], R.data[4], R.data[8] } * e.x,
+                        math::Vec3f{ R.data[1], R.data[5], R.data[9] } * e.y,
+                        math::Vec3f{ R.data[2], R.data[6], R.data[10] } * e.z,
+                        boundsColor,
+                        vertices + i * BoxLineVertexCount
+                    );
                 }
-            }
-        }
+            });
 
-        const std::size_t PointCount = 2u*staticDebugLines_.size() + 2u*transientDebugLines_.size();
-        if (showLines_ && PointCount > 0u) {
-            /// LINES
-            ///////////////////////////////////////////////////////////
-            lineBuffer_.bind();
-            math::Vec3f* lines = (math::Vec3f*)lineBuffer_.mapBufferRange(0, PointCount * 6u * sizeof(float), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
-            for (unsigned i = 0u; i < 2u * staticDebugLines_.size(); i += 2u) {
-                unsigned index = i / 2u;
-                lines[i] = staticDebugLines_[index].origin;
-                lines[i + 1u] = staticDebugLines_[index].end;
-            }
-            for (auto i = 2u * staticDebugLines_.size(); i < PointCount; i += 2u) {
-                unsigned index = (i / 2u) - staticDebugLines_.size();
-                lines[i] = transientDebugLines_[index].origin;
-                lines[i + 1u] = transientDebugLines_[index].end;
-            }
-            lineBuffer_.unmapBuffer();
-
-            shader->setUniform("color", math::Vec3f{ 0.9f, 0.6f, 0.15f });
-            shader->setUniform("model", math::Matrix4f{});
-            {
-                opengl::UseArray array(lineBufferArray_);
-                glDrawArrays(GL_LINES, 0, PointCount);
-            }
-            lineBuffer_.unbind();
+        // Vec3f isn't trivially copyable, so the lines are copied vertex by vertex
+        DebugVertex* lineVertices = vertices + BoxLineVertexCount * frame.bounds.size();
+        for (const DebugLine& line : frame.lines) {
+            *lineVertices++ = line.start;
+            *lineVertices++ = line.end;
         }
+        stream.flush(allocation);
+        attributePointers_(allocation);
+        glDrawArrays(GL_LINES, 0, GLsizei(lineVertexCount));
+    }
 
-        if (showDebugBoxes_) {
-            glBindBuffer(GL_ARRAY_BUFFER, cubeVbo_);
-            for (auto& box : staticDebugBoxes_) {
-                math::Matrix4f M = math::Matrix4f::translation(box.position) * math::Matrix4f::scale(box.scale);
-                shader->setUniform("model", M);
-                shader->setUniform("color", box.color);
-                glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, cubeTris);
-            }
-            for (auto& box : transientDebugBoxes_) {
-                math::Matrix4f M = math::Matrix4f::translation(box.position) * math::Matrix4f::scale(box.scale);
-                shader->setUniform("model", M);
-                shader->setUniform("color", box.color);
-                glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, cubeTris);
-            }
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (triangleVertexCount > 0u) {
+        opengl::StreamBuffer::Allocation allocation = stream.allocate(triangleVertexCount * sizeof(DebugVertex));
+        DebugVertex* out = static_cast<DebugVertex*>(allocation.data);
+        for (const RenderDebugBox& box : frame.boxes) {
+            const math::Vec3f e = 0.5f * box.scale;
+            writeBoxTriangles(
+                box.position,
+                math::Vec3f{ e.x, 0.f, 0.f },
+                math::Vec3f{ 0.f, e.y, 0.f },
+                math::Vec3f{ 0.f, 0.f, e.z },
+                packDebugColor(box.color),
+                out
+            );
+            out += BoxTriangleVertexCount;
         }
+        stream.flush(allocation);
+        attributePointers_(allocation);
+        glDrawArrays(GL_TRIANGLES, 0, GLsizei(triangleVertexCount));
     }
+
+    state.bindVertexArray(oldArray);
+    state.bindBuffer(GL_ARRAY_BUFFER, oldBuffer);
+}
+
+void DebugRenderSystem::swapFrames() {
+    frames_.swap();
 }
 
-void DebugRenderSystem::receive(const ecs::ComponentAssignedEvent<component::Camera>& event) {
-    cameraEntity_ = event.entity;
+void DebugRenderSystem::attributePointers_(const opengl::StreamBuffer::Allocation& allocation) {
+    opengl::stateCache().bindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+    const char* base = reinterpret_cast<const char*>(allocation.offset);
+    glVertexAttribPointer(vertexAttribute_, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), base + offsetof(DebugVertex, position));
+    glVertexAttribPointer(colorAttribute_, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex), base + offsetof(DebugVertex, color));
 }
 
 void DebugRenderSystem::receive(const ShowDebugLines& event) {
@@ -227,11 +205,13 @@ void DebugRenderSystem::receive(const RenderDebugBox& box) {
 }
 
 void DebugRenderSystem::addDebugLine(const RenderDebugLine& line) {
+    const std::uint32_t color = packDebugColor(LineColor);
+    const DebugLine vertices{ DebugVertex{ line.start, color }, DebugVertex{ line.end, color } };
     if (line.lifeTime == 0.f) {
-        staticDebugLines_.push_back(math::Linef{ line.start, line.end });
+        staticDebugLines_.push_back(vertices);
     }
     else {
-        transientDebugLines_.push_back(math::Linef{ line.start, line.end });
+        transientDebugLines_.insert(vertices, line.lifeTime);
     }
 }
 
@@ -240,8 +220,7 @@ void DebugRenderSystem::addDebugBox(const RenderDebugBox& box) {
         staticDebugBoxes_.push_back(box);
     }
     else {
-        transientDebugBoxes_.push_back(box);
-        boxLifeTimes_.push_back(box.lifeTime);
+        transientDebugBoxes_.insert(box, box.lifeTime);
     }
 }
 
@@ -4,9 +4,11 @@
 #include "component/Include.h"
 #include "math/Geometry.h"
 #include "system/Events.h"
-#include "opengl/BufferObject.h"
+#include "system/DebugGeometry.h"
+#include "opengl/StreamBuffer.h"
+#include "utils/DoubleBuffer.h"
+#include "utils/TimingWheel.h"
 #include <vector>
-#include <utility>
 
 namespace pg {
 
@@ -14,6 +16,20 @@ struct Context;
 
 namespace system {
 
+/**
+ * @class DebugRenderSystem
+ * @brief Draws the debug lines, debug boxes and bounding boxes.
+ *
+ * All primitives are expanded into world space vertices with a color each, and streamed into
+ * one line list and one triangle list per frame. The bounding box wireframes are expanded on
+ * the thread pool. Each list is drawn with a single call, see debug.vert.glsl.
+ *
+ * Lines and boxes with a lifetime are kept in timing wheels, so that expiring them only costs
+ * as much as the elements which expire.
+ *
+ * Like RenderSystem, update copies the primitives into a frame on the simulation thread, render
+ * draws the published frame on the GL thread, and swapFrames publishes the frame in between.
+ */
 class DebugRenderSystem : public ecs::System, public ecs::Receiver {
 public:
     DebugRenderSystem() = delete;
@@ -21,7 +37,8 @@ public:
     virtual ~DebugRenderSystem();
     void configure(ecs::EventManager&) override;
     void update(ecs::EntityManager&, ecs::EventManager&, float) override;
-    void receive(const ecs::ComponentAssignedEvent<component::Camera>&);
+    void render();
+    void swapFrames();
     void receive(const ShowDebugLines&);
     void receive(const ShowBoundingBoxes&);
     void receive(const ShowDebugBoxes&);
@@ -31,43 +48,42 @@ public:
     void addDebugBox(const RenderDebugBox&);
 
 private:
-    template<typename T>
-    void updateTransientElements_(std::vector<float>& lifeTimes, std::vector<T>& elements, float dt) {
-        if (lifeTimes.size() != 0u) {
-            for (auto i = lifeTimes.size() - 1u; i-- > 0u;) {
-                lifeTimes[i] -= dt;
-                if (lifeTimes[i] < 0.f) {
-                    std::swap(lifeTimes[i], lifeTimes.back());
-                    lifeTimes.pop_back();
-                    std::swap(elements[i], elements.back());
-                    elements.pop_back();
-                }
-            }
-        }
-    }
+    // the components of one entity whose bounding box is drawn
+    struct BoundsItem {
+        component::Transform    transform;
+        math::AABoxf            bounds;
+    };
+
+    // the primitives to draw, copied by update
+    struct DebugFrame {
+        std::vector<BoundsItem>     bounds{};
+        std::vector<DebugLine>      lines{};
+        std::vector<RenderDebugBox> boxes{};
+    };
+
+    // point the vertex attributes at streamed DebugVertex data
+    void attributePointers_(const opengl::StreamBuffer::Allocation& allocation);
 
     Context&                    context_;
-    ecs::Entity                 cameraEntity_;
-    math::Matrix4f              defaultProjection_;
 
-    // lines
-    std::vector<math::Linef>    staticDebugLines_;
-    std::vector<math::Linef>    transientDebugLines_;
-    std::vector<float>          lineLifeTimes_;
+    // lines, stored as vertices so that they can be copied straight into the stream buffer
+    std::vector<DebugLine>          staticDebugLines_;
+    TimingWheel<DebugLine>          transientDebugLines_;
 
     // boxes
-    std::vector<RenderDebugBox> staticDebugBoxes_;
-    std::vector<RenderDebugBox> transientDebugBoxes_;
-    std::vector<float>          boxLifeTimes_;
+    std::vector<RenderDebugBox>     staticDebugBoxes_;
+    TimingWheel<RenderDebugBox>     transientDebugBoxes_;
+
+    DoubleBuffer<DebugFrame>    frames_;
 
-    opengl::BufferObject        lineBuffer_;
-    opengl::VertexAttributes    lineBufferArray_;
+    // the vertices are streamed, so the attribute pointers are set when drawing
+    GLuint                      vao_;
+    GLuint                      vertexAttribute_;
+    GLuint                      colorAttribute_;
 
     bool    showLines_;
     bool    showBoundingBoxes_;
     bool    showDebugBoxes_;
-    GLuint  cubeVbo_;
-    GLuint  cubeVao_;
 };
 
 }
@@ -0,0 +1,108 @@
+#include "system/DrawCommands.h"
+#include "math/Matrix.h"
+#include "utils/Assert.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// the projected size below which the first coarser level is drawn; each level after that halves it
+const float LodScreenSize = 0.5f;
+// how far past a threshold the projected size has to go before the level changes
+const float LodHysteresis = 0.1f;
+
+float lodThreshold(std::uint32_t lod) {
+    return LodScreenSize * std::ldexp(1.f, -int(lod));
+}
+
+}
+
+namespace pg {
+namespace system {
+
+std::uint32_t selectLod(std::uint32_t lodCount, std::uint32_t current, float screenSize) {
+    PG_ASSERT(lodCount > 0u);
+    std::uint32_t lod = std::min(current, lodCount - 1u);
+    // lodThreshold(lod) is the size below which lod + 1 is drawn
+    while (lod + 1u < lodCount && screenSize < lodThreshold(lod) * (1.f - LodHysteresis)) {
+        ++lod;
+    }
+    while (lod > 0u && screenSize > lodThreshold(lod - 1u) * (1.f + LodHysteresis)) {
+        --lod;
+    }
+    return lod;
+}
+
+void recordDrawCommands(
+    const LodCamera& camera,
+    const RenderItem* items,
+    std::size_t begin,
+    std::size_t end,
+    std::uint32_t* lods,
+    char* blocks,
+    std::size_t blockStride,
+    CommandList& commands
+) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const RenderItem& item = items[i];
+        const component::Transform& transform = item.transform;
+        const Mesh& mesh = *item.mesh;
+        std::uint32_t& current = lods[item.entity];
+
+        const math::Matrix4f world = math::Matrix4f::translation(transform.position)
+            * math::Matrix4f::rotation(transform.rotation)
+            * math::Matrix4f::scale(transform.scale);
+        opengl::ObjectBlock& object = *reinterpret_cast<opengl::ObjectBlock*>(blocks + i * blockStride);
+        object.model = world * mesh.dequantize;
+        object.base = item.material.baseColor;
+        object.shininess = item.material.shininess;
+        object.ambient = item.material.ambientColor;
+        object.specularColor = item.material.specularColor;
+
+        if (mesh.lodCount > 1u) {
+            // the bounding sphere of the mesh's box in world space
+            const math::Vec3f c = mesh.bounds.center();
+            const math::Vec3f center{
+                world.data[0] * c.x + world.data[1] * c.y + world.data[2] * c.z + world.data[3],
+                world.data[4] * c.x + world.data[5] * c.y + world.data[6] * c.z + world.data[7],
+                world.data[8] * c.x + world.data[9] * c.y + world.data[10] * c.z + world.data[11]
+            };
+            const float scale = std::max(std::abs(transform.scale.x), std::max(std::abs(transform.scale.y), std::abs(transform.scale.z)));
+            const float radius = mesh.bounds.extents().norm() * scale;
+            const float distance = (center - camera.position).norm();
+            // the camera is inside the sphere, draw at full detail
+            const float screenSize = distance > radius ? radius * camera.projectionScale / distance : std::numeric_limits<float>::max();
+            current = selectLod(mesh.lodCount, current, screenSize);
+        }
+        else {
+            current = 0u;
+        }
+
+        const MeshLod& lod = mesh.lods[current];
+        const GLuint vertexArray = item.vertexArray;
+        commands.push_back(DrawCommand{
+            (std::uint64_t(vertexArray) << 32u) | std::uint64_t(i),
+            vertexArray,
+            lod.indexOffset,
+            lod.indexCount,
+            mesh.indexType,
+            mesh.baseVertex,
+            std::uint32_t(i)
+        });
+    }
+}
+
+void mergeDrawCommands(const std::vector<CommandList>& lists, std::size_t listCount, CommandList& merged) {
+    PG_ASSERT(listCount <= lists.size());
+    merged.clear();
+    for (std::size_t i = 0u; i < listCount; ++i) {
+        merged.insert(merged.end(), lists[i].begin(), lists[i].end());
+    }
+    std::sort(merged.begin(), merged.end(), [](const DrawCommand& lhs, const DrawCommand& rhs) -> bool {
+        return lhs.key < rhs.key;
+    });
+}
+
+}   // system
+}   // pg
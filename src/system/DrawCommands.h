@@ -0,0 +1,76 @@
+#pragma once
+
+#include "component/Transform.h"
+#include "manager/Mesh.h"
+#include "system/Material.h"
+#include "opengl/UniformBlocks.h"
+#include "math/Vector.h"
+#include <GL/glew.h>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+namespace system {
+
+/// @brief A draw call as plain data. Commands are recorded in parallel, and replayed on the GL thread.
+struct DrawCommand {
+    std::uint64_t   key;            // the vertex array in the high bits, so that sorting groups draws by program
+    GLuint          vertexArray;
+    GLintptr        indexOffset;    // in bytes, selects the detail level
+    GLsizei         indexCount;
+    GLenum          indexType;
+    GLint           baseVertex;     // the mesh's, zero if its indices were rebased
+    std::uint32_t   block;          // the index of the draw's object block
+};
+
+using CommandList = std::vector<DrawCommand>;
+
+/// @brief The render state of one visible entity, copied out of its components by the simulation.
+struct RenderItem {
+    component::Transform    transform;
+    const Mesh*             mesh;
+    GLuint                  vertexArray;
+    Material                material;
+    std::uint32_t           entity;     // the entity's index, which keys its detail level
+};
+
+/// @brief The camera state which detail level selection needs.
+struct LodCamera {
+    math::Vec3f position;
+    float       projectionScale;    // cot(fov / 2), the second diagonal element of the projection matrix
+};
+
+/**
+ * @brief Select the detail level of a mesh from its projected size.
+ * @param screenSize The projected bounding sphere radius, as a fraction of half the viewport height.
+ * @param current The level drawn last frame. Levels only change once the size is clearly past
+ * the threshold, so that objects near it don't pop back and forth.
+ */
+std::uint32_t selectLod(std::uint32_t lodCount, std::uint32_t current, float screenSize);
+
+/**
+ * @brief Record the draw commands of items [begin, end).
+ * The object block of items[i] is written to blocks + i * blockStride, and the command is appended
+ * to commands. Each item's detail level is selected for the camera, starting from and written
+ * back to lods[items[i].entity]. No OpenGL calls are made, so disjoint ranges can be recorded
+ * concurrently.
+ */
+void recordDrawCommands(
+    const LodCamera& camera,
+    const RenderItem* items,
+    std::size_t begin,
+    std::size_t end,
+    std::uint32_t* lods,
+    char* blocks,
+    std::size_t blockStride,
+    CommandList& commands
+);
+
+/**
+ * @brief Append the first listCount lists to merged, and sort the result by key.
+ */
+void mergeDrawCommands(const std::vector<CommandList>& lists, std::size_t listCount, CommandList& merged);
+
+}   // system
+}   // pg
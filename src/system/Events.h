@@ -5,6 +5,9 @@
 #include <cstdlib>
 
 namespace pg {
+
+struct Mesh;
+
 namespace system {
 
 struct CameraActivated {
@@ -23,11 +26,26 @@ struct ShowDebugLines {
     bool show;
 };
 
+// emitted when an entity's transform may have changed, see SpatialSystem
+struct TransformChanged {
+    ecs::Entity entity;
+};
+
+// emitted when an entity's model space box has been changed in place, see SpatialSystem
+struct BoundsChanged {
+    ecs::Entity entity;
+};
+
 // emitted when a text file is updated in the file system
 struct TextFileUpdated {
     std::size_t id;
 };
 
+// emitted when a mesh which was loaded in the background has replaced its placeholder
+struct MeshLoaded {
+    const Mesh* mesh;
+};
+
 struct RenderDebugLine {
     math::Vec3f start;
     math::Vec3f end;
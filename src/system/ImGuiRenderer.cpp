@@ -1,6 +1,7 @@
 #include "app/Context.h"
 #include "system/ImGuiRenderer.h"
 #include "manager/ShaderManager.h"
+#include "opengl/StateCache.h"
 #include "opengl/VertexAttributes.h"
 #include "math/Matrix.h"
 #include "utils/Assert.h"
@@ -12,6 +13,9 @@
 #include <SDL_mouse.h>
 #include <SDL_timer.h>
 #include <SDL_syswm.h>
+#include <cstddef>
+#include <cstring>
+#include <vector>
 
 // link to where I got some of the code from:
 // https://github.com/ocornut/imgui/blob/master/examples/opengl3_example/imgui_impl_glfw_gl3.cpp#L31
@@ -19,94 +23,122 @@
 namespace {
 // unfortunate global state
 pg::opengl::Program*            gShader{ nullptr };
-pg::opengl::BufferObject*       gVbo{ nullptr };
+pg::opengl::StreamBuffer*       gStream{ nullptr };
 GLuint                          gVao{0u};
+GLuint                          gPositionAttribute{ 0u };
+GLuint                          gUvAttribute{ 0u };
+GLuint                          gColorAttribute{ 0u };
 pg::opengl::Texture*            gFont{ nullptr };
 
-void renderDrawLists(ImDrawData* drawData) {
-    // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled
-    GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-    GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-    GLint last_blend_src; glGetIntegerv(GL_BLEND_SRC, &last_blend_src);
-    GLint last_blend_dst; glGetIntegerv(GL_BLEND_DST, &last_blend_dst);
-    GLint last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, &last_blend_equation_rgb);
-    GLint last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &last_blend_equation_alpha);
-
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+// a copy of an ImDrawList's buffers
+struct DrawList {
+    std::vector<ImDrawVert> vertices;
+    std::vector<ImDrawIdx>  indices;
+    std::vector<ImDrawCmd>  commands;
+};
 
-    // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_SCISSOR_TEST);
-    glActiveTexture(GL_TEXTURE0);
+// the draw lists of the last ImGui::Render, drawn while the next frame's UI is built
+std::vector<DrawList>           gDrawLists{};
+std::size_t                     gDrawListCount{ 0u };
+float                           gFramebufferHeight{ 0.f };
 
+void captureDrawLists(ImDrawData* drawData) {
     ImGuiIO& io = ImGui::GetIO();
-
-    float fbHeight = io.DisplaySize.y * io.DisplayFramebufferScale.y;
+    gFramebufferHeight = io.DisplaySize.y * io.DisplayFramebufferScale.y;
     drawData->ScaleClipRects(io.DisplayFramebufferScale);
 
-    const float orthoProjection[4][4] = {
-        { 2.0f / io.DisplaySize.x,  0.0f,                   0.0f, 0.0f },
-        { 0.0f,                   -2.0f / io.DisplaySize.y, 0.0f, 0.0f },
-        { 0.0f,                   0.0f,                   -1.0f, 0.0f },
-        { -1.0f,                  1.0f,                   0.0f, 1.0f }
-    };
-    gShader->use();
-    glUniformMatrix4fv(gShader->uniform("MOrtho"), 1, GL_FALSE, &orthoProjection[0][0]);
+    gDrawListCount = 0u;
     for (int n = 0; n < drawData->CmdListsCount; n++) {
         const ImDrawList* commandList = drawData->CmdLists[n];
-        const ImDrawIdx* idxBuffer = &commandList->IdxBuffer.front();
-
-        // set vertex data
-        gVbo->dataStore(
-            (GLsizeiptr)commandList->VtxBuffer.size(),
-            sizeof(ImDrawVert),
-            (GLvoid*)&commandList->VtxBuffer.front(),
-            GL_STREAM_DRAW
-            );
-
-        glBindVertexArray(gVao);
-
-        for (int cmdIndex = 0; cmdIndex < commandList->CmdBuffer.size(); cmdIndex++) {
-            const ImDrawCmd* pcmd = &commandList->CmdBuffer[cmdIndex];
-            if (pcmd->UserCallback) {
-                pcmd->UserCallback(commandList, pcmd);
-            }
-            else {
-                glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
-                glScissor(
-                    (int)pcmd->ClipRect.x,
-                    (int)(fbHeight - pcmd->ClipRect.w),
-                    (int)(pcmd->ClipRect.z - pcmd->ClipRect.x),
-                    (int)(pcmd->ClipRect.w - pcmd->ClipRect.y)
-                    );
-                glDrawElements(
-                    GL_TRIANGLES,
-                    (GLsizei)pcmd->ElemCount,
-                    GL_UNSIGNED_SHORT,
-                    idxBuffer
-                    );
-            }
-            idxBuffer += pcmd->ElemCount;
+        if (commandList->VtxBuffer.empty() || commandList->IdxBuffer.empty()) {
+            continue;
+        }
+        if (gDrawLists.size() <= gDrawListCount) {
+            gDrawLists.resize(gDrawListCount + 1u);
+        }
+        DrawList& list = gDrawLists[gDrawListCount++];
+        list.vertices.assign(commandList->VtxBuffer.begin(), commandList->VtxBuffer.end());
+        list.indices.assign(commandList->IdxBuffer.begin(), commandList->IdxBuffer.end());
+        list.commands.assign(commandList->CmdBuffer.begin(), commandList->CmdBuffer.end());
+    }
+}
+
+void renderDrawLists() {
+    // the previous state is read from the state cache, so this doesn't cost any glGet calls
+    pg::opengl::StateCache& state = pg::opengl::stateCache();
+    const GLuint lastProgram = state.program();
+    const GLuint lastVertexArray = state.vertexArray();
+    const GLuint lastTexture = state.texture(GL_TEXTURE_2D);
+    const GLenum lastBlendSource = state.blendSource();
+    const GLenum lastBlendDestination = state.blendDestination();
+    const GLenum lastBlendEquation = state.blendEquation();
+    const bool lastEnableBlend = state.isEnabled(GL_BLEND);
+    const bool lastEnableCullFace = state.isEnabled(GL_CULL_FACE);
+    const bool lastEnableDepthTest = state.isEnabled(GL_DEPTH_TEST);
+    const bool lastEnableScissorTest = state.isEnabled(GL_SCISSOR_TEST);
+
+    // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled
+    state.setEnabled(GL_BLEND, true);
+    state.blendEquation(GL_FUNC_ADD);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.setEnabled(GL_CULL_FACE, false);
+    state.setEnabled(GL_DEPTH_TEST, false);
+    state.setEnabled(GL_SCISSOR_TEST, true);
+    state.activeTexture(GL_TEXTURE0);
+
+    // the screen space projection comes from the frame block, written by RenderSystem
+    gShader->use();
+    state.bindVertexArray(gVao);
+    for (std::size_t n = 0u; n < gDrawListCount; n++) {
+        const DrawList& commandList = gDrawLists[n];
+
+        // stream the vertex and index data
+        const std::size_t vertexBytes = commandList.vertices.size() * sizeof(ImDrawVert);
+        const std::size_t indexBytes = commandList.indices.size() * sizeof(ImDrawIdx);
+        pg::opengl::StreamBuffer::Allocation vertices = gStream->allocate(vertexBytes);
+        std::memcpy(vertices.data, commandList.vertices.data(), vertexBytes);
+        gStream->flush(vertices);
+        pg::opengl::StreamBuffer::Allocation indices = gStream->allocate(indexBytes);
+        std::memcpy(indices.data, commandList.indices.data(), indexBytes);
+        gStream->flush(indices);
+
+        state.bindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+        glVertexAttribPointer(gPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (const void*)(vertices.offset + offsetof(ImDrawVert, pos)));
+        glVertexAttribPointer(gUvAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (const void*)(vertices.offset + offsetof(ImDrawVert, uv)));
+        glVertexAttribPointer(gColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (const void*)(vertices.offset + offsetof(ImDrawVert, col)));
+        state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.buffer);
+
+        GLintptr indexOffset = indices.offset;
+        for (const ImDrawCmd& command : commandList.commands) {
+            // the original list is gone by now, so there is nothing to call the callbacks with
+            PG_ASSERT(!command.UserCallback);
+            state.bindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)command.TextureId);
+            glScissor(
+                (int)command.ClipRect.x,
+                (int)(gFramebufferHeight - command.ClipRect.w),
+                (int)(command.ClipRect.z - command.ClipRect.x),
+                (int)(command.ClipRect.w - command.ClipRect.y)
+                );
+            glDrawElements(
+                GL_TRIANGLES,
+                (GLsizei)command.ElemCount,
+                sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                (const void*)indexOffset
+                );
+            indexOffset += command.ElemCount * sizeof(ImDrawIdx);
         }
     }
-    glBindVertexArray(0u);
     gShader->stopUsing();
-    glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFunc(last_blend_src, last_blend_dst);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+    state.useProgram(lastProgram);
+    state.bindVertexArray(lastVertexArray);
+    state.bindTexture(GL_TEXTURE_2D, lastTexture);
+
+    state.blendEquation(lastBlendEquation);
+    state.blendFunc(lastBlendSource, lastBlendDestination);
+    state.setEnabled(GL_BLEND, lastEnableBlend);
+    state.setEnabled(GL_CULL_FACE, lastEnableCullFace);
+    state.setEnabled(GL_DEPTH_TEST, lastEnableDepthTest);
+    state.setEnabled(GL_SCISSOR_TEST, lastEnableScissorTest);
 }
 
 void setClipboardText(const char* text) {
@@ -133,8 +165,7 @@ ImGuiRenderer::~ImGuiRenderer() {
     if (--refCount_ == 0u) {
         ImGui::Shutdown();
         LOG_DEBUG2 << "Destructing global ImGuiRenderer resources";
-        delete gVbo;
-        glDeleteVertexArrays(1, &gVao);
+        opengl::stateCache().deleteVertexArray(gVao);
         delete gFont;
     }
     LOG_DEBUG2 << "Done destructing ImGuiRenderer resources.";
@@ -168,6 +199,12 @@ void ImGuiRenderer::render() {
     ImGui::Render();
 }
 
+void ImGuiRenderer::draw() {
+    if (gDrawListCount > 0u) {
+        renderDrawLists();
+    }
+}
+
 void ImGuiRenderer::initialize_() {
 
     ImGuiIO& io = ImGui::GetIO();
@@ -191,7 +228,7 @@ void ImGuiRenderer::initialize_() {
     io.KeyMap[ImGuiKey_Y] = SDLK_y;
     io.KeyMap[ImGuiKey_Z] = SDLK_z;
 
-    io.RenderDrawListsFn = renderDrawLists;
+    io.RenderDrawListsFn = captureDrawLists;
     io.GetClipboardTextFn = getClipboardText;
     io.SetClipboardTextFn = setClipboardText;
 
@@ -212,21 +249,22 @@ void ImGuiRenderer::createDeviceObjects_() {
     if (!gShader) {
         gShader = context_.shaderManager.get("panel");
     }
-    if (!gVbo) {
-        gVbo = new opengl::BufferObject(GL_ARRAY_BUFFER);
+    if (!gStream) {
+        gStream = context_.streamBuffer;
+        PG_ASSERT(gStream);
     }
     if (!gVao) {
-        gVbo->bind();
+        // the vertex data is streamed, so the attribute pointers are set when drawing
+        gPositionAttribute = GLuint(gShader->attribute("position"));
+        gUvAttribute = GLuint(gShader->attribute("uv"));
+        gColorAttribute = GLuint(gShader->attribute("color"));
         glGenVertexArrays(1, &gVao);
-        glBindVertexArray(gVao);
-        glVertexAttribPointer(gShader->attribute("position"), 2, GL_FLOAT, GL_FALSE, 20, 0);
-        glEnableVertexAttribArray(gShader->attribute("position"));
-        glVertexAttribPointer(gShader->attribute("uv"), 2, GL_FLOAT, GL_FALSE, 20, (const void*)8u);
-        glEnableVertexAttribArray(gShader->attribute("uv"));
-        glVertexAttribPointer(gShader->attribute("color"), 4, GL_UNSIGNED_BYTE, GL_TRUE, 20, (const void*)16);
-        glEnableVertexAttribArray(gShader->attribute("color"));
-        glBindVertexArray(0u);
-        gVbo->unbind();
+        const GLuint lastVertexArray = opengl::stateCache().vertexArray();
+        opengl::stateCache().bindVertexArray(gVao);
+        glEnableVertexAttribArray(gPositionAttribute);
+        glEnableVertexAttribArray(gUvAttribute);
+        glEnableVertexAttribArray(gColorAttribute);
+        opengl::stateCache().bindVertexArray(lastVertexArray);
     }
     if (!gFont) {
         gFont = new opengl::Texture(GL_TEXTURE_2D);
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "imgui/imgui.h"
-#include "opengl/BufferObject.h"
+#include "opengl/StreamBuffer.h"
 #include "opengl/Texture.h"
 #include "opengl/Program.h"
 
@@ -33,7 +33,16 @@ public:
     void mouseButtonReleased(int button);
 
     void newFrame(float dt, int x, int y);
+    /*
+     * @brief Finish the frame's UI, and copy its draw lists.
+     * The UI is built between newFrame and render, on any one thread at a time.
+     **/
     void render();
+    /*
+     * @brief Draw the draw lists copied by the last render. Call on the GL thread.
+     * The copy lets the next frame's UI be built while this one is drawn.
+     **/
+    void draw();
 
     // public function callbacks need to be set here
     // the idea would be to have ImGuiRenderer do something with a mouse click
@@ -2,6 +2,7 @@
 #include "component/Camera.h"
 #include "system/PickingSystem.h"
 #include "system/Events.h"
+#include "system/SpatialSystem.h"
 #include "math/Geometry.h"
 #include "math/Intersection.h"
 #include "math/Quaternion.h"
@@ -27,40 +28,44 @@ void PickingSystem::update(ecs::EntityManager& entities, ecs::EventManager& even
     // do nothing
 }
 
-ecs::Entity PickingSystem::rayCast(ecs::EntityManager& entities, ecs::EventManager& events, float x, float y) {
+math::Rayf PickingSystem::cameraRay(float x, float y) const {
     auto camera = cameraEntity_.component<component::Camera>();
     auto cameraTransform = cameraEntity_.component<component::Transform>();
-    float aspectRatio = float(context_.window->width()) / context_.window->height();
+    float aspectRatio = context_.aspectRatio();
     math::Frustumf frustum{ camera->verticalFov, aspectRatio, camera->nearPlane, camera->farPlane };
-    math::Rayf ray = math::generateCameraRay(cameraTransform->position, cameraTransform->rotation, frustum, x, y);
-    math::Rayf testRay = ray;
+    return math::generateCameraRay(cameraTransform->position, cameraTransform->rotation, frustum, x, y);
+}
+
+ecs::Entity PickingSystem::rayCast(ecs::EntityManager& entities, ecs::EventManager& events, float x, float y) {
+    math::Rayf ray = cameraRay(x, y);
 
     events.emit<RenderDebugLine>(ray.origin, ray.direction * 50.f, 5.f);
-    bool result = false;
 
     float smallest = std::numeric_limits<float>::max();
     ecs::Entity target{};
 
-    for (ecs::Entity entity : entities.join<component::Transform, math::AABoxf>()) {
+    const math::AabbTree& tree = context_.systemManager.system<SpatialSystem>().tree();
+    tree.queryRay(ray, [&](std::uint32_t index) -> float {
+        ecs::Entity entity = entities.get(index);
+        if (!entity.has<component::Transform>()) {
+            return std::numeric_limits<float>::max();
+        }
         auto transform = entity.component<component::Transform>();
         auto aabb = entity.component<math::AABoxf>();
-        math::Vec3f min = aabb->min.hadamard(transform->scale) + transform->position;
-        math::Vec3f max = aabb->max.hadamard(transform->scale) + transform->position;
-        math::Vec3f center = 0.5f * (min + max);
-        math::Spheref sphere{ center, (center - min).norm() };
-
-        if (math::rayIntersectsSphere(testRay, sphere)) {
-            result = math::rayIntersectsAABox(
-                ray,
-                *aabb,
-                transform->position, transform->rotation, transform->scale
-                );
-            if (ray.t < smallest) {
-                smallest = ray.t;
-                target = entity;
-            }
+        math::Rayf testRay = ray;
+        if (!math::rayIntersectsAABox(
+            testRay,
+            *aabb,
+            transform->position, transform->rotation, transform->scale
+            )) {
+            return std::numeric_limits<float>::max();
+        }
+        if (testRay.t < smallest) {
+            smallest = testRay.t;
+            target = entity;
         }
-    }
+        return testRay.t;
+    });
     return target;
 }
 
@@ -2,6 +2,7 @@
 
 #include "component/Include.h"
 #include "ecs/Entity.h"
+#include "math/Geometry.h"
 
 namespace pg {
 
@@ -23,6 +24,8 @@ public:
     void receive(const ecs::ComponentAssignedEvent<component::Camera>&);
     void update(ecs::EntityManager&, ecs::EventManager&, float) override;
 
+    // the ray through normalized device coordinates, from the active camera
+    math::Rayf cameraRay(float x, float y) const;
     // cast a ray from mouse coordinates
     ecs::Entity rayCast(ecs::EntityManager&, ecs::EventManager&, float x, float y);
 
@@ -1,12 +1,17 @@
 #include "system/RenderSystem.h"
 #include "system/Material.h"
+#include "system/SpatialSystem.h"
+#include "opengl/StateCache.h"
 #include "opengl/Use.h"
 #include "opengl/VertexAttributes.h"
+#include "math/Quantize.h"
 #include "component/Include.h"
 #include "utils/Log.h"
 #include "utils/Assert.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <utility>
 
 namespace {
@@ -14,6 +19,42 @@ namespace {
 const float DegreesToRads = 3.141592653f / 180.0f;
 const float RadsToDegrees = 180.0f / 3.141592653f;
 const float Pi = 3.141592653f;
+// smaller ranges aren't worth waking up a worker for
+const std::size_t MinRecordRange = 64u;
+// a light's radius is where its brightest channel has attenuated to this
+const float LightCutoff = 1.f / 256.f;
+// the ambient coefficient when there are no lights
+const float DefaultAmbientCoefficient = 0.5f;
+const float DefaultNear = 0.1f;
+const float DefaultFar = 100.f;
+// the width of the occlusion buffer, its height follows the window's aspect ratio
+const std::uint32_t OcclusionWidth = 256u;
+
+float lightRadius(const pg::component::PointLight& light, float farPlane) {
+    const float brightest = std::max(light.intensity.x, std::max(light.intensity.y, light.intensity.z));
+    if (brightest <= LightCutoff) {
+        return 0.f;
+    }
+    if (light.attenuation <= 0.f) {
+        // the light never fades, so it reaches everything in view
+        return std::numeric_limits<float>::max();
+    }
+    return std::min(std::sqrt((brightest / LightCutoff - 1.f) / light.attenuation), 2.f * farPlane);
+}
+
+// no entity has this id
+const std::uint64_t NoEntity = ~std::uint64_t(0u);
+
+pg::system::RenderItem renderItem(pg::ecs::Entity entity, const pg::component::Transform& transform) {
+    const pg::component::Renderable& renderable = *entity.component< pg::component::Renderable >();
+    return pg::system::RenderItem{
+        transform,
+        renderable.mesh,
+        renderable.attributes.object(),
+        renderable.material,
+        entity.id().index()
+    };
+}
 
 }
 
@@ -23,26 +64,86 @@ namespace system {
 RenderSystem::RenderSystem(Context& context)
     : System(),
     cameraEntity_{},
-    lightEntity_{},
     defaultProjection_{},
     defaultLight_{},
     defaultState_{},
+    frames_{},
+    unhideableItems_{},
+    batchesDirty_{ false },
+    staticGeneration_{ 0u },
+    previousTransforms_{},
+    previousIds_{},
+    alpha_{ 1.f },
+    renderItems_{},
+    lods_{},
+    commandLists_{},
+    drawCommands_{},
+    frameStats_{},
+    frameBlock_{ *context.streamBuffer, opengl::BlockBinding::Frame, sizeof(opengl::FrameBlock) },
+    objectBlocks_{ *context.streamBuffer, opengl::BlockBinding::Object, sizeof(opengl::ObjectBlock) },
+    lightSpheres_{},
+    lightClusters_{},
+    lightData_{},
+    lightDataBuffer_{ GL_TEXTURE_BUFFER },
+    lightClusterBuffer_{ GL_TEXTURE_BUFFER },
+    lightIndexBuffer_{ GL_TEXTURE_BUFFER },
+    lightDataTexture_{ GL_TEXTURE_BUFFER },
+    lightClusterTexture_{ GL_TEXTURE_BUFFER },
+    lightIndexTexture_{ GL_TEXTURE_BUFFER },
+    occlusionBuffer_{},
+    occluders_{},
+    occluderMeshes_{},
+    staticBatches_{ context.meshManager },
+    batchGeneration_{ 0u },
     context_{ context },
     debug_{ false } {
-    defaultProjection_ = Matrix4f::perspective(70.0f, 1.5f, 0.1f, 100.0f);
+    defaultProjection_ = Matrix4f::perspective(70.0f, 1.5f, DefaultNear, DefaultFar);
+    // the texture buffers refer to the buffer objects, so respecifying the buffers doesn't detach them
+    lightDataTexture_.setStore(GL_RGBA32F, lightDataBuffer_);
+    lightClusterTexture_.setStore(GL_RG32UI, lightClusterBuffer_);
+    lightIndexTexture_.setStore(GL_R32UI, lightIndexBuffer_);
+    // the UI draws with the frame block too, so make sure it is valid before the first frame
+    writeFrameBlock_(frames_.read(), DefaultAmbientCoefficient);
 }
 
 void RenderSystem::configure(ecs::EventManager& events) {
     events.subscribe< ecs::ComponentAssignedEvent<Camera> >(*this);
-    events.subscribe< ecs::ComponentAssignedEvent<PointLight> >(*this);
+    events.subscribe< MeshLoaded >(*this);
+    events.subscribe< ecs::ComponentAssignedEvent<Static> >(*this);
+    events.subscribe< ecs::ComponentRemovedEvent<Static> >(*this);
+    events.subscribe< ecs::EntityDestroyedEvent >(*this);
 }
 
 void RenderSystem::receive(const ecs::ComponentAssignedEvent< Camera >& event) {
     cameraEntity_ = event.entity;
 }
 
-void RenderSystem::receive(const ecs::ComponentAssignedEvent< PointLight >& event) {
-    lightEntity_ = event.entity;
+void RenderSystem::receive(const MeshLoaded& event) {
+    // the occluder mesh was read from the placeholder
+    occluderMeshes_.erase(event.mesh);
+    // the renderables draw the loaded mesh already, but their boxes are still the placeholder's
+    for (ecs::Entity entity : context_.entityManager.join< Renderable, AABoxf >()) {
+        if (entity.component< Renderable >()->mesh == event.mesh) {
+            *entity.rawPointer< AABoxf >() = event.mesh->bounds;
+            context_.eventManager.emit< BoundsChanged >(entity);
+            // the batches contain the placeholder
+            batchesDirty_ = batchesDirty_ || entity.has< Static >();
+        }
+    }
+}
+
+void RenderSystem::receive(const ecs::ComponentAssignedEvent< Static >&) {
+    batchesDirty_ = true;
+}
+
+void RenderSystem::receive(const ecs::ComponentRemovedEvent< Static >&) {
+    batchesDirty_ = true;
+}
+
+void RenderSystem::receive(const ecs::EntityDestroyedEvent& event) {
+    if (event.entity.has< Static >()) {
+        batchesDirty_ = true;
+    }
 }
 
 void RenderSystem::update(
@@ -50,19 +151,20 @@ void RenderSystem::update(
     ecs::EventManager& events,
     float dt
     ) {
-    Matrix4f cameraMatrix{ defaultProjection_ };
-    Vec3f cameraPos{};
-    Vec3f lightPos{};
-    Vec3f lightIntensity{};
-    float attenuation = 1.0f;
-    float ambientCoefficient = 0.5f;
+    RenderFrame& frame = frames_.write();
+    frame.cameraMatrix = defaultProjection_;
+    frame.worldToView = Matrix4f{};
+    frame.cameraPosition = Vec3f{};
+    frame.cameraForward = Vec3f{ 0.f, 0.f, -1.f };
+    frame.projectionScale = defaultProjection_.data[5];
+    frame.clusterGrid = math::ClusterGrid{ defaultProjection_, DefaultNear, DefaultFar };
 
     if (cameraEntity_.isValid()) {
-        float aspectRatio = float(context_.window->width()) / context_.window->height();
-        auto transform = cameraEntity_.component< Transform >();
-        auto view = Matrix4f::translation(transform->position)
-            * Matrix4f::rotation(transform->rotation)
-            * Matrix4f::scale(transform->scale);
+        float aspectRatio = context_.aspectRatio();
+        const Transform transform = interpolated_(cameraEntity_);
+        auto view = Matrix4f::translation(transform.position)
+            * Matrix4f::rotation(transform.rotation)
+            * Matrix4f::scale(transform.scale);
         auto camera = cameraEntity_.component< Camera >();
         auto proj = Matrix4f::perspective(
             camera->verticalFov,
@@ -70,63 +172,336 @@ void RenderSystem::update(
             camera->nearPlane,
             camera->farPlane
             );
-        cameraMatrix = proj * view.inverse();
+        frame.worldToView = view.inverse();
+        frame.cameraMatrix = proj * frame.worldToView;
+        frame.cameraPosition = transform.position;
+        // the view looks along -z
+        frame.cameraForward = Vec3f{ -view.data[2], -view.data[6], -view.data[10] }.normalized();
+        frame.projectionScale = proj.data[5];
+        frame.clusterGrid = math::ClusterGrid{ proj, camera->nearPlane, camera->farPlane };
     }
 
-    if (lightEntity_.isValid()) {
-        lightPos = lightEntity_.component< Transform >()->position;
-        lightIntensity = lightEntity_.component< PointLight >()->intensity;
-        attenuation = lightEntity_.component< PointLight >()->attenuation;
-        ambientCoefficient = lightEntity_.component< PointLight >()->ambientCoefficient;
+    frame.lights.clear();
+    for (ecs::Entity entity : entities.join< Transform, PointLight >()) {
+        frame.lights.push_back(LightItem{ interpolated_(entity).position, *entity.component< PointLight >() });
     }
 
+    frame.occluders.clear();
+    for (ecs::Entity entity : entities.join< Transform, Renderable, Occluder >()) {
+        const Transform transform = interpolated_(entity);
+        frame.occluders.push_back(OccluderItem{
+            Matrix4f::translation(transform.position) * Matrix4f::rotation(transform.rotation) * Matrix4f::scale(transform.scale),
+            entity.component< Renderable >()->mesh
+        });
+    }
+
+    if (batchesDirty_) {
+        StaticBatches::gather(entities, frame.staticItems);
+        staticGeneration_++;
+        batchesDirty_ = false;
+    }
+    frame.staticGeneration = staticGeneration_;
+
+    /*
+    * Copy the renderables inside the view frustum. The static ones are drawn in batches. The
+    * occluders would hide themselves, and entities without a bounding box can't be tested, so
+    * they go after the ones which the occluders can hide.
+    */
+    frame.items.clear();
+    frame.bounds.clear();
+    unhideableItems_.clear();
+    const FrustumPlanesf frustum{ frame.cameraMatrix };
+    const AabbTree& tree = context_.systemManager.system<SpatialSystem>().tree();
+    tree.queryFrustum(frustum, [this, &entities, &frame](std::uint32_t index) -> void {
+        ecs::Entity entity = entities.get(index);
+        if (!entity.has<Transform>() || !entity.has<Renderable>() || entity.has<Static>()) {
+            return;
+        }
+        if (entity.has<Occluder>()) {
+            unhideableItems_.push_back(renderItem(entity, interpolated_(entity)));
+            return;
+        }
+        frame.items.push_back(renderItem(entity, interpolated_(entity)));
+        frame.bounds.push_back(*entity.component<AABoxf>());
+    });
+    for (ecs::Entity entity : entities.join< Transform, Renderable>()) {
+        if (!entity.has<AABoxf>() && !entity.has<Static>()) {
+            unhideableItems_.push_back(renderItem(entity, interpolated_(entity)));
+        }
+    }
+    frame.items.insert(frame.items.end(), unhideableItems_.begin(), unhideableItems_.end());
+}
+
+void RenderSystem::storePreviousTransforms(ecs::EntityManager& entities) {
+    std::fill(previousIds_.begin(), previousIds_.end(), NoEntity);
+    for (ecs::Entity entity : entities.join< Transform >()) {
+        const std::uint32_t index = entity.id().index();
+        if (index >= previousIds_.size()) {
+            previousIds_.resize(index + 1u, NoEntity);
+            previousTransforms_.resize(index + 1u);
+        }
+        previousIds_[index] = entity.id().id();
+        previousTransforms_[index] = *entity.component< Transform >();
+    }
+}
+
+void RenderSystem::setInterpolation(float alpha) {
+    alpha_ = std::min(std::max(alpha, 0.f), 1.f);
+}
+
+Transform RenderSystem::interpolated_(ecs::Entity entity) const {
+    const Transform& current = *entity.component< Transform >();
+    const std::uint32_t index = entity.id().index();
+    // entities which didn't exist, or had no transform, before the step are drawn as they are
+    if (alpha_ >= 1.f || index >= previousIds_.size() || previousIds_[index] != entity.id().id()) {
+        return current;
+    }
+    const Transform& previous = previousTransforms_[index];
+    return Transform{
+        previous.position + (current.position - previous.position) * alpha_,
+        math::nlerp(previous.rotation, current.rotation, alpha_),
+        previous.scale + (current.scale - previous.scale) * alpha_
+    };
+}
+
+void RenderSystem::render() {
+    const RenderFrame& frame = frames_.read();
+    const float ambientCoefficient = assignLights_(frame);
+    writeFrameBlock_(frame, ambientCoefficient);
+    bindLightTextures_();
+
+    if (frame.staticGeneration != batchGeneration_) {
+        staticBatches_.rebuild(frame.staticItems);
+        batchGeneration_ = frame.staticGeneration;
+    }
+
+    /*
+    * Drop the items hidden behind the occluders
+    */
+    const bool occlusion = renderOccluders_(frame);
+    frameStats_.occluded = 0u;
+    const std::vector<RenderItem>* visible = &frame.items;
+    if (occlusion) {
+        renderItems_.clear();
+        for (std::size_t i = 0u; i < frame.items.size(); ++i) {
+            const RenderItem& item = frame.items[i];
+            if (i < frame.bounds.size()) {
+                const AABoxf box = transformAABox(frame.bounds[i], item.transform.position, item.transform.rotation, item.transform.scale);
+                if (!occlusionBuffer_.isVisible(box)) {
+                    frameStats_.occluded++;
+                    continue;
+                }
+            }
+            renderItems_.push_back(item);
+        }
+        visible = &renderItems_;
+    }
+
+    /*
+    * Record: write the object blocks and the draw commands for disjoint ranges of the items in parallel
+    */
+    std::uint32_t entityCount = 0u;
+    for (const RenderItem& item : *visible) {
+        entityCount = std::max(entityCount, item.entity + 1u);
+    }
+    if (lods_.size() < entityCount) {
+        lods_.resize(entityCount, 0u);
+    }
+    objectBlocks_.allocate(visible->size());
+    ThreadPool& pool = context_.threadPool;
+    if (commandLists_.size() < pool.size()) {
+        commandLists_.resize(pool.size());
+    }
+    const RenderItem* items = visible->data();
+    std::uint32_t* lods = lods_.data();
+    char* blocks = objectBlocks_.data();
+    const std::size_t stride = objectBlocks_.stride();
+    const LodCamera lodCamera{ frame.cameraPosition, frame.projectionScale };
+    const std::size_t lists = pool.parallelFor(visible->size(), MinRecordRange,
+        [this, &lodCamera, items, lods, blocks, stride](std::size_t begin, std::size_t end, std::size_t list) -> void {
+            commandLists_[list].clear();
+            recordDrawCommands(lodCamera, items, begin, end, lods, blocks, stride, commandLists_[list]);
+        });
+    objectBlocks_.flush();
+    mergeDrawCommands(commandLists_, lists, drawCommands_);
+
+    /*
+    * Submit: replay the merged commands on this thread, which owns the GL context
+    */
     {
         opengl::Program* shader = context_.shaderManager.get("specular");
         opengl::UseProgram use(*shader);
+        opengl::StateCache& state = opengl::stateCache();
+        const GLuint lastVertexArray = state.vertexArray();
 
-        /*
-        * Then, iterate over renderables
-        */
-        for (ecs::Entity entity : entities.join< Transform, Renderable>()) {
-            auto renderable = entity.component< Renderable>();
-            auto transform = entity.component< Transform>();
-            shader->setUniform(
-                "model",
-                Matrix4f::translation(transform->position)
-                * Matrix4f::rotation(transform->rotation)
-                * Matrix4f::scale(transform->scale)
-                );
-            shader->setUniform("camera", cameraMatrix);
-            /*for (const auto& it : renderable->material.uniforms) {
-                shader->setUniform(it.first.c_str(), it.second);
-            }*/
-            shader->setUniform("shininess", renderable->material.shininess);
-            shader->setUniform("base", renderable->material.baseColor);
-            shader->setUniform("ambient", renderable->material.ambientColor);
-            shader->setUniform("specularColor", renderable->material.specularColor);
-            shader->setUniform("pointLight.position", lightPos);
-            shader->setUniform("pointLight.intensity", lightIntensity);
-            shader->setUniform("pointLight.attenuation", attenuation);
-            shader->setUniform("pointLight.ambientCoefficient", ambientCoefficient);
-            renderable->attributes.bind();
-            glDrawArrays(GL_TRIANGLES, 0, renderable->vbo->count() / renderable->attributes.elementsPerIndex());
-            renderable->attributes.unbind();
+        frameStats_.drawCalls = 0u;
+        frameStats_.triangles = 0u;
+        for (const DrawCommand& command : drawCommands_) {
+            objectBlocks_.bind(command.block);
+            state.bindVertexArray(command.vertexArray);
+            const void* indexOffset = reinterpret_cast<const void*>(command.indexOffset);
+            if (command.baseVertex != 0) {
+                glDrawElementsBaseVertex(GL_TRIANGLES, command.indexCount, command.indexType, indexOffset, command.baseVertex);
+            }
+            else {
+                glDrawElements(GL_TRIANGLES, command.indexCount, command.indexType, indexOffset);
+            }
+            frameStats_.drawCalls++;
+            frameStats_.triangles += std::size_t(command.indexCount) / 3u;
         }
+        state.bindVertexArray(lastVertexArray);
     }
+    const FrustumPlanesf frustum{ frame.cameraMatrix };
+    staticBatches_.draw(*context_.shaderManager.get("static"), frustum, frameStats_.drawCalls, frameStats_.triangles);
+}
+
+void RenderSystem::swapFrames() {
+    frames_.swap();
 }
 
-void RenderSystem::setSpecularUniforms_(const Vec3f& pos, opengl::Program* p) {
-    p->setUniform("cameraPosition", pos);
+void RenderSystem::writeFrameBlock_(const RenderFrame& renderFrame, float ambientCoefficient) {
+    frameBlock_.allocate(1u);
+    opengl::FrameBlock& frame = frameBlock_.block<opengl::FrameBlock>(0u);
+    frame.camera = renderFrame.cameraMatrix;
+    // maps window pixel coordinates, with the origin in the top-left corner, to clip space
+    const float width = float(context_.window->width());
+    const float height = float(context_.window->height());
+    frame.screen = Matrix4f{
+        2.f / width, 0.f, 0.f, -1.f,
+        0.f, -2.f / height, 0.f, 1.f,
+        0.f, 0.f, -1.f, 0.f,
+        0.f, 0.f, 0.f, 1.f
+    };
+    frame.cameraPosition = renderFrame.cameraPosition;
+    frame.ambientCoefficient = ambientCoefficient;
+    frame.cameraForward = renderFrame.cameraForward;
+    frame.clusterScale = Vec4f{
+        float(math::ClusterGrid::CountX) / width,
+        float(math::ClusterGrid::CountY) / height,
+        renderFrame.clusterGrid.depthScale,
+        renderFrame.clusterGrid.depthBias
+    };
+    frame.clusterCounts[0] = std::int32_t(math::ClusterGrid::CountX);
+    frame.clusterCounts[1] = std::int32_t(math::ClusterGrid::CountY);
+    frame.clusterCounts[2] = std::int32_t(math::ClusterGrid::CountZ);
+    frame.clusterCounts[3] = 0;
+    frameBlock_.flush();
+    frameBlock_.bind(0u);
+}
+
+float RenderSystem::assignLights_(const RenderFrame& frame) {
+    /*
+    * Gather the lights in world space for the shaders, and in view space for the assignment.
+    * Lights entirely behind the camera or beyond the far plane don't reach any cluster.
+    */
+    lightSpheres_.clear();
+    lightData_.clear();
+    float ambientSum = 0.f;
+    std::size_t lightCount = 0u;
+    const math::ClusterGrid& grid = frame.clusterGrid;
+    for (const LightItem& item : frame.lights) {
+        const PointLight& light = item.light;
+        const Vec3f& position = item.position;
+        ambientSum += light.ambientCoefficient;
+        lightCount++;
+        const float radius = lightRadius(light, grid.farPlane);
+        const Vec4f view = frame.worldToView * Vec4f{ position, 1.f };
+        const float depth = -view.z;
+        if (radius <= 0.f || depth + radius < grid.nearPlane || depth - radius > grid.farPlane) {
+            continue;
+        }
+        lightSpheres_.push_back(Vec3f{ view.x, view.y, view.z }, radius);
+        lightData_.push_back(Vec4f{ position, radius });
+        lightData_.push_back(Vec4f{ light.intensity, light.attenuation });
+    }
+    lightClusters_.assign(grid, lightSpheres_, context_.threadPool);
+    frameStats_.lights = lightSpheres_.size();
+    frameStats_.clusterLights = lightClusters_.indices().size();
+
+    // texel fetches from an empty buffer are undefined, so the buffers always get at least one element
+    if (lightData_.empty()) {
+        lightData_.push_back(Vec4f{});
+    }
+    const std::uint32_t noIndex = 0u;
+    const std::vector<std::uint32_t>& indices = lightClusters_.indices();
+    lightDataBuffer_.dataStore(GLsizeiptr(lightData_.size()), sizeof(Vec4f), lightData_.data(), GL_STREAM_DRAW);
+    lightClusterBuffer_.dataStore(GLsizeiptr(lightClusters_.clusters().size()), sizeof(std::uint32_t), lightClusters_.clusters().data(), GL_STREAM_DRAW);
+    lightIndexBuffer_.dataStore(
+        GLsizeiptr(std::max(indices.size(), std::size_t(1u))),
+        sizeof(std::uint32_t),
+        indices.empty() ? &noIndex : indices.data(),
+        GL_STREAM_DRAW
+    );
+    return lightCount > 0u ? ambientSum / float(lightCount) : DefaultAmbientCoefficient;
+}
+
+void RenderSystem::bindLightTextures_() {
+    opengl::StateCache& state = opengl::stateCache();
+    const GLenum lastUnit = state.activeTexture();
+    state.activeTexture(GL_TEXTURE0 + GLenum(opengl::TextureUnit::LightData));
+    state.bindTexture(GL_TEXTURE_BUFFER, lightDataTexture_.object());
+    state.activeTexture(GL_TEXTURE0 + GLenum(opengl::TextureUnit::LightClusters));
+    state.bindTexture(GL_TEXTURE_BUFFER, lightClusterTexture_.object());
+    state.activeTexture(GL_TEXTURE0 + GLenum(opengl::TextureUnit::LightIndices));
+    state.bindTexture(GL_TEXTURE_BUFFER, lightIndexTexture_.object());
+    state.activeTexture(lastUnit);
+}
+
+bool RenderSystem::renderOccluders_(const RenderFrame& frame) {
+    occluders_.clear();
+    for (const OccluderItem& item : frame.occluders) {
+        const Mesh* mesh = item.mesh;
+        auto it = occluderMeshes_.find(mesh);
+        if (it == occluderMeshes_.end()) {
+            // read the full detail mesh back, and dequantize the positions
+            OccluderMesh occluderMesh{};
+            std::vector<MeshVertex> vertices;
+            context_.meshManager.download(*mesh, vertices, occluderMesh.indices);
+            occluderMesh.positions.reserve(vertices.size());
+            for (const MeshVertex& vertex : vertices) {
+                const Vec4f p = mesh->dequantize * Vec4f{
+                    math::dequantizeSnorm16(vertex.position[0]),
+                    math::dequantizeSnorm16(vertex.position[1]),
+                    math::dequantizeSnorm16(vertex.position[2]),
+                    1.f
+                };
+                occluderMesh.positions.push_back(Vec3f{ p.x, p.y, p.z });
+            }
+            it = occluderMeshes_.emplace(mesh, std::move(occluderMesh)).first;
+        }
+        const OccluderMesh& occluderMesh = it->second;
+        occluders_.push_back(math::OccluderInstance{
+            item.world,
+            occluderMesh.positions.data(),
+            occluderMesh.positions.size(),
+            occluderMesh.indices.data(),
+            occluderMesh.indices.size()
+        });
+    }
+    frameStats_.occluderTriangles = 0u;
+    if (occluders_.empty()) {
+        return false;
+    }
+
+    const unsigned windowWidth = std::max(context_.window->width(), 1u);
+    occlusionBuffer_.resize(OcclusionWidth, std::max(OcclusionWidth * context_.window->height() / windowWidth, 1u));
+    occlusionBuffer_.render(frame.cameraMatrix, occluders_, context_.threadPool);
+    frameStats_.occluderTriangles = occlusionBuffer_.triangleCount();
+    return true;
 }
 
 CameraInfo RenderSystem::activeCameraInfo() const {
     PG_ASSERT(cameraEntity_.isValid());
     auto camera = cameraEntity_.component<Camera>();
     auto transform = cameraEntity_.component<Transform>();
-    float aspectRatio = float(context_.window->width()) / context_.window->height();
+    float aspectRatio = context_.aspectRatio();
     Frustumf frustum{ camera->verticalFov, aspectRatio, camera->nearPlane, camera->farPlane };
     return CameraInfo{ frustum, transform->position, transform->rotation, camera->verticalFov };
 }
 
+const RenderSystem::FrameStats& RenderSystem::frameStats() const {
+    return frameStats_;
+}
+
 }
 }
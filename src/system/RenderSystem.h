@@ -9,8 +9,17 @@
 #include "math/Vector.h"
 #include "math/Quaternion.h"
 #include "math/Geometry.h"
+#include "math/LightClusters.h"
+#include "math/OcclusionBuffer.h"
 #include "opengl/BufferObject.h"
+#include "opengl/Texture.h"
+#include "opengl/UniformBlockBuffer.h"
+#include "system/DrawCommands.h"
+#include "system/StaticBatches.h"
+#include "utils/DoubleBuffer.h"
+#include <unordered_map>
 #include <vector>
+#include <cstdint>
 
 namespace pg {
 namespace system {
@@ -25,18 +34,53 @@ struct CameraInfo {
     float fov;
 };
 
+/**
+ * @class RenderSystem
+ * @brief Draws the renderables, with clustered point lights and occlusion culling.
+ *
+ * The simulation and the renderer run concurrently. update runs on the simulation thread, and
+ * copies the camera, the lights, the occluders and the renderables in the view frustum into a
+ * frame of plain data. render runs on the GL thread, and draws the last published frame without
+ * touching the components. swapFrames publishes the frame update wrote, while both are idle.
+ */
 class RenderSystem : public ecs::System, public ecs::Receiver {
 public:
     RenderSystem() = delete;
     explicit RenderSystem(Context& context);
 
     void configure(ecs::EventManager&) override;
+    /// @brief Copy the render state of the entities into the next frame.
+    /// The transforms are interpolated, see setInterpolation.
     void update(ecs::EntityManager&, ecs::EventManager&, float) override;
+    /// @brief Remember the transforms before a simulation step. Call before each step.
+    void storePreviousTransforms(ecs::EntityManager&);
+    /// @brief Make update draw the transforms alpha of the way from the ones before the last
+    /// step to the current ones. With 1, the current ones are drawn as they are.
+    void setInterpolation(float alpha);
+    /// @brief Draw the published frame. Call on the GL thread.
+    void render();
+    /// @brief Publish the frame written by update. Call while neither update nor render runs.
+    void swapFrames();
     void receive(const ecs::ComponentAssignedEvent<Camera>&);
-    void receive(const ecs::ComponentAssignedEvent<PointLight>&);
+    void receive(const MeshLoaded&);
+    void receive(const ecs::ComponentAssignedEvent<Static>&);
+    void receive(const ecs::ComponentRemovedEvent<Static>&);
+    void receive(const ecs::EntityDestroyedEvent&);
 
     CameraInfo activeCameraInfo() const;
 
+    struct FrameStats {
+        std::size_t drawCalls{ 0u };
+        std::size_t triangles{ 0u };
+        std::size_t lights{ 0u };           // the point lights in range of the view frustum
+        std::size_t clusterLights{ 0u };    // the light index list entries of all clusters
+        std::size_t occluderTriangles{ 0u };    // rasterized into the occlusion buffer
+        std::size_t occluded{ 0u };         // renderables in the frustum, but hidden by occluders
+    };
+
+    /// @brief The draw calls, triangles, lights and occlusion culling of the last render.
+    const FrameStats& frameStats() const;
+
 private:
 
     struct DefaultState {
@@ -44,18 +88,101 @@ private:
         DirectionalLight light;
     };
 
-    // camera position passed as parameter
-    void setSpecularUniforms_(const Vec3f&, opengl::Program*);
+    // the full detail positions and triangles of an occluder's mesh, in model space
+    struct OccluderMesh {
+        std::vector<Vec3f>          positions;
+        std::vector<std::uint32_t>  indices;
+    };
 
+    struct LightItem {
+        Vec3f       position;       // in world space
+        PointLight  light;
+    };
+
+    struct OccluderItem {
+        Matrix4f    world;
+        const Mesh* mesh;
+    };
+
+    // everything render needs, copied out of the components by update
+    struct RenderFrame {
+        Matrix4f            cameraMatrix{};
+        Matrix4f            worldToView{};
+        Vec3f               cameraPosition{};
+        Vec3f               cameraForward{ 0.f, 0.f, -1.f };
+        float               projectionScale{ 1.f };
+        math::ClusterGrid   clusterGrid{};
+        // the non-static renderables in the view frustum
+        std::vector<RenderItem>     items{};
+        // the model space boxes of the first bounds.size() items, the ones the occluders can hide
+        std::vector<AABoxf>         bounds{};
+        std::vector<LightItem>      lights{};
+        std::vector<OccluderItem>   occluders{};
+        // gathered when the static renderables change, for the batches of staticGeneration
+        std::vector<StaticBatches::Item>    staticItems{};
+        std::uint64_t               staticGeneration{ 0u };
+    };
+
+    // write the camera, screen and light state, and bind the block for all programs
+    void writeFrameBlock_(const RenderFrame& frame, float ambientCoefficient);
+    // assign the point lights to the clusters, upload the lights and the cluster lists, and
+    // return the average ambient coefficient of the lights
+    float assignLights_(const RenderFrame& frame);
+    void  bindLightTextures_();
+    // rasterize the occluders, returns false if there are none
+    bool  renderOccluders_(const RenderFrame& frame);
+    // the entity's transform, interpolated from the stored one
+    Transform interpolated_(ecs::Entity entity) const;
+
+    /*
+    * Simulation side, used by update
+    */
     // render state entities
     ecs::Entity     cameraEntity_;
-    ecs::Entity     lightEntity_;   // for now the world shall have one light and it shall be a directional light
 
     // render state math
     Matrix4f  defaultProjection_;
     DirectionalLight defaultLight_;
     DefaultState defaultState_;
 
+    DoubleBuffer<RenderFrame>   frames_;
+    std::vector<RenderItem>     unhideableItems_;   // collected separately, they go after the others
+    bool                        batchesDirty_;      // the static renderables are gathered in the next update
+    std::uint64_t               staticGeneration_;  // incremented for each gather
+    // the transforms before the last step, and the ids of their entities, by entity index
+    std::vector<Transform>      previousTransforms_;
+    std::vector<std::uint64_t>  previousIds_;
+    float                       alpha_;
+
+    /*
+    * GL side, used by render
+    */
+    // reused between frames to avoid reallocating
+    std::vector<RenderItem>  renderItems_;      // the items the occluders don't hide
+    std::vector<std::uint32_t>  lods_;          // the detail level drawn last, by entity index
+    std::vector<CommandList> commandLists_;     // one per thread pool range
+    CommandList              drawCommands_;     // the merged, sorted commands
+    FrameStats               frameStats_;
+    opengl::UniformBlockBuffer  frameBlock_;
+    opengl::UniformBlockBuffer  objectBlocks_;   // one block per visible entity
+    // clustered lighting, see math::LightClusters
+    math::LightSpheres       lightSpheres_;     // in view space
+    math::LightClusters      lightClusters_;
+    std::vector<Vec4f>       lightData_;        // two texels per light, see TextureUnit::LightData
+    opengl::BufferObject     lightDataBuffer_;
+    opengl::BufferObject     lightClusterBuffer_;
+    opengl::BufferObject     lightIndexBuffer_;
+    opengl::Texture          lightDataTexture_;
+    opengl::Texture          lightClusterTexture_;
+    opengl::Texture          lightIndexTexture_;
+    // occlusion culling, see math::OcclusionBuffer
+    math::OcclusionBuffer    occlusionBuffer_;
+    std::vector<math::OccluderInstance> occluders_;
+    // the meshes of the occluders, read back from the GPU once
+    std::unordered_map<const Mesh*, OccluderMesh> occluderMeshes_;
+    StaticBatches            staticBatches_;
+    std::uint64_t            batchGeneration_;  // the generation of the static items the batches were built from
+
     Context& context_;
     bool    debug_;
 };
@@ -2,8 +2,10 @@
 #include "app/KeyboardManager.h"
 #include "app/MouseEvents.h"
 #include "app/Context.h"
+#include "utils/AllocationTracker.h"
 #include "utils/Assert.h"
 #include "utils/Log.h"
+#include "utils/Profiler.h"
 
 namespace pg {
 namespace system {
@@ -62,6 +64,8 @@ void ScriptSystem::update(ecs::EntityManager& entities, ecs::EventManager& event
                 vm.executeString(
                     "import \"pg/entity\" for Entity\n"
                     "var entity = Entity.new()\n"
+                    // the script assigns its own, if it draws anything
+                    "var draw = Fn.new { |dt| }\n"
                     );
                 {
                     auto set = vm.method("main", "entity", "set_(_)");
@@ -86,6 +90,14 @@ void ScriptSystem::update(ecs::EntityManager& entities, ecs::EventManager& event
     }
 }
 
+void ScriptSystem::draw(float dt) {
+    PG_PROFILE_ZONE("ScriptSystem::draw");
+    PG_ALLOCATION_TAG("ScriptSystem::draw");
+    for (ecs::Entity entity : context_.entityManager.join< component::Script >()) {
+        entity.component< component::Script >()->draw(dt);
+    }
+}
+
 void ScriptSystem::receive(const ecs::ComponentAssignedEvent< component::Script >& event) {
     event.component->activate();
     containedScripts_.add(event.component->scriptId);
@@ -22,7 +22,11 @@ class ScriptSystem : public ecs::System, public ecs::Receiver {
 public:
     ScriptSystem(Context& context, KeyboardManager&, MouseEvents&);
     void configure(ecs::EventManager&) override;
+    /// @brief Call the scripts' update, once per simulation step.
     void update(ecs::EntityManager&, ecs::EventManager&, float) override;
+    /// @brief Call the scripts' draw, once per frame after the steps. The scripts build their UI
+    /// and debug draw lists there, so that they are submitted once per frame, however many steps it ran.
+    void draw(float dt);
 
     void receive(const ecs::ComponentAssignedEvent< component::Script >&);
     void receive(const ecs::ComponentRemovedEvent< component::Script >&);
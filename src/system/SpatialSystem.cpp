@@ -0,0 +1,103 @@
+#include "system/SpatialSystem.h"
+#include <algorithm>
+
+namespace {
+
+// the tree is rebuilt with the SAH once this many leaves have been inserted incrementally
+const std::size_t MinRebuildInsertions = 64u;
+
+}
+
+namespace pg {
+namespace system {
+
+void SpatialSystem::configure(ecs::EventManager& events) {
+    events.subscribe<ecs::ComponentAssignedEvent<math::AABoxf>>(*this);
+    events.subscribe<ecs::ComponentRemovedEvent<math::AABoxf>>(*this);
+    events.subscribe<ecs::ComponentAssignedEvent<component::Transform>>(*this);
+    events.subscribe<ecs::ComponentRemovedEvent<component::Transform>>(*this);
+    events.subscribe<ecs::EntityDestroyedEvent>(*this);
+    events.subscribe<TransformChanged>(*this);
+    events.subscribe<BoundsChanged>(*this);
+}
+
+void SpatialSystem::update(ecs::EntityManager& entities, ecs::EventManager&, float) {
+    for (std::uint32_t index : movedEntities_) {
+        moved_[index] = false;
+        // the proxy is gone if the entity, or its box, was removed after it moved
+        if (proxies_[index] != math::AabbTree::Null) {
+            tree_.move(proxies_[index], worldBox_(entities.get(index)));
+        }
+    }
+    movedEntities_.clear();
+    if (insertions_ >= std::max(MinRebuildInsertions, tree_.size() / 2u)) {
+        tree_.rebuild();
+        insertions_ = 0u;
+    }
+}
+
+void SpatialSystem::receive(const ecs::ComponentAssignedEvent<math::AABoxf>& event) {
+    const std::uint32_t index = event.entity.id().index();
+    if (index >= proxies_.size()) {
+        proxies_.resize(index + 1u, math::AabbTree::Null);
+        moved_.resize(index + 1u, false);
+    }
+    removeProxy_(index);
+    proxies_[index] = tree_.insert(worldBox_(event.entity), index);
+    insertions_++;
+}
+
+void SpatialSystem::receive(const ecs::ComponentRemovedEvent<math::AABoxf>& event) {
+    removeProxy_(event.entity.id().index());
+}
+
+void SpatialSystem::receive(const ecs::ComponentAssignedEvent<component::Transform>& event) {
+    markMoved_(event.entity.id().index());
+}
+
+void SpatialSystem::receive(const ecs::ComponentRemovedEvent<component::Transform>& event) {
+    // refit to the model space box
+    markMoved_(event.entity.id().index());
+}
+
+void SpatialSystem::receive(const ecs::EntityDestroyedEvent& event) {
+    removeProxy_(event.entity.id().index());
+}
+
+void SpatialSystem::receive(const TransformChanged& event) {
+    markMoved_(event.entity.id().index());
+}
+
+void SpatialSystem::receive(const BoundsChanged& event) {
+    markMoved_(event.entity.id().index());
+}
+
+const math::AabbTree& SpatialSystem::tree() const {
+    return tree_;
+}
+
+math::AABoxf SpatialSystem::worldBox_(const ecs::Entity& entity) const {
+    const math::AABoxf& box = *entity.component<math::AABoxf>();
+    if (!entity.has<component::Transform>()) {
+        return box;
+    }
+    auto transform = entity.component<component::Transform>();
+    return math::transformAABox(box, transform->position, transform->rotation, transform->scale);
+}
+
+void SpatialSystem::removeProxy_(std::uint32_t entityIndex) {
+    if (entityIndex < proxies_.size() && proxies_[entityIndex] != math::AabbTree::Null) {
+        tree_.remove(proxies_[entityIndex]);
+        proxies_[entityIndex] = math::AabbTree::Null;
+    }
+}
+
+void SpatialSystem::markMoved_(std::uint32_t entityIndex) {
+    if (entityIndex < proxies_.size() && proxies_[entityIndex] != math::AabbTree::Null && !moved_[entityIndex]) {
+        moved_[entityIndex] = true;
+        movedEntities_.push_back(entityIndex);
+    }
+}
+
+}
+}
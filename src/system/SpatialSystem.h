@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ecs/Include.h"
+#include "component/Transform.h"
+#include "system/Events.h"
+#include "math/AabbTree.h"
+#include "math/Geometry.h"
+#include <vector>
+#include <cstdint>
+
+namespace pg {
+namespace system {
+
+/**
+ * @class SpatialSystem
+ * @brief Keeps the world space boxes of all entities with an AABoxf component in a dynamic AABB tree.
+ *
+ * The leaf user data is the entity index, which can be turned back into an entity with
+ * EntityManager::get. Entities without a Transform are inserted with their model space box.
+ *
+ * Only the leaves of the entities which a TransformChanged or BoundsChanged event names are
+ * refit, so whatever writes to a Transform, or to an AABoxf in place, has to emit one. The script
+ * bindings emit TransformChanged when a script gets or sets an entity's transform.
+ */
+class SpatialSystem : public ecs::System, public ecs::Receiver {
+public:
+    SpatialSystem() = default;
+
+    void configure(ecs::EventManager&) override;
+    // refit the leaves of moved entities, and rebuild the tree after many insertions
+    void update(ecs::EntityManager&, ecs::EventManager&, float) override;
+
+    void receive(const ecs::ComponentAssignedEvent<math::AABoxf>&);
+    void receive(const ecs::ComponentRemovedEvent<math::AABoxf>&);
+    void receive(const ecs::ComponentAssignedEvent<component::Transform>&);
+    void receive(const ecs::ComponentRemovedEvent<component::Transform>&);
+    void receive(const ecs::EntityDestroyedEvent&);
+    void receive(const TransformChanged&);
+    void receive(const BoundsChanged&);
+
+    const math::AabbTree& tree() const;
+
+private:
+    math::AABoxf worldBox_(const ecs::Entity&) const;
+    void removeProxy_(std::uint32_t entityIndex);
+    void markMoved_(std::uint32_t entityIndex);
+
+    math::AabbTree              tree_{};
+    std::vector<std::uint32_t>  proxies_{};     // indexed by entity index
+    std::vector<bool>           moved_{};       // indexed by entity index, whether it's in movedEntities_
+    std::vector<std::uint32_t>  movedEntities_{};   // the indices of the entities to refit in the next update
+    std::size_t                 insertions_{ 0u };  // since the last rebuild
+};
+
+}
+}
@@ -0,0 +1,330 @@
+#include "system/StaticBatches.h"
+#include "component/Include.h"
+#include "math/Intersection.h"
+#include "math/Matrix.h"
+#include "math/Quantize.h"
+#include "opengl/StateCache.h"
+#include "opengl/Use.h"
+#include "utils/Assert.h"
+#include "utils/Log.h"
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+using namespace pg;
+
+// the most vertices 16-bit indices can address
+const std::size_t MaxBatchVertices = 0x10000u;
+
+using BatchItem = system::StaticBatches::Item;
+
+struct SourceMesh {
+    std::vector<MeshVertex>     vertices;
+    std::vector<std::uint32_t>  indices;
+};
+
+using SourceMeshes = std::unordered_map<const Mesh*, SourceMesh>;
+
+bool materialLess(const system::Material& lhs, const system::Material& rhs) {
+    const float l[] = { lhs.baseColor.x, lhs.baseColor.y, lhs.baseColor.z, lhs.ambientColor.x, lhs.ambientColor.y,
+        lhs.ambientColor.z, lhs.specularColor.x, lhs.specularColor.y, lhs.specularColor.z, lhs.shininess };
+    const float r[] = { rhs.baseColor.x, rhs.baseColor.y, rhs.baseColor.z, rhs.ambientColor.x, rhs.ambientColor.y,
+        rhs.ambientColor.z, rhs.specularColor.x, rhs.specularColor.y, rhs.specularColor.z, rhs.shininess };
+    return std::lexicographical_compare(l, l + 10, r, r + 10);
+}
+
+bool sameMaterial(const system::Material& lhs, const system::Material& rhs) {
+    return !materialLess(lhs, rhs) && !materialLess(rhs, lhs);
+}
+
+math::Vec3f transformPoint(const math::Matrix4f& m, const math::Vec3f& p) {
+    return math::Vec3f{
+        m.data[0] * p.x + m.data[1] * p.y + m.data[2] * p.z + m.data[3],
+        m.data[4] * p.x + m.data[5] * p.y + m.data[6] * p.z + m.data[7],
+        m.data[8] * p.x + m.data[9] * p.y + m.data[10] * p.z + m.data[11]
+    };
+}
+
+// normals go through the inverse transpose of the world matrix, which is applied here by columns
+math::Vec3f transformNormal(const math::Matrix4f& inverse, const math::Vec3f& n) {
+    math::Vec3f result{
+        inverse.data[0] * n.x + inverse.data[4] * n.y + inverse.data[8] * n.z,
+        inverse.data[1] * n.x + inverse.data[5] * n.y + inverse.data[9] * n.z,
+        inverse.data[2] * n.x + inverse.data[6] * n.y + inverse.data[10] * n.z
+    };
+    const float length = result.norm();
+    return length > 0.f ? result * (1.f / length) : n;
+}
+
+/*
+ * Transform the items' vertices into world space, and concatenate them and their triangles.
+ * The positions are quantized within the bounds of the merged mesh.
+ */
+void mergeItems(
+    const BatchItem* begin,
+    const BatchItem* end,
+    const SourceMeshes& sources,
+    std::vector<MeshVertex>& vertices,
+    std::vector<std::uint32_t>& indices,
+    math::AABoxf& bounds
+) {
+    std::vector<math::Vec3f> positions;
+    std::vector<math::Vec3f> normals;
+    indices.clear();
+    for (const BatchItem* item = begin; item != end; ++item) {
+        const SourceMesh& source = sources.at(item->mesh);
+        const math::Matrix4f toWorld = item->world * item->mesh->dequantize;
+        const math::Matrix4f inverse = item->world.inverse();
+        const std::uint32_t first = std::uint32_t(positions.size());
+        for (const MeshVertex& vertex : source.vertices) {
+            const math::Vec3f position{
+                math::dequantizeSnorm16(vertex.position[0]),
+                math::dequantizeSnorm16(vertex.position[1]),
+                math::dequantizeSnorm16(vertex.position[2])
+            };
+            const math::Vec2f normal{ math::dequantizeSnorm16(vertex.normal[0]), math::dequantizeSnorm16(vertex.normal[1]) };
+            positions.push_back(transformPoint(toWorld, position));
+            normals.push_back(transformNormal(inverse, math::octahedralDecode(normal)));
+        }
+        for (std::uint32_t index : source.indices) {
+            indices.push_back(first + index);
+        }
+    }
+
+    math::Vec3f min{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    math::Vec3f max{ -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+    for (const math::Vec3f& position : positions) {
+        for (int axis = 0; axis < 3; ++axis) {
+            min.data[axis] = std::min(min.data[axis], position.data[axis]);
+            max.data[axis] = std::max(max.data[axis], position.data[axis]);
+        }
+    }
+    bounds = math::AABoxf{ min, max };
+
+    vertices.resize(positions.size());
+    for (std::size_t i = 0u; i < positions.size(); ++i) {
+        math::quantizePosition(positions[i], bounds, vertices[i].position);
+        vertices[i].position[3] = 0;
+        math::quantizeNormal(normals[i], vertices[i].normal);
+    }
+}
+
+}
+
+namespace pg {
+namespace system {
+
+StaticBatches::StaticBatches(MeshManager& meshes)
+    : meshes_{ meshes },
+    batches_{},
+    instances_{},
+    commands_{},
+    instanceBuffer_{ GL_ARRAY_BUFFER },
+    indirectBuffer_{ GL_DRAW_INDIRECT_BUFFER },
+    attributes_{},
+    program_{ 0u },
+    locations_{ -1, -1, -1, -1 },
+    multiDraw_{ GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance } {
+    if (!multiDraw_) {
+        LOG_INFO << "ARB_multi_draw_indirect is not available, static batches are drawn one by one";
+    }
+}
+
+void StaticBatches::gather(ecs::EntityManager& entities, std::vector<Item>& items) {
+    items.clear();
+    for (ecs::Entity entity : entities.join< component::Transform, component::Renderable, component::Static >()) {
+        const component::Transform& transform = *entity.component< component::Transform >();
+        const component::Renderable& renderable = *entity.component< component::Renderable >();
+        const math::Matrix4f world = math::Matrix4f::translation(transform.position)
+            * math::Matrix4f::rotation(transform.rotation)
+            * math::Matrix4f::scale(transform.scale);
+        items.push_back(Item{ renderable.mesh, world, renderable.material });
+    }
+}
+
+void StaticBatches::rebuild(std::vector<Item> items) {
+    for (Mesh& batch : batches_) {
+        meshes_.release(batch);
+    }
+    batches_.clear();
+    instances_.clear();
+
+    if (items.empty()) {
+        return;
+    }
+    // group the items by material, and each material's items by mesh
+    std::sort(items.begin(), items.end(), [](const BatchItem& lhs, const BatchItem& rhs) -> bool {
+        if (materialLess(lhs.material, rhs.material)) {
+            return true;
+        }
+        if (materialLess(rhs.material, lhs.material)) {
+            return false;
+        }
+        return lhs.mesh < rhs.mesh;
+    });
+
+    SourceMeshes sources;
+    for (const BatchItem& item : items) {
+        if (sources.find(item.mesh) == sources.end()) {
+            SourceMesh& source = sources[item.mesh];
+            meshes_.download(*item.mesh, source.vertices, source.indices);
+        }
+    }
+
+    std::vector<MeshVertex> vertices;
+    std::vector<std::uint32_t> indices;
+    std::vector<std::uint16_t> shortIndices;
+    for (std::size_t begin = 0u; begin < items.size();) {
+        // a single mesh which is too large for 16-bit indices gets a batch of its own
+        std::size_t end = begin;
+        std::size_t vertexCount = 0u;
+        while (end < items.size() && sameMaterial(items[end].material, items[begin].material)) {
+            const std::size_t count = sources.at(items[end].mesh).vertices.size();
+            if (end > begin && vertexCount + count > MaxBatchVertices) {
+                break;
+            }
+            vertexCount += count;
+            ++end;
+        }
+
+        MeshView view;
+        mergeItems(items.data() + begin, items.data() + end, sources, vertices, indices, view.bounds);
+        view.vertices = vertices.data();
+        view.vertexCount = vertices.size();
+        if (vertices.size() <= MaxBatchVertices) {
+            shortIndices.assign(indices.begin(), indices.end());
+            view.indices = shortIndices.data();
+            view.indexSize = sizeof(std::uint16_t);
+        }
+        else {
+            view.indices = indices.data();
+            view.indexSize = sizeof(std::uint32_t);
+        }
+        view.indexCount = indices.size();
+        view.lodOffsets[0] = 0u;
+        view.lodSizes[0] = indices.size();
+        view.lodCount = 1u;
+        batches_.emplace_back();
+        meshes_.upload(view, batches_.back());
+
+        const system::Material& material = items[begin].material;
+        const math::Matrix4f& dequantize = batches_.back().dequantize;
+        instances_.push_back(Instance{
+            math::Vec4f{ math::Vec3f{ dequantize.data[3], dequantize.data[7], dequantize.data[11] }, dequantize.data[0] },
+            math::Vec4f{ material.baseColor, material.shininess },
+            material.ambientColor,
+            material.specularColor
+        });
+        begin = end;
+    }
+    instanceBuffer_.dataStore(GLsizeiptr(instances_.size()), sizeof(Instance), instances_.data(), GL_STATIC_DRAW);
+    LOG_INFO << "Merged " << items.size() << " static entities into " << batches_.size() << " batches";
+}
+
+void StaticBatches::draw(opengl::Program& program, const math::FrustumPlanesf& frustum, std::size_t& drawCalls, std::size_t& triangles) {
+    if (batches_.empty()) {
+        return;
+    }
+    if (program.object() != program_) {
+        bindProgram_(program);
+    }
+    opengl::UseProgram use(program);
+    opengl::StateCache& state = opengl::stateCache();
+    const GLuint lastVertexArray = state.vertexArray();
+    state.bindVertexArray(attributes_.object());
+
+    if (multiDraw_) {
+        // one command per visible batch, the 16-bit ones first
+        commands_.clear();
+        std::size_t shortCommands = 0u;
+        for (GLenum indexType : { GLenum(GL_UNSIGNED_SHORT), GLenum(GL_UNSIGNED_INT) }) {
+            const GLintptr indexSize = indexType == GL_UNSIGNED_SHORT ? GLintptr(sizeof(std::uint16_t)) : GLintptr(sizeof(std::uint32_t));
+            for (std::size_t i = 0u; i < batches_.size(); ++i) {
+                const Mesh& batch = batches_[i];
+                if (batch.indexType != indexType || !math::frustumIntersectsAABox(frustum, batch.bounds)) {
+                    continue;
+                }
+                commands_.push_back(IndirectCommand{
+                    GLuint(batch.lods[0].indexCount),
+                    1u,
+                    GLuint(batch.lods[0].indexOffset / indexSize),
+                    batch.baseVertex,
+                    GLuint(i)
+                });
+                triangles += std::size_t(batch.lods[0].indexCount) / 3u;
+            }
+            if (indexType == GL_UNSIGNED_SHORT) {
+                shortCommands = commands_.size();
+            }
+        }
+        if (!commands_.empty()) {
+            indirectBuffer_.dataStore(GLsizeiptr(commands_.size()), sizeof(IndirectCommand), commands_.data(), GL_STREAM_DRAW);
+            const GLuint lastIndirect = state.buffer(GL_DRAW_INDIRECT_BUFFER);
+            state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_.object());
+            if (shortCommands > 0u) {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, GLsizei(shortCommands), 0);
+                drawCalls++;
+            }
+            if (commands_.size() > shortCommands) {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                    reinterpret_cast<const void*>(shortCommands * sizeof(IndirectCommand)), GLsizei(commands_.size() - shortCommands), 0);
+                drawCalls++;
+            }
+            state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, lastIndirect);
+        }
+    }
+    else {
+        for (std::size_t i = 0u; i < batches_.size(); ++i) {
+            const Mesh& batch = batches_[i];
+            if (!math::frustumIntersectsAABox(frustum, batch.bounds)) {
+                continue;
+            }
+            // the instanced attributes aren't arrays in this path, so they can be set as constants
+            const Instance& instance = instances_[i];
+            glVertexAttrib4fv(GLuint(locations_[0]), instance.dequantize.data);
+            glVertexAttrib4fv(GLuint(locations_[1]), instance.base.data);
+            glVertexAttrib3fv(GLuint(locations_[2]), instance.ambient.data);
+            glVertexAttrib3fv(GLuint(locations_[3]), instance.specularColor.data);
+            const void* indexOffset = reinterpret_cast<const void*>(batch.lods[0].indexOffset);
+            if (batch.baseVertex != 0) {
+                glDrawElementsBaseVertex(GL_TRIANGLES, batch.lods[0].indexCount, batch.indexType, indexOffset, batch.baseVertex);
+            }
+            else {
+                glDrawElements(GL_TRIANGLES, batch.lods[0].indexCount, batch.indexType, indexOffset);
+            }
+            drawCalls++;
+            triangles += std::size_t(batch.lods[0].indexCount) / 3u;
+        }
+    }
+    state.bindVertexArray(lastVertexArray);
+}
+
+std::size_t StaticBatches::size() const {
+    return batches_.size();
+}
+
+void StaticBatches::bindProgram_(const opengl::Program& program) {
+    static_assert(sizeof(Instance) == 14u * sizeof(float), "Instance should match the instanced attributes");
+    const char* names[] = { "dequantize", "materialBase", "materialAmbient", "materialSpecular" };
+    for (int i = 0; i < 4; ++i) {
+        locations_[i] = program.attribute(names[i]);
+        PG_ASSERT(locations_[i] >= 0);
+    }
+    // the static program gets a vertex array of its own from the MeshManager, so the instanced
+    // attributes don't leak into the other programs' vertex arrays
+    attributes_ = meshes_.attributes(program);
+    if (multiDraw_) {
+        attributes_.attachInstanceAttributes(instanceBuffer_.object(), {
+            { unsigned(locations_[0]), opengl::AttributeType::Float, 4 },
+            { unsigned(locations_[1]), opengl::AttributeType::Float, 4 },
+            { unsigned(locations_[2]), opengl::AttributeType::Float, 3 },
+            { unsigned(locations_[3]), opengl::AttributeType::Float, 3 }
+        });
+    }
+    program_ = program.object();
+}
+
+}   // system
+}   // pg
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ecs/Include.h"
+#include "manager/Mesh.h"
+#include "manager/MeshManager.h"
+#include "math/Geometry.h"
+#include "math/Matrix.h"
+#include "math/Vector.h"
+#include "opengl/BufferObject.h"
+#include "opengl/Program.h"
+#include "opengl/VertexAttributes.h"
+#include "system/Material.h"
+#include <GL/glew.h>
+#include <vector>
+#include <cstdlib>
+
+namespace pg {
+namespace system {
+
+/**
+ * @class StaticBatches
+ * @brief Merges the static renderables into pre-transformed batches, and draws them.
+ *
+ * The static renderables are gathered from the entities, so that the batches can be built on the
+ * GL thread while the simulation runs. Their meshes are read back, transformed into world space,
+ * and concatenated into one mesh per material. A batch is split once it reaches 65536 vertices,
+ * so that it can use 16-bit indices. The batches are uploaded into the MeshManager's arenas, and
+ * are drawn with the vertex array the MeshManager shares between all meshes.
+ *
+ * The material and dequantization of each batch are instanced vertex attributes. With
+ * ARB_multi_draw_indirect and ARB_base_instance, each batch's draw command selects its attributes
+ * with baseInstance, and all visible batches are drawn with one glMultiDrawElementsIndirect call
+ * per index type. Otherwise, the batches are drawn one by one, with the attributes set as
+ * constants in between.
+ */
+class StaticBatches {
+public:
+    explicit StaticBatches(MeshManager& meshes);
+    // the batch ranges are freed along with the MeshManager's arenas
+    ~StaticBatches() = default;
+
+    StaticBatches() = delete;
+    StaticBatches(const StaticBatches&) = delete;
+    StaticBatches& operator=(const StaticBatches&) = delete;
+
+    /// @brief The render state of one static renderable, see gather.
+    struct Item {
+        const Mesh*         mesh;
+        math::Matrix4f      world;
+        Material            material;
+    };
+
+    /// @brief Copy the transforms, meshes and materials of the static renderables into items.
+    static void gather(ecs::EntityManager& entities, std::vector<Item>& items);
+    /// @brief Replace the batches with new ones, made from the gathered items.
+    void        rebuild(std::vector<Item> items);
+    /**
+     * @brief Draw the batches which intersect the frustum with the program, see static.vert.glsl.
+     * The draw calls and triangles are added to the counters.
+     */
+    void        draw(opengl::Program& program, const math::FrustumPlanesf& frustum, std::size_t& drawCalls, std::size_t& triangles);
+
+    std::size_t size() const;
+
+private:
+    // the instanced attributes of a batch
+    struct Instance {
+        math::Vec4f dequantize;     // the center of the bounds, and the scale
+        math::Vec4f base;           // the base color, and the shininess
+        math::Vec3f ambient;
+        math::Vec3f specularColor;
+    };
+
+    // the layout glMultiDrawElementsIndirect reads
+    struct IndirectCommand {
+        GLuint  count;
+        GLuint  instanceCount;
+        GLuint  firstIndex;
+        GLint   baseVertex;
+        GLuint  baseInstance;
+    };
+
+    void        bindProgram_(const opengl::Program& program);
+
+    MeshManager&                    meshes_;
+    std::vector<Mesh>               batches_{};
+    std::vector<Instance>           instances_{};       // one per batch
+    std::vector<IndirectCommand>    commands_{};        // reused between frames
+    opengl::BufferObject            instanceBuffer_{ GL_ARRAY_BUFFER };
+    opengl::BufferObject            indirectBuffer_{ GL_DRAW_INDIRECT_BUFFER };
+    opengl::VertexAttributes        attributes_{};
+    GLuint                          program_{ 0u };     // the program attributes_ was made for
+    GLint                           locations_[4];      // of the instanced attributes, in Instance order
+    bool                            multiDraw_{ false };
+};
+
+}   // system
+}   // pg
@@ -1,16 +1,90 @@
 #include "system/UiSystem.h"
 #include "system/Events.h"
+#include "system/RenderSystem.h"
+#include "opengl/StateCache.h"
+#include "utils/AllocationTracker.h"
+#include "utils/Profiler.h"
 #include "GL/glew.h"
 #include "imgui/imgui.h"
 #include <GL/glew.h>
+#include <algorithm>
+#include <initializer_list>
 #include <string>
+#include <cstdint>
 
 namespace pg {
 namespace system {
 
+namespace {
+
+// a zone keeps its colour from frame to frame
+ImU32 zoneColour(const char* name) {
+    std::uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; ++c) {
+        hash = (hash ^ std::uint32_t(*c)) * 16777619u;
+    }
+    return ImColor::HSV(float(hash % 1024u) / 1024.f, 0.5f, 0.6f);
+}
+
+/*
+ * Draw the zones of each thread on a time line of the frame, with the nested zones below their
+ * parents. Hovering over a zone shows its name and time.
+ * */
+void flameChart(const Profiler::Frame& frame) {
+    const double frameTime = double(frame.end - frame.begin);
+    if (frameTime <= 0.0) {
+        return;
+    }
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.f;
+    const float width = std::max(ImGui::GetContentRegionAvailWidth(), 1.f);
+
+    std::size_t first = 0u;
+    while (first < frame.events.size()) {
+        // the events are sorted by thread
+        const std::uint32_t thread = frame.events[first].thread;
+        std::size_t last = first;
+        std::uint32_t depth = 0u;
+        while (last < frame.events.size() && frame.events[last].thread == thread) {
+            depth = std::max(depth, frame.events[last].depth);
+            ++last;
+        }
+
+        ImGui::Text("%s", frame.threads[thread].c_str());
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const ImVec2 corner{ origin.x + width, origin.y + rowHeight * float(depth + 1u) };
+        ImGui::PushID(int(thread));
+        ImGui::InvisibleButton("lanes", ImVec2{ width, corner.y - origin.y });
+        ImGui::PopID();
+        drawList->PushClipRect(origin, corner, true);
+        for (std::size_t i = first; i < last; ++i) {
+            const ProfileEvent& event = frame.events[i];
+            const double begin = double(event.begin - std::min(event.begin, frame.begin));
+            const double end = double(std::min(event.end, frame.end) - std::min(event.end, frame.begin));
+            const float x0 = origin.x + float(begin / frameTime) * width;
+            const float x1 = std::max(origin.x + float(end / frameTime) * width, x0 + 1.f);
+            const float y0 = origin.y + rowHeight * float(event.depth);
+            const ImVec2 a{ x0, y0 };
+            const ImVec2 b{ x1, y0 + rowHeight - 1.f };
+            drawList->AddRectFilled(a, b, zoneColour(event.name));
+            if (ImGui::CalcTextSize(event.name).x + 4.f < x1 - x0) {
+                drawList->AddText(ImVec2{ x0 + 2.f, y0 + 2.f }, IM_COL32_WHITE, event.name);
+            }
+            if (ImGui::IsMouseHoveringRect(a, b)) {
+                ImGui::SetTooltip("%s: %.3f ms", event.name, double(event.end - event.begin) / 1000000.0);
+            }
+        }
+        drawList->PopClipRect();
+        first = last;
+    }
+}
+
+}
+
 UiSystem::UiSystem(Context& context)
     : System(),
-    display_(false)
+    display_(false),
+    context_(context)
 {}
 
 void UiSystem::update(ecs::EntityManager& entities, ecs::EventManager& events, float dt) {
@@ -36,7 +110,75 @@ void UiSystem::ui_(ecs::EventManager& events, float dt) {
         ImGui::Text("  GLSL_VERSION: %s", (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
         ImGui::Text("  GL_VENDOR: %s", (const char*)glGetString(GL_VENDOR));
         ImGui::Text("  GL_RENDERER: %s", (const char*)glGetString(GL_RENDERER));
+        const opengl::StateCache::Counters& counters = opengl::stateCache().counters();
+        ImGui::Text("State cache, last frame:");
+        ImGui::Text("  calls: %llu", (unsigned long long)counters.calls);
+        ImGui::Text("  elided: %llu", (unsigned long long)counters.elided);
+        ImGui::Text("  glGet queries: %llu", (unsigned long long)counters.queries);
+        const RenderSystem::FrameStats& stats = context_.systemManager.system<RenderSystem>().frameStats();
+        ImGui::Text("Scene, last frame:");
+        ImGui::Text("  draw calls: %llu", (unsigned long long)stats.drawCalls);
+        ImGui::Text("  triangles: %llu", (unsigned long long)stats.triangles);
+        ImGui::Text("  point lights: %llu", (unsigned long long)stats.lights);
+        ImGui::Text("  light cluster entries: %llu", (unsigned long long)stats.clusterLights);
+        ImGui::Text("  occluder triangles: %llu", (unsigned long long)stats.occluderTriangles);
+        ImGui::Text("  occluded: %llu", (unsigned long long)stats.occluded);
+
+        ImGui::TreePop();
+    }
+
+    if (ImGui::TreeNode("Systems")) {
+        ImGui::Text("Update times over the last %u updates, in ms:", unsigned(ecs::SystemManager::TimingWindow));
+        ImGui::Columns(6, "system stats");
+        for (const char* heading : { "system", "mean", "p50", "p95", "p99", "max" }) {
+            ImGui::Text("%s", heading);
+            ImGui::NextColumn();
+        }
+        ImGui::Separator();
+        for (const ecs::SystemManager::UpdateStats& stats : context_.systemManager.updateStats()) {
+            ImGui::Text("%s", stats.name.c_str());
+            ImGui::NextColumn();
+            for (float value : { stats.mean, stats.p50, stats.p95, stats.p99, stats.max }) {
+                ImGui::Text("%.3f", value);
+                ImGui::NextColumn();
+            }
+        }
+        ImGui::Columns(1);
+        if (ImGui::Button("Write to system_stats.csv")) {
+            context_.systemManager.writeUpdateStats("system_stats.csv");
+        }
+        ImGui::TreePop();
+    }
+
+    if (ImGui::TreeNode("Profiler")) {
+        Profiler& prof = profiler();
+        const Profiler::Frame& frame = prof.lastFrame();
+        ImGui::Text("Frame: %.3f ms", double(frame.end - frame.begin) / 1000000.0);
+        if (!prof.capturing()) {
+            if (ImGui::Button("Start capture")) {
+                prof.startCapture();
+            }
+        }
+        else if (ImGui::Button("Write capture to trace.json")) {
+            prof.writeCapture("trace.json");
+        }
+        flameChart(frame);
+        ImGui::TreePop();
+    }
 
+    if (ImGui::TreeNode("Allocations")) {
+        if (AllocationTracker::enabled()) {
+            const AllocationTracker::Frame& frame = allocationTracker().lastFrame();
+            ImGui::Text("Last frame: %llu allocations, %llu bytes, %llu frees",
+                (unsigned long long)frame.total.allocations, (unsigned long long)frame.total.bytes, (unsigned long long)frame.total.frees);
+            for (const AllocationTracker::TagStats& tag : frame.tags) {
+                ImGui::Text("  %s: %llu allocations, %llu bytes", tag.name,
+                    (unsigned long long)tag.stats.allocations, (unsigned long long)tag.stats.bytes);
+            }
+        }
+        else {
+            ImGui::Text("Build with premake5 --track-allocations to count the allocations.");
+        }
         ImGui::TreePop();
     }
 
@@ -20,6 +20,7 @@ public:
 private:
     void ui_(ecs::EventManager&, float);
     bool display_;
+    Context& context_;
 
 };
 
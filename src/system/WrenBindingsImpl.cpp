@@ -10,6 +10,7 @@
 #include "manager/ShaderManager.h"
 #include "opengl/VertexAttributes.h"
 #include "system/DebugRenderSystem.h"
+#include "system/Events.h"
 #include "system/ScriptSystem.h"
 #include "system/PickingSystem.h"
 #include "system/RenderSystem.h"
@@ -29,6 +30,17 @@ extern "C" {
 #include <limits>
 #include <vector>
 
+namespace {
+
+// the wren test suite runs without the event manager
+void transformChanged(const pg::ecs::Entity& entity) {
+    if (pg::Locator<pg::ecs::EventManager>::has()) {
+        pg::Locator<pg::ecs::EventManager>::get()->emit<pg::system::TransformChanged>(entity);
+    }
+}
+
+}
+
 namespace pg {
 namespace wren {
 
@@ -55,8 +67,7 @@ void planeIntersection(WrenVM* vm) {
 void generateCameraRay(WrenVM* vm) {
     float x = float(wrenGetSlotDouble(vm, 1));
     float y = float(wrenGetSlotDouble(vm, 2));
-    auto camera = Locator<system::RenderSystem>::get()->activeCameraInfo();
-    auto ray = math::generateCameraRay(camera.position, camera.orientation, camera.frustum, x, y);
+    auto ray = Locator<system::PickingSystem>::get()->cameraRay(x, y);
     wrenpp::setSlotForeignValue(vm, 0, ray);
 }
 
@@ -128,6 +139,7 @@ void setTransform(WrenVM* vm) {
     ecs::Entity* e = wrenpp::getSlotForeign<ecs::Entity>(vm, 0);
     component::Transform* t = wrenpp::getSlotForeign<Transform>(vm, 0);
     *e->rawPointer<Transform>() = *t;
+    transformChanged(*e);
 }
 
 void hasTransform(WrenVM* vm) {
@@ -160,27 +172,29 @@ void assignRenderable(WrenVM* vm) {
     ecs::Entity* e = wrenpp::getSlotForeign<ecs::Entity>(vm, 0);
     const WrenRenderable* r = wrenpp::getSlotForeign<WrenRenderable>(vm, 1);
 
-    pg::opengl::BufferObject* buffer = Locator<pg::MeshManager>::get()->get(r->model.cString());
+    // headless, nothing is drawn, but the entity can still be picked
+    if (!Locator<pg::MeshManager>::has()) {
+        const math::AABoxf bounds = MeshManager::cubeBounds();
+        e->assign<math::AABoxf>(bounds.min, bounds.max);
+        return;
+    }
+
+    const pg::Mesh* mesh = Locator<pg::MeshManager>::get()->get(r->model.cString());
     pg::opengl::Program* shader = Locator<pg::ShaderManager>::get()->get(r->shader.cString());
 
     system::Material mat{ r->baseColor, r->ambientColor, r->specularColor, r->shininess };
 
-    buffer->bind();
-    opengl::VertexAttributes vao({
-        {unsigned(shader->attribute("vertex")), opengl::AttributeType::Float, 3},
-        {unsigned(shader->attribute("normal")), opengl::AttributeType::Float, 3}
-    });
-    buffer->unbind();
+    opengl::VertexAttributes vao = Locator<pg::MeshManager>::get()->attributes(*shader);
 
-    e->assign<component::Renderable>(buffer, shader, vao, mat);
-
-    const auto& bb = Locator<MeshManager>::get()->getBoundingBox(r->model.cString());
-    e->assign<math::AABoxf>(bb.min, bb.max);
+    e->assign<component::Renderable>(mesh, shader, vao, mat);
+    e->assign<math::AABoxf>(mesh->bounds.min, mesh->bounds.max);
 }
 
 void getTransform(WrenVM* vm) {
     const ecs::Entity* entity = wrenpp::getSlotForeign<ecs::Entity>(vm, 0);
     if (entity->has<Transform>()) {
+        // the script can write to the transform through the pointer
+        transformChanged(*entity);
         wrenpp::setSlotForeignPtr(vm, 0, entity->rawPointer<Transform>());
     }
     else {
@@ -656,6 +670,9 @@ void castCameraRay(WrenVM* vm) {
 }
 
 void addStaticDebugBox(WrenVM* vm) {
+    if (!Locator<system::DebugRenderSystem>::has()) {
+        return;
+    }
     auto* renderer = Locator<system::DebugRenderSystem>::get();
     auto* position = wrenpp::getSlotForeign<math::Vec3f>(vm, 1);
     auto* scale = wrenpp::getSlotForeign<math::Vec3f>(vm, 2);
@@ -664,6 +681,9 @@ void addStaticDebugBox(WrenVM* vm) {
 }
 
 void addTransientDebugBox(WrenVM* vm) {
+    if (!Locator<system::DebugRenderSystem>::has()) {
+        return;
+    }
     auto* renderer = Locator<system::DebugRenderSystem>::get();
     auto* position = wrenpp::getSlotForeign<math::Vec3f>(vm, 1);
     auto* scale = wrenpp::getSlotForeign<math::Vec3f>(vm, 2);
@@ -673,6 +693,9 @@ void addTransientDebugBox(WrenVM* vm) {
 }
 
 void addStaticDebugLine(WrenVM* vm) {
+    if (!Locator<system::DebugRenderSystem>::has()) {
+        return;
+    }
     const math::Vec3f* start = wrenpp::getSlotForeign<math::Vec3f>(vm, 1);
     const math::Vec3f* end   = wrenpp::getSlotForeign<math::Vec3f>(vm, 2);
     const math::Vec3f* color = wrenpp::getSlotForeign<math::Vec3f>(vm, 3);
@@ -680,6 +703,9 @@ void addStaticDebugLine(WrenVM* vm) {
 }
 
 void addTransientDebugLine(WrenVM* vm) {
+    if (!Locator<system::DebugRenderSystem>::has()) {
+        return;
+    }
     const math::Vec3f* start = wrenpp::getSlotForeign<math::Vec3f>(vm, 1);
     const math::Vec3f* end = wrenpp::getSlotForeign<math::Vec3f>(vm, 2);
     const math::Vec3f* color = wrenpp::getSlotForeign<math::Vec3f>(vm, 3);
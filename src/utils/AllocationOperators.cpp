@@ -0,0 +1,83 @@
+#include "utils/AllocationTracker.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef PG_TRACK_ALLOCATIONS
+
+/*
+ * The global allocation functions are replaced, so that the allocations are counted. The other
+ * forms of operator new and delete call these.
+ *
+ * They are in a file of their own, which doesn't allocate. Where a new or delete expression is
+ * compiled in the same file, the compiler can inline the replaced delete into it, and then warns
+ * that std::free is called on a pointer from operator new (-Wmismatched-new-delete).
+ * */
+
+namespace {
+
+void* allocate(std::size_t size) {
+    void* p = std::malloc(size ? size : 1u);
+    if (p) {
+        pg::allocationTracker().allocated(size);
+    }
+    return p;
+}
+
+void deallocate(void* p) {
+    if (p) {
+        pg::allocationTracker().freed();
+        std::free(p);
+    }
+}
+
+}
+
+void* operator new(std::size_t size) {
+    void* p = allocate(size);
+    if (!p) {
+        throw std::bad_alloc{};
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = allocate(size);
+    if (!p) {
+        throw std::bad_alloc{};
+    }
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    deallocate(p);
+}
+
+void operator delete[](void* p) noexcept {
+    deallocate(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    deallocate(p);
+}
+
+#endif
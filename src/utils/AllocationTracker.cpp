@@ -0,0 +1,245 @@
+#include "utils/AllocationTracker.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <new>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__GLIBC__)
+#include <execinfo.h>
+#include <cxxabi.h>
+#endif
+
+namespace {
+
+// plain data, so that the operators can use them before and after the static initialization
+thread_local std::uint32_t currentTag = 0u;
+thread_local std::uint32_t untilSample = 0u;
+// set while the thread holds the tracker's mutex, which the sampling would lock again
+thread_local bool insideTracker = false;
+
+std::uint32_t captureStack(void** frames, std::uint32_t capacity) {
+#ifdef _WIN32
+    return std::uint32_t(RtlCaptureStackBackTrace(0u, DWORD(capacity), frames, nullptr));
+#elif defined(__GLIBC__)
+    return std::uint32_t(backtrace(frames, int(capacity)));
+#else
+    return 0u;
+#endif
+}
+
+class TrackerLock {
+public:
+    explicit TrackerLock(std::mutex& mutex)
+        : lock_{ mutex } {
+        insideTracker = true;
+    }
+
+    ~TrackerLock() {
+        insideTracker = false;
+    }
+
+private:
+    std::lock_guard<std::mutex> lock_;
+};
+
+}
+
+namespace pg {
+
+const std::size_t AllocationTracker::MaxTags;
+const std::size_t AllocationTracker::MaxSamples;
+const std::size_t AllocationTracker::MaxSampleFrames;
+
+AllocationTracker::AllocationTracker()
+    : mutex_{},
+    names_{ "untagged" },
+    tagCount_{ 1u },
+    counters_{},
+    last_{},
+    sampleInterval_{ 0u },
+    samples_{},
+    sampleCount_{ 0u },
+    lastFrame_{} {}
+
+bool AllocationTracker::enabled() {
+#ifdef PG_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::uint32_t AllocationTracker::tag(const char* name) {
+    TrackerLock lock{ mutex_ };
+    const std::uint32_t count = tagCount_.load(std::memory_order_relaxed);
+    for (std::uint32_t i = 0u; i < count; ++i) {
+        if (std::strcmp(names_[i], name) == 0) {
+            return i;
+        }
+    }
+    if (count == MaxTags) {
+        // the rest are counted as untagged
+        return 0u;
+    }
+    names_[count] = name;
+    tagCount_.store(count + 1u, std::memory_order_release);
+    return count;
+}
+
+void AllocationTracker::setSampleInterval(std::uint32_t interval) {
+    sampleInterval_.store(interval, std::memory_order_relaxed);
+}
+
+void AllocationTracker::clearSamples() {
+    TrackerLock lock{ mutex_ };
+    sampleCount_ = 0u;
+}
+
+std::vector<AllocationSite> AllocationTracker::sampledSites() const {
+    TrackerLock lock{ mutex_ };
+    std::map<std::pair<std::uint32_t, std::vector<void*>>, AllocationSite> sites;
+    const std::size_t count = std::size_t(std::min<std::uint64_t>(sampleCount_, MaxSamples));
+    for (std::size_t i = 0u; i < count; ++i) {
+        const Sample& sample = samples_[i];
+        std::vector<void*> frames(sample.frames, sample.frames + sample.depth);
+        AllocationSite& site = sites[std::make_pair(sample.tag, frames)];
+        if (site.samples == 0u) {
+            site.frames = std::move(frames);
+            site.tag = names_[sample.tag];
+        }
+        ++site.samples;
+        site.bytes += sample.size;
+    }
+    std::vector<AllocationSite> result;
+    for (auto& site : sites) {
+        result.push_back(std::move(site.second));
+    }
+    std::sort(result.begin(), result.end(),
+        [](const AllocationSite& lhs, const AllocationSite& rhs) -> bool { return lhs.samples > rhs.samples; });
+    return result;
+}
+
+void AllocationTracker::endFrame() {
+    if (lastFrame_.tags.capacity() < MaxTags) {
+        lastFrame_.tags.reserve(MaxTags);
+    }
+    lastFrame_.total = AllocationStats{};
+    lastFrame_.tags.clear();
+    const std::uint32_t count = tagCount_.load(std::memory_order_acquire);
+    for (std::uint32_t i = 0u; i < count; ++i) {
+        const AllocationStats current{
+            counters_[i].allocations.load(std::memory_order_relaxed),
+            counters_[i].bytes.load(std::memory_order_relaxed),
+            counters_[i].frees.load(std::memory_order_relaxed)
+        };
+        const AllocationStats frame{
+            current.allocations - last_[i].allocations,
+            current.bytes - last_[i].bytes,
+            current.frees - last_[i].frees
+        };
+        last_[i] = current;
+        if (frame.allocations != 0u || frame.frees != 0u) {
+            lastFrame_.tags.push_back(TagStats{ names_[i], frame });
+            lastFrame_.total.allocations += frame.allocations;
+            lastFrame_.total.bytes += frame.bytes;
+            lastFrame_.total.frees += frame.frees;
+        }
+    }
+}
+
+const AllocationTracker::Frame& AllocationTracker::lastFrame() const {
+    return lastFrame_;
+}
+
+AllocationStats AllocationTracker::total() const {
+    AllocationStats result{};
+    const std::uint32_t count = tagCount_.load(std::memory_order_acquire);
+    for (std::uint32_t i = 0u; i < count; ++i) {
+        result.allocations += counters_[i].allocations.load(std::memory_order_relaxed);
+        result.bytes += counters_[i].bytes.load(std::memory_order_relaxed);
+        result.frees += counters_[i].frees.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void AllocationTracker::allocated(std::size_t size) {
+    const std::uint32_t tag = currentTag;
+    counters_[tag].allocations.fetch_add(1u, std::memory_order_relaxed);
+    counters_[tag].bytes.fetch_add(size, std::memory_order_relaxed);
+    const std::uint32_t interval = sampleInterval_.load(std::memory_order_relaxed);
+    if (interval != 0u) {
+        if (untilSample == 0u || untilSample > interval) {
+            untilSample = interval;
+        }
+        if (--untilSample == 0u) {
+            sample_(tag, size);
+        }
+    }
+}
+
+void AllocationTracker::freed() {
+    counters_[currentTag].frees.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void AllocationTracker::sample_(std::uint32_t tag, std::size_t size) {
+    if (insideTracker) {
+        return;
+    }
+    Sample sample;
+    sample.depth = captureStack(sample.frames, MaxSampleFrames);
+    sample.tag = tag;
+    sample.size = size;
+    TrackerLock lock{ mutex_ };
+    samples_[std::size_t(sampleCount_ % MaxSamples)] = sample;
+    ++sampleCount_;
+}
+
+AllocationTracker& allocationTracker() {
+    // never destroyed, since operator delete is still called during the static destruction
+    alignas(AllocationTracker) static unsigned char storage[sizeof(AllocationTracker)];
+    static AllocationTracker* instance = new (storage) AllocationTracker{};
+    return *instance;
+}
+
+std::string describeFrame(void* address) {
+#if defined(__GLIBC__)
+    // "binary(mangled+0x12) [0x1234]", where the name is only known for the exported symbols
+    char** symbols = backtrace_symbols(&address, 1);
+    if (symbols) {
+        std::string description = symbols[0];
+        std::free(symbols);
+        const std::size_t open = description.find('(');
+        const std::size_t plus = description.find('+', open);
+        const std::size_t close = description.find(')', plus);
+        if (open != std::string::npos && plus != std::string::npos && close != std::string::npos && plus > open + 1u) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(description.substr(open + 1u, plus - open - 1u).c_str(), nullptr, nullptr, &status);
+            if (status == 0 && demangled) {
+                description = std::string(demangled) + " " + description.substr(plus, close - plus);
+            }
+            std::free(demangled);
+        }
+        return description;
+    }
+#endif
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", address);
+    return buffer;
+}
+
+AllocationTag::AllocationTag(std::uint32_t tag)
+    : previous_{ currentTag } {
+    currentTag = tag;
+}
+
+AllocationTag::~AllocationTag() {
+    currentTag = previous_;
+}
+
+}
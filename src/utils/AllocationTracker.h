@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+
+struct AllocationStats {
+    std::uint64_t   allocations{ 0u };
+    std::uint64_t   bytes{ 0u };    // the bytes requested by the allocations
+    std::uint64_t   frees{ 0u };
+};
+
+/// @brief A call stack which allocated, aggregated from the samples.
+struct AllocationSite {
+    std::vector<void*>  frames{};   // the return addresses, innermost first
+    const char*         tag{ nullptr };
+    std::uint64_t       samples{ 0u };
+    std::uint64_t       bytes{ 0u };    // the bytes of the sampled allocations
+};
+
+/**
+ * @class AllocationTracker
+ * @brief Counts the heap allocations made through operator new, by tag and by frame.
+ *
+ * The global operator new and delete are replaced, and report to the tracker, only in programs
+ * built with PG_TRACK_ALLOCATIONS. Without it, the tracker counts nothing, see enabled.
+ *
+ * An allocation is counted under the innermost tag of the allocating thread, see
+ * PG_ALLOCATION_TAG, or under "untagged". SystemManager::update tags the systems' updates with
+ * their type names. endFrame collects the counts of the frame into lastFrame.
+ *
+ * With a sample interval, the call stack of every nth allocation of a thread is kept, and the
+ * stacks are aggregated by sites. The call stacks are only captured on Windows and with glibc.
+ *
+ * Use the global instance from allocationTracker().
+ */
+class AllocationTracker {
+public:
+    static const std::size_t MaxTags = 64u;
+    // the samples are kept in a ring buffer of this size
+    static const std::size_t MaxSamples = 1u << 10u;
+    static const std::size_t MaxSampleFrames = 16u;
+
+    struct TagStats {
+        const char*     name;
+        AllocationStats stats;
+    };
+
+    struct Frame {
+        AllocationStats         total{};
+        std::vector<TagStats>   tags{};     // the tags which allocated or freed in the frame
+    };
+
+    AllocationTracker();
+
+    AllocationTracker(const AllocationTracker&) = delete;
+    AllocationTracker& operator=(const AllocationTracker&) = delete;
+
+    /// @brief Whether the program is built with PG_TRACK_ALLOCATIONS.
+    static bool     enabled();
+
+    /// @brief The index of the tag with the name, which is added if it's new. The name has to outlive the tracker.
+    std::uint32_t   tag(const char* name);
+    /// @brief Keep the call stack of every nth allocation of each thread. Zero stops the sampling.
+    void            setSampleInterval(std::uint32_t interval);
+    void            clearSamples();
+    /// @brief The sampled call sites, with the most sampled first.
+    std::vector<AllocationSite> sampledSites() const;
+
+    /// @brief Collect the counts since the last call into lastFrame.
+    void            endFrame();
+    const Frame&    lastFrame() const;
+    /// @brief The counts of all tags, since the program started.
+    AllocationStats total() const;
+
+    // called by the replaced operators
+    void            allocated(std::size_t size);
+    void            freed();
+
+private:
+    struct Counters {
+        std::atomic<std::uint64_t>  allocations{ 0u };
+        std::atomic<std::uint64_t>  bytes{ 0u };
+        std::atomic<std::uint64_t>  frees{ 0u };
+    };
+
+    struct Sample {
+        void*           frames[MaxSampleFrames];
+        std::uint32_t   depth;
+        std::uint32_t   tag;
+        std::uint64_t   size;
+    };
+
+    void    sample_(std::uint32_t tag, std::size_t size);
+
+    mutable std::mutex          mutex_;     // guards adding tags, and the samples
+    const char*                 names_[MaxTags];
+    std::atomic<std::uint32_t>  tagCount_;
+    Counters                    counters_[MaxTags];
+    AllocationStats             last_[MaxTags];
+    std::atomic<std::uint32_t>  sampleInterval_;
+    Sample                      samples_[MaxSamples];
+    std::uint64_t               sampleCount_;
+    Frame                       lastFrame_;
+};
+
+/// @brief The tracker which the replaced operator new reports to.
+AllocationTracker& allocationTracker();
+
+/// @brief The function and offset of a sampled return address, where it can be found.
+std::string describeFrame(void* address);
+
+/**
+ * @class AllocationTag
+ * @brief Counts the allocations of the calling thread under a tag, until it is destroyed.
+ * The tags nest. See PG_ALLOCATION_TAG.
+ */
+class AllocationTag {
+public:
+    explicit AllocationTag(std::uint32_t tag);
+    ~AllocationTag();
+
+    AllocationTag(const AllocationTag&) = delete;
+    AllocationTag& operator=(const AllocationTag&) = delete;
+
+private:
+    std::uint32_t   previous_;
+};
+
+}
+
+#define PG_ALLOCATION_CONCAT_IMPL(a, b) a##b
+#define PG_ALLOCATION_CONCAT(a, b) PG_ALLOCATION_CONCAT_IMPL(a, b)
+/// @brief Count the allocations of the rest of the enclosing scope under the tag. The name has to be a string literal.
+#define PG_ALLOCATION_TAG(name) \
+    static const std::uint32_t PG_ALLOCATION_CONCAT(allocationTagIndex, __LINE__) = ::pg::allocationTracker().tag(name); \
+    ::pg::AllocationTag PG_ALLOCATION_CONCAT(allocationTag, __LINE__){ PG_ALLOCATION_CONCAT(allocationTagIndex, __LINE__) }
@@ -66,7 +66,7 @@ BasicStorage<T>::BasicStorage(BasicStorage&& other)
     : buffer_(other.buffer_),
     capacity_(other.capacity_) {
     other.buffer_ = nullptr;
-    other.capacity_ = nullptr;
+    other.capacity_ = 0u;
 }
 
 template< typename T >
@@ -77,7 +77,7 @@ BasicStorage<T>& BasicStorage<T>::operator=(BasicStorage&& rhs) {
     buffer_ = rhs.buffer_;
     capacity_ = rhs.capacity_;
     rhs.buffer_ = nullptr;
-    rhs.capacity_ = nullptr;
+    rhs.capacity_ = 0u;
     return *this;
 }
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <utility>
+
+namespace pg {
+
+/**
+ * @class DoubleBuffer
+ * @brief Two copies of a value, one being written by a producer while the other is read by a consumer.
+ *
+ * swap publishes the written copy, and has to be called while neither side uses the buffer.
+ * If nothing was written since the last swap, swap keeps the published copy, so the consumer
+ * keeps reading the latest complete value.
+ */
+template<typename T>
+class DoubleBuffer {
+public:
+    DoubleBuffer() = default;
+    ~DoubleBuffer() = default;
+
+    /// @brief The copy being written. Its previous contents are stale by two swaps.
+    T& write() {
+        written_ = true;
+        return buffers_[1 - front_];
+    }
+
+    /// @brief The copy published by the last swap.
+    const T& read() const {
+        return buffers_[front_];
+    }
+
+    /// @brief Publish the written copy, if write was called since the last swap.
+    void swap() {
+        if (written_) {
+            front_ = 1 - front_;
+            written_ = false;
+        }
+    }
+
+private:
+    T       buffers_[2]{};
+    int     front_{ 0 };
+    bool    written_{ false };
+};
+
+}
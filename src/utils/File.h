@@ -6,6 +6,11 @@
 #include <sstream>
 #include <fstream>
 #include <sys/stat.h>
+#include <cerrno>
+#include <cstdint>
+#ifdef _WIN32
+#include <direct.h>
+#endif
 
 namespace pg {
 
@@ -15,6 +20,33 @@ inline bool fileExists(const std::string& file) {
     return (stat(file.c_str(), &buffer) == 0);
 }
 
+/// @brief Get the last modification time of a file, or zero if it doesn't exist.
+inline std::uint64_t fileModifiedTime(const std::string& file) {
+    struct stat buffer;
+    if (stat(file.c_str(), &buffer) != 0) {
+        return 0u;
+    }
+    return std::uint64_t(buffer.st_mtime);
+}
+
+/// @brief Get the size of a file in bytes, or zero if it doesn't exist.
+inline std::uint64_t fileSize(const std::string& file) {
+    struct stat buffer;
+    if (stat(file.c_str(), &buffer) != 0) {
+        return 0u;
+    }
+    return std::uint64_t(buffer.st_size);
+}
+
+/// @brief Create a directory, unless it exists already. Parent directories aren't created.
+inline bool createDirectory(const std::string& directory) {
+#ifdef _WIN32
+    return _mkdir(directory.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
 /// @brief Get the contents of a file as a string.
 inline std::string fileToString(const std::string& file) {
     std::ifstream fin;
@@ -0,0 +1,80 @@
+#include "utils/FrameTimer.h"
+#include "utils/Assert.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// the length of one slice of sleep
+const std::chrono::microseconds SleepSlice{ 1000 };
+// the estimate follows the later samples more than the first ones, in case the scheduler changes
+const std::uint64_t MaxSleepSamples = 1000u;
+
+}
+
+namespace pg {
+
+FixedTimestep::FixedTimestep(Duration step, int maxSteps)
+    : step_{ step },
+    maxSteps_{ maxSteps } {
+    PG_ASSERT(step.count() > 0);
+    PG_ASSERT(maxSteps > 0);
+}
+
+int FixedTimestep::advance(Duration elapsed) {
+    accumulator_ += std::max(elapsed, Duration{ 0 });
+    const Duration limit = step_ * maxSteps_;
+    if (accumulator_ >= limit + step_) {
+        // keep the fraction of the next step, so that the interpolation doesn't jump
+        const Duration excess = accumulator_ - limit - (accumulator_ - limit) % step_;
+        dropped_ += excess;
+        accumulator_ -= excess;
+    }
+    int steps = 0;
+    while (accumulator_ >= step_ && steps < maxSteps_) {
+        accumulator_ -= step_;
+        ++steps;
+    }
+    return steps;
+}
+
+float FixedTimestep::alpha() const {
+    return float(double(accumulator_.count()) / double(step_.count()));
+}
+
+float FixedTimestep::step() const {
+    return float(std::chrono::duration<double>(step_).count());
+}
+
+FixedTimestep::Duration FixedTimestep::dropped() const {
+    return dropped_;
+}
+
+void FramePacer::waitUntil(Clock::time_point deadline) {
+    for (;;) {
+        const Clock::time_point start = Clock::now();
+        const double remaining = std::chrono::duration<double>(deadline - start).count();
+        if (remaining <= estimate_) {
+            break;
+        }
+        std::this_thread::sleep_for(SleepSlice);
+        const double slept = std::chrono::duration<double>(Clock::now() - start).count();
+        // the running mean and variance, which turn into moving ones after MaxSleepSamples
+        count_ = std::min(count_ + 1u, MaxSleepSamples);
+        const double weight = 1.0 / double(count_);
+        const double delta = slept - mean_;
+        mean_ += weight * delta;
+        variance_ = (1.0 - weight) * (variance_ + weight * delta * delta);
+        estimate_ = mean_ + 2.0 * std::sqrt(variance_);
+    }
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+double FramePacer::sleepEstimate() const {
+    return estimate_;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace pg {
+
+/**
+ * @class FixedTimestep
+ * @brief Splits the measured frame times into simulation steps of a fixed length.
+ *
+ * The time which is left over after the steps carries over to the next frame, and alpha tells
+ * how far it is into the next step, for interpolating between the last two steps.
+ *
+ * If the steps take longer to simulate than they cover, the frames would need more and more
+ * steps to catch up. At most maxSteps are run per frame, and the time beyond them is dropped,
+ * so the simulation slows down instead.
+ */
+class FixedTimestep {
+public:
+    // integer time, so that the steps don't drift with rounding errors
+    using Duration = std::chrono::nanoseconds;
+
+    FixedTimestep(Duration step, int maxSteps);
+
+    /// @brief Add the time which passed since the last frame, and get the number of steps to run.
+    int     advance(Duration elapsed);
+    /// @brief The fraction of a step left over after the steps of the last advance, in [0, 1).
+    float   alpha() const;
+    /// @brief The length of a step, in seconds.
+    float   step() const;
+    /// @brief The total time which was dropped by the catch up limit.
+    Duration dropped() const;
+
+private:
+    Duration    step_;
+    int         maxSteps_;
+    Duration    accumulator_{ 0 };
+    Duration    dropped_{ 0 };
+};
+
+/**
+ * @class FramePacer
+ * @brief Waits until a deadline, more precisely than sleeping alone.
+ *
+ * Sleeps overshoot by an amount which depends on the OS scheduler. The pacer sleeps in short
+ * slices while the time left is larger than the overshoot it has observed so far, and spins
+ * for the rest. The estimate is the mean of the observed slices plus two standard deviations.
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FramePacer() = default;
+
+    /// @brief Block the calling thread until the deadline. Returns immediately if it has passed.
+    void    waitUntil(Clock::time_point deadline);
+    /// @brief The current estimate of how long a slice of sleep takes, in seconds.
+    double  sleepEstimate() const;
+
+private:
+    double          estimate_{ 0.002 };
+    double          mean_{ 0.002 };
+    double          variance_{ 0.0 };
+    std::uint64_t   count_{ 1u };
+};
+
+}
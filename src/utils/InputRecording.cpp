@@ -0,0 +1,303 @@
+#include "utils/InputRecording.h"
+#include "utils/Assert.h"
+#include "utils/Log.h"
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const std::uint32_t Magic = 0x52504e49u;    // "INPR"
+const std::uint32_t FormatVersion = 1u;
+
+// the record type after the last event
+const std::uint8_t EndRecord = 0xffu;
+// the buffered records are written once there are this many bytes
+const std::size_t FlushSize = 1u << 12u;
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80u) {
+        out.push_back(std::uint8_t(value | 0x80u));
+        value >>= 7u;
+    }
+    out.push_back(std::uint8_t(value));
+}
+
+// zigzag coding, so that small negative numbers are short too
+void putSigned(std::vector<std::uint8_t>& out, std::int32_t value) {
+    putVarint(out, (std::uint32_t(value) << 1u) ^ std::uint32_t(value >> 31));
+}
+
+void putString(std::vector<std::uint8_t>& out, const std::string& str) {
+    putVarint(out, str.size());
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+class Reader {
+public:
+    Reader(const std::vector<std::uint8_t>& data)
+        : data_{ data } {}
+
+    bool varint(std::uint64_t& value) {
+        value = 0u;
+        for (unsigned shift = 0u; shift < 64u; shift += 7u) {
+            if (position_ == data_.size()) {
+                return false;
+            }
+            const std::uint8_t byte = data_[position_++];
+            value |= std::uint64_t(byte & 0x7fu) << shift;
+            if ((byte & 0x80u) == 0u) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool varint(std::uint32_t& value) {
+        std::uint64_t wide;
+        const bool ok = varint(wide);
+        value = std::uint32_t(wide);
+        return ok;
+    }
+
+    bool signedVarint(std::int32_t& value) {
+        std::uint32_t zigzag;
+        const bool ok = varint(zigzag);
+        value = std::int32_t(zigzag >> 1u) ^ -std::int32_t(zigzag & 1u);
+        return ok;
+    }
+
+    bool byte(std::uint8_t& value) {
+        if (position_ == data_.size()) {
+            return false;
+        }
+        value = data_[position_++];
+        return true;
+    }
+
+    bool string(std::string& str) {
+        std::uint64_t size;
+        if (!varint(size) || size > data_.size() - position_) {
+            return false;
+        }
+        str.assign(data_.begin() + position_, data_.begin() + position_ + size);
+        position_ += std::size_t(size);
+        return true;
+    }
+
+    bool done() const {
+        return position_ == data_.size();
+    }
+
+private:
+    const std::vector<std::uint8_t>& data_;
+    std::size_t position_{ 0u };
+};
+
+}
+
+namespace pg {
+
+bool operator==(const InputEvent& lhs, const InputEvent& rhs) {
+    return lhs.type == rhs.type && lhs.code == rhs.code && lhs.scancode == rhs.scancode
+        && lhs.state == rhs.state && lhs.repeat == rhs.repeat
+        && lhs.x == rhs.x && lhs.y == rhs.y && lhs.dx == rhs.dx && lhs.dy == rhs.dy;
+}
+
+std::uint64_t hashFile(const std::string& file) {
+    std::ifstream in{ file, std::ios::binary };
+    if (!in) {
+        return 0u;
+    }
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::istreambuf_iterator<char> it{ in }, end{}; it != end; ++it) {
+        hash = (hash ^ std::uint8_t(*it)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+InputRecorder::~InputRecorder() {
+    if (file_) {
+        flush_();
+        std::fclose(file_);
+    }
+}
+
+bool InputRecorder::open(const std::string& file, const InputRecordingHeader& header) {
+    PG_ASSERT(!file_);
+    file_ = std::fopen(file.c_str(), "wb");
+    if (!file_) {
+        LOG_ERROR << "Could not open " << file << " for recording the input";
+        return false;
+    }
+    ok_ = true;
+    lastStep_ = 0u;
+    buffer_.clear();
+    putVarint(buffer_, Magic);
+    putVarint(buffer_, FormatVersion);
+    putVarint(buffer_, header.seed);
+    putVarint(buffer_, header.stepLength);
+    putVarint(buffer_, header.width);
+    putVarint(buffer_, header.height);
+    putString(buffer_, header.scene);
+    putVarint(buffer_, header.sceneHash);
+    return flush_();
+}
+
+bool InputRecorder::isOpen() const {
+    return file_ != nullptr;
+}
+
+void InputRecorder::record(std::uint64_t step, const InputEvent& event) {
+    PG_ASSERT(file_);
+    PG_ASSERT(step >= lastStep_);
+    putVarint(buffer_, step - lastStep_);
+    lastStep_ = step;
+    buffer_.push_back(std::uint8_t(event.type));
+    switch (event.type) {
+    case InputEvent::KeyDown:
+    case InputEvent::KeyUp:
+        putSigned(buffer_, event.code);
+        putSigned(buffer_, event.scancode);
+        putVarint(buffer_, event.state);
+        putVarint(buffer_, event.repeat);
+        break;
+    case InputEvent::MouseMotion:
+        putSigned(buffer_, event.x);
+        putSigned(buffer_, event.y);
+        putSigned(buffer_, event.dx);
+        putSigned(buffer_, event.dy);
+        putVarint(buffer_, event.state);
+        break;
+    case InputEvent::MouseButtonDown:
+    case InputEvent::MouseButtonUp:
+        putSigned(buffer_, event.code);
+        putVarint(buffer_, event.repeat);
+        putSigned(buffer_, event.x);
+        putSigned(buffer_, event.y);
+        break;
+    case InputEvent::MouseWheel:
+        putSigned(buffer_, event.x);
+        putSigned(buffer_, event.y);
+        break;
+    case InputEvent::Quit:
+        break;
+    }
+    if (buffer_.size() >= FlushSize) {
+        flush_();
+    }
+}
+
+bool InputRecorder::close(std::uint64_t steps) {
+    PG_ASSERT(file_);
+    PG_ASSERT(steps >= lastStep_);
+    putVarint(buffer_, steps - lastStep_);
+    buffer_.push_back(EndRecord);
+    const bool flushed = flush_();
+    const bool closed = std::fclose(file_) == 0;
+    file_ = nullptr;
+    return flushed && closed && ok_;
+}
+
+bool InputRecorder::flush_() {
+    if (!buffer_.empty() && std::fwrite(buffer_.data(), 1u, buffer_.size(), file_) != buffer_.size()) {
+        ok_ = false;
+    }
+    buffer_.clear();
+    return ok_;
+}
+
+bool InputReplay::open(const std::string& file) {
+    std::ifstream in{ file, std::ios::binary };
+    if (!in) {
+        LOG_ERROR << "Could not open the input recording " << file;
+        return false;
+    }
+    const std::vector<std::uint8_t> data{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+    Reader reader{ data };
+
+    std::uint32_t magic = 0u;
+    std::uint32_t version = 0u;
+    if (!reader.varint(magic) || magic != Magic || !reader.varint(version) || version != FormatVersion) {
+        LOG_ERROR << file << " is not an input recording of format version " << FormatVersion;
+        return false;
+    }
+    if (!reader.varint(header_.seed) || !reader.varint(header_.stepLength)
+        || !reader.varint(header_.width) || !reader.varint(header_.height)
+        || !reader.string(header_.scene) || !reader.varint(header_.sceneHash)) {
+        LOG_ERROR << "The header of the input recording " << file << " is truncated";
+        return false;
+    }
+
+    records_.clear();
+    next_ = 0u;
+    std::uint64_t step = 0u;
+    bool ended = false;
+    while (!reader.done()) {
+        std::uint64_t delta;
+        std::uint8_t type;
+        if (!reader.varint(delta) || !reader.byte(type)) {
+            break;
+        }
+        step += delta;
+        if (type == EndRecord) {
+            ended = true;
+            break;
+        }
+        Record record{ step, InputEvent{} };
+        InputEvent& event = record.event;
+        event.type = InputEvent::Type(type);
+        bool ok = true;
+        switch (event.type) {
+        case InputEvent::KeyDown:
+        case InputEvent::KeyUp:
+            ok = reader.signedVarint(event.code) && reader.signedVarint(event.scancode)
+                && reader.varint(event.state) && reader.varint(event.repeat);
+            break;
+        case InputEvent::MouseMotion:
+            ok = reader.signedVarint(event.x) && reader.signedVarint(event.y)
+                && reader.signedVarint(event.dx) && reader.signedVarint(event.dy) && reader.varint(event.state);
+            break;
+        case InputEvent::MouseButtonDown:
+        case InputEvent::MouseButtonUp:
+            ok = reader.signedVarint(event.code) && reader.varint(event.repeat)
+                && reader.signedVarint(event.x) && reader.signedVarint(event.y);
+            break;
+        case InputEvent::MouseWheel:
+            ok = reader.signedVarint(event.x) && reader.signedVarint(event.y);
+            break;
+        case InputEvent::Quit:
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) {
+            break;
+        }
+        records_.push_back(record);
+    }
+    steps_ = step;
+    if (!ended) {
+        LOG_ERROR << "The input recording " << file << " didn't end cleanly, it is replayed up to step " << steps_;
+    }
+    return true;
+}
+
+const InputRecordingHeader& InputReplay::header() const {
+    return header_;
+}
+
+std::uint64_t InputReplay::steps() const {
+    return steps_;
+}
+
+bool InputReplay::next(std::uint64_t step, InputEvent& event) {
+    if (next_ == records_.size() || records_[next_].step > step) {
+        return false;
+    }
+    PG_ASSERT(records_[next_].step == step);
+    event = records_[next_++].event;
+    return true;
+}
+
+}
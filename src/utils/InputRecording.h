@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+namespace pg {
+
+/// @brief An input event, with the fields of the corresponding SDL event which the states read.
+struct InputEvent {
+    enum Type : std::uint8_t {
+        KeyDown,
+        KeyUp,
+        MouseMotion,
+        MouseButtonDown,
+        MouseButtonUp,
+        MouseWheel,
+        Quit
+    };
+
+    Type            type{ Quit };
+    std::int32_t    code{ 0 };      // the key code, or the mouse button
+    std::int32_t    scancode{ 0 };
+    std::uint32_t   state{ 0u };    // the key modifiers, or the mouse button mask of a motion
+    std::uint32_t   repeat{ 0u };   // the key repeat, or the click count of a mouse button
+    std::int32_t    x{ 0 };         // the mouse coordinates, or the wheel scroll
+    std::int32_t    y{ 0 };
+    std::int32_t    dx{ 0 };        // the relative mouse motion
+    std::int32_t    dy{ 0 };
+};
+
+bool operator==(const InputEvent& lhs, const InputEvent& rhs);
+
+/// @brief What a recording needs besides the input, to run the same way again.
+struct InputRecordingHeader {
+    std::uint32_t   seed{ 0u };     // the random number generator seed, see Random.h
+    std::uint64_t   stepLength{ 0u };   // the simulation step, in nanoseconds
+    std::uint32_t   width{ 0u };    // the window size, which the mouse coordinates are relative to
+    std::uint32_t   height{ 0u };
+    std::string     scene{};
+    std::uint64_t   sceneHash{ 0u };    // of the scene file's contents, see hashFile
+};
+
+/// @brief The FNV-1a hash of a file's contents, or zero if it can't be read.
+std::uint64_t hashFile(const std::string& file);
+
+/**
+ * @class InputRecorder
+ * @brief Writes input events with the simulation step they precede into a file.
+ *
+ * The file starts with a header, followed by one record per event: the number of steps since
+ * the last record and the event type, and the event's fields. The integers are variable length,
+ * so most records are a few bytes. An end record holds the total number of steps, so that a
+ * replay knows how long the session ran. The records are buffered, and written in blocks.
+ */
+class InputRecorder {
+public:
+    InputRecorder() = default;
+    ~InputRecorder();
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    bool open(const std::string& file, const InputRecordingHeader& header);
+    bool isOpen() const;
+    /// @brief Record an event, which was handled before the given step. The steps can't decrease.
+    void record(std::uint64_t step, const InputEvent& event);
+    /// @brief Write the end record and close the file. The destructor closes without an end record.
+    bool close(std::uint64_t steps);
+
+private:
+    bool flush_();
+
+    std::FILE*                  file_{ nullptr };
+    std::vector<std::uint8_t>   buffer_{};
+    std::uint64_t               lastStep_{ 0u };
+    bool                        ok_{ true };
+};
+
+/**
+ * @class InputReplay
+ * @brief Reads the events written by InputRecorder back, one step at a time.
+ */
+class InputReplay {
+public:
+    InputReplay() = default;
+
+    /// @brief Read the whole recording. Returns false if it can't be read, or has another format version.
+    bool open(const std::string& file);
+    const InputRecordingHeader& header() const;
+    /// @brief The number of steps the session ran, or the step of the last event if it didn't end cleanly.
+    std::uint64_t steps() const;
+    /**
+     * @brief Get the next event which precedes the given step.
+     * @return false once the events of the step have been read. The steps have to increase.
+     */
+    bool next(std::uint64_t step, InputEvent& event);
+
+private:
+    struct Record {
+        std::uint64_t   step;
+        InputEvent      event;
+    };
+
+    InputRecordingHeader    header_{};
+    std::vector<Record>     records_{};
+    std::size_t             next_{ 0u };
+    std::uint64_t           steps_{ 0u };
+};
+
+}
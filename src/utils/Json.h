@@ -41,7 +41,7 @@ struct JsonToken {
         if (token_) {
             if (token->type == JSON_STRING) {
                 std::size_t count = indexToFirstDelim(token->str, '\"');
-                PG_ASSERT(count <= TokenBufferSize_);
+                PG_ASSERT(count < TokenBufferSize_);
                 std::memset(buffer_, 0, TokenBufferSize_);
                 std::memcpy(buffer_, token->str, count);
             }
@@ -52,7 +52,7 @@ struct JsonToken {
 
     template<typename T>
     T as() const {
-        static_assert(false, "This should be fully specialized.");
+        static_assert(sizeof(T) == 0u, "This should be fully specialized.");
     }
 
     inline operator bool() const {
@@ -63,7 +63,8 @@ private:
 
     friend class JsonParser;
 
-    static const int TokenBufferSize_{ 32 };
+    // the longest string, with its terminator
+    static const int TokenBufferSize_{ 64 };
     json_token* token_;
     char        buffer_[TokenBufferSize_];
 };
@@ -89,7 +90,7 @@ inline int JsonToken::as() const {
 template<>
 inline unsigned int JsonToken::as() const {
     PG_ASSERT(token_->type == JSON_NUMBER);
-    return unsigned int(std::atof(token_->str));
+    return (unsigned int)(std::atof(token_->str));
 }
 
 template<>
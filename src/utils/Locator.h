@@ -16,6 +16,11 @@ public:
         service_ = service;
     }
 
+    // some services are optional, for instance the renderers when running headless
+    static bool has() {
+        return service_ != nullptr;
+    }
+
 private:
     static T* service_;
 };
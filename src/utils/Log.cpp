@@ -1,4 +1,410 @@
 #include "Log.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// a power of two, and a multiple of the record alignment
+const std::size_t BufferCapacity = 1u << 16u;
+const std::size_t RecordAlignment = 16u;
+// the longer messages are truncated
+const std::size_t MaxMessageSize = BufferCapacity / 4u;
+const std::chrono::milliseconds DrainInterval{ 2 };
+// the level of the record which skips the rest of the buffer, up to the wrap around
+const std::uint8_t PaddingLevel = 0xffu;
+
+const char BinaryMagic[4] = { 'P', 'G', 'L', 'G' };
+const std::uint32_t BinaryVersion = 1u;
+
+struct RecordHeader {
+    std::int64_t    time;
+    std::uint32_t   size;
+    std::uint8_t    level;
+};
+static_assert(sizeof(RecordHeader) <= RecordAlignment, "the record header must fit the alignment");
+
+std::size_t alignRecord(std::size_t size) {
+    return (size + RecordAlignment - 1u) & ~(RecordAlignment - 1u);
+}
+
+std::int64_t nowNanoseconds() {
+    return std::int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// the parts of a record: a text part is followed by its length and the characters,
+// a number by its eight bytes
+enum Part : std::uint8_t {
+    TextPart,
+    SignedPart,
+    UnsignedPart,
+    RealPart
+};
+const std::size_t TextPartHeader = 1u + sizeof(std::uint32_t);
+const std::size_t NumberPartSize = 1u + 8u;
+
+// formats like the log always has: " [12:34:56 Info] message"
+class RecordFormatter {
+public:
+    void append(std::string& out, std::int64_t time, pg::LogLevel level, const char* record, std::size_t size) {
+        const std::time_t seconds = std::time_t(time / 1000000000);
+        if (seconds != lastSecond_) {
+            char buffer[16];
+            std::strftime(buffer, sizeof(buffer), "%H:%M:%S", std::localtime(&seconds));
+            timeString_ = buffer;
+            lastSecond_ = seconds;
+        }
+        out += " [";
+        out += timeString_;
+        out += ' ';
+        out += pg::LogLevelToString(level);
+        out += "] ";
+        if (level > pg::LogLevel::Debug) {
+            out.append(std::size_t(level - pg::LogLevel::Debug), '\t');
+        }
+        appendParts_(out, record, size);
+        out += '\n';
+    }
+
+private:
+    static void appendParts_(std::string& out, const char* record, std::size_t size) {
+        std::size_t position = 0u;
+        char number[32];
+        while (position < size) {
+            const std::uint8_t part = std::uint8_t(record[position]);
+            if (part == TextPart) {
+                std::uint32_t length;
+                std::memcpy(&length, record + position + 1u, sizeof(length));
+                out.append(record + position + TextPartHeader, length);
+                position += TextPartHeader + length;
+                continue;
+            }
+            if (part == SignedPart) {
+                long long value;
+                std::memcpy(&value, record + position + 1u, sizeof(value));
+                std::snprintf(number, sizeof(number), "%lld", value);
+            }
+            else if (part == UnsignedPart) {
+                unsigned long long value;
+                std::memcpy(&value, record + position + 1u, sizeof(value));
+                std::snprintf(number, sizeof(number), "%llu", value);
+            }
+            else {
+                double value;
+                std::memcpy(&value, record + position + 1u, sizeof(value));
+                // like an ostream with the default format
+                std::snprintf(number, sizeof(number), "%g", value);
+            }
+            out += number;
+            position += NumberPartSize;
+        }
+    }
+
+    std::time_t lastSecond_{ -1 };
+    std::string timeString_{};
+};
+
+// grows up to MaxMessageSize, and then drops the rest of the record
+class RecordBuffer : public std::streambuf {
+public:
+    RecordBuffer()
+        : buffer_(256u) {
+        reset();
+    }
+
+    void reset() {
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    char* data() {
+        return pbase();
+    }
+
+    std::size_t size() const {
+        return std::size_t(pptr() - pbase());
+    }
+
+    std::size_t room() const {
+        return MaxMessageSize - size();
+    }
+
+    // sputn without the virtual call, while the data fits
+    void append(const char* data, std::size_t count) {
+        if (std::size_t(epptr() - pptr()) >= count) {
+            std::memcpy(pptr(), data, count);
+            pbump(int(count));
+        }
+        else {
+            sputn(data, std::streamsize(count));
+        }
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return traits_type::not_eof(c);
+        }
+        const std::size_t used = size();
+        if (buffer_.size() >= MaxMessageSize) {
+            return traits_type::eof();
+        }
+        buffer_.resize(buffer_.size() * 2u);
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        pbump(int(used));
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+private:
+    std::vector<char> buffer_;
+};
+
+struct ThreadBuffer {
+    explicit ThreadBuffer(std::uint32_t index)
+        : bytes(BufferCapacity),
+        index{ index } {}
+
+    std::vector<char>           bytes;
+    // written is advanced by the thread, read by the writer
+    std::atomic<std::uint64_t>  written{ 0u };
+    std::atomic<std::uint64_t>  read{ 0u };
+    // cleared when the thread exits, so that the next new thread reuses the buffer
+    std::atomic<bool>           owned{ true };
+    std::uint32_t               index;
+};
+
+enum LoggerState {
+    NotStarted,
+    Running,
+    Stopped
+};
+
+// constant initialized, so that it can be checked during the static destruction
+std::atomic<int> loggerState{ NotStarted };
+
+class Logger {
+public:
+    Logger()
+        : writer_{} {
+        loggerState.store(Running, std::memory_order_release);
+        writer_ = std::thread{ [this]() -> void { run_(); } };
+    }
+
+    ~Logger() {
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            stop_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+        loggerState.store(Stopped, std::memory_order_release);
+        closeOutput_();
+    }
+
+    ThreadBuffer& registerThread() {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        for (auto& buffer : buffers_) {
+            bool owned = false;
+            if (buffer->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+                return *buffer;
+            }
+        }
+        buffers_.emplace_back(new ThreadBuffer{ std::uint32_t(buffers_.size()) });
+        return *buffers_.back();
+    }
+
+    void push(ThreadBuffer& buffer, pg::LogLevel level, std::int64_t time, const char* text, std::size_t size) {
+        const std::size_t need = alignRecord(sizeof(RecordHeader) + size);
+        std::uint64_t written = buffer.written.load(std::memory_order_relaxed);
+        const std::size_t offset = std::size_t(written & (BufferCapacity - 1u));
+        const std::size_t tail = BufferCapacity - offset;
+        // a record doesn't wrap around, the rest of the buffer is skipped instead
+        const std::size_t total = need <= tail ? need : tail + need;
+        while (written + total - buffer.read.load(std::memory_order_acquire) > BufferCapacity) {
+            std::this_thread::yield();
+        }
+        if (need > tail) {
+            writeHeader_(buffer, offset, RecordHeader{ 0, 0u, PaddingLevel });
+            written += tail;
+        }
+        const std::size_t start = std::size_t(written & (BufferCapacity - 1u));
+        writeHeader_(buffer, start, RecordHeader{ time, std::uint32_t(size), std::uint8_t(level) });
+        std::memcpy(buffer.bytes.data() + start + sizeof(RecordHeader), text, size);
+        buffer.written.store(written + need, std::memory_order_release);
+        // wake the writer early, rather than waiting for a full buffer
+        if (written + need - buffer.read.load(std::memory_order_relaxed) > BufferCapacity / 2u
+            && !wakeRequested_.exchange(true, std::memory_order_relaxed)) {
+            wake_.notify_one();
+        }
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        drain_();
+    }
+
+    bool setOutput(const std::string& file, pg::LogFormat format) {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        drain_();
+        closeOutput_();
+        format_ = format;
+        if (file.empty()) {
+            return true;
+        }
+        std::FILE* output = std::fopen(file.c_str(), format == pg::LogFormat::Binary ? "wb" : "w");
+        if (!output) {
+            format_ = pg::LogFormat::Text;
+            return false;
+        }
+        output_ = output;
+        if (format == pg::LogFormat::Binary) {
+            std::fwrite(BinaryMagic, 1u, sizeof(BinaryMagic), output_);
+            std::fwrite(&BinaryVersion, sizeof(BinaryVersion), 1u, output_);
+        }
+        return true;
+    }
+
+private:
+    struct Pending {
+        std::int64_t    time;
+        const char*     text;
+        std::uint32_t   size;
+        std::uint8_t    level;
+        std::uint32_t   thread;
+    };
+
+    static void writeHeader_(ThreadBuffer& buffer, std::size_t offset, const RecordHeader& header) {
+        std::memcpy(buffer.bytes.data() + offset, &header, sizeof(RecordHeader));
+    }
+
+    void run_() {
+        std::unique_lock<std::mutex> lock{ mutex_ };
+        while (!stop_) {
+            wake_.wait_for(lock, DrainInterval);
+            wakeRequested_.store(false, std::memory_order_relaxed);
+            drain_();
+        }
+        drain_();
+    }
+
+    // the only reader of the buffers, called with the mutex held
+    void drain_() {
+        pending_.clear();
+        ends_.clear();
+        for (auto& buffer : buffers_) {
+            const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+            std::uint64_t read = buffer->read.load(std::memory_order_relaxed);
+            while (read < written) {
+                const std::size_t offset = std::size_t(read & (BufferCapacity - 1u));
+                RecordHeader header;
+                std::memcpy(&header, buffer->bytes.data() + offset, sizeof(RecordHeader));
+                if (header.level == PaddingLevel) {
+                    read += BufferCapacity - offset;
+                    continue;
+                }
+                pending_.push_back(Pending{
+                    header.time, buffer->bytes.data() + offset + sizeof(RecordHeader),
+                    header.size, header.level, buffer->index
+                });
+                read += alignRecord(sizeof(RecordHeader) + header.size);
+            }
+            ends_.push_back(written);
+        }
+        if (pending_.empty()) {
+            return;
+        }
+        // the records of each thread are in order already
+        std::stable_sort(pending_.begin(), pending_.end(),
+            [](const Pending& lhs, const Pending& rhs) -> bool { return lhs.time < rhs.time; });
+
+        std::FILE* output = output_ ? output_ : stderr;
+        batch_.clear();
+        for (const Pending& record : pending_) {
+            if (format_ == pg::LogFormat::Binary) {
+                batch_.append(reinterpret_cast<const char*>(&record.time), sizeof(record.time));
+                batch_.append(reinterpret_cast<const char*>(&record.level), sizeof(record.level));
+                batch_.append(reinterpret_cast<const char*>(&record.thread), sizeof(record.thread));
+                batch_.append(reinterpret_cast<const char*>(&record.size), sizeof(record.size));
+                batch_.append(record.text, record.size);
+            }
+            else {
+                formatter_.append(batch_, record.time, pg::LogLevel(record.level), record.text, record.size);
+            }
+        }
+        std::fwrite(batch_.data(), 1u, batch_.size(), output);
+        std::fflush(output);
+
+        // only now can the threads overwrite the records
+        for (std::size_t i = 0u; i < buffers_.size(); ++i) {
+            buffers_[i]->read.store(ends_[i], std::memory_order_release);
+        }
+    }
+
+    void closeOutput_() {
+        if (output_) {
+            std::fclose(output_);
+            output_ = nullptr;
+        }
+    }
+
+    std::mutex                                  mutex_{};   // guards everything but the buffers' contents
+    std::condition_variable                     wake_{};
+    std::atomic<bool>                           wakeRequested_{ false };
+    bool                                        stop_{ false };
+    std::vector<std::unique_ptr<ThreadBuffer>>  buffers_{};
+    std::vector<Pending>                        pending_{};
+    std::vector<std::uint64_t>                  ends_{};
+    std::string                                 batch_{};
+    RecordFormatter                             formatter_{};
+    std::FILE*                                  output_{ nullptr };
+    pg::LogFormat                               format_{ pg::LogFormat::Text };
+    std::thread                                 writer_;
+};
+
+Logger& logger() {
+    static Logger instance{};
+    return instance;
+}
+
+// one stream per nesting level of the records being collected, see Log. The streams are only
+// added, so that each keeps its buffer.
+struct ThreadStreams {
+    pg::LogStream& push() {
+        if (depth == streams.size()) {
+            streams.emplace_back(new pg::LogStream{});
+        }
+        return *streams[depth++];
+    }
+
+    std::vector<std::unique_ptr<pg::LogStream>> streams{};
+    std::size_t depth{ 0u };
+};
+
+thread_local ThreadStreams threadStreams{};
+
+struct ThreadSlot {
+    ~ThreadSlot() {
+        if (buffer && loggerState.load(std::memory_order_acquire) == Running) {
+            buffer->owned.store(false, std::memory_order_release);
+        }
+    }
+
+    ThreadBuffer* buffer{ nullptr };
+};
+
+thread_local ThreadSlot threadSlot{};
+
+}
 
 namespace pg {
 
@@ -22,4 +428,266 @@ std::ostream& operator<<(std::ostream& os, const math::Quatf& q) {
     return os;
 }
 
+struct LogStream::Record {
+    static const std::size_t NoText = ~std::size_t(0u);
+
+    Record()
+        : buffer{},
+        stream{ &buffer },
+        flags{ stream.flags() } {}
+
+    void begin() {
+        buffer.reset();
+        textStart = NoText;
+        // the manipulators of the last record don't carry over
+        if (formatted) {
+            stream.clear();
+            stream.flags(flags);
+            stream.precision(6);
+            stream.width(0);
+            stream.fill(' ');
+            formatted = false;
+        }
+    }
+
+    bool openText() {
+        if (textStart == NoText) {
+            if (buffer.room() < TextPartHeader) {
+                // the record is full, and the stream drops the rest
+                stream.setstate(std::ios_base::badbit);
+                formatted = true;
+                return false;
+            }
+            textStart = buffer.size();
+            const char header[TextPartHeader] = { char(TextPart) };
+            buffer.append(header, TextPartHeader);
+        }
+        return true;
+    }
+
+    void closeText() {
+        if (textStart != NoText) {
+            const std::uint32_t length = std::uint32_t(buffer.size() - textStart - TextPartHeader);
+            std::memcpy(buffer.data() + textStart + 1u, &length, sizeof(length));
+            textStart = NoText;
+        }
+    }
+
+    void text(const char* str, std::size_t size) {
+        if (openText()) {
+            buffer.append(str, size);
+        }
+    }
+
+    RecordBuffer            buffer;
+    std::ostream            stream;
+    std::ios_base::fmtflags flags;
+    std::size_t             textStart{ NoText };
+    // whether the stream was used, so that its state may have changed
+    bool                    formatted{ false };
+};
+
+LogStream::LogStream()
+    : record_{ new Record{} } {}
+
+LogStream::~LogStream() = default;
+
+std::ostream& LogStream::formatted_() {
+    record_->formatted = true;
+    record_->openText();
+    return record_->stream;
+}
+
+bool LogStream::defaultFormat_() const {
+    const std::ostream& stream = record_->stream;
+    return stream.flags() == record_->flags && stream.precision() == 6 && stream.width() == 0;
+}
+
+template<typename Stored, typename T>
+LogStream& LogStream::number_(std::uint8_t part, T value) {
+    static_assert(sizeof(Stored) == NumberPartSize - 1u, "a number part holds eight bytes");
+    if (!defaultFormat_()) {
+        formatted_() << value;
+        return *this;
+    }
+    record_->closeText();
+    if (record_->buffer.room() >= NumberPartSize) {
+        char bytes[NumberPartSize] = { char(part) };
+        const Stored stored = Stored(value);
+        std::memcpy(bytes + 1u, &stored, sizeof(stored));
+        record_->buffer.append(bytes, NumberPartSize);
+    }
+    return *this;
+}
+
+LogStream& LogStream::operator<<(const char* str) {
+    if (str && defaultFormat_()) {
+        record_->text(str, std::strlen(str));
+    }
+    else {
+        formatted_() << str;
+    }
+    return *this;
+}
+
+LogStream& LogStream::operator<<(const std::string& str) {
+    if (defaultFormat_()) {
+        record_->text(str.data(), str.size());
+    }
+    else {
+        formatted_() << str;
+    }
+    return *this;
+}
+
+LogStream& LogStream::operator<<(char c) {
+    if (defaultFormat_()) {
+        record_->text(&c, 1u);
+    }
+    else {
+        formatted_() << c;
+    }
+    return *this;
+}
+
+LogStream& LogStream::operator<<(bool value) {
+    return number_<long long>(SignedPart, value);
+}
+
+LogStream& LogStream::operator<<(short value) {
+    return number_<long long>(SignedPart, value);
+}
+
+LogStream& LogStream::operator<<(unsigned short value) {
+    return number_<unsigned long long>(UnsignedPart, value);
+}
+
+LogStream& LogStream::operator<<(int value) {
+    return number_<long long>(SignedPart, value);
+}
+
+LogStream& LogStream::operator<<(unsigned int value) {
+    return number_<unsigned long long>(UnsignedPart, value);
+}
+
+LogStream& LogStream::operator<<(long value) {
+    return number_<long long>(SignedPart, value);
+}
+
+LogStream& LogStream::operator<<(unsigned long value) {
+    return number_<unsigned long long>(UnsignedPart, value);
+}
+
+LogStream& LogStream::operator<<(long long value) {
+    return number_<long long>(SignedPart, value);
+}
+
+LogStream& LogStream::operator<<(unsigned long long value) {
+    return number_<unsigned long long>(UnsignedPart, value);
+}
+
+LogStream& LogStream::operator<<(float value) {
+    return number_<double>(RealPart, value);
+}
+
+LogStream& LogStream::operator<<(double value) {
+    return number_<double>(RealPart, value);
+}
+
+LogStream& LogStream::operator<<(std::ostream& (*manipulator)(std::ostream&)) {
+    formatted_() << manipulator;
+    return *this;
+}
+
+LogStream& LogStream::operator<<(std::ios_base& (*manipulator)(std::ios_base&)) {
+    record_->formatted = true;
+    record_->stream << manipulator;
+    return *this;
+}
+
+Log::Log()
+    : stream_{ threadStreams.push() } {}
+
+LogStream& Log::get(LogLevel level) {
+    level_ = level;
+    time_ = nowNanoseconds();
+    stream_.record_->begin();
+    return stream_;
+}
+
+Log::~Log() {
+    LogStream::Record& record = *stream_.record_;
+    record.closeText();
+    const char* data = record.buffer.data();
+    const std::size_t size = record.buffer.size();
+    const int state = loggerState.load(std::memory_order_acquire);
+    if (state == Stopped) {
+        // during the static destruction, after the writer has stopped
+        std::string line{};
+        RecordFormatter{}.append(line, time_, level_, data, size);
+        std::fwrite(line.data(), 1u, line.size(), stderr);
+        --threadStreams.depth;
+        return;
+    }
+    Logger& instance = logger();
+    if (!threadSlot.buffer) {
+        threadSlot.buffer = &instance.registerThread();
+    }
+    instance.push(*threadSlot.buffer, level_, time_, data, size);
+    if (level_ <= LogLevel::Error) {
+        instance.flush();
+    }
+    --threadStreams.depth;
+}
+
+bool Log::setOutput(const std::string& file, LogFormat format) {
+    if (loggerState.load(std::memory_order_acquire) == Stopped) {
+        return false;
+    }
+    return logger().setOutput(file, format);
+}
+
+void Log::flush() {
+    if (loggerState.load(std::memory_order_acquire) == Running) {
+        logger().flush();
+    }
+}
+
+bool decodeBinaryLog(const std::string& file, std::ostream& out) {
+    std::ifstream in{ file, std::ios::binary };
+    if (!in) {
+        return false;
+    }
+    const std::string data{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+    std::uint32_t version = 0u;
+    if (data.size() < sizeof(BinaryMagic) + sizeof(version) || data.compare(0u, sizeof(BinaryMagic), BinaryMagic, sizeof(BinaryMagic)) != 0) {
+        return false;
+    }
+    std::memcpy(&version, data.data() + sizeof(BinaryMagic), sizeof(version));
+    if (version != BinaryVersion) {
+        return false;
+    }
+    const std::size_t recordHeader = sizeof(std::int64_t) + sizeof(std::uint8_t) + 2u * sizeof(std::uint32_t);
+    std::size_t position = sizeof(BinaryMagic) + sizeof(version);
+    RecordFormatter formatter{};
+    std::string line{};
+    while (data.size() - position >= recordHeader) {
+        std::int64_t time;
+        std::uint8_t level;
+        std::uint32_t size;
+        std::memcpy(&time, data.data() + position, sizeof(time));
+        std::memcpy(&level, data.data() + position + sizeof(time), sizeof(level));
+        std::memcpy(&size, data.data() + position + recordHeader - sizeof(size), sizeof(size));
+        position += recordHeader;
+        if (data.size() - position < size) {
+            return false;
+        }
+        line.clear();
+        formatter.append(line, time, LogLevel(level), data.data() + position, size);
+        out << line;
+        position += size;
+    }
+    return position == data.size();
+}
+
 }
@@ -9,6 +9,9 @@
 #include <cctype>   // for isspace
 #include <iostream>
 #include <algorithm>
+#include <memory>
+#include <string>
+#include <cstdint>
 
 namespace pg {
 
@@ -91,36 +94,122 @@ inline std::string NowTime() {
 }
 
 
-class Log {
+enum class LogFormat {
+    Text,
+    // the records as they are queued, in native byte order, see decodeBinaryLog
+    Binary
+};
 
+/**
+ * @class LogStream
+ * @brief Collects the parts of a log record.
+ *
+ * The strings are copied, and the numbers are stored as they are, for the writer thread to
+ * format. The other values are formatted with their ostream operator. Once a manipulator changes
+ * the format, the numbers are formatted right away too, with the manipulator applied. A thread
+ * has one stream per nesting level of the records, which is reset by each record, so the
+ * manipulators don't carry over.
+ */
+class LogStream {
 public:
-    Log() = default;
-    ~Log() {
-        os_ << std::endl;
-        std::cerr << os_.str();
-        std::cerr.flush();  //syncrohize underlying device
+    LogStream();
+    ~LogStream();
+
+    LogStream(const LogStream&) = delete;
+    LogStream& operator=(const LogStream&) = delete;
+
+    LogStream& operator<<(const char* str);
+    LogStream& operator<<(const std::string& str);
+    LogStream& operator<<(char c);
+    LogStream& operator<<(bool value);
+    LogStream& operator<<(short value);
+    LogStream& operator<<(unsigned short value);
+    LogStream& operator<<(int value);
+    LogStream& operator<<(unsigned int value);
+    LogStream& operator<<(long value);
+    LogStream& operator<<(unsigned long value);
+    LogStream& operator<<(long long value);
+    LogStream& operator<<(unsigned long long value);
+    LogStream& operator<<(float value);
+    LogStream& operator<<(double value);
+    LogStream& operator<<(std::ostream& (*manipulator)(std::ostream&));
+    LogStream& operator<<(std::ios_base& (*manipulator)(std::ios_base&));
+
+    template<typename T>
+    LogStream& operator<<(const T& value) {
+        formatted_() << value;
+        return *this;
     }
 
+private:
+    friend class Log;
+    struct Record;
+
+    // opens a text part of the record, and returns the stream which formats into it
+    std::ostream&   formatted_();
+    bool            defaultFormat_() const;
+    // stores the number as the given type, if the format is the default
+    template<typename Stored, typename T>
+    LogStream&      number_(std::uint8_t part, T value);
+
+    std::unique_ptr<Record> record_;
+};
+
+/**
+ * @class Log
+ * @brief A log record, which is queued when it is destroyed, see LOG.
+ *
+ * The record is collected by one of the calling thread's LogStreams, and copied into a ring buffer
+ * which only that thread writes to, so logging never takes a lock. A writer thread collects the
+ * records of all threads every few milliseconds, or once a buffer is half full, sorts them by
+ * time, formats them and writes them in one batch. A thread waits for the writer only if its
+ * ring buffer is full. Errors are flushed right away, so that they are written before a crash.
+ *
+ * A record can be logged while another one is being collected, for example by a function which
+ * is called in the other's stream expression. Each Log takes the next stream of the thread when
+ * it is constructed, and gives it back when it is destroyed, so the records don't share one.
+ *
+ * The levels above PG_LOG_MAX_LEVEL are compiled out, see LOG.
+ */
+class Log {
+
+public:
+    Log();
+    ~Log();
+
+    Log(const Log&) = delete;
+    Log& operator=(const Log&) = delete;
+
     inline static LogLevel& ReportingLevel() {
         static LogLevel level{ LogLevel::Debug4 };
         return level;
     }
 
-    inline std::ostringstream& get(LogLevel level = LogLevel::Info) {
-        //TO-DO: use std::put_time here to format the time output.
-        os_ << " [" << NowTime() << " " << LogLevelToString(level) << "] ";
-        os_ << std::string(level < LogLevel::Debug ? 0 : level - LogLevel::Debug, '\t');
-        return os_;
-    }
+    LogStream& get(LogLevel level = LogLevel::Info);
+
+    /// @brief Write the log to a file from now on, or to stderr if the file is empty.
+    static bool setOutput(const std::string& file, LogFormat format = LogFormat::Text);
+    /// @brief Write the queued records of all threads, and return once they are written.
+    static void flush();
 
 private:
-    std::ostringstream os_{};
+    LogStream&      stream_;
+    LogLevel        level_{ LogLevel::Info };
+    std::int64_t    time_{ 0 };     // system_clock nanoseconds
 };
 
+/// @brief Write a log written with LogFormat::Binary as text.
+bool decodeBinaryLog(const std::string& file, std::ostream& out);
+
 }
 
+// the most verbose level which is compiled in. The levels above it cost nothing at run time.
+#ifndef PG_LOG_MAX_LEVEL
+#define PG_LOG_MAX_LEVEL pg::LogLevel::All
+#endif
+
 #define LOG(level) \
-if ( level > pg::Log::ReportingLevel() ) ; \
+if ( level > PG_LOG_MAX_LEVEL || level > pg::Log::ReportingLevel() ) ; \
 else pg::Log().get( level )
 
 #define LOG_ERROR LOG(pg::LogLevel::Error)
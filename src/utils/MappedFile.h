@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <cstdlib>
+
+namespace pg {
+
+/**
+ * @class MappedFile
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * The pages are read in by the operating system as they are touched, so mapping a file and
+ * handing the pointer to glBufferData reads the file without an intermediate copy.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&);
+    MappedFile& operator=(MappedFile&&);
+
+    /**
+     * @brief Map the file, closing the current mapping first.
+     * @return false if the file doesn't exist, is empty, or couldn't be mapped.
+     */
+    bool        open(const std::string& file);
+    void        close();
+
+    bool        isOpen() const;
+    const char* data() const;
+    std::size_t size() const;
+
+private:
+    void swap_(MappedFile&);
+
+    const char*     data_{ nullptr };
+    std::size_t     size_{ 0u };
+#ifdef _WIN32
+    void*           file_{ nullptr };
+    void*           mapping_{ nullptr };
+#endif
+};
+
+}
@@ -0,0 +1,192 @@
+#include "utils/Profiler.h"
+#include "utils/Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace pg {
+
+struct Profiler::ThreadBuffer {
+    explicit ThreadBuffer(std::uint32_t index)
+        : events(BufferCapacity),
+        index{ index } {}
+
+    std::vector<ProfileEvent>   events;
+    // written is advanced by the thread, read by endFrame
+    std::atomic<std::uint64_t>  written{ 0u };
+    std::atomic<std::uint64_t>  read{ 0u };
+    std::uint32_t               depth{ 0u };
+    std::uint32_t               index;
+    std::string                 name{};
+};
+
+namespace {
+
+struct ThreadSlot {
+    const Profiler* owner{ nullptr };
+    void*           buffer{ nullptr };
+};
+
+thread_local ThreadSlot threadSlot{};
+
+void writeEscaped(std::FILE* file, const std::string& str) {
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(c, file);
+    }
+}
+
+}
+
+Profiler::Profiler()
+    : mutex_{},
+    buffers_{},
+    lastFrame_{},
+    capture_{},
+    captureBegin_{ 0u },
+    capturing_{ false } {
+    lastFrame_.end = now();
+}
+
+Profiler::~Profiler() = default;
+
+std::uint64_t Profiler::now() {
+    return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Profiler::ThreadBuffer& Profiler::buffer_() {
+    if (threadSlot.owner != this) {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        buffers_.emplace_back(new ThreadBuffer{ std::uint32_t(buffers_.size()) });
+        buffers_.back()->name = "thread " + std::to_string(buffers_.size() - 1u);
+        threadSlot.owner = this;
+        threadSlot.buffer = buffers_.back().get();
+    }
+    return *static_cast<ThreadBuffer*>(threadSlot.buffer);
+}
+
+std::uint32_t Profiler::beginZone() {
+    return buffer_().depth++;
+}
+
+void Profiler::endZone(const char* name, std::uint64_t begin, std::uint32_t depth) {
+    const std::uint64_t end = now();
+    ThreadBuffer& buffer = buffer_();
+    buffer.depth = depth;
+    const std::uint64_t written = buffer.written.load(std::memory_order_relaxed);
+    if (written - buffer.read.load(std::memory_order_acquire) >= BufferCapacity) {
+        return;
+    }
+    buffer.events[std::size_t(written % BufferCapacity)] = ProfileEvent{ name, begin, end, depth, buffer.index };
+    buffer.written.store(written + 1u, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = buffer_();
+    std::lock_guard<std::mutex> lock{ mutex_ };
+    buffer.name = name;
+}
+
+void Profiler::endFrame() {
+    lastFrame_.begin = lastFrame_.end;
+    lastFrame_.end = now();
+    lastFrame_.events.clear();
+    lastFrame_.threads.clear();
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        for (auto& buffer : buffers_) {
+            const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+            const std::uint64_t read = buffer->read.load(std::memory_order_relaxed);
+            for (std::uint64_t i = read; i < written; ++i) {
+                lastFrame_.events.push_back(buffer->events[std::size_t(i % BufferCapacity)]);
+            }
+            buffer->read.store(written, std::memory_order_release);
+            lastFrame_.threads.push_back(buffer->name);
+        }
+    }
+    // each buffer is in the order the zones ended, which puts children before their parents
+    std::sort(lastFrame_.events.begin(), lastFrame_.events.end(),
+        [](const ProfileEvent& lhs, const ProfileEvent& rhs) -> bool {
+            if (lhs.thread != rhs.thread) {
+                return lhs.thread < rhs.thread;
+            }
+            if (lhs.begin != rhs.begin) {
+                return lhs.begin < rhs.begin;
+            }
+            return lhs.depth < rhs.depth;
+        }
+    );
+    if (capturing_) {
+        const std::size_t room = MaxCaptureEvents - capture_.size();
+        const std::size_t count = std::min(room, lastFrame_.events.size());
+        capture_.insert(capture_.end(), lastFrame_.events.begin(), lastFrame_.events.begin() + count);
+    }
+}
+
+const Profiler::Frame& Profiler::lastFrame() const {
+    return lastFrame_;
+}
+
+void Profiler::startCapture() {
+    capture_.clear();
+    captureBegin_ = lastFrame_.end;
+    capturing_ = true;
+}
+
+bool Profiler::capturing() const {
+    return capturing_;
+}
+
+bool Profiler::writeCapture(const std::string& path) {
+    capturing_ = false;
+    std::vector<std::string> threads;
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        for (const auto& buffer : buffers_) {
+            threads.push_back(buffer->name);
+        }
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR << "Could not open trace file " << path << " for writing";
+        return false;
+    }
+    std::fputs("{\"traceEvents\":[", file);
+    const char* separator = "\n";
+    for (std::size_t i = 0u; i < threads.size(); ++i) {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"", separator, unsigned(i));
+        writeEscaped(file, threads[i]);
+        std::fputs("\"}}", file);
+        separator = ",\n";
+    }
+    for (const ProfileEvent& event : capture_) {
+        // the timestamps are in microseconds
+        const double begin = double(event.begin - std::min(event.begin, captureBegin_)) / 1000.0;
+        const double duration = double(event.end - event.begin) / 1000.0;
+        std::fprintf(file, "%s{\"name\":\"", separator);
+        writeEscaped(file, event.name);
+        std::fprintf(file, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            unsigned(event.thread), begin, duration);
+        separator = ",\n";
+    }
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    const bool ok = !std::ferror(file);
+    if (std::fclose(file) != 0 || !ok) {
+        LOG_ERROR << "Could not write trace file " << path;
+        return false;
+    }
+    LOG_INFO << "Wrote " << capture_.size() << " profiling zones to " << path;
+    capture_.clear();
+    return true;
+}
+
+Profiler& profiler() {
+    static Profiler instance{};
+    return instance;
+}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+
+/// @brief A finished profiling zone. The times are steady_clock nanoseconds, see Profiler::now.
+struct ProfileEvent {
+    const char*     name;
+    std::uint64_t   begin;
+    std::uint64_t   end;
+    std::uint32_t   depth;      // the number of zones on the same thread it is nested in
+    std::uint32_t   thread;     // an index into Profiler::Frame::threads
+};
+
+/**
+ * @class Profiler
+ * @brief Collects the profiling zones of all threads, frame by frame.
+ *
+ * Each thread records its finished zones into a ring buffer of its own. Only the thread writes
+ * to its buffer, and endFrame reads the events written since the last call, so recording never
+ * takes a lock. The buffer is registered on the thread's first zone. The zones a thread
+ * finishes after filling its buffer, before the next endFrame, are dropped.
+ *
+ * The collected frames can be captured, and written as a Chrome trace, see writeCapture. The
+ * file opens in chrome://tracing.
+ *
+ * Use the profiler through PG_PROFILE_ZONE, and the global instance from profiler().
+ */
+class Profiler {
+public:
+    static const std::size_t BufferCapacity = 1u << 14u;
+    // the capture stops at this many events
+    static const std::size_t MaxCaptureEvents = 1u << 21u;
+
+    struct Frame {
+        std::uint64_t               begin{ 0u };
+        std::uint64_t               end{ 0u };
+        std::vector<ProfileEvent>   events{};       // sorted by thread, then by begin
+        std::vector<std::string>    threads{};      // the names of the threads, by index
+    };
+
+    Profiler();
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /// @brief The current time in nanoseconds, from std::chrono::steady_clock.
+    static std::uint64_t now();
+
+    /// @brief Open a zone on the calling thread, and return its depth.
+    std::uint32_t   beginZone();
+    /// @brief Record a finished zone. name has to outlive the profiler, like a string literal or typeName does.
+    void            endZone(const char* name, std::uint64_t begin, std::uint32_t depth);
+    /// @brief Name the calling thread in the frames and traces.
+    void            setThreadName(const std::string& name);
+
+    /// @brief Collect the zones finished since the last call into lastFrame.
+    void            endFrame();
+    const Frame&    lastFrame() const;
+
+    /// @brief Keep the events of the frames from now on, until writeCapture.
+    void            startCapture();
+    bool            capturing() const;
+    /// @brief Stop capturing, and write the captured events as Chrome trace_event JSON.
+    bool            writeCapture(const std::string& file);
+
+private:
+    struct ThreadBuffer;
+
+    ThreadBuffer&   buffer_();
+
+    std::mutex                                  mutex_;         // guards the buffer list and the thread names
+    std::vector<std::unique_ptr<ThreadBuffer>>  buffers_;
+    Frame                                       lastFrame_;
+    std::vector<ProfileEvent>                   capture_;
+    std::uint64_t                               captureBegin_;
+    bool                                        capturing_;
+};
+
+/// @brief The profiler all zones are recorded into.
+Profiler& profiler();
+
+/**
+ * @class ProfileZone
+ * @brief Records the time between its construction and destruction, see PG_PROFILE_ZONE.
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name_{ name },
+        depth_{ profiler().beginZone() },
+        begin_{ Profiler::now() } {}
+
+    ~ProfileZone() {
+        profiler().endZone(name_, begin_, depth_);
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char*     name_;
+    std::uint32_t   depth_;
+    std::uint64_t   begin_;
+};
+
+}
+
+#define PG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define PG_PROFILE_CONCAT(a, b) PG_PROFILE_CONCAT_IMPL(a, b)
+/// @brief Profile the rest of the enclosing scope. The name has to be a string literal.
+#define PG_PROFILE_ZONE(name) ::pg::ProfileZone PG_PROFILE_CONCAT(profileZone, __LINE__){ name }
@@ -12,11 +12,20 @@ std::minstd_rand& globalUniformRng() {
     return u;
 }
 
+bool& deterministic() {
+    static bool d{ false };
+    return d;
+}
+
 }
 
 namespace pg {
 
 void randomize() {
+    if (deterministic()) {
+        globalUniformRng().seed(globalUniformRng()());
+        return;
+    }
     std::random_device rd{};
     globalUniformRng().seed(rd());
 }
@@ -25,6 +34,11 @@ void seed(unsigned int s) {
     globalUniformRng().seed(s);
 }
 
+void seedDeterministic(unsigned int s) {
+    deterministic() = true;
+    globalUniformRng().seed(s);
+}
+
 std::int32_t randi(std::int32_t a, std::int32_t b) {
     static std::uniform_int_distribution<> d{};
     using Distribution = decltype(d)::param_type;
@@ -15,6 +15,10 @@ void randomize();
 
 void seed(unsigned int seed);
 
+/// \brief Seed the generator, and make randomize draw its seeds from the generator from now on.
+/// The input recordings use this, so that the seed reproduces all the numbers of a session.
+void seedDeterministic(unsigned int seed);
+
 /// \brief Get a random int32 in [ a, b ].
 std::int32_t randi(std::int32_t a, std::int32_t b);
 
@@ -0,0 +1,88 @@
+#include "utils/RangeAllocator.h"
+#include "utils/Assert.h"
+#include <iterator>
+
+namespace pg {
+
+const std::size_t RangeAllocator::Invalid;
+
+RangeAllocator::RangeAllocator(std::size_t capacity)
+    : free_{},
+    capacity_{ 0u },
+    used_{ 0u } {
+    grow(capacity);
+}
+
+std::size_t RangeAllocator::allocate(std::size_t size, std::size_t alignment) {
+    PG_ASSERT(alignment != 0u);
+    if (size == 0u) {
+        return Invalid;
+    }
+    for (auto it = free_.begin(); it != free_.end(); ++it) {
+        const std::size_t begin = it->first;
+        const std::size_t end = begin + it->second;
+        const std::size_t offset = (begin + alignment - 1u) / alignment * alignment;
+        if (offset + size > end) {
+            continue;
+        }
+        // what's left of the free range on either side of the allocation stays free
+        free_.erase(it);
+        if (offset > begin) {
+            free_.emplace(begin, offset - begin);
+        }
+        if (offset + size < end) {
+            free_.emplace(offset + size, end - offset - size);
+        }
+        used_ += size;
+        return offset;
+    }
+    return Invalid;
+}
+
+void RangeAllocator::free(std::size_t offset, std::size_t size) {
+    PG_ASSERT(offset + size <= capacity_);
+    PG_ASSERT(size <= used_);
+    if (size == 0u) {
+        return;
+    }
+    used_ -= size;
+    auto next = free_.lower_bound(offset);
+    PG_ASSERT(next == free_.end() || offset + size <= next->first);
+    if (next != free_.begin()) {
+        auto previous = std::prev(next);
+        PG_ASSERT(previous->first + previous->second <= offset);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            free_.erase(previous);
+        }
+    }
+    if (next != free_.end() && offset + size == next->first) {
+        size += next->second;
+        free_.erase(next);
+    }
+    free_.emplace(offset, size);
+}
+
+void RangeAllocator::grow(std::size_t capacity) {
+    PG_ASSERT(capacity >= capacity_);
+    if (capacity == capacity_) {
+        return;
+    }
+    const std::size_t added = capacity - capacity_;
+    const std::size_t offset = capacity_;
+    capacity_ = capacity;
+    // free merges the new space with a free range at the old end
+    used_ += added;
+    free(offset, added);
+}
+
+std::size_t RangeAllocator::capacity() const {
+    return capacity_;
+}
+
+std::size_t RangeAllocator::used() const {
+    return used_;
+}
+
+}
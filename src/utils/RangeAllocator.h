@@ -0,0 +1,41 @@
+#pragma once
+
+#include <map>
+#include <cstdlib>
+
+namespace pg {
+
+/**
+ * @class RangeAllocator
+ * @brief Hands out disjoint ranges of an address space, such as the bytes of a GPU buffer.
+ *
+ * The allocator only does the bookkeeping, the memory itself lives elsewhere. Allocation is
+ * first fit, and freed ranges are merged with their free neighbors.
+ */
+class RangeAllocator {
+public:
+    static const std::size_t Invalid = ~std::size_t(0u);
+
+    explicit RangeAllocator(std::size_t capacity = 0u);
+
+    /**
+     * @param alignment The offset of the range is a multiple of this. It doesn't have to be a power of two.
+     * @return The offset of the range, or Invalid if no free range is large enough.
+     */
+    std::size_t allocate(std::size_t size, std::size_t alignment = 1u);
+    /// @brief Give back a range returned by allocate.
+    void        free(std::size_t offset, std::size_t size);
+    /// @brief Extend the address space. The new space is free.
+    void        grow(std::size_t capacity);
+
+    std::size_t capacity() const;
+    /// @brief The number of allocated units, not counting alignment padding.
+    std::size_t used() const;
+
+private:
+    std::map<std::size_t, std::size_t>  free_{};    // offset to size, in address order
+    std::size_t                         capacity_{ 0u };
+    std::size_t                         used_{ 0u };
+};
+
+}
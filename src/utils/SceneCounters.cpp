@@ -0,0 +1,82 @@
+#include "utils/SceneCounters.h"
+#include "utils/File.h"
+#include "utils/Json.h"
+#include "utils/Log.h"
+#include <cstdio>
+
+namespace pg {
+
+void SceneCounters::add(const std::string& name, double value) {
+    for (auto& counter : counters_) {
+        if (counter.first == name) {
+            counter.second += value;
+            return;
+        }
+    }
+    counters_.emplace_back(name, value);
+}
+
+double SceneCounters::value(const std::string& name) const {
+    for (const auto& counter : counters_) {
+        if (counter.first == name) {
+            return counter.second;
+        }
+    }
+    return 0.0;
+}
+
+const std::vector<std::pair<std::string, double>>& SceneCounters::counters() const {
+    return counters_;
+}
+
+bool SceneCounters::write(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR << "Could not open scene counter file " << path << " for writing";
+        return false;
+    }
+    std::fputs("{\n  \"counters\": [", file);
+    for (std::size_t i = 0u; i < counters_.size(); ++i) {
+        std::fprintf(file, "%s\n    {\"name\": \"%s\", \"value\": %.0f}", i == 0u ? "" : ",",
+            counters_[i].first.c_str(), counters_[i].second);
+    }
+    std::fputs("\n  ]\n}\n", file);
+    const bool ok = !std::ferror(file);
+    if (std::fclose(file) != 0 || !ok) {
+        LOG_ERROR << "Could not write scene counter file " << path;
+        return false;
+    }
+    return true;
+}
+
+int SceneCounters::compare(const std::string& baseline, double tolerance) const {
+    if (!fileExists(baseline)) {
+        LOG_ERROR << "The baseline " << baseline << " does not exist";
+        return -1;
+    }
+    JsonParser json{ baseline.c_str() };
+    int failures = 0;
+    int compared = 0;
+    char query[32];
+    for (int i = 0;; ++i) {
+        std::snprintf(query, sizeof(query), "counters[%i]", i);
+        const JsonToken entry = json.query(query);
+        if (!entry) {
+            break;
+        }
+        const std::string name = json.query(entry, "name").as<const char*>();
+        const double expected = json.query(entry, "value").as<double>();
+        const JsonToken ownTolerance = json.query(entry, "tolerance");
+        const double limit = expected * (1.0 + (ownTolerance ? ownTolerance.as<double>() : tolerance));
+        const double actual = value(name);
+        if (actual > limit) {
+            LOG_ERROR << "Regressed " << name << ": " << actual << ", baseline " << expected;
+            ++failures;
+        }
+        ++compared;
+    }
+    LOG_INFO << "Compared " << compared << " scene counters against " << baseline << ": " << failures << " regressed";
+    return failures;
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pg {
+
+/**
+ * @class SceneCounters
+ * @brief Counters which a replay sums over its frames, and compares against a baseline.
+ *
+ * A replay runs the same steps every time, so counts like the draw calls, the state changes
+ * and the allocations of each tag only change if the code does. The counters are written as
+ * JSON, in the format of the baseline:
+ *
+ *     {"counters": [{"name": "drawCalls", "value": 3600}, {"name": "stateChanges", "value": 52000}]}
+ *
+ * A baseline entry can have a "tolerance" of its own, which overrides the one given to compare.
+ */
+class SceneCounters {
+public:
+    SceneCounters() = default;
+    ~SceneCounters() = default;
+
+    /// @brief Add to the counter of the name, which starts from zero.
+    void    add(const std::string& name, double value);
+    /// @brief The value of a counter, or zero if nothing was added to it.
+    double  value(const std::string& name) const;
+    /// @brief The counters, in the order they were first added to.
+    const std::vector<std::pair<std::string, double>>& counters() const;
+
+    bool    write(const std::string& file) const;
+    /**
+     * @brief Log the counters which exceed the baseline's by more than the tolerance, a fraction
+     * of the baseline's value. Only the counters in the baseline are compared, and the ones
+     * which weren't added to are zero.
+     * @return The number of counters which regressed, or -1 if the baseline can't be read.
+     */
+    int     compare(const std::string& baseline, double tolerance) const;
+
+private:
+    std::vector<std::pair<std::string, double>> counters_{};
+};
+
+}
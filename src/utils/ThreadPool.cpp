@@ -0,0 +1,105 @@
+#include "utils/ThreadPool.h"
+#include "utils/Assert.h"
+#include <algorithm>
+
+namespace pg {
+
+ThreadPool::ThreadPool(std::size_t workers) {
+    threads_.reserve(workers);
+    for (std::size_t i = 0u; i < workers; ++i) {
+        threads_.emplace_back(&ThreadPool::work_, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::size() const {
+    return threads_.size() + 1u;
+}
+
+std::size_t ThreadPool::parallelFor(std::size_t count, std::size_t minRangeSize, const RangeFunction& f) {
+    if (count == 0u) {
+        return 0u;
+    }
+    minRangeSize = std::max<std::size_t>(minRangeSize, 1u);
+    std::size_t ranges = std::min(size(), (count + minRangeSize - 1u) / minRangeSize);
+    const std::size_t rangeSize = (count + ranges - 1u) / ranges;
+    // rounding up the range size can leave the last ranges empty
+    ranges = (count + rangeSize - 1u) / rangeSize;
+    if (ranges == 1u) {
+        f(0u, count, 0u);
+        return 1u;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PG_ASSERT(pending_ == 0u);
+        function_ = &f;
+        count_ = count;
+        rangeSize_ = rangeSize;
+        ranges_ = ranges;
+        pending_ = ranges - 1u;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    // the calling thread takes the first range
+    f(0u, std::min(rangeSize, count), 0u);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() -> bool { return pending_ == 0u; });
+    function_ = nullptr;
+    return ranges;
+}
+
+std::size_t ThreadPool::defaultWorkerCount() {
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1u ? hardwareThreads - 1u : 0u;
+}
+
+void ThreadPool::work_(std::size_t worker) {
+    std::size_t seenGeneration = 0u;
+    for (;;) {
+        const RangeFunction* function = nullptr;
+        std::size_t begin = 0u;
+        std::size_t end = 0u;
+        const std::size_t range = worker + 1u;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seenGeneration]() -> bool { return stop_ || generation_ != seenGeneration; });
+            if (stop_) {
+                return;
+            }
+            seenGeneration = generation_;
+            if (range >= ranges_) {
+                // not needed for this loop
+                continue;
+            }
+            function = function_;
+            begin = range * rangeSize_;
+            end = std::min(begin + rangeSize_, count_);
+        }
+
+        (*function)(begin, end, range);
+
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last = --pending_ == 0u;
+        }
+        if (last) {
+            done_.notify_one();
+        }
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+namespace pg {
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads for fork-join style loops.
+ *
+ * parallelFor splits an index range into contiguous, disjoint ranges, and runs them on the
+ * workers and the calling thread. It returns once all the ranges are done, so the caller
+ * can read the results without further synchronization.
+ *
+ * parallelFor is meant to be called from one thread at a time.
+ */
+class ThreadPool {
+public:
+    /// @brief The range function is called with (begin, end, range index).
+    using RangeFunction = std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+    /**
+     * @param workers The number of worker threads, in addition to the calling thread.
+     */
+    explicit ThreadPool(std::size_t workers = defaultWorkerCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the maximum number of ranges, which is the worker count plus the calling thread.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Call f for disjoint ranges covering [0, count).
+     * Ranges contain at least minRangeSize indices, except for the last one.
+     * @return The number of ranges that were run. The range indices are [0, return value).
+     */
+    std::size_t parallelFor(std::size_t count, std::size_t minRangeSize, const RangeFunction& f);
+
+    /// @brief One less than the number of hardware threads, so that the caller has a core too.
+    static std::size_t defaultWorkerCount();
+
+private:
+    void work_(std::size_t worker);
+
+    std::vector<std::thread>    threads_{};
+    std::mutex                  mutex_{};
+    std::condition_variable     wake_{};
+    std::condition_variable     done_{};
+    const RangeFunction*        function_{ nullptr };
+    std::size_t                 count_{ 0u };
+    std::size_t                 rangeSize_{ 0u };
+    std::size_t                 ranges_{ 0u };
+    std::size_t                 pending_{ 0u };     // worker ranges which haven't finished yet
+    std::size_t                 generation_{ 0u };  // incremented for each parallelFor
+    bool                        stop_{ false };
+};
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "utils/Assert.h"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pg {
+
+/**
+ * @class TimingWheel
+ * @brief Stores elements until their lifetime runs out, in slots keyed by their expiry tick.
+ *
+ * Time is split into ticks of a fixed length. An element expiring in tick t is stored in slot
+ * t % SlotCount, and each slot keeps its elements contiguously. Advancing past a tick clears its
+ * slot, so expiry only costs as much as the elements which expire. Elements which live longer
+ * than SlotCount ticks stay in their slot, and are passed over once per revolution.
+ *
+ * Elements expire at the end of the tick their lifetime ends in, so at most one tick late.
+ * forEachSlot hands out the slots' storage directly, so that it can be copied into vertex buffers
+ * as is. The order of the elements is unspecified.
+ */
+template<typename T, std::size_t SlotCount = 256u>
+class TimingWheel {
+public:
+    /// @param tickLength The length of a tick, in the same unit as the lifetimes.
+    explicit TimingWheel(float tickLength);
+    TimingWheel() = delete;
+    ~TimingWheel() = default;
+
+    /// @brief Store the element until lifeTime has passed.
+    void        insert(const T& element, float lifeTime);
+    /// @brief Move time forward by dt, and remove the elements whose lifetime has run out.
+    void        advance(float dt);
+    void        clear();
+
+    /// @brief Call f(const T* elements, std::size_t count) for each non-empty slot.
+    template<typename F>
+    void        forEachSlot(F f) const;
+
+    std::size_t size() const;
+    bool        empty() const;
+
+private:
+    struct Slot {
+        std::vector<T>              elements{};
+        std::vector<std::uint64_t>  expiry{};   // the tick each element expires in
+    };
+
+    // remove the elements of the slot which expire in or before the tick
+    void        expire_(Slot& slot, std::uint64_t tick);
+
+    std::vector<Slot>   slots_;
+    std::uint64_t       tick_;          // the current tick
+    float               elapsed_;       // the time passed since the start of the current tick
+    float               tickLength_;
+    std::size_t         size_;
+};
+
+template<typename T, std::size_t SlotCount>
+TimingWheel<T, SlotCount>::TimingWheel(float tickLength)
+    : slots_(SlotCount),
+    tick_{ 0u },
+    elapsed_{ 0.f },
+    tickLength_{ tickLength },
+    size_{ 0u } {
+    PG_ASSERT(tickLength > 0.f);
+}
+
+template<typename T, std::size_t SlotCount>
+void TimingWheel<T, SlotCount>::insert(const T& element, float lifeTime) {
+    // the tick which the end of the lifetime falls in, but never the current one
+    const float ticks = std::floor((elapsed_ + lifeTime) / tickLength_);
+    const std::uint64_t expiry = tick_ + std::uint64_t(std::max(ticks, 0.f)) + 1u;
+    Slot& slot = slots_[expiry % SlotCount];
+    slot.elements.push_back(element);
+    slot.expiry.push_back(expiry);
+    ++size_;
+}
+
+template<typename T, std::size_t SlotCount>
+void TimingWheel<T, SlotCount>::advance(float dt) {
+    elapsed_ += dt;
+    if (elapsed_ < tickLength_) {
+        return;
+    }
+    const float ticks = std::floor(elapsed_ / tickLength_);
+    elapsed_ -= ticks * tickLength_;
+    const std::uint64_t target = tick_ + std::uint64_t(ticks);
+    // after a whole revolution, every slot has been passed
+    const std::uint64_t passed = std::min(target - tick_, std::uint64_t(SlotCount));
+    for (std::uint64_t t = tick_ + 1u; t <= tick_ + passed; ++t) {
+        expire_(slots_[t % SlotCount], target);
+    }
+    tick_ = target;
+}
+
+template<typename T, std::size_t SlotCount>
+void TimingWheel<T, SlotCount>::clear() {
+    for (Slot& slot : slots_) {
+        slot.elements.clear();
+        slot.expiry.clear();
+    }
+    size_ = 0u;
+}
+
+template<typename T, std::size_t SlotCount>
+template<typename F>
+void TimingWheel<T, SlotCount>::forEachSlot(F f) const {
+    for (const Slot& slot : slots_) {
+        if (!slot.elements.empty()) {
+            f(slot.elements.data(), slot.elements.size());
+        }
+    }
+}
+
+template<typename T, std::size_t SlotCount>
+std::size_t TimingWheel<T, SlotCount>::size() const {
+    return size_;
+}
+
+template<typename T, std::size_t SlotCount>
+bool TimingWheel<T, SlotCount>::empty() const {
+    return size_ == 0u;
+}
+
+template<typename T, std::size_t SlotCount>
+void TimingWheel<T, SlotCount>::expire_(Slot& slot, std::uint64_t tick) {
+    const std::size_t count = slot.elements.size();
+    std::size_t kept = 0u;
+    for (std::size_t i = 0u; i < count; ++i) {
+        if (slot.expiry[i] > tick) {
+            // a later revolution
+            slot.elements[kept] = slot.elements[i];
+            slot.expiry[kept] = slot.expiry[i];
+            ++kept;
+        }
+    }
+    slot.elements.erase(slot.elements.begin() + kept, slot.elements.end());
+    slot.expiry.erase(slot.expiry.begin() + kept, slot.expiry.end());
+    size_ -= count - kept;
+}
+
+}
@@ -0,0 +1,37 @@
+#include "utils/TypeName.h"
+#include <initializer_list>
+#include <cstdlib>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace pg {
+
+std::string unqualifiedTypeName(const char* name) {
+    std::string result = name;
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        result = demangled;
+    }
+    std::free(demangled);
+#endif
+    // MSVC names start with the kind of the type
+    for (const char* prefix : { "class ", "struct ", "union ", "enum " }) {
+        const std::string kind = prefix;
+        if (result.compare(0u, kind.size(), kind) == 0) {
+            result.erase(0u, kind.size());
+            break;
+        }
+    }
+    // the template arguments keep their namespaces
+    const std::size_t arguments = result.find('<');
+    const std::size_t scope = result.rfind("::", arguments);
+    if (scope != std::string::npos) {
+        result.erase(0u, scope + 2u);
+    }
+    return result;
+}
+
+}
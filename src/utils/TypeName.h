@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <typeinfo>
+
+namespace pg {
+
+/**
+ * @brief Turn a std::type_info name into the type's name without namespaces.
+ * The name is demangled first, where the compiler mangles it.
+ */
+std::string unqualifiedTypeName(const char* name);
+
+/// @brief The type's name without namespaces, e.g. "RenderSystem" for pg::system::RenderSystem.
+template<typename T>
+const char* typeName() {
+    static const std::string name = unqualifiedTypeName(typeid(T).name());
+    return name.c_str();
+}
+
+}
@@ -0,0 +1,60 @@
+#include "utils/Worker.h"
+#include "utils/Assert.h"
+#include <utility>
+
+namespace pg {
+
+Worker::Worker()
+    : thread_{} {
+    // the thread reads the members, so it starts after they are initialized
+    thread_ = std::thread(&Worker::work_, this);
+}
+
+Worker::~Worker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void Worker::start(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PG_ASSERT(!busy_);
+        task_ = std::move(task);
+        busy_ = true;
+    }
+    wake_.notify_one();
+}
+
+void Worker::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() -> bool { return !busy_; });
+}
+
+void Worker::work_() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // a task given before stopping is still run
+            wake_.wait(lock, [this]() -> bool { return stop_ || busy_; });
+            if (!busy_) {
+                return;
+            }
+            task = std::move(task_);
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        done_.notify_one();
+    }
+}
+
+}
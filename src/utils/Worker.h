@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace pg {
+
+/**
+ * @class Worker
+ * @brief A dedicated thread which runs one task at a time.
+ *
+ * start hands a task to the thread and returns immediately, wait blocks until the task is done.
+ * Everything the task wrote can be read without further synchronization once wait returns.
+ *
+ * start and wait are meant to be called from one thread, the owner of the worker.
+ */
+class Worker {
+public:
+    using Task = std::function<void()>;
+
+    Worker();
+    ~Worker();
+
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+
+    /// @brief Run the task on the worker thread. The previous task has to be waited for first.
+    void start(Task task);
+    /// @brief Block until the task given to start is done. Returns immediately if there is none.
+    void wait();
+
+private:
+    void work_();
+
+    std::thread                 thread_;
+    std::mutex                  mutex_{};
+    std::condition_variable     wake_{};
+    std::condition_variable     done_{};
+    Task                        task_{};
+    bool                        busy_{ false };
+    bool                        stop_{ false };
+};
+
+}
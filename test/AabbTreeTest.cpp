@@ -0,0 +1,155 @@
+#include "math/AabbTree.h"
+#include "utils/Random.h"
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using pg::math::AabbTree;
+using pg::math::AABoxf;
+using pg::math::Rayf;
+using pg::math::Vec3f;
+
+namespace {
+
+AABoxf unitBoxAt(float x, float y, float z) {
+    return AABoxf{ Vec3f{ x - 0.5f, y - 0.5f, z - 0.5f }, Vec3f{ x + 0.5f, y + 0.5f, z + 0.5f } };
+}
+
+std::vector<std::uint32_t> sorted(std::vector<std::uint32_t> v) {
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+}
+
+SUITE( AabbTreeTest ) {
+
+    struct TreeWithGrid {
+        AabbTree tree{ 0.f };
+        std::vector<AABoxf> boxes{};
+        std::vector<std::uint32_t> proxies{};
+
+        TreeWithGrid() {
+            for (int x = 0; x < 10; ++x) {
+                for (int y = 0; y < 10; ++y) {
+                    for (int z = 0; z < 10; ++z) {
+                        boxes.push_back(unitBoxAt(2.f * x, 2.f * y, 2.f * z));
+                        proxies.push_back(tree.insert(boxes.back(), std::uint32_t(boxes.size() - 1u)));
+                    }
+                }
+            }
+        }
+
+        std::vector<std::uint32_t> bruteForce(const AABoxf& region) const {
+            std::vector<std::uint32_t> result;
+            for (std::uint32_t i = 0u; i < boxes.size(); ++i) {
+                if (pg::math::aaboxIntersectsAABox(region, boxes[i])) {
+                    result.push_back(i);
+                }
+            }
+            return result;
+        }
+
+        std::vector<std::uint32_t> query(const AABoxf& region) const {
+            std::vector<std::uint32_t> result;
+            tree.queryBox(region, [&result](std::uint32_t data) -> void {
+                result.push_back(data);
+            });
+            return sorted(result);
+        }
+    };
+
+    TEST( EmptyTreeReturnsNothing ) {
+        AabbTree tree;
+        int count = 0;
+        tree.queryBox(unitBoxAt(0.f, 0.f, 0.f), [&count](std::uint32_t) -> void { count++; });
+        CHECK_EQUAL( 0, count );
+        CHECK_EQUAL( 0u, tree.size() );
+    }
+
+    TEST_FIXTURE( TreeWithGrid, BoxQueryMatchesBruteForce ) {
+        CHECK_EQUAL( 1000u, tree.size() );
+        AABoxf region{ Vec3f{ 3.f, 3.f, 3.f }, Vec3f{ 8.f, 6.f, 11.f } };
+        std::vector<std::uint32_t> expected = bruteForce(region);
+        CHECK( !expected.empty() );
+        CHECK( expected == query(region) );
+    }
+
+    TEST_FIXTURE( TreeWithGrid, TreeStaysBalanced ) {
+        // a perfectly balanced tree of 1000 leaves has a height of 10
+        CHECK( tree.height() <= 20 );
+        tree.rebuild();
+        CHECK( tree.height() <= 20 );
+    }
+
+    TEST_FIXTURE( TreeWithGrid, RemovedLeavesAreNotReturned ) {
+        AABoxf region{ Vec3f{ -1.f, -1.f, -1.f }, Vec3f{ 1.f, 1.f, 1.f } };
+        CHECK_EQUAL( 1u, query(region).size() );
+        tree.remove(proxies[0]);
+        CHECK_EQUAL( 0u, query(region).size() );
+        CHECK_EQUAL( 999u, tree.size() );
+    }
+
+    TEST_FIXTURE( TreeWithGrid, MovedLeafIsFoundAtNewPosition ) {
+        AABoxf target = unitBoxAt(100.f, 100.f, 100.f);
+        CHECK( tree.move(proxies[5], target) );
+        std::vector<std::uint32_t> found = query(target);
+        CHECK_EQUAL( 1u, found.size() );
+        CHECK_EQUAL( 5u, found[0] );
+    }
+
+    TEST_FIXTURE( TreeWithGrid, RebuildKeepsProxiesAndResults ) {
+        tree.rebuild();
+        CHECK_EQUAL( 1000u, tree.size() );
+        for (std::uint32_t i = 0u; i < proxies.size(); i += 97u) {
+            CHECK_EQUAL( i, tree.userData(proxies[i]) );
+        }
+        AABoxf region{ Vec3f{ 0.f, 7.f, 2.f }, Vec3f{ 12.f, 9.f, 4.f } };
+        CHECK( bruteForce(region) == query(region) );
+    }
+
+    TEST_FIXTURE( TreeWithGrid, RayQueryFindsClosestHit ) {
+        // a ray along the x axis through the row of boxes at y = 2, z = 4
+        Rayf ray{ Vec3f{ -10.f, 2.f, 4.f }, Vec3f{ 1.f, 0.f, 0.f }, 0.f };
+        float closest = std::numeric_limits<float>::max();
+        std::uint32_t hit = AabbTree::Null;
+        tree.queryRay(ray, [&](std::uint32_t data) -> float {
+            Rayf test = ray;
+            if (!pg::math::rayIntersectsAABox(test, boxes[data])) {
+                return std::numeric_limits<float>::max();
+            }
+            if (test.t < closest) {
+                closest = test.t;
+                hit = data;
+            }
+            return test.t;
+        });
+        CHECK_EQUAL( 12u, hit );
+        CHECK_CLOSE( 9.5f, closest, 0.0001f );
+    }
+
+    TEST( RandomInsertsAndRemovesMatchBruteForce ) {
+        pg::seed(1u);
+        AabbTree tree{ 0.f };
+        std::vector<AABoxf> boxes;
+        std::vector<std::uint32_t> proxies;
+        for (std::uint32_t i = 0u; i < 500u; ++i) {
+            boxes.push_back(unitBoxAt(pg::randf(-50.f, 50.f), pg::randf(-50.f, 50.f), pg::randf(-50.f, 50.f)));
+            proxies.push_back(tree.insert(boxes.back(), i));
+        }
+        for (std::uint32_t i = 0u; i < 500u; i += 2u) {
+            tree.remove(proxies[i]);
+        }
+        AABoxf region{ Vec3f{ -20.f, -20.f, -20.f }, Vec3f{ 20.f, 20.f, 20.f } };
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t i = 1u; i < 500u; i += 2u) {
+            if (pg::math::aaboxIntersectsAABox(region, boxes[i])) {
+                expected.push_back(i);
+            }
+        }
+        std::vector<std::uint32_t> result;
+        tree.queryBox(region, [&result](std::uint32_t data) -> void { result.push_back(data); });
+        CHECK( expected == sorted(result) );
+    }
+}
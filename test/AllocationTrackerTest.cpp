@@ -0,0 +1,113 @@
+#include "utils/AllocationTracker.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using pg::AllocationSite;
+using pg::AllocationTracker;
+using pg::allocationTracker;
+
+namespace {
+
+const AllocationTracker::TagStats* findTag(const AllocationTracker::Frame& frame, const char* name) {
+    for (const AllocationTracker::TagStats& tag : frame.tags) {
+        if (std::strcmp(tag.name, name) == 0) {
+            return &tag;
+        }
+    }
+    return nullptr;
+}
+
+// the compiler can remove the allocations whose memory isn't used otherwise
+void* volatile sink = nullptr;
+
+template<typename T>
+std::unique_ptr<T> allocate(T value) {
+    std::unique_ptr<T> p{ new T(value) };
+    sink = p.get();
+    return p;
+}
+
+void allocateInts(std::vector<std::unique_ptr<int>>& out, int count) {
+    for (int i = 0; i < count; ++i) {
+        out.push_back(allocate(i));
+    }
+}
+
+}
+
+SUITE( AllocationTrackerTest ) {
+
+    // the test program is built with PG_TRACK_ALLOCATIONS
+    TEST( TheOperatorsAreTracked ) {
+        CHECK( AllocationTracker::enabled() );
+    }
+
+    TEST( AllocationsAreCountedUnderTheirTag ) {
+        allocationTracker().endFrame();
+        {
+            PG_ALLOCATION_TAG("outer");
+            std::unique_ptr<int> first = allocate(1);
+            {
+                PG_ALLOCATION_TAG("inner");
+                std::unique_ptr<double> second = allocate(2.0);
+                std::unique_ptr<double> third = allocate(3.0);
+            }
+            std::unique_ptr<char[]> fourth{ new char[100] };
+            sink = fourth.get();
+        }
+        allocationTracker().endFrame();
+        const AllocationTracker::Frame& frame = allocationTracker().lastFrame();
+        const AllocationTracker::TagStats* outer = findTag(frame, "outer");
+        const AllocationTracker::TagStats* inner = findTag(frame, "inner");
+        CHECK( outer && inner );
+        if (outer && inner) {
+            CHECK_EQUAL( 2u, outer->stats.allocations );
+            CHECK_EQUAL( sizeof(int) + 100u, outer->stats.bytes );
+            CHECK_EQUAL( 2u, outer->stats.frees );
+            CHECK_EQUAL( 2u, inner->stats.allocations );
+            CHECK_EQUAL( 2u * sizeof(double), inner->stats.bytes );
+        }
+        CHECK( frame.total.allocations >= 4u );
+    }
+
+    TEST( AFrameWithoutAllocationsIsEmpty ) {
+        allocationTracker().endFrame();
+        int sum = 0;
+        for (int i = 0; i < 100; ++i) {
+            sum += i;
+        }
+        allocationTracker().endFrame();
+        CHECK_EQUAL( 0u, allocationTracker().lastFrame().total.allocations );
+        CHECK( allocationTracker().lastFrame().tags.empty() );
+        CHECK_EQUAL( 4950, sum );
+    }
+
+    TEST( EveryNthAllocationIsSampled ) {
+        std::vector<std::unique_ptr<int>> ints;
+        ints.reserve(64);
+        allocationTracker().clearSamples();
+        allocationTracker().setSampleInterval(4u);
+        {
+            PG_ALLOCATION_TAG("sampled");
+            allocateInts(ints, 64);
+        }
+        allocationTracker().setSampleInterval(0u);
+        const std::vector<AllocationSite> sites = allocationTracker().sampledSites();
+        allocationTracker().clearSamples();
+        std::uint64_t samples = 0u;
+        for (const AllocationSite& site : sites) {
+            CHECK_EQUAL( std::string("sampled"), std::string(site.tag) );
+            CHECK_EQUAL( std::uint64_t(sizeof(int)) * site.samples, site.bytes );
+            samples += site.samples;
+        }
+        CHECK_EQUAL( 16u, samples );
+#if defined(__GLIBC__) || defined(_WIN32)
+        // all the samples come from the same call site
+        CHECK_EQUAL( 1u, sites.size() );
+        CHECK( !sites.empty() && !sites.front().frames.empty() );
+        CHECK( !sites.empty() && !pg::describeFrame(sites.front().frames.front()).empty() );
+#endif
+    }
+}
@@ -0,0 +1,29 @@
+#include "utils/DoubleBuffer.h"
+#include <UnitTest++/UnitTest++.h>
+
+using pg::DoubleBuffer;
+
+SUITE( DoubleBufferTest ) {
+
+    TEST( SwapPublishesTheWrittenValue ) {
+        DoubleBuffer<int> buffer;
+        buffer.write() = 1;
+        CHECK_EQUAL( 0, buffer.read() );
+        buffer.swap();
+        CHECK_EQUAL( 1, buffer.read() );
+        buffer.write() = 2;
+        CHECK_EQUAL( 1, buffer.read() );
+        buffer.swap();
+        CHECK_EQUAL( 2, buffer.read() );
+    }
+
+    TEST( SwapWithoutWritingKeepsTheLatestValue ) {
+        DoubleBuffer<int> buffer;
+        buffer.write() = 1;
+        buffer.swap();
+        buffer.swap();
+        CHECK_EQUAL( 1, buffer.read() );
+        buffer.swap();
+        CHECK_EQUAL( 1, buffer.read() );
+    }
+}
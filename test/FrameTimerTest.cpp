@@ -0,0 +1,58 @@
+#include "utils/FrameTimer.h"
+#include <UnitTest++/UnitTest++.h>
+
+using pg::FixedTimestep;
+using pg::FramePacer;
+using std::chrono::milliseconds;
+using std::chrono::microseconds;
+
+SUITE( FrameTimerTest ) {
+
+    TEST( ElapsedTimeIsSplitIntoSteps ) {
+        FixedTimestep timestep{ milliseconds(10), 5 };
+        CHECK_EQUAL( 0, timestep.advance(milliseconds(5)) );
+        CHECK_CLOSE( 0.5f, timestep.alpha(), 1e-6f );
+        CHECK_EQUAL( 1, timestep.advance(milliseconds(10)) );
+        CHECK_CLOSE( 0.5f, timestep.alpha(), 1e-6f );
+        CHECK_EQUAL( 3, timestep.advance(milliseconds(25)) );
+        CHECK_CLOSE( 0.f, timestep.alpha(), 1e-6f );
+        CHECK_CLOSE( 0.01f, timestep.step(), 1e-6f );
+    }
+
+    TEST( StepsPerFrameAreLimited ) {
+        FixedTimestep timestep{ milliseconds(10), 4 };
+        CHECK_EQUAL( 4, timestep.advance(microseconds(1002500)) );
+        // the fraction of a step is kept, the rest beyond the limit is dropped
+        CHECK_CLOSE( 0.25f, timestep.alpha(), 1e-6f );
+        CHECK( timestep.dropped() == milliseconds(960) );
+        CHECK_EQUAL( 0, timestep.advance(milliseconds(0)) );
+    }
+
+    TEST( TheStepsDontDependOnTheFrameTimes ) {
+        FixedTimestep even{ milliseconds(10), 8 };
+        FixedTimestep uneven{ milliseconds(10), 8 };
+        int evenSteps = 0;
+        int unevenSteps = 0;
+        for (int i = 0; i < 100; ++i) {
+            evenSteps += even.advance(milliseconds(12));
+            unevenSteps += uneven.advance(milliseconds(i % 2 == 0 ? 3 : 21));
+        }
+        CHECK_EQUAL( 120, evenSteps );
+        CHECK_EQUAL( evenSteps, unevenSteps );
+    }
+
+    TEST( PacerWaitsUntilTheDeadline ) {
+        FramePacer pacer;
+        for (int i = 0; i < 5; ++i) {
+            const FramePacer::Clock::time_point deadline = FramePacer::Clock::now() + milliseconds(3);
+            pacer.waitUntil(deadline);
+            CHECK( FramePacer::Clock::now() >= deadline );
+        }
+        CHECK( pacer.sleepEstimate() > 0.0 );
+    }
+
+    TEST( PacerReturnsForPassedDeadlines ) {
+        FramePacer pacer;
+        pacer.waitUntil(FramePacer::Clock::now() - milliseconds(1));
+    }
+}
@@ -0,0 +1,107 @@
+#include "utils/InputRecording.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cstdio>
+#include <string>
+
+using pg::InputEvent;
+using pg::InputRecorder;
+using pg::InputRecordingHeader;
+using pg::InputReplay;
+
+namespace {
+
+const char* RecordingFile = "input_recording_test.bin";
+
+InputEvent keyDown(int code) {
+    InputEvent event{};
+    event.type = InputEvent::KeyDown;
+    event.code = code;
+    event.scancode = code - 93;
+    event.state = 0x40u;
+    return event;
+}
+
+InputEvent mouseMotion(int x, int y, int dx, int dy) {
+    InputEvent event{};
+    event.type = InputEvent::MouseMotion;
+    event.x = x;
+    event.y = y;
+    event.dx = dx;
+    event.dy = dy;
+    event.state = 1u;
+    return event;
+}
+
+}
+
+SUITE( InputRecordingTest ) {
+
+    TEST( EventsAreReplayedAtTheirSteps ) {
+        InputRecordingHeader header{};
+        header.seed = 1234567u;
+        header.stepLength = 16666667u;
+        header.width = 1280u;
+        header.height = 720u;
+        header.scene = "scene.json";
+        header.sceneHash = 0xcbf29ce484222325ull;
+        {
+            InputRecorder recorder{};
+            CHECK( recorder.open(RecordingFile, header) );
+            recorder.record(0u, keyDown(119));
+            recorder.record(0u, mouseMotion(400, 300, -3, 2));
+            recorder.record(150u, mouseMotion(-20, 70000, 0, -400));
+            CHECK( recorder.close(1000u) );
+        }
+        InputReplay replay{};
+        CHECK( replay.open(RecordingFile) );
+        CHECK_EQUAL( header.seed, replay.header().seed );
+        CHECK( replay.header().stepLength == header.stepLength );
+        CHECK_EQUAL( header.width, replay.header().width );
+        CHECK_EQUAL( header.height, replay.header().height );
+        CHECK_EQUAL( header.scene, replay.header().scene );
+        CHECK( replay.header().sceneHash == header.sceneHash );
+        CHECK( replay.steps() == 1000u );
+
+        InputEvent event{};
+        CHECK( replay.next(0u, event) );
+        CHECK( event == keyDown(119) );
+        CHECK( replay.next(0u, event) );
+        CHECK( event == mouseMotion(400, 300, -3, 2) );
+        CHECK( !replay.next(0u, event) );
+        for (std::uint64_t step = 1u; step < 150u; ++step) {
+            CHECK( !replay.next(step, event) );
+        }
+        CHECK( replay.next(150u, event) );
+        CHECK( event == mouseMotion(-20, 70000, 0, -400) );
+        CHECK( !replay.next(151u, event) );
+        std::remove(RecordingFile);
+    }
+
+    TEST( TruncatedRecordingIsReplayedUpToTheLastEvent ) {
+        {
+            InputRecorder recorder{};
+            CHECK( recorder.open(RecordingFile, InputRecordingHeader{}) );
+            recorder.record(10u, keyDown(97));
+            recorder.record(20u, keyDown(98));
+            // no end record, as if the application crashed
+        }
+        InputReplay replay{};
+        CHECK( replay.open(RecordingFile) );
+        CHECK( replay.steps() == 20u );
+        InputEvent event{};
+        CHECK( replay.next(10u, event) );
+        CHECK( replay.next(20u, event) );
+        CHECK( event == keyDown(98) );
+        std::remove(RecordingFile);
+    }
+
+    TEST( OtherFilesAreRejected ) {
+        std::FILE* file = std::fopen(RecordingFile, "wb");
+        std::fputs("{ \"entities\": [] }", file);
+        std::fclose(file);
+        InputReplay replay{};
+        CHECK( !replay.open(RecordingFile) );
+        std::remove(RecordingFile);
+        CHECK( !replay.open(RecordingFile) );
+    }
+}
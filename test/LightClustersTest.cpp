@@ -0,0 +1,114 @@
+#include "math/LightClusters.h"
+#include "math/Matrix.h"
+#include "utils/ThreadPool.h"
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+
+using namespace pg::math;
+
+namespace {
+
+const float Near = 0.1f;
+const float Far = 100.f;
+
+ClusterGrid makeGrid() {
+    return ClusterGrid{ Matrix4f::perspective(1.2f, 16.f / 9.f, Near, Far), Near, Far };
+}
+
+// the cluster which contains the view space point
+std::uint32_t clusterOf(const ClusterGrid& grid, const Vec3f& p) {
+    const float depth = -p.z;
+    const float ndcX = p.x / (depth * grid.tanHalfFovX);
+    const float ndcY = p.y / (depth * grid.tanHalfFovY);
+    const std::uint32_t x = std::uint32_t((ndcX + 1.f) * 0.5f * ClusterGrid::CountX);
+    const std::uint32_t y = std::uint32_t((ndcY + 1.f) * 0.5f * ClusterGrid::CountY);
+    return x + ClusterGrid::CountX * (y + ClusterGrid::CountY * grid.slice(depth));
+}
+
+bool clusterContains(const LightClusters& clusters, std::uint32_t cluster, std::uint32_t light) {
+    const std::uint32_t* begin = clusters.indices().data() + clusters.clusters()[2u * cluster];
+    const std::uint32_t* end = begin + clusters.clusters()[2u * cluster + 1u];
+    return std::find(begin, end, light) != end;
+}
+
+// points inside the frustum, from a fixed sequence
+LightSpheres randomLights(const ClusterGrid& grid, std::size_t count) {
+    LightSpheres lights;
+    std::uint32_t state = 12345u;
+    auto next = [&state]() -> float {
+        state = state * 1664525u + 1013904223u;
+        return float(state >> 8u) / float(1u << 24u);
+    };
+    for (std::size_t i = 0u; i < count; ++i) {
+        const float depth = Near + (Far - Near) * next() * next();
+        const float x = (2.f * next() - 1.f) * 0.95f * depth * grid.tanHalfFovX;
+        const float y = (2.f * next() - 1.f) * 0.95f * depth * grid.tanHalfFovY;
+        lights.push_back(Vec3f{ x, y, -depth }, 0.1f + 2.f * next());
+    }
+    return lights;
+}
+
+}
+
+SUITE( LightClustersTest ) {
+
+    TEST( SlicesCoverTheDepthRange ) {
+        const ClusterGrid grid = makeGrid();
+        CHECK_CLOSE( Near, grid.sliceDepth(0u), 1e-6f );
+        CHECK_CLOSE( Far, grid.sliceDepth(ClusterGrid::CountZ), 1e-3f );
+        for (std::uint32_t slice = 0u; slice < ClusterGrid::CountZ; ++slice) {
+            const float middle = 0.5f * (grid.sliceDepth(slice) + grid.sliceDepth(slice + 1u));
+            CHECK_EQUAL( slice, grid.slice(middle) );
+        }
+        CHECK_EQUAL( 0u, grid.slice(0.f) );
+        CHECK_EQUAL( ClusterGrid::CountZ - 1u, grid.slice(2.f * Far) );
+    }
+
+    TEST( EachLightIsInTheClusterContainingItsCenter ) {
+        pg::ThreadPool pool(2u);
+        const ClusterGrid grid = makeGrid();
+        const LightSpheres lights = randomLights(grid, 500u);
+        LightClusters clusters;
+        clusters.assign(grid, lights, pool);
+        for (std::uint32_t i = 0u; i < lights.size(); ++i) {
+            const Vec3f center{ lights.x[i], lights.y[i], lights.z[i] };
+            CHECK( clusterContains(clusters, clusterOf(grid, center), i) );
+        }
+    }
+
+    TEST( SmallLightsOnlyReachNearbyClusters ) {
+        pg::ThreadPool pool(0u);
+        const ClusterGrid grid = makeGrid();
+        LightSpheres lights;
+        lights.push_back(Vec3f{ 0.3f, 0.2f, -12.f }, 0.01f);
+        LightClusters clusters;
+        clusters.assign(grid, lights, pool);
+        // a tiny sphere well inside a cluster touches that cluster only
+        CHECK_EQUAL( 1u, clusters.indices().size() );
+        CHECK( clusterContains(clusters, clusterOf(grid, Vec3f{ 0.3f, 0.2f, -12.f }), 0u) );
+    }
+
+    TEST( LightsBehindTheCameraAreNotAssigned ) {
+        pg::ThreadPool pool(0u);
+        LightSpheres lights;
+        lights.push_back(Vec3f{ 0.f, 0.f, 5.f }, 1.f);
+        LightClusters clusters;
+        clusters.assign(makeGrid(), lights, pool);
+        CHECK( clusters.indices().empty() );
+    }
+
+    TEST( AssignmentDoesntDependOnTheThreadCount ) {
+        pg::ThreadPool serial(0u);
+        pg::ThreadPool parallel(3u);
+        const ClusterGrid grid = makeGrid();
+        const LightSpheres lights = randomLights(grid, 1000u);
+        LightClusters a, b;
+        a.assign(grid, lights, serial);
+        b.assign(grid, lights, parallel);
+        CHECK( a.clusters() == b.clusters() );
+        CHECK( a.indices() == b.indices() );
+    }
+}
@@ -0,0 +1,151 @@
+// the debug levels are compiled out of this file
+#define PG_LOG_MAX_LEVEL pg::LogLevel::Info
+#include "utils/Log.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using pg::Log;
+using pg::LogFormat;
+
+namespace {
+
+const char* LogFile = "log_test.txt";
+
+std::vector<std::string> readLines(const std::string& file) {
+    std::ifstream in{ file };
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+int evaluated = 0;
+
+int countEvaluation() {
+    return ++evaluated;
+}
+
+// logs while the caller's record is being collected
+int loggedValue() {
+    LOG_INFO << std::hex << "inner " << 255;
+    return 7;
+}
+
+}
+
+SUITE( LogTest ) {
+
+    TEST( RecordsOfAllThreadsAreWrittenInOrder ) {
+        const int Threads = 4;
+        const int Records = 2000;
+        CHECK( Log::setOutput(LogFile) );
+        std::vector<std::thread> threads;
+        for (int t = 0; t < Threads; ++t) {
+            threads.emplace_back([t]() -> void {
+                for (int i = 0; i < Records; ++i) {
+                    LOG_INFO << "thread " << t << " record " << i;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        Log::flush();
+        CHECK( Log::setOutput("") );
+
+        const std::vector<std::string> lines = readLines(LogFile);
+        CHECK_EQUAL( std::size_t(Threads * Records), lines.size() );
+        std::vector<int> next(Threads, 0);
+        for (const std::string& line : lines) {
+            CHECK( line.find("Info] thread ") != std::string::npos );
+            int thread = -1;
+            int record = -1;
+            std::sscanf(line.c_str() + line.find("thread "), "thread %d record %d", &thread, &record);
+            CHECK( thread >= 0 && thread < Threads );
+            if (thread >= 0 && thread < Threads) {
+                CHECK_EQUAL( next[thread], record );
+                next[thread] = record + 1;
+            }
+        }
+        std::remove(LogFile);
+    }
+
+    TEST( BinaryLogDecodesToTheTextLog ) {
+        CHECK( Log::setOutput(LogFile, LogFormat::Binary) );
+        LOG_WARNING << std::hex << 255;
+        // the manipulators of the last record are reset
+        LOG_INFO << 255 << " " << 1.5f;
+        Log::flush();
+        CHECK( Log::setOutput("") );
+
+        std::ostringstream text;
+        CHECK( pg::decodeBinaryLog(LogFile, text) );
+        std::istringstream lines{ text.str() };
+        std::string line;
+        CHECK( bool(std::getline(lines, line)) );
+        CHECK( line.find("Warning] ff") != std::string::npos );
+        CHECK( bool(std::getline(lines, line)) );
+        CHECK( line.find("Info] 255 1.5") != std::string::npos );
+        CHECK( !bool(std::getline(lines, line)) );
+        std::remove(LogFile);
+        CHECK( !pg::decodeBinaryLog(LogFile, text) );
+    }
+
+    TEST( NumbersAreFormattedLikeAnOstream ) {
+        CHECK( Log::setOutput(LogFile) );
+        LOG_INFO << -5 << " " << 3000000000u << " " << 0.1 << " " << 1e20 << " " << 2.5f << " " << true << 'c' << std::size_t(7);
+        Log::flush();
+        CHECK( Log::setOutput("") );
+        std::ostringstream expected;
+        expected << -5 << " " << 3000000000u << " " << 0.1 << " " << 1e20 << " " << 2.5f << " " << true << 'c' << std::size_t(7);
+        const std::vector<std::string> lines = readLines(LogFile);
+        CHECK_EQUAL( 1u, lines.size() );
+        CHECK( lines.size() == 1u && lines[0].find("Info] " + expected.str()) != std::string::npos );
+        std::remove(LogFile);
+    }
+
+    TEST( LongRecordsAreTruncated ) {
+        CHECK( Log::setOutput(LogFile) );
+        LOG_INFO << std::string(1u << 20u, 'x');
+        LOG_INFO << "after";
+        Log::flush();
+        CHECK( Log::setOutput("") );
+        const std::vector<std::string> lines = readLines(LogFile);
+        CHECK_EQUAL( 2u, lines.size() );
+        CHECK( lines.size() == 2u && lines[0].size() < (1u << 20u) && lines[1].find("after") != std::string::npos );
+        std::remove(LogFile);
+    }
+
+    TEST( RecordsLoggedWhileCollectingAnotherAreSeparate ) {
+        CHECK( Log::setOutput(LogFile) );
+        LOG_INFO << "outer " << 5 << " " << loggedValue() << " " << 10;
+        Log::flush();
+        CHECK( Log::setOutput("") );
+        const std::vector<std::string> lines = readLines(LogFile);
+        CHECK_EQUAL( 2u, lines.size() );
+        // in the order their records began, which depends on the evaluation order
+        const std::string both = lines.size() == 2u ? lines[0] + lines[1] : std::string{};
+        CHECK( both.find("Info] outer 5 7 10") != std::string::npos );
+        CHECK( both.find("Info] inner ff") != std::string::npos );
+        std::remove(LogFile);
+    }
+
+    TEST( LevelsAboveTheMaximumAreCompiledOut ) {
+        evaluated = 0;
+        LOG_DEBUG << countEvaluation();
+        LOG_DEBUG4 << countEvaluation();
+        CHECK_EQUAL( 0, evaluated );
+        CHECK( Log::setOutput(LogFile) );
+        LOG_INFO << countEvaluation();
+        Log::flush();
+        CHECK( Log::setOutput("") );
+        CHECK_EQUAL( 1, evaluated );
+        std::remove(LogFile);
+    }
+}
@@ -0,0 +1,57 @@
+#include "utils/MappedFile.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+using pg::MappedFile;
+
+namespace {
+
+const char* TestFile = "mapped_file_test.bin";
+
+void writeTestFile(const char* contents) {
+    FILE* file = std::fopen(TestFile, "wb");
+    std::fwrite(contents, 1, std::strlen(contents), file);
+    std::fclose(file);
+}
+
+}
+
+SUITE( MappedFileTest ) {
+
+    TEST( MappedDataMatchesTheFile ) {
+        writeTestFile("mesh data");
+        {
+            MappedFile file;
+            CHECK( file.open(TestFile) );
+            CHECK( file.isOpen() );
+            CHECK_EQUAL( 9u, file.size() );
+            CHECK( std::memcmp(file.data(), "mesh data", 9u) == 0 );
+        }
+        std::remove(TestFile);
+    }
+
+    TEST( MissingFileDoesntOpen ) {
+        MappedFile file;
+        CHECK( !file.open("this file does not exist.bin") );
+        CHECK( !file.isOpen() );
+        CHECK( file.data() == nullptr );
+    }
+
+    TEST( MoveTransfersTheMapping ) {
+        writeTestFile("abc");
+        {
+            MappedFile file;
+            CHECK( file.open(TestFile) );
+            MappedFile moved{ std::move(file) };
+            CHECK( !file.isOpen() );
+            CHECK( moved.isOpen() );
+            CHECK_EQUAL( 'a', moved.data()[0] );
+            file = std::move(moved);
+            CHECK( file.isOpen() );
+            CHECK( !moved.isOpen() );
+        }
+        std::remove(TestFile);
+    }
+}
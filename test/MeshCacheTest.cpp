@@ -0,0 +1,106 @@
+#include "manager/MeshCache.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cstdio>
+#include <cstring>
+
+using pg::MappedFile;
+using pg::MeshCacheKey;
+using pg::MeshVertex;
+using pg::MeshView;
+
+namespace {
+
+const char* TestFile = "mesh_cache_test.mesh";
+
+const MeshVertex Vertices[] = {
+    { { 1, 2, 3, 0 }, { 4, 5 } },
+    { { -1, -2, -3, 0 }, { -4, -5 } },
+    { { 100, 200, 300, 0 }, { 400, 500 } },
+    { { 7, 8, 9, 0 }, { 10, 11 } }
+};
+const std::uint16_t Indices[] = { 0, 1, 2, 0, 2, 3, 0, 1, 2 };
+
+MeshView testMesh() {
+    MeshView mesh{};
+    mesh.vertices = Vertices;
+    mesh.vertexCount = 4u;
+    mesh.indices = Indices;
+    mesh.indexCount = 9u;
+    mesh.indexSize = sizeof(std::uint16_t);
+    mesh.lodCount = 2u;
+    mesh.lodOffsets[0] = 0u;
+    mesh.lodSizes[0] = 6u;
+    mesh.lodOffsets[1] = 6u;
+    mesh.lodSizes[1] = 3u;
+    mesh.bounds = pg::math::AABoxf{ pg::math::Vec3f{ -1.f, -2.f, -3.f }, pg::math::Vec3f{ 1.f, 2.f, 3.f } };
+    return mesh;
+}
+
+const MeshCacheKey TestKey{ "data/mesh.obj", 1234u, 56u, 789u };
+
+}
+
+SUITE( MeshCacheTest ) {
+
+    TEST( ReadMeshMatchesTheWrittenOne ) {
+        CHECK( pg::writeMeshCache(TestFile, TestKey, testMesh()) );
+        {
+            MappedFile file;
+            MeshView mesh{};
+            CHECK( pg::readMeshCache(TestFile, TestKey, file, mesh) );
+            CHECK_EQUAL( 4u, mesh.vertexCount );
+            CHECK( std::memcmp(Vertices, mesh.vertices, sizeof(Vertices)) == 0 );
+            CHECK_EQUAL( 9u, mesh.indexCount );
+            CHECK_EQUAL( 2u, mesh.indexSize );
+            CHECK( std::memcmp(Indices, mesh.indices, sizeof(Indices)) == 0 );
+            CHECK_EQUAL( 0u, reinterpret_cast<std::uintptr_t>(mesh.vertices) % 16u );
+            CHECK_EQUAL( 0u, reinterpret_cast<std::uintptr_t>(mesh.indices) % 16u );
+            CHECK_EQUAL( 2u, mesh.lodCount );
+            CHECK_EQUAL( 6u, mesh.lodOffsets[1] );
+            CHECK_EQUAL( 3u, mesh.lodSizes[1] );
+            CHECK_EQUAL( -3.f, mesh.bounds.min.z );
+            CHECK_EQUAL( 2.f, mesh.bounds.max.y );
+        }
+        std::remove(TestFile);
+    }
+
+    TEST( DifferentKeyDoesntRead ) {
+        CHECK( pg::writeMeshCache(TestFile, TestKey, testMesh()) );
+        for (const MeshCacheKey& key : {
+            MeshCacheKey{ "data/other.obj", TestKey.modified, TestKey.importFlags, TestKey.sourceSize },
+            MeshCacheKey{ TestKey.source, TestKey.modified + 1u, TestKey.importFlags, TestKey.sourceSize },
+            MeshCacheKey{ TestKey.source, TestKey.modified, TestKey.importFlags | 1u, TestKey.sourceSize },
+            MeshCacheKey{ TestKey.source, TestKey.modified, TestKey.importFlags, TestKey.sourceSize + 1u } }) {
+            MappedFile file;
+            MeshView mesh{};
+            CHECK( !pg::readMeshCache(TestFile, key, file, mesh) );
+            CHECK( !file.isOpen() );
+        }
+        std::remove(TestFile);
+    }
+
+    TEST( IndexOutsideTheVerticesDoesntRead ) {
+        const std::uint16_t outside[] = { 0, 1, 2, 0, 2, 4, 0, 1, 2 };
+        MeshView corrupt = testMesh();
+        corrupt.indices = outside;
+        CHECK( pg::writeMeshCache(TestFile, TestKey, corrupt) );
+        {
+            MappedFile file;
+            MeshView mesh{};
+            CHECK( !pg::readMeshCache(TestFile, TestKey, file, mesh) );
+        }
+        std::remove(TestFile);
+    }
+
+    TEST( LodRangeOutsideTheIndicesDoesntRead ) {
+        MeshView corrupt = testMesh();
+        corrupt.lodSizes[1] = 4u;
+        CHECK( pg::writeMeshCache(TestFile, TestKey, corrupt) );
+        {
+            MappedFile file;
+            MeshView mesh{};
+            CHECK( !pg::readMeshCache(TestFile, TestKey, file, mesh) );
+        }
+        std::remove(TestFile);
+    }
+}
@@ -0,0 +1,114 @@
+#include "math/MeshOptimizer.h"
+#include "utils/Random.h"
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+using namespace pg::math;
+
+namespace {
+
+// a regular grid of quads, with the triangles in a random order
+std::vector<std::uint32_t> shuffledGrid(std::uint32_t size) {
+    std::vector<std::array<std::uint32_t, 3>> triangles;
+    for (std::uint32_t y = 0u; y < size; ++y) {
+        for (std::uint32_t x = 0u; x < size; ++x) {
+            std::uint32_t v = y * (size + 1u) + x;
+            triangles.push_back({ v, v + 1u, v + size + 1u });
+            triangles.push_back({ v + 1u, v + size + 2u, v + size + 1u });
+        }
+    }
+    pg::seed(42u);
+    for (std::size_t i = triangles.size() - 1u; i > 0u; --i) {
+        std::swap(triangles[i], triangles[pg::randi(0, std::int32_t(i))]);
+    }
+    std::vector<std::uint32_t> indices;
+    for (const auto& t : triangles) {
+        indices.insert(indices.end(), t.begin(), t.end());
+    }
+    return indices;
+}
+
+std::vector<std::array<std::uint32_t, 3>> sortedTriangles(const std::vector<std::uint32_t>& indices) {
+    std::vector<std::array<std::uint32_t, 3>> triangles;
+    for (std::size_t i = 0u; i < indices.size(); i += 3u) {
+        std::array<std::uint32_t, 3> t{ { indices[i], indices[i + 1u], indices[i + 2u] } };
+        // rotate the smallest index first, which keeps the winding
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+}
+
+SUITE( MeshOptimizerTest ) {
+
+    TEST( WeldMergesIdenticalVertices ) {
+        const float vertices[] = {
+            0.f, 0.f, 0.f,
+            1.f, 0.f, 0.f,
+            0.f, 0.f, 0.f,
+            0.f, 1.f, 0.f,
+            1.f, 0.f, 0.f
+        };
+        std::vector<float> unique;
+        std::vector<std::uint32_t> remap;
+        CHECK_EQUAL( 3u, weldVertices(vertices, 5u, 3u, unique, remap) );
+        CHECK_EQUAL( 9u, unique.size() );
+        const std::uint32_t expected[] = { 0u, 1u, 0u, 2u, 1u };
+        CHECK_ARRAY_EQUAL( expected, remap.data(), 5 );
+        CHECK_EQUAL( 1.f, unique[7] );
+    }
+
+    TEST( WeldKeepsVerticesWhichDifferInAnyComponent ) {
+        const float vertices[] = {
+            0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+            0.f, 0.f, 0.f, 1.f, 0.f, 0.f
+        };
+        std::vector<float> unique;
+        std::vector<std::uint32_t> remap;
+        CHECK_EQUAL( 2u, weldVertices(vertices, 2u, 6u, unique, remap) );
+    }
+
+    TEST( CacheOptimizationKeepsTheTriangles ) {
+        std::vector<std::uint32_t> indices = shuffledGrid(16u);
+        std::vector<std::uint32_t> optimized = indices;
+        optimizeVertexCache(optimized.data(), optimized.size(), 17u * 17u);
+        CHECK( sortedTriangles(indices) == sortedTriangles(optimized) );
+    }
+
+    TEST( CacheOptimizationLowersTheMissRatio ) {
+        std::vector<std::uint32_t> indices = shuffledGrid(32u);
+        const std::size_t vertexCount = 33u * 33u;
+        const float before = averageCacheMissRatio(indices.data(), indices.size(), vertexCount);
+        optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+        const float after = averageCacheMissRatio(indices.data(), indices.size(), vertexCount);
+        CHECK( before > 1.5f );
+        CHECK( after < 0.9f );
+    }
+
+    TEST( FetchOptimizationOrdersVerticesByFirstUse ) {
+        float vertices[] = { 0.f, 1.f, 2.f, 3.f };
+        std::uint32_t indices[] = { 2u, 0u, 3u, 3u, 0u, 2u };
+        CHECK_EQUAL( 3u, optimizeVertexFetch(vertices, 4u, 1u, indices, 6u) );
+        const std::uint32_t expectedIndices[] = { 0u, 1u, 2u, 2u, 1u, 0u };
+        CHECK_ARRAY_EQUAL( expectedIndices, indices, 6 );
+        const float expectedVertices[] = { 2.f, 0.f, 3.f };
+        CHECK_ARRAY_EQUAL( expectedVertices, vertices, 3 );
+    }
+
+    TEST( MissRatioOfUnsharedTrianglesIsThree ) {
+        const std::uint32_t indices[] = { 0u, 1u, 2u, 3u, 4u, 5u };
+        CHECK_CLOSE( 3.f, averageCacheMissRatio(indices, 6u, 6u), 1e-6f );
+    }
+
+    TEST( MissRatioCountsEvictions ) {
+        // with a cache of three, the fourth vertex evicts the first one
+        const std::uint32_t indices[] = { 0u, 1u, 2u, 1u, 3u, 0u };
+        CHECK_CLOSE( 2.5f, averageCacheMissRatio(indices, 6u, 4u, 3u), 1e-6f );
+    }
+}
@@ -0,0 +1,106 @@
+#include "math/MeshSimplifier.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+
+using namespace pg::math;
+
+namespace {
+
+// a size x size grid of quads in the xz-plane, with the height given by the function
+template<typename F>
+void grid(std::uint32_t size, F height, std::vector<float>& vertices, std::vector<std::uint32_t>& indices) {
+    for (std::uint32_t y = 0u; y <= size; ++y) {
+        for (std::uint32_t x = 0u; x <= size; ++x) {
+            const float u = float(x) / size;
+            const float v = float(y) / size;
+            vertices.push_back(u);
+            vertices.push_back(height(u, v));
+            vertices.push_back(v);
+        }
+    }
+    for (std::uint32_t y = 0u; y < size; ++y) {
+        for (std::uint32_t x = 0u; x < size; ++x) {
+            std::uint32_t v = y * (size + 1u) + x;
+            indices.insert(indices.end(), { v, v + size + 1u, v + 1u });
+            indices.insert(indices.end(), { v + 1u, v + size + 1u, v + size + 2u });
+        }
+    }
+}
+
+bool onBorder(const float* vertex) {
+    return vertex[0] == 0.f || vertex[0] == 1.f || vertex[2] == 0.f || vertex[2] == 1.f;
+}
+
+}
+
+SUITE( MeshSimplifierTest ) {
+
+    TEST( FlatGridIsReducedToTheTargetWithoutError ) {
+        std::vector<float> vertices;
+        std::vector<std::uint32_t> indices;
+        grid(32u, [](float, float) -> float { return 0.f; }, vertices, indices);
+        std::vector<std::uint32_t> result;
+        const float error = simplifyMesh(vertices.data(), vertices.size() / 3u, 3u, indices.data(), indices.size(), indices.size() / 4u, 1.f, result);
+        CHECK( result.size() <= indices.size() / 4u );
+        CHECK( !result.empty() );
+        CHECK_CLOSE( 0.f, error, 1e-5f );
+    }
+
+    TEST( ResultIndicesAreValidAndNotDegenerate ) {
+        std::vector<float> vertices;
+        std::vector<std::uint32_t> indices;
+        grid(32u, [](float u, float v) -> float { return 0.1f * std::sin(6.f * u) * std::cos(4.f * v); }, vertices, indices);
+        std::vector<std::uint32_t> result;
+        simplifyMesh(vertices.data(), vertices.size() / 3u, 3u, indices.data(), indices.size(), indices.size() / 2u, 1.f, result);
+        CHECK_EQUAL( 0u, result.size() % 3u );
+        for (std::size_t i = 0u; i < result.size(); i += 3u) {
+            CHECK( result[i] < vertices.size() / 3u );
+            CHECK( result[i] != result[i + 1u] && result[i + 1u] != result[i + 2u] && result[i + 2u] != result[i] );
+        }
+    }
+
+    TEST( BoundaryVerticesAreKept ) {
+        std::vector<float> vertices;
+        std::vector<std::uint32_t> indices;
+        grid(16u, [](float u, float v) -> float { return 0.2f * u * v; }, vertices, indices);
+        std::vector<std::uint32_t> result;
+        simplifyMesh(vertices.data(), vertices.size() / 3u, 3u, indices.data(), indices.size(), 0u, 1.f, result);
+
+        std::vector<bool> used(vertices.size() / 3u, false);
+        for (std::uint32_t index : result) {
+            used[index] = true;
+        }
+        for (std::size_t v = 0u; v < used.size(); ++v) {
+            if (onBorder(&vertices[v * 3u])) {
+                CHECK( used[v] );
+            }
+        }
+    }
+
+    TEST( TrianglesDontFlip ) {
+        std::vector<float> vertices;
+        std::vector<std::uint32_t> indices;
+        grid(32u, [](float u, float v) -> float { return 0.1f * std::sin(6.f * u) * std::cos(4.f * v); }, vertices, indices);
+        std::vector<std::uint32_t> result;
+        simplifyMesh(vertices.data(), vertices.size() / 3u, 3u, indices.data(), indices.size(), indices.size() / 8u, 1.f, result);
+        for (std::size_t i = 0u; i < result.size(); i += 3u) {
+            const float* a = &vertices[result[i] * 3u];
+            const float* b = &vertices[result[i + 1u] * 3u];
+            const float* c = &vertices[result[i + 2u] * 3u];
+            // the y-component of the normal points up for every triangle of the grid
+            const float normalY = (c[0] - a[0]) * (b[2] - a[2]) - (c[2] - a[2]) * (b[0] - a[0]);
+            CHECK( normalY > 0.f );
+        }
+    }
+
+    TEST( NothingIsCollapsedWhenTheErrorBoundIsZero ) {
+        std::vector<float> vertices;
+        std::vector<std::uint32_t> indices;
+        grid(8u, [](float u, float v) -> float { return u * u + v * v; }, vertices, indices);
+        std::vector<std::uint32_t> result;
+        CHECK_EQUAL( 0.f, simplifyMesh(vertices.data(), vertices.size() / 3u, 3u, indices.data(), indices.size(), 0u, 0.f, result) );
+        CHECK( result == indices );
+    }
+}
@@ -0,0 +1,132 @@
+#include "math/OcclusionBuffer.h"
+#include "math/Geometry.h"
+#include "math/Matrix.h"
+#include "utils/ThreadPool.h"
+#include <UnitTest++/UnitTest++.h>
+#include <vector>
+#include <cstdint>
+
+using namespace pg::math;
+
+namespace {
+
+const Matrix4f Projection = Matrix4f::perspective(1.2f, 2.f, 0.1f, 100.f);
+
+// a square in the xy plane, facing +z
+const Vec3f SquarePositions[] = {
+    Vec3f{ -1.f, -1.f, 0.f },
+    Vec3f{ 1.f, -1.f, 0.f },
+    Vec3f{ 1.f, 1.f, 0.f },
+    Vec3f{ -1.f, 1.f, 0.f }
+};
+const std::uint32_t FrontIndices[] = { 0u, 1u, 2u, 0u, 2u, 3u };
+const std::uint32_t BackIndices[] = { 0u, 2u, 1u, 0u, 3u, 2u };
+
+OccluderInstance square(const Matrix4f& world, const std::uint32_t* indices = FrontIndices) {
+    return OccluderInstance{ world, SquarePositions, 4u, indices, 6u };
+}
+
+// a wall of half size 2 at the depth, in front of the camera
+OccluderInstance wall(float depth) {
+    return square(Matrix4f::translation(Vec3f{ 0.f, 0.f, -depth }) * Matrix4f::scale(Vec3f{ 2.f, 2.f, 1.f }));
+}
+
+AABoxf boxAt(const Vec3f& center, float halfSize) {
+    const Vec3f extents{ halfSize, halfSize, halfSize };
+    return AABoxf{ center - extents, center + extents };
+}
+
+}
+
+SUITE( OcclusionBufferTest ) {
+
+    TEST( ResolutionIsRoundedUpToTiles ) {
+        OcclusionBuffer buffer;
+        buffer.resize(250u, 100u);
+        CHECK_EQUAL( 256u, buffer.width() );
+        CHECK_EQUAL( 104u, buffer.height() );
+    }
+
+    TEST( NothingIsHiddenWithoutOccluders ) {
+        pg::ThreadPool pool(0u);
+        OcclusionBuffer buffer;
+        buffer.resize(128u, 64u);
+        buffer.render(Projection, std::vector<OccluderInstance>{}, pool);
+        CHECK( buffer.isVisible(boxAt(Vec3f{ 0.f, 0.f, -10.f }, 1.f)) );
+        CHECK_EQUAL( 0u, buffer.triangleCount() );
+    }
+
+    TEST( WallHidesBoxesBehindIt ) {
+        pg::ThreadPool pool(0u);
+        OcclusionBuffer buffer;
+        buffer.resize(128u, 64u);
+        buffer.render(Projection, std::vector<OccluderInstance>{ wall(5.f) }, pool);
+        CHECK_EQUAL( 2u, buffer.triangleCount() );
+        CHECK_CLOSE( 1.f / 5.f, buffer.depth(64u, 32u), 1e-4f );
+
+        CHECK( !buffer.isVisible(boxAt(Vec3f{ 0.f, 0.f, -10.f }, 1.f)) );
+        // in front of the wall
+        CHECK( buffer.isVisible(boxAt(Vec3f{ 0.f, 0.f, -3.f }, 1.f)) );
+        // intersecting the wall
+        CHECK( buffer.isVisible(boxAt(Vec3f{ 0.f, 0.f, -5.f }, 0.5f)) );
+        // behind the wall, but sticking out from behind its edge
+        CHECK( buffer.isVisible(boxAt(Vec3f{ 4.f, 0.f, -10.f }, 1.f)) );
+    }
+
+    TEST( BackFacesDontOcclude ) {
+        pg::ThreadPool pool(0u);
+        OcclusionBuffer buffer;
+        buffer.resize(128u, 64u);
+        const Matrix4f world = Matrix4f::translation(Vec3f{ 0.f, 0.f, -5.f }) * Matrix4f::scale(Vec3f{ 2.f, 2.f, 1.f });
+        buffer.render(Projection, std::vector<OccluderInstance>{ square(world, BackIndices) }, pool);
+        CHECK_EQUAL( 0u, buffer.triangleCount() );
+        CHECK( buffer.isVisible(boxAt(Vec3f{ 0.f, 0.f, -10.f }, 1.f)) );
+    }
+
+    TEST( OccludersCrossingTheNearPlaneAreClipped ) {
+        pg::ThreadPool pool(0u);
+        OcclusionBuffer buffer;
+        buffer.resize(128u, 64u);
+        // a floor one unit below the camera, reaching from behind it far into the view
+        const Matrix4f floor = Matrix4f::translation(Vec3f{ 0.f, -1.f, 0.f })
+            * Matrix4f{
+                1.f, 0.f, 0.f, 0.f,
+                0.f, 0.f, 1.f, 0.f,
+                0.f, -1.f, 0.f, 0.f,
+                0.f, 0.f, 0.f, 1.f
+            }   // turns the square to face +y
+            * Matrix4f::scale(Vec3f{ 50.f, 50.f, 1.f });
+        buffer.render(Projection, std::vector<OccluderInstance>{ square(floor) }, pool);
+        CHECK( buffer.triangleCount() > 0u );
+        // under the floor
+        CHECK( !buffer.isVisible(boxAt(Vec3f{ 0.f, -3.f, -10.f }, 0.5f)) );
+        // on top of it
+        CHECK( buffer.isVisible(boxAt(Vec3f{ 0.f, 0.f, -10.f }, 0.5f)) );
+        // crossing the near plane
+        CHECK( buffer.isVisible(boxAt(Vec3f{ 0.f, -3.f, 0.f }, 0.5f)) );
+    }
+
+    TEST( DepthDoesntDependOnTheThreadCount ) {
+        std::vector<OccluderInstance> occluders;
+        for (int i = 0; i < 16; ++i) {
+            const float x = float(i % 4) * 3.f - 4.5f;
+            const float y = float(i / 4) * 2.f - 3.f;
+            occluders.push_back(square(Matrix4f::translation(Vec3f{ x, y, -8.f - float(i) })));
+        }
+        pg::ThreadPool serial(0u);
+        pg::ThreadPool parallel(3u);
+        OcclusionBuffer a, b;
+        a.resize(160u, 80u);
+        b.resize(160u, 80u);
+        a.render(Projection, occluders, serial);
+        b.render(Projection, occluders, parallel);
+        CHECK_EQUAL( a.triangleCount(), b.triangleCount() );
+        bool same = true;
+        for (std::uint32_t y = 0u; y < a.height(); ++y) {
+            for (std::uint32_t x = 0u; x < a.width(); ++x) {
+                same = same && a.depth(x, y) == b.depth(x, y);
+            }
+        }
+        CHECK( same );
+    }
+}
@@ -0,0 +1,103 @@
+#include "utils/Profiler.h"
+#include "utils/TypeName.h"
+#include "utils/ThreadPool.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+using pg::Profiler;
+using pg::ProfileEvent;
+using pg::profiler;
+
+namespace {
+
+const ProfileEvent* findEvent(const Profiler::Frame& frame, const std::string& name) {
+    for (const ProfileEvent& event : frame.events) {
+        if (name == event.name) {
+            return &event;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+SUITE( ProfilerTest ) {
+
+    TEST( NestedZonesRecordTheirDepth ) {
+        profiler().endFrame();
+        {
+            PG_PROFILE_ZONE("outer");
+            PG_PROFILE_ZONE("inner");
+        }
+        profiler().endFrame();
+        const Profiler::Frame& frame = profiler().lastFrame();
+        const ProfileEvent* outer = findEvent(frame, "outer");
+        const ProfileEvent* inner = findEvent(frame, "inner");
+        CHECK( outer && inner );
+        if (outer && inner) {
+            CHECK_EQUAL( 0u, outer->depth );
+            CHECK_EQUAL( 1u, inner->depth );
+            CHECK( outer->begin <= inner->begin );
+            CHECK( inner->end <= outer->end );
+            CHECK( outer < inner );
+            CHECK( frame.begin <= outer->begin && outer->end <= frame.end );
+        }
+    }
+
+    TEST( ZonesAreCollectedOnlyOnce ) {
+        {
+            PG_PROFILE_ZONE("once");
+        }
+        profiler().endFrame();
+        CHECK( findEvent(profiler().lastFrame(), "once") );
+        profiler().endFrame();
+        CHECK( !findEvent(profiler().lastFrame(), "once") );
+    }
+
+    TEST( ZonesOfOtherThreadsAreCollected ) {
+        profiler().endFrame();
+        std::thread thread([]() -> void {
+            profiler().setThreadName("worker");
+            PG_PROFILE_ZONE("on worker");
+        });
+        thread.join();
+        profiler().endFrame();
+        const Profiler::Frame& frame = profiler().lastFrame();
+        const ProfileEvent* event = findEvent(frame, "on worker");
+        CHECK( event );
+        if (event) {
+            CHECK_EQUAL( 0u, event->depth );
+            CHECK_EQUAL( "worker", frame.threads[event->thread] );
+        }
+    }
+
+    TEST( CaptureIsWrittenAsChromeTrace ) {
+        profiler().endFrame();
+        profiler().startCapture();
+        {
+            PG_PROFILE_ZONE("captured");
+        }
+        profiler().endFrame();
+        CHECK( profiler().capturing() );
+        const std::string path = "profiler_test_trace.json";
+        CHECK( profiler().writeCapture(path) );
+        CHECK( !profiler().capturing() );
+        std::ifstream file(path);
+        const std::string trace{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        file.close();
+        std::remove(path.c_str());
+        CHECK( trace.find("\"traceEvents\"") != std::string::npos );
+        CHECK( trace.find("\"name\":\"captured\",\"ph\":\"X\"") != std::string::npos );
+        CHECK( trace.find("\"thread_name\"") != std::string::npos );
+    }
+
+    TEST( TypeNamesHaveNoNamespaces ) {
+        CHECK_EQUAL( std::string("ThreadPool"), pg::typeName<pg::ThreadPool>() );
+        CHECK_EQUAL( "ThreadPool", pg::unqualifiedTypeName("class pg::ThreadPool") );
+        CHECK_EQUAL( "vector<pg::ThreadPool>", pg::unqualifiedTypeName("std::vector<pg::ThreadPool>") );
+    }
+}
@@ -0,0 +1,111 @@
+#include "math/Quantize.h"
+#include "utils/Random.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cmath>
+
+using namespace pg::math;
+
+namespace {
+
+Vec3f randomUnitVector() {
+    Vec3f v{ pg::randf(-1.f, 1.f), pg::randf(-1.f, 1.f), pg::randf(-1.f, 1.f) };
+    while (v.norm() < 0.01f) {
+        v = Vec3f{ pg::randf(-1.f, 1.f), pg::randf(-1.f, 1.f), pg::randf(-1.f, 1.f) };
+    }
+    return v.normalized();
+}
+
+Vec3f transformPoint(const Matrix4f& m, const Vec3f& p) {
+    Vec4f r = m * Vec4f{ p.x, p.y, p.z, 1.f };
+    return Vec3f{ r.x, r.y, r.z };
+}
+
+Vec3f dequantizeNormal(const std::int16_t q[2]) {
+    return octahedralDecode(Vec2f{ dequantizeSnorm16(q[0]), dequantizeSnorm16(q[1]) });
+}
+
+}
+
+SUITE( QuantizeTest ) {
+
+    TEST( Snorm16RoundTripErrorIsBounded ) {
+        for (int i = -1000; i <= 1000; ++i) {
+            float v = i / 1000.f;
+            CHECK_CLOSE( v, dequantizeSnorm16(quantizeSnorm16(v)), 0.5f / 32767.f + 1e-7f );
+        }
+        CHECK_EQUAL( 32767, quantizeSnorm16(2.f) );
+        CHECK_EQUAL( -1.f, dequantizeSnorm16(-32768) );
+    }
+
+    TEST( Unorm16RoundTripErrorIsBounded ) {
+        for (int i = 0; i <= 1000; ++i) {
+            float v = i / 1000.f;
+            CHECK_CLOSE( v, dequantizeUnorm16(quantizeUnorm16(v)), 0.5f / 65535.f + 1e-7f );
+        }
+    }
+
+    TEST( OctahedralEncodingRoundTripsExactly ) {
+        pg::seed(7u);
+        for (int i = 0; i < 1000; ++i) {
+            Vec3f n = randomUnitVector();
+            Vec2f e = octahedralEncode(n);
+            CHECK( std::abs(e.x) <= 1.f && std::abs(e.y) <= 1.f );
+            Vec3f d = octahedralDecode(e);
+            CHECK_CLOSE( 1.f, d.dot(n), 1e-5f );
+        }
+    }
+
+    TEST( PositionErrorIsWithinHalfAStepOfTheBounds ) {
+        pg::seed(11u);
+        AABoxf bounds{ Vec3f{ -3.f, 10.f, 0.f }, Vec3f{ 5.f, 10.5f, 100.f } };
+        Matrix4f dequantize = dequantizationMatrix(bounds);
+        // half a quantization step of the largest axis, plus float rounding in the reconstruction
+        const float maxError = 50.f * (0.5f / 32767.f) + 1e-5f;
+        for (int i = 0; i < 1000; ++i) {
+            Vec3f p{ pg::randf(-3.f, 5.f), pg::randf(10.f, 10.5f), pg::randf(0.f, 100.f) };
+            std::int16_t q[3];
+            quantizePosition(p, bounds, q);
+            Vec3f r = transformPoint(dequantize, Vec3f{ dequantizeSnorm16(q[0]), dequantizeSnorm16(q[1]), dequantizeSnorm16(q[2]) });
+            CHECK_CLOSE( p.x, r.x, maxError );
+            CHECK_CLOSE( p.y, r.y, maxError );
+            CHECK_CLOSE( p.z, r.z, maxError );
+        }
+    }
+
+    TEST( FlatAndPointBoxesCanBeQuantized ) {
+        AABoxf flat{ Vec3f{ -1.f, 0.f, -1.f }, Vec3f{ 1.f, 0.f, 1.f } };
+        std::int16_t q[3];
+        quantizePosition(Vec3f{ 0.5f, 0.f, -1.f }, flat, q);
+        CHECK_EQUAL( 16384, q[0] );
+        CHECK_EQUAL( 0, q[1] );
+        CHECK_EQUAL( -32767, q[2] );
+
+        AABoxf point{ Vec3f{ 1.f, 2.f, 3.f }, Vec3f{ 1.f, 2.f, 3.f } };
+        CHECK( quantizationScale(point) > 0.f );
+        quantizePosition(Vec3f{ 1.f, 2.f, 3.f }, point, q);
+        CHECK_EQUAL( 0, q[0] );
+    }
+
+    TEST( NormalErrorIsBelowAHundredthOfADegree ) {
+        pg::seed(13u);
+        const float maxAngle = 0.01f * 3.14159265f / 180.f;
+        for (int i = 0; i < 10000; ++i) {
+            Vec3f n = randomUnitVector();
+            std::int16_t q[2];
+            quantizeNormal(n, q);
+            Vec3f d = dequantizeNormal(q);
+            // the dot product is too close to one for float precision, so compare the sine
+            CHECK( d.dot(n) > 0.f && d.cross(n).norm() <= std::sin(maxAngle) );
+        }
+        // the poles and the folded edges of the octahedron
+        const Vec3f axes[] = {
+            Vec3f{ 0.f, 0.f, 1.f }, Vec3f{ 0.f, 0.f, -1.f }, Vec3f{ 1.f, 0.f, 0.f },
+            Vec3f{ -1.f, 0.f, 0.f }, Vec3f{ 0.f, 1.f, 0.f }, Vec3f{ 0.f, -1.f, 0.f }
+        };
+        for (const Vec3f& n : axes) {
+            std::int16_t q[2];
+            quantizeNormal(n, q);
+            CHECK_CLOSE( 1.f, dequantizeNormal(q).dot(n), 1e-6f );
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include "utils/RangeAllocator.h"
+#include <UnitTest++/UnitTest++.h>
+
+using pg::RangeAllocator;
+
+SUITE( RangeAllocatorTest ) {
+
+    TEST( AllocationsDontOverlap ) {
+        RangeAllocator allocator(100u);
+        CHECK_EQUAL( 0u, allocator.allocate(40u) );
+        CHECK_EQUAL( 40u, allocator.allocate(40u) );
+        CHECK_EQUAL( 80u, allocator.used() );
+    }
+
+    TEST( AllocationFailsWhenFull ) {
+        RangeAllocator allocator(100u);
+        allocator.allocate(60u);
+        CHECK_EQUAL( RangeAllocator::Invalid, allocator.allocate(50u) );
+        CHECK_EQUAL( 60u, allocator.allocate(40u) );
+        CHECK_EQUAL( RangeAllocator::Invalid, allocator.allocate(1u) );
+    }
+
+    TEST( OffsetsAreAligned ) {
+        RangeAllocator allocator(100u);
+        allocator.allocate(5u);
+        CHECK_EQUAL( 12u, allocator.allocate(12u, 12u) );
+        // the padding stays free
+        CHECK_EQUAL( 5u, allocator.allocate(7u) );
+    }
+
+    TEST( FreedNeighborsAreMerged ) {
+        RangeAllocator allocator(90u);
+        const std::size_t a = allocator.allocate(30u);
+        const std::size_t b = allocator.allocate(30u);
+        const std::size_t c = allocator.allocate(30u);
+        allocator.free(a, 30u);
+        allocator.free(c, 30u);
+        CHECK_EQUAL( RangeAllocator::Invalid, allocator.allocate(60u) );
+        allocator.free(b, 30u);
+        CHECK_EQUAL( 0u, allocator.used() );
+        CHECK_EQUAL( 0u, allocator.allocate(90u) );
+    }
+
+    TEST( GrowingExtendsTheLastFreeRange ) {
+        RangeAllocator allocator(100u);
+        allocator.allocate(80u);
+        CHECK_EQUAL( RangeAllocator::Invalid, allocator.allocate(40u) );
+        allocator.grow(200u);
+        CHECK_EQUAL( 200u, allocator.capacity() );
+        CHECK_EQUAL( 80u, allocator.allocate(120u) );
+    }
+}
@@ -0,0 +1,69 @@
+#include "utils/SceneCounters.h"
+#include <UnitTest++/UnitTest++.h>
+#include <cstdio>
+
+using pg::SceneCounters;
+
+namespace {
+
+const char* BaselineFile = "scene_counters_test.json";
+
+void writeBaseline(const char* contents) {
+    FILE* file = std::fopen(BaselineFile, "w");
+    std::fputs(contents, file);
+    std::fclose(file);
+}
+
+}
+
+SUITE( SceneCountersTest ) {
+
+    TEST( AddedValuesAreSummedInFirstAddedOrder ) {
+        SceneCounters counters;
+        counters.add("drawCalls", 10.0);
+        counters.add("stateChanges", 4.0);
+        counters.add("drawCalls", 5.0);
+        CHECK_EQUAL( 15.0, counters.value("drawCalls") );
+        CHECK_EQUAL( 0.0, counters.value("triangles") );
+        CHECK_EQUAL( 2u, counters.counters().size() );
+        CHECK( counters.counters()[0].first == "drawCalls" );
+        CHECK( counters.counters()[1].first == "stateChanges" );
+    }
+
+    TEST( WrittenCountersMatchTheirOwnBaseline ) {
+        SceneCounters counters;
+        counters.add("drawCalls", 3600.0);
+        counters.add("allocations ScriptSystem", 120.0);
+        CHECK( counters.write(BaselineFile) );
+        CHECK_EQUAL( 0, counters.compare(BaselineFile, 0.0) );
+        counters.add("drawCalls", 1.0);
+        CHECK_EQUAL( 1, counters.compare(BaselineFile, 0.0) );
+        std::remove(BaselineFile);
+    }
+
+    TEST( CountersWithinTheTolerancePass ) {
+        writeBaseline("{\"counters\": [{\"name\": \"drawCalls\", \"value\": 100},"
+            " {\"name\": \"stateChanges\", \"value\": 100, \"tolerance\": 0.5}]}");
+        SceneCounters counters;
+        counters.add("drawCalls", 110.0);
+        counters.add("stateChanges", 140.0);
+        CHECK_EQUAL( 1, counters.compare(BaselineFile, 0.0) );
+        CHECK_EQUAL( 0, counters.compare(BaselineFile, 0.1) );
+        counters.add("stateChanges", 20.0);
+        CHECK_EQUAL( 1, counters.compare(BaselineFile, 0.1) );
+        std::remove(BaselineFile);
+    }
+
+    TEST( CountersMissingFromTheResultsAreZero ) {
+        writeBaseline("{\"counters\": [{\"name\": \"allocations Events\", \"value\": 3}]}");
+        SceneCounters counters;
+        counters.add("drawCalls", 1000.0);
+        CHECK_EQUAL( 0, counters.compare(BaselineFile, 0.0) );
+        std::remove(BaselineFile);
+    }
+
+    TEST( MissingBaselineFails ) {
+        SceneCounters counters;
+        CHECK_EQUAL( -1, counters.compare("this baseline does not exist.json", 0.0) );
+    }
+}
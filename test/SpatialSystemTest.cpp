@@ -0,0 +1,69 @@
+#include "system/SpatialSystem.h"
+#include <UnitTest++/UnitTest++.h>
+#include <vector>
+
+using pg::component::Transform;
+using pg::math::AABoxf;
+using pg::math::Quatf;
+using pg::math::Vec3f;
+
+namespace {
+
+std::vector<std::uint32_t> entitiesAt(const pg::math::AabbTree& tree, const Vec3f& point) {
+    std::vector<std::uint32_t> found;
+    tree.queryBox(AABoxf{ point, point }, [&found](std::uint32_t index) -> void { found.push_back(index); });
+    return found;
+}
+
+}
+
+SUITE( SpatialSystemTest ) {
+
+    struct SpatialFixture {
+        SpatialFixture() {
+            spatial.configure(events);
+            entity.assign<Transform>(Vec3f{ 0.f, 0.f, 0.f }, Quatf::Identity(), Vec3f{ 1.f, 1.f, 1.f });
+            entity.assign<AABoxf>(Vec3f{ -0.5f, -0.5f, -0.5f }, Vec3f{ 0.5f, 0.5f, 0.5f });
+            spatial.update(entities, events, 0.016f);
+        }
+
+        pg::ecs::EventManager events{};
+        // outlives the entity manager, which destroys the entities
+        pg::system::SpatialSystem spatial{};
+        pg::ecs::EntityManager entities{ events };
+        pg::ecs::Entity entity{ entities.create() };
+    };
+
+    TEST_FIXTURE( SpatialFixture, OnlyChangedTransformsAreRefit ) {
+        CHECK_EQUAL( 1u, entitiesAt(spatial.tree(), Vec3f{ 0.f, 0.f, 0.f }).size() );
+
+        entity.component<Transform>()->position = Vec3f{ 10.f, 0.f, 0.f };
+        spatial.update(entities, events, 0.016f);
+        CHECK_EQUAL( 1u, entitiesAt(spatial.tree(), Vec3f{ 0.f, 0.f, 0.f }).size() );
+        CHECK( entitiesAt(spatial.tree(), Vec3f{ 10.f, 0.f, 0.f }).empty() );
+
+        events.emit<pg::system::TransformChanged>(entity);
+        spatial.update(entities, events, 0.016f);
+        CHECK( entitiesAt(spatial.tree(), Vec3f{ 0.f, 0.f, 0.f }).empty() );
+        CHECK_EQUAL( 1u, entitiesAt(spatial.tree(), Vec3f{ 10.f, 0.f, 0.f }).size() );
+    }
+
+    TEST_FIXTURE( SpatialFixture, BoxesChangedInPlaceAreRefit ) {
+        // like a loaded mesh replacing its placeholder's box
+        *entity.rawPointer<AABoxf>() = AABoxf{ Vec3f{ 4.f, 4.f, 4.f }, Vec3f{ 5.f, 5.f, 5.f } };
+        events.emit<pg::system::BoundsChanged>(entity);
+        spatial.update(entities, events, 0.016f);
+        CHECK( entitiesAt(spatial.tree(), Vec3f{ 0.f, 0.f, 0.f }).empty() );
+        CHECK_EQUAL( 1u, entitiesAt(spatial.tree(), Vec3f{ 4.5f, 4.5f, 4.5f }).size() );
+    }
+
+    TEST_FIXTURE( SpatialFixture, RemovingTheTransformRefitsToTheModelBox ) {
+        entity.component<Transform>()->position = Vec3f{ 10.f, 0.f, 0.f };
+        events.emit<pg::system::TransformChanged>(entity);
+        spatial.update(entities, events, 0.016f);
+
+        entity.remove<Transform>();
+        spatial.update(entities, events, 0.016f);
+        CHECK_EQUAL( 1u, entitiesAt(spatial.tree(), Vec3f{ 0.f, 0.f, 0.f }).size() );
+    }
+}
@@ -0,0 +1,91 @@
+#include "ecs/Include.h"
+#include "utils/AllocationTracker.h"
+#include <UnitTest++/UnitTest++.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+
+using pg::ecs::SystemManager;
+
+namespace {
+
+class SleepingSystem : public pg::ecs::System {
+public:
+    void update(pg::ecs::EntityManager&, pg::ecs::EventManager&, float) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+};
+
+class AllocatingSystem : public pg::ecs::System {
+public:
+    void update(pg::ecs::EntityManager&, pg::ecs::EventManager&, float) override {
+        if (allocate) {
+            sink = std::make_unique<int>(1);
+        }
+    }
+
+    bool allocate{ false };
+    std::unique_ptr<int> sink{};
+};
+
+}
+
+SUITE( SystemManagerTest ) {
+
+    TEST( UpdatesAreTimedPerSystem ) {
+        pg::ecs::EventManager events{};
+        pg::ecs::EntityManager entities{ events };
+        SystemManager systems{ events, entities };
+        systems.add<SleepingSystem>();
+        CHECK( systems.updateStats().empty() );
+
+        for (int i = 0; i < 10; ++i) {
+            systems.update<SleepingSystem>(0.016f);
+        }
+        const auto stats = systems.updateStats();
+        CHECK_EQUAL( 1u, stats.size() );
+        CHECK_EQUAL( "SleepingSystem", stats[0].name );
+        CHECK_EQUAL( 10u, stats[0].samples );
+        CHECK( stats[0].p50 >= 1.f );
+        CHECK( stats[0].mean >= 1.f );
+        CHECK( stats[0].p50 <= stats[0].p95 );
+        CHECK( stats[0].p95 <= stats[0].p99 );
+        CHECK( stats[0].p99 <= stats[0].max );
+
+        const std::string path = "system_manager_test_stats.csv";
+        CHECK( systems.writeUpdateStats(path) );
+        std::ifstream file(path);
+        const std::string csv{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        file.close();
+        std::remove(path.c_str());
+        CHECK_EQUAL( 0u, csv.find("system,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\nSleepingSystem,10,") );
+    }
+
+    TEST( UpdatesAreTaggedWithTheSystemName ) {
+        pg::ecs::EventManager events{};
+        pg::ecs::EntityManager entities{ events };
+        SystemManager systems{ events, entities };
+        systems.add<AllocatingSystem>();
+        AllocatingSystem& system = systems.system<AllocatingSystem>();
+        pg::AllocationTracker& tracker = pg::allocationTracker();
+
+        // the first update sets the timing window up
+        systems.update<AllocatingSystem>(0.016f);
+        tracker.endFrame();
+        systems.update<AllocatingSystem>(0.016f);
+        tracker.endFrame();
+        CHECK_EQUAL( 0u, tracker.lastFrame().total.allocations );
+
+        system.allocate = true;
+        systems.update<AllocatingSystem>(0.016f);
+        tracker.endFrame();
+        CHECK_EQUAL( 1u, tracker.lastFrame().total.allocations );
+        CHECK_EQUAL( 1u, tracker.lastFrame().tags.size() );
+        CHECK_EQUAL( 0, std::strcmp("AllocatingSystem", tracker.lastFrame().tags[0].name) );
+    }
+}
@@ -0,0 +1,85 @@
+#include "utils/ThreadPool.h"
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+using pg::ThreadPool;
+
+SUITE( ThreadPoolTest ) {
+
+    TEST( RangesCoverEveryIndexExactlyOnce ) {
+        ThreadPool pool{ 3u };
+        std::vector<int> visits(1000, 0);
+        std::size_t ranges = pool.parallelFor(visits.size(), 1u, [&visits](std::size_t begin, std::size_t end, std::size_t) {
+            for (std::size_t i = begin; i < end; ++i) {
+                ++visits[i];
+            }
+        });
+        CHECK_EQUAL( 4u, ranges );
+        CHECK( std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; }) );
+    }
+
+    TEST( RangeIndicesAreDistinct ) {
+        ThreadPool pool{ 3u };
+        std::vector<int> seen(pool.size(), 0);
+        for (int loop = 0; loop < 100; ++loop) {
+            std::size_t ranges = pool.parallelFor(10u, 1u, [&seen](std::size_t, std::size_t, std::size_t range) {
+                ++seen[range];
+            });
+            CHECK_EQUAL( 4u, ranges );
+        }
+        for (int count : seen) {
+            CHECK_EQUAL( 100, count );
+        }
+    }
+
+    TEST( SmallLoopsRunOnTheCallingThreadOnly ) {
+        ThreadPool pool{ 3u };
+        std::size_t calls = 0u;
+        std::size_t ranges = pool.parallelFor(10u, 64u, [&calls](std::size_t begin, std::size_t end, std::size_t range) {
+            CHECK_EQUAL( 0u, begin );
+            CHECK_EQUAL( 10u, end );
+            CHECK_EQUAL( 0u, range );
+            ++calls;
+        });
+        CHECK_EQUAL( 1u, ranges );
+        CHECK_EQUAL( 1u, calls );
+    }
+
+    TEST( NoRangeIsEmpty ) {
+        ThreadPool pool{ 3u };
+        // 5 indices over 4 threads rounds up to ranges of 2, so only three ranges are needed
+        // the results are checked on this thread, since UnitTest++ doesn't report from several threads
+        std::atomic<int> emptyRanges{ 0 };
+        std::size_t ranges = pool.parallelFor(5u, 1u, [&emptyRanges](std::size_t begin, std::size_t end, std::size_t) {
+            if (begin >= end) {
+                ++emptyRanges;
+            }
+        });
+        CHECK_EQUAL( 3u, ranges );
+        CHECK_EQUAL( 0, emptyRanges.load() );
+    }
+
+    TEST( EmptyLoopDoesNothing ) {
+        ThreadPool pool{ 2u };
+        std::atomic<int> calls{ 0 };
+        std::size_t ranges = pool.parallelFor(0u, 1u, [&calls](std::size_t, std::size_t, std::size_t) {
+            ++calls;
+        });
+        CHECK_EQUAL( 0u, ranges );
+        CHECK_EQUAL( 0, calls.load() );
+    }
+
+    TEST( PoolWithoutWorkersRunsEverythingOnTheCaller ) {
+        ThreadPool pool{ 0u };
+        CHECK_EQUAL( 1u, pool.size() );
+        int sum = 0;
+        pool.parallelFor(100u, 1u, [&sum](std::size_t begin, std::size_t end, std::size_t) {
+            for (std::size_t i = begin; i < end; ++i) {
+                sum += int(i);
+            }
+        });
+        CHECK_EQUAL( 4950, sum );
+    }
+}
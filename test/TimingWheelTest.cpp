@@ -0,0 +1,84 @@
+#include "utils/TimingWheel.h"
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <vector>
+
+using pg::TimingWheel;
+
+namespace {
+
+template<typename T, std::size_t N>
+std::vector<T> elements(const TimingWheel<T, N>& wheel) {
+    std::vector<T> result;
+    wheel.forEachSlot([&result](const T* data, std::size_t count) -> void {
+        result.insert(result.end(), data, data + count);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}
+
+SUITE( TimingWheelTest ) {
+
+    TEST( ElementsLiveUntilTheirLifetimeRunsOut ) {
+        TimingWheel<int> wheel{ 0.1f };
+        wheel.insert(1, 0.25f);
+        wheel.insert(2, 1.f);
+        CHECK_EQUAL( 2u, wheel.size() );
+        wheel.advance(0.2f);
+        CHECK_EQUAL( 2u, wheel.size() );
+        wheel.advance(0.2f);
+        CHECK_EQUAL( 1u, wheel.size() );
+        CHECK( elements(wheel) == std::vector<int>{ 2 } );
+        wheel.advance(0.7f);
+        CHECK( wheel.empty() );
+    }
+
+    TEST( ElementsExpireAtMostOneTickLate ) {
+        TimingWheel<int> wheel{ 0.1f };
+        wheel.advance(0.05f);
+        wheel.insert(1, 0.3f);
+        wheel.advance(0.3f);
+        CHECK_EQUAL( 1u, wheel.size() );
+        wheel.advance(0.1f);
+        CHECK( wheel.empty() );
+    }
+
+    TEST( ElementsLongerThanARevolutionSurviveIt ) {
+        TimingWheel<int, 8u> wheel{ 1.f };
+        wheel.insert(1, 2.5f);
+        wheel.insert(2, 20.5f);
+        for (int i = 0; i < 10; ++i) {
+            wheel.advance(1.f);
+        }
+        CHECK( elements(wheel) == std::vector<int>{ 2 } );
+        for (int i = 0; i < 11; ++i) {
+            wheel.advance(1.f);
+        }
+        CHECK( wheel.empty() );
+    }
+
+    TEST( LargeStepsExpireEverythingDue ) {
+        TimingWheel<int, 8u> wheel{ 1.f };
+        for (int i = 0; i < 32; ++i) {
+            wheel.insert(i, float(i));
+        }
+        wheel.advance(100.f);
+        CHECK( wheel.empty() );
+    }
+
+    TEST( SlotsAreContiguous ) {
+        TimingWheel<int> wheel{ 1.f };
+        for (int i = 0; i < 100; ++i) {
+            wheel.insert(i, 5.f);
+        }
+        std::size_t slots = 0u;
+        wheel.forEachSlot([&slots](const int* data, std::size_t count) -> void {
+            ++slots;
+            CHECK_EQUAL( 100u, count );
+            CHECK_EQUAL( 99, data[99] );
+        });
+        CHECK_EQUAL( 1u, slots );
+    }
+}
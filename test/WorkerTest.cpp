@@ -0,0 +1,44 @@
+#include "utils/Worker.h"
+#include <UnitTest++/UnitTest++.h>
+#include <thread>
+#include <vector>
+
+using pg::Worker;
+
+SUITE( WorkerTest ) {
+
+    TEST( TasksRunOnTheWorkerThread ) {
+        Worker worker;
+        std::thread::id id{};
+        worker.start([&id]() -> void { id = std::this_thread::get_id(); });
+        worker.wait();
+        CHECK( id != std::thread::id{} );
+        CHECK( id != std::this_thread::get_id() );
+    }
+
+    TEST( ResultsAreVisibleAfterWait ) {
+        Worker worker;
+        std::vector<int> values;
+        for (int i = 0; i < 100; ++i) {
+            worker.start([&values, i]() -> void { values.push_back(i); });
+            worker.wait();
+            CHECK_EQUAL( std::size_t(i + 1), values.size() );
+        }
+        CHECK_EQUAL( 99, values.back() );
+    }
+
+    TEST( WaitingWithoutATaskReturns ) {
+        Worker worker;
+        worker.wait();
+        worker.wait();
+    }
+
+    TEST( DestructorFinishesTheTask ) {
+        bool done = false;
+        {
+            Worker worker;
+            worker.start([&done]() -> void { done = true; });
+        }
+        CHECK( done );
+    }
+}